@@ -0,0 +1,480 @@
+//
+//  GRJsonBenchmark.m
+//  GRFoundation
+//
+//  Created by Grant Robinson on 10/17/26.
+//  Copyright (c) 2026 Grant Robinson. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "GRJson.h"
+#import "GRJsonFormatter.h"
+#import "GRJsonParser.h"
+#import "GRJsonWriter.h"
+#import "GRJsonValue.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/resource.h>
+
+/**
+ Measures JSON throughput, allocations and memory for every engine over every case, printing one JSON object
+ per line (see README.md for the format), and checks the results against an optional thresholds file.
+ */
+
+#pragma mark - allocation counting
+
+static uint64_t allocationCount;
+
+#if defined(__APPLE__)
+
+/* libmalloc reports every allocation to this hook once it is set; it is what malloc stack logging uses */
+typedef void (malloc_logger_t)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t framesToSkip);
+extern malloc_logger_t *malloc_logger;
+#define MALLOC_LOG_TYPE_ALLOCATE 2
+
+static void logAllocation(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t framesToSkip) {
+	if (type & MALLOC_LOG_TYPE_ALLOCATE) {
+		__atomic_add_fetch(&allocationCount, 1, __ATOMIC_RELAXED);
+	}
+}
+
+static BOOL startCountingAllocations(void) {
+	malloc_logger = logAllocation;
+	return YES;
+}
+
+#elif defined(__GLIBC__)
+
+/* the executable's own malloc family takes precedence over libc's for every library in the process */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+	__atomic_add_fetch(&allocationCount, 1, __ATOMIC_RELAXED);
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+	__atomic_add_fetch(&allocationCount, 1, __ATOMIC_RELAXED);
+	return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+	__atomic_add_fetch(&allocationCount, 1, __ATOMIC_RELAXED);
+	return __libc_realloc(ptr, size);
+}
+
+static BOOL startCountingAllocations(void) {
+	return YES;
+}
+
+#else
+
+static BOOL startCountingAllocations(void) {
+	return NO;
+}
+
+#endif
+
+static inline uint64_t currentAllocations(void) {
+	return __atomic_load_n(&allocationCount, __ATOMIC_RELAXED);
+}
+
+/** the high-water mark of the process's resident set, in kilobytes */
+static long peakResidentKilobytes(void) {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+	return (long)(usage.ru_maxrss / 1024);
+#else
+	return (long)usage.ru_maxrss;
+#endif
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+#pragma mark - engines
+
+/** Receives every event and does nothing with it: the raw cost of tokenizing, without strings or numbers. */
+@interface GRJsonBenchmarkSink : NSObject <GRJsonDelegate>
+@end
+
+@implementation GRJsonBenchmarkSink
+
+- (void) json_null {}
+- (void) json_bool:(BOOL)boolVal {}
+- (void) json_number:(const unsigned char *)numberVal length:(unsigned long)len {}
+- (void) json_string:(NSString *)strVal {}
+- (void) json_object_begin {}
+- (void) json_object_key:(NSString *)key {}
+- (void) json_object_end {}
+- (void) json_array_begin {}
+- (void) json_array_end {}
+- (void) json_string_bytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii {}
+- (void) json_object_key_bytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii {}
+- (void) json_integer:(int64_t)value {}
+- (void) json_double:(double)value {}
+
+@end
+
+/** Parses into an arena that is rewound rather than freed between documents, as a C consumer would. */
+@interface GRJsonBenchmarkValueTree : NSObject {
+	GRJsonArena arena;
+	GRJsonTokenizer tokenizer;
+}
+- (BOOL) parse:(NSData *)data error:(NSError *__autoreleasing *)error;
+@end
+
+@implementation GRJsonBenchmarkValueTree
+
+- (instancetype) init {
+	if ((self = [super init])) {
+		GRJsonArenaInit(&arena);
+		GRJsonTokenizerInit(&tokenizer);
+	}
+	return self;
+}
+
+- (void) dealloc {
+	GRJsonArenaRelease(&arena);
+	GRJsonTokenizerDestroy(&tokenizer);
+}
+
+- (BOOL) parse:(NSData *)data error:(NSError *__autoreleasing *)error {
+	GRJsonArenaReset(&arena);
+	const GRJsonValue *root = NULL;
+	if (GRJsonValueParse(&arena, &tokenizer, data.bytes, data.length, &root) != GRJsonErrorNone) {
+		if (error) {
+			*error = [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: @(tokenizer.errorMessage)}];
+		}
+		return NO;
+	}
+	return root != NULL;
+}
+
+@end
+
+typedef BOOL (^GRJsonBenchmarkEngine)(NSData *data, NSError *__autoreleasing *error);
+
+/** the engines, in the order they are reported */
+static NSArray<NSString *> *engineNames(void) {
+	return @[@"grjson-sax", @"grjson-validate", @"grjson-minify", @"grjson-pretty", @"grjson-value", @"grjsonparser", @"nsjsonserialization"];
+}
+
+/** a fresh engine, so that whatever it keeps between documents is set up before timing starts */
+static GRJsonBenchmarkEngine makeEngine(NSString *name) {
+	if ([name isEqualToString:@"grjson-sax"]) {
+		GRJsonBenchmarkSink *sink = [[GRJsonBenchmarkSink alloc] init];
+		GRJson *json = [[GRJson alloc] initWithDelegate:sink];
+		return ^BOOL(NSData *data, NSError *__autoreleasing *error) {
+			json.data = data;
+			BOOL parsed = [json parse:error];
+			json.data = nil;
+			// keeps the sink alive for as long as the engine, since the parser only holds it weakly
+			return parsed && sink != nil;
+		};
+	}
+	if ([name isEqualToString:@"grjson-validate"]) {
+		return ^BOOL(NSData *data, NSError *__autoreleasing *error) {
+			return [GRJson validateData:data error:error];
+		};
+	}
+	if ([name isEqualToString:@"grjson-minify"] || [name isEqualToString:@"grjson-pretty"]) {
+		GRJsonTranscodeStyle style = [name isEqualToString:@"grjson-minify"] ? GRJsonTranscodeMinify : GRJsonTranscodePretty;
+		return ^BOOL(NSData *data, NSError *__autoreleasing *error) {
+			GRJsonFormatter *formatter = [[GRJsonFormatter alloc] initWithStyle:style indentWidth:2];
+			return [formatter feed:data error:error] && [formatter finish:error];
+		};
+	}
+	if ([name isEqualToString:@"grjson-value"]) {
+		GRJsonBenchmarkValueTree *tree = [[GRJsonBenchmarkValueTree alloc] init];
+		return ^BOOL(NSData *data, NSError *__autoreleasing *error) {
+			return [tree parse:data error:error];
+		};
+	}
+	if ([name isEqualToString:@"grjsonparser"]) {
+		GRJsonParser *parser = [[GRJsonParser alloc] init];
+		return ^BOOL(NSData *data, NSError *__autoreleasing *error) {
+			return [parser JSONObjectFromData:data error:error] != nil;
+		};
+	}
+	if ([name isEqualToString:@"nsjsonserialization"]) {
+		return ^BOOL(NSData *data, NSError *__autoreleasing *error) {
+			return [NSJSONSerialization JSONObjectWithData:data options:0 error:error] != nil;
+		};
+	}
+	return nil;
+}
+
+#pragma mark - cases
+
+/** an array of documents with objects and arrays nested depth levels deep, to stress container bookkeeping */
+static NSData *deepNestingCase(void) {
+	const int documents = 200;
+	const int depth = 256;
+	NSMutableData *data = [NSMutableData dataWithCapacity:(NSUInteger)(documents * depth * 7)];
+	[data appendBytes:"[" length:1];
+	for (int i = 0; i < documents; i++) {
+		if (i) {
+			[data appendBytes:"," length:1];
+		}
+		for (int level = 0; level < depth; level++) {
+			[data appendBytes:(level & 1) ? "[" : "{\"a\":" length:(level & 1) ? 1 : 5];
+		}
+		[data appendBytes:"1" length:1];
+		for (int level = depth - 1; level >= 0; level--) {
+			[data appendBytes:(level & 1) ? "]" : "}" length:1];
+		}
+	}
+	[data appendBytes:"]" length:1];
+	return data;
+}
+
+/** a few very long strings: plain ASCII, escape-heavy, and multi-byte UTF-8 */
+static NSData *longStringsCase(void) {
+	const NSUInteger stringLength = 64 * 1024;
+	NSMutableString *json = [NSMutableString stringWithString:@"["];
+	NSArray<NSString *> *pieces = @[@"the quick brown fox jumps over the lazy dog ", @"tab\\there \\\"quoted\\\" line\\n\\u00e9 ", @"日本語のテキスト café "];
+	for (NSUInteger i = 0; i < 48; i++) {
+		if (i) {
+			[json appendString:@","];
+		}
+		[json appendString:@"\""];
+		NSString *piece = pieces[i % pieces.count];
+		NSUInteger start = json.length;
+		while (json.length - start < stringLength) {
+			[json appendString:piece];
+		}
+		[json appendString:@"\""];
+	}
+	[json appendString:@"]"];
+	return [json dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+/** the standard corpus files that are present in the directory, then the synthetic cases */
+static NSArray<NSArray *> *loadCases(NSString *corpus, NSMutableArray<NSString *> *missing) {
+	NSMutableArray<NSArray *> *cases = [NSMutableArray array];
+	for (NSString *name in @[@"twitter", @"canada", @"citm_catalog"]) {
+		NSString *path = [[corpus stringByAppendingPathComponent:name] stringByAppendingPathExtension:@"json"];
+		NSData *data = [NSData dataWithContentsOfFile:path];
+		if (data) {
+			[cases addObject:@[name, data]];
+		}
+		else {
+			[missing addObject:name];
+		}
+	}
+	[cases addObject:@[@"deep_nesting", deepNestingCase()]];
+	[cases addObject:@[@"long_strings", longStringsCase()]];
+	return cases;
+}
+
+#pragma mark - output
+
+static void printLine(void (^write)(GRJsonWriter *writer)) {
+	GRJsonWriter *writer = [[GRJsonWriter alloc] init];
+	[writer beginObject];
+	write(writer);
+	[writer endObject];
+	NSData *line = writer.data;
+	fwrite(line.bytes, 1, line.length, stdout);
+	fputc('\n', stdout);
+	fflush(stdout);
+}
+
+static void writeField(GRJsonWriter *writer, NSString *key, id value) {
+	[writer writeKey:key];
+	[writer writeObject:value];
+}
+
+#pragma mark - running
+
+typedef struct GRJsonBenchmarkResult {
+	NSUInteger iterations;
+	double seconds;
+	double bestSeconds;
+	double allocationsPerDocument; ///< negative when allocations can't be counted
+	long peakResidentKilobytes;
+} GRJsonBenchmarkResult;
+
+/** runs the engine over data for at least minTime seconds, after one untimed warm-up pass */
+static BOOL runCase(GRJsonBenchmarkEngine engine, NSData *data, double minTime, BOOL countingAllocations, GRJsonBenchmarkResult *result, NSError *__autoreleasing *error) {
+	@autoreleasepool {
+		if (!engine(data, error)) {
+			return NO;
+		}
+	}
+	uint64_t allocationsBefore = currentAllocations();
+	NSUInteger iterations = 0;
+	double total = 0;
+	double best = HUGE_VAL;
+	while (total < minTime || iterations < 3) {
+		@autoreleasepool {
+			double start = now();
+			BOOL parsed = engine(data, NULL);
+			double elapsed = now() - start;
+			if (!parsed) {
+				break;
+			}
+			total += elapsed;
+			best = MIN(best, elapsed);
+			iterations++;
+		}
+	}
+	if (iterations == 0) {
+		return NO;
+	}
+	result->iterations = iterations;
+	result->seconds = total;
+	result->bestSeconds = best;
+	result->allocationsPerDocument = countingAllocations ? (double)(currentAllocations() - allocationsBefore) / (double)iterations : -1;
+	result->peakResidentKilobytes = peakResidentKilobytes();
+	return YES;
+}
+
+/** the limits for one case and engine: an exact "case/engine" entry, falling back to "*" + "/engine" */
+static NSDictionary *limitsFor(NSDictionary *thresholds, NSString *caseName, NSString *engine) {
+	NSDictionary *limits = thresholds[[NSString stringWithFormat:@"%@/%@", caseName, engine]];
+	return limits ?: thresholds[[NSString stringWithFormat:@"*/%@", engine]];
+}
+
+/** compares one measurement with its limit, printing a regression record if it is on the wrong side */
+static BOOL checkLimit(NSDictionary *limits, NSString *limitName, NSString *metric, double value, BOOL isMinimum, NSString *caseName, NSString *engine) {
+	NSNumber *limit = limits[limitName];
+	if (limit == nil || value < 0) {
+		return YES;
+	}
+	BOOL within = isMinimum ? value >= limit.doubleValue : value <= limit.doubleValue;
+	if (!within) {
+		printLine(^(GRJsonWriter *writer) {
+			writeField(writer, @"type", @"regression");
+			writeField(writer, @"case", caseName);
+			writeField(writer, @"engine", engine);
+			writeField(writer, @"metric", metric);
+			writeField(writer, @"limit", limit);
+			writeField(writer, @"value", @(value));
+		});
+	}
+	return within;
+}
+
+static void usage(void) {
+	fprintf(stderr, "usage: GRJsonBenchmark [--corpus DIR] [--thresholds FILE] [--min-time SECONDS] [--case NAME] [--engine NAME]\n");
+}
+
+int main(int argc, const char *argv[]) {
+	@autoreleasepool {
+		NSString *corpus = @"Corpus";
+		NSString *thresholdsPath = nil;
+		NSString *onlyCase = nil;
+		NSString *onlyEngine = nil;
+		double minTime = 1.0;
+		for (int i = 1; i < argc; i++) {
+			NSString *option = @(argv[i]);
+			if (i + 1 >= argc) {
+				usage();
+				return 2;
+			}
+			NSString *value = @(argv[++i]);
+			if ([option isEqualToString:@"--corpus"]) {
+				corpus = value;
+			}
+			else if ([option isEqualToString:@"--thresholds"]) {
+				thresholdsPath = value;
+			}
+			else if ([option isEqualToString:@"--min-time"]) {
+				minTime = value.doubleValue;
+			}
+			else if ([option isEqualToString:@"--case"]) {
+				onlyCase = value;
+			}
+			else if ([option isEqualToString:@"--engine"]) {
+				onlyEngine = value;
+			}
+			else {
+				usage();
+				return 2;
+			}
+		}
+
+		NSDictionary *thresholds = nil;
+		if (thresholdsPath) {
+			NSError *error = nil;
+			NSData *thresholdsData = [NSData dataWithContentsOfFile:thresholdsPath];
+			thresholds = thresholdsData ? [GRJsonParser JSONObjectFromData:thresholdsData error:&error] : nil;
+			if (![thresholds isKindOfClass:[NSDictionary class]]) {
+				fprintf(stderr, "could not read thresholds from %s\n", thresholdsPath.UTF8String);
+				return 2;
+			}
+		}
+
+		BOOL countingAllocations = startCountingAllocations();
+		NSMutableArray<NSString *> *missing = [NSMutableArray array];
+		NSArray<NSArray *> *cases = loadCases(corpus, missing);
+
+		printLine(^(GRJsonWriter *writer) {
+			writeField(writer, @"type", @"environment");
+			writeField(writer, @"simd_backend", @(GRJsonSimdBackendName([GRJson simdBackend])));
+			writeField(writer, @"processors", @([NSProcessInfo processInfo].activeProcessorCount));
+			writeField(writer, @"os", [NSProcessInfo processInfo].operatingSystemVersionString);
+			writeField(writer, @"min_time", @(minTime));
+			writeField(writer, @"counts_allocations", @(countingAllocations));
+			writeField(writer, @"missing_corpus", missing);
+		});
+
+		BOOL passed = YES;
+		for (NSArray *testCase in cases) {
+			NSString *caseName = testCase[0];
+			NSData *data = testCase[1];
+			if (onlyCase && ![onlyCase isEqualToString:caseName]) {
+				continue;
+			}
+			for (NSString *engine in engineNames()) {
+				if (onlyEngine && ![onlyEngine isEqualToString:engine]) {
+					continue;
+				}
+				@autoreleasepool {
+					GRJsonBenchmarkResult result;
+					NSError *error = nil;
+					if (!runCase(makeEngine(engine), data, minTime, countingAllocations, &result, &error)) {
+						printLine(^(GRJsonWriter *writer) {
+							writeField(writer, @"type", @"error");
+							writeField(writer, @"case", caseName);
+							writeField(writer, @"engine", engine);
+							writeField(writer, @"message", error.localizedDescription ?: @"failed");
+						});
+						continue;
+					}
+					double megabytesPerSecond = (double)data.length * (double)result.iterations / result.seconds / 1e6;
+					double bestMegabytesPerSecond = (double)data.length / result.bestSeconds / 1e6;
+					printLine(^(GRJsonWriter *writer) {
+						writeField(writer, @"type", @"result");
+						writeField(writer, @"case", caseName);
+						writeField(writer, @"engine", engine);
+						writeField(writer, @"bytes", @(data.length));
+						writeField(writer, @"iterations", @(result.iterations));
+						writeField(writer, @"mb_per_s", @(megabytesPerSecond));
+						writeField(writer, @"best_mb_per_s", @(bestMegabytesPerSecond));
+						writeField(writer, @"allocations_per_doc", result.allocationsPerDocument >= 0 ? @(result.allocationsPerDocument) : nil);
+						writeField(writer, @"peak_rss_kb", @(result.peakResidentKilobytes));
+					});
+					NSDictionary *limits = limitsFor(thresholds, caseName, engine);
+					if (limits) {
+						passed &= checkLimit(limits, @"min_mb_per_s", @"mb_per_s", megabytesPerSecond, YES, caseName, engine);
+						passed &= checkLimit(limits, @"max_allocations_per_doc", @"allocations_per_doc", result.allocationsPerDocument, NO, caseName, engine);
+						passed &= checkLimit(limits, @"max_peak_rss_kb", @"peak_rss_kb", (double)result.peakResidentKilobytes, NO, caseName, engine);
+					}
+				}
+			}
+		}
+		return passed ? 0 : 1;
+	}
+}
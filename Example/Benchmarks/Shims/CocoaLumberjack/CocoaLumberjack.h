@@ -0,0 +1,36 @@
+//
+//  CocoaLumberjack.h
+//  GRFoundation
+//
+//  Created by Grant Robinson on 10/17/26.
+//  Copyright (c) 2026 Grant Robinson. All rights reserved.
+//
+
+// Just enough of CocoaLumberjack for the library's Logging.h, so the benchmark builds without the pod.
+
+#ifndef GRJsonBenchmark_CocoaLumberjack_h
+#define GRJsonBenchmark_CocoaLumberjack_h
+
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(NSUInteger, DDLogLevel) {
+	DDLogLevelOff = 0,
+	DDLogLevelError = 1,
+	DDLogLevelWarning = 3,
+	DDLogLevelInfo = 7,
+	DDLogLevelDebug = 15,
+	DDLogLevelVerbose = 31,
+};
+
+// parse errors are expected while benchmarking, so only explicit builds with GRJSON_BENCHMARK_LOG see them
+#ifdef GRJSON_BENCHMARK_LOG
+#define DDLogError(frmt, ...) NSLog(frmt, ##__VA_ARGS__)
+#else
+#define DDLogError(frmt, ...) do { if (0) { NSLog(frmt, ##__VA_ARGS__); } } while (0)
+#endif
+#define DDLogWarn DDLogError
+#define DDLogInfo DDLogError
+#define DDLogDebug DDLogError
+#define DDLogVerbose DDLogError
+
+#endif /* GRJsonBenchmark_CocoaLumberjack_h */
@@ -9,6 +9,9 @@
 // https://github.com/Specta/Specta
 
 #import <GRFoundation/GRFoundation.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
 
 struct TestSerializeStruct {
 	double value1;
@@ -191,6 +194,103 @@ GROArrayClass(objects, CustomParentClass)
 
 @end
 
+@interface JSONEventRecorder : NSObject <GRJsonDelegate>
+
+@property (nonatomic, strong) NSMutableArray<NSString *> *events;
+
++ (NSArray<NSString *> *) eventsForJSON:(NSString *)json error:(NSError *__autoreleasing *)error;
+
+@end
+
+@implementation JSONEventRecorder
+
++ (NSArray<NSString *> *) eventsForJSON:(NSString *)json error:(NSError *__autoreleasing *)error {
+	JSONEventRecorder *recorder = [[JSONEventRecorder alloc] init];
+	GRJson *parser = [[GRJson alloc] initWithData:[json dataUsingEncoding:NSUTF8StringEncoding] delegate:recorder];
+	if (![parser parse:error]) {
+		return nil;
+	}
+	return recorder.events;
+}
+
+- (instancetype) init {
+	self = [super init];
+	if (self) {
+		_events = [NSMutableArray array];
+	}
+	return self;
+}
+
+- (void) json_null {
+	[_events addObject:@"null"];
+}
+
+- (void) json_bool:(BOOL)boolVal {
+	[_events addObject:boolVal ? @"true" : @"false"];
+}
+
+- (void) json_number:(const unsigned char *)numberVal length:(unsigned long)len {
+	[_events addObject:[NSString stringWithFormat:@"number:%@", [[NSString alloc] initWithBytes:numberVal length:len encoding:NSUTF8StringEncoding]]];
+}
+
+- (void) json_string:(NSString *)strVal {
+	[_events addObject:[NSString stringWithFormat:@"string:%@", strVal]];
+}
+
+- (void) json_object_begin {
+	[_events addObject:@"{"];
+}
+
+- (void) json_object_key:(NSString *)key {
+	[_events addObject:[NSString stringWithFormat:@"key:%@", key]];
+}
+
+- (void) json_object_end {
+	[_events addObject:@"}"];
+}
+
+- (void) json_array_begin {
+	[_events addObject:@"["];
+}
+
+- (void) json_array_end {
+	[_events addObject:@"]"];
+}
+
+@end
+
+@interface JSONByteSpanRecorder : JSONEventRecorder
+
+@end
+
+@implementation JSONByteSpanRecorder
+
+- (void) json_string_bytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii {
+	[self.events addObject:[NSString stringWithFormat:@"string_bytes:%@:%d:%d", [[NSString alloc] initWithBytes:bytes length:len encoding:NSUTF8StringEncoding], needsUnescape, ascii]];
+}
+
+- (void) json_object_key_bytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii {
+	[self.events addObject:[NSString stringWithFormat:@"key_bytes:%@", [GRJson stringWithBytes:bytes length:len needsUnescape:needsUnescape]]];
+}
+
+@end
+
+/** compresses data with zlib; windowBits picks the format, as for deflateInit2 */
+static NSData *deflatedData(NSData *data, int windowBits) {
+	z_stream z;
+	memset(&z, 0, sizeof(z));
+	deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+	NSMutableData *compressed = [NSMutableData dataWithLength:deflateBound(&z, data.length)];
+	z.next_in = (Bytef *)data.bytes;
+	z.avail_in = (uInt)data.length;
+	z.next_out = compressed.mutableBytes;
+	z.avail_out = (uInt)compressed.length;
+	deflate(&z, Z_FINISH);
+	compressed.length = z.total_out;
+	deflateEnd(&z);
+	return compressed;
+}
+
 SpecBegin(InitialSpecs)
 
 describe(@"JSONConversion", ^{
@@ -331,7 +431,888 @@ describe(@"JSONConversion", ^{
 		expect(error).to.beNil();
 		expect(obj).to.beKindOf([CustomChildClassPartTwo class]);
 	});
-	
+
+	it(@"maps JSON data in a single pass", ^{
+		NSData *data = [@"{\"unknown\": {\"deep\": [1, 2, {\"x\": null}]}, \"unknownText\": \"not mapped \\u00e9\", \"objects\": [{\"type\": \"parent\"}, {\"type\": \"child\", \"alsoUnknown\": \"dropped\"}, {\"type\": \"childPartTwo\", \"notInParent\": \"here\"}]}" dataUsingEncoding:NSUTF8StringEncoding];
+		NSError *error = nil;
+		CustomContainerClass *mapped = [GROMapper mapData:data to:[CustomContainerClass class] error:&error];
+		expect(error).to.beNil();
+		CustomContainerClass *viaTree = [GROMapper map:[GRJsonParser JSONObjectFromData:data error:&error] to:[CustomContainerClass class] error:&error];
+		expect(@(mapped.objects.count)).to.equal(@(viaTree.objects.count));
+		expect(mapped.objects[0]).to.beKindOf([CustomParentClass class]);
+		expect(mapped.objects[1]).to.beKindOf([CustomChildClass class]);
+		expect(mapped.objects[2]).to.beKindOf([CustomChildClassPartTwo class]);
+		expect(((CustomChildClassPartTwo *)mapped.objects[2]).notInParent).to.equal(@"here");
+
+		NSArray<CustomParentClass *> *objects = [GROMapper mapData:[@"[{\"type\": \"child\"}]" dataUsingEncoding:NSUTF8StringEncoding] to:[CustomParentClass class] error:&error];
+		expect(error).to.beNil();
+		expect(objects[0]).to.beKindOf([CustomChildClass class]);
+
+		expect([GROMapper mapData:[@"\"text\"" dataUsingEncoding:NSUTF8StringEncoding] to:[CustomParentClass class] error:&error]).to.beNil();
+		expect(error.code).to.equal(GROMapperErrorCodeInvalidRootJSONObject);
+		error = nil;
+		expect([GROMapper mapData:[@"{\"objects\": [1]}" dataUsingEncoding:NSUTF8StringEncoding] to:[CustomContainerClass class] error:&error]).to.beNil();
+		expect(error).toNot.beNil();
+	});
+
+});
+
+describe(@"GRJson", ^{
+
+	it(@"produces the same events with every SIMD backend", ^{
+		NSMutableString *json = [NSMutableString stringWithString:@"{\n"];
+		for (int i = 0; i < 50; i++) {
+			[json appendFormat:@"    \"key%d\" : [\"a long string value that spans more than one sixty-four byte block %d\", %d, true, null, {\"nested\\\"key\" : \"esc\\\\aped\"}],\n", i, i, i];
+		}
+		[json appendString:@"\t\"last\":false\r\n}"];
+		GRJsonSimdBackend backends[] = {GRJsonSimdBackendScalar, GRJsonSimdBackendSSE2, GRJsonSimdBackendAVX2, GRJsonSimdBackendNEON};
+		[GRJson setSimdBackend:GRJsonSimdBackendScalar];
+		NSArray<NSString *> *expected = [JSONEventRecorder eventsForJSON:json error:nil];
+		expect(expected.count).to.beGreaterThan(50);
+		for (size_t i = 1; i < sizeof(backends) / sizeof(backends[0]); i++) {
+			if (![GRJson setSimdBackend:backends[i]]) {
+				continue;
+			}
+			expect([JSONEventRecorder eventsForJSON:json error:nil]).to.equal(expected);
+		}
+		[GRJson setSimdBackend:GRJsonSimdBackendAuto];
+	});
+
+	it(@"parses null inside containers", ^{
+		NSError *error = nil;
+		expect([JSONEventRecorder eventsForJSON:@"[null, {\"a\" : null, \"b\" : [null]}, null]" error:&error]).to.equal((@[@"[", @"null", @"{", @"key:a", @"null", @"key:b", @"[", @"null", @"]", @"}", @"null", @"]"]));
+		expect(error).to.beNil();
+		expect([JSONEventRecorder eventsForJSON:@"null" error:&error]).to.equal(@[@"null"]);
+		expect([JSONEventRecorder eventsForJSON:@"[nul]" error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+	});
+
+	it(@"parses negative numbers and rejects other signs", ^{
+		NSError *error = nil;
+		expect([JSONEventRecorder eventsForJSON:@"[-1, -0, -0.5, -1e-3, -12E+2, 7]" error:&error]).to.equal((@[@"[", @"number:-1", @"number:-0", @"number:-0.5", @"number:-1e-3", @"number:-12E+2", @"number:7", @"]"]));
+		expect(error).to.beNil();
+		for (NSString *json in @[@"[+1]", @"[-]", @"[--1]", @"[-a]", @"[- 1]", @"[-01]", @"+1", @"-"]) {
+			error = nil;
+			expect([JSONEventRecorder eventsForJSON:json error:&error]).to.beNil();
+			expect(error).notTo.beNil();
+		}
+	});
+
+	it(@"produces the same events when fed one byte at a time", ^{
+		NSString *json = @"{\"name\" : \"caf\\u00e9 \\\"quoted\\\"\", \"values\" : [12345, -0.5e10, true, false, null], \"empty\" : {}}";
+		NSArray<NSString *> *expected = [JSONEventRecorder eventsForJSON:json error:nil];
+		NSData *data = [json dataUsingEncoding:NSUTF8StringEncoding];
+		JSONEventRecorder *recorder = [[JSONEventRecorder alloc] init];
+		GRJson *parser = [[GRJson alloc] initWithDelegate:recorder];
+		NSError *error = nil;
+		for (NSUInteger i = 0; i < data.length; i++) {
+			expect([parser feed:[data subdataWithRange:NSMakeRange(i, 1)] error:&error]).to.beTruthy();
+		}
+		expect([parser finish:&error]).to.beTruthy();
+		expect(error).to.beNil();
+		expect(recorder.events).to.equal(expected);
+	});
+
+	it(@"parses streams and file descriptors through a small fixed buffer", ^{
+		NSMutableString *json = [NSMutableString stringWithString:@"["];
+		for (int i = 0; i < 200; i++) {
+			[json appendFormat:@"%@{\"key %d\" : \"a value long enough to straddle the read buffer \\u00e9 %d\", \"n\" : %d.5e1}", i ? @", " : @"", i, i, i];
+		}
+		[json appendString:@"]"];
+		NSArray<NSString *> *expected = [JSONEventRecorder eventsForJSON:json error:nil];
+		NSData *data = [json dataUsingEncoding:NSUTF8StringEncoding];
+		NSError *error = nil;
+
+		JSONEventRecorder *recorder = [[JSONEventRecorder alloc] init];
+		GRJson *parser = [[GRJson alloc] initWithDelegate:recorder];
+		parser.readBufferSize = 256;
+		expect([parser parseStream:[NSInputStream inputStreamWithData:data] error:&error]).to.beTruthy();
+		expect(error).to.beNil();
+		expect(recorder.events).to.equal(expected);
+
+		NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+		[data writeToFile:path atomically:NO];
+		int fd = open(path.fileSystemRepresentation, O_RDONLY);
+		recorder = [[JSONEventRecorder alloc] init];
+		parser = [[GRJson alloc] initWithDelegate:recorder];
+		parser.readBufferSize = 256;
+		expect([parser parseFileDescriptor:fd error:&error]).to.beTruthy();
+		close(fd);
+		[[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+		expect(recorder.events).to.equal(expected);
+
+		NSData *truncated = [data subdataWithRange:NSMakeRange(0, data.length - 1)];
+		recorder = [[JSONEventRecorder alloc] init];
+		expect([[[GRJson alloc] initWithDelegate:recorder] parseStream:[NSInputStream inputStreamWithData:truncated] error:&error]).to.beFalsy();
+		expect(error).notTo.beNil();
+		expect(recorder.events.count).to.equal(expected.count - 1);
+	});
+
+	it(@"reports a truncated document when fed data is finished", ^{
+		JSONEventRecorder *recorder = [[JSONEventRecorder alloc] init];
+		GRJson *parser = [[GRJson alloc] initWithDelegate:recorder];
+		NSError *error = nil;
+		expect([parser feed:[@"[1, 2, \"thr" dataUsingEncoding:NSUTF8StringEncoding] error:&error]).to.beTruthy();
+		expect(recorder.events).to.equal(@[@"[", @"number:1", @"number:2"]);
+		expect([parser finish:&error]).to.beFalsy();
+		expect(error).notTo.beNil();
+	});
+
+	it(@"reports an earlier error when fed an empty chunk", ^{
+		GRJson *parser = [[GRJson alloc] initWithDelegate:[[JSONEventRecorder alloc] init]];
+		NSError *error = nil;
+		expect([parser feed:[@"[1, ]" dataUsingEncoding:NSUTF8StringEncoding] error:&error]).to.beFalsy();
+		NSString *reason = error.localizedDescription;
+		error = nil;
+		expect([parser feed:[NSData data] error:&error]).to.beFalsy();
+		expect(error.localizedDescription).to.equal(reason);
+	});
+
+	it(@"hands strings and keys to delegates that want byte spans without creating strings", ^{
+		JSONByteSpanRecorder *recorder = [[JSONByteSpanRecorder alloc] init];
+		GRJson *parser = [[GRJson alloc] initWithData:[@"{\"a\\tb\" : [\"plain\", \"tab\\there\", \"caf\u00e9\"]}" dataUsingEncoding:NSUTF8StringEncoding] delegate:recorder];
+		NSError *error = nil;
+		expect([parser parse:&error]).to.beTruthy();
+		expect(recorder.events).to.equal(@[@"{", @"key_bytes:a\tb", @"[", @"string_bytes:plain:0:1", @"string_bytes:tab\\there:1:1", @"string_bytes:caf\u00e9:0:0", @"]", @"}"]);
+	});
+
+	it(@"rejects un-escaped control characters in strings", ^{
+		NSError *error = nil;
+		NSArray<NSString *> *events = [JSONEventRecorder eventsForJSON:@"[\"a\x01b\"]" error:&error];
+		expect(events).to.beNil();
+		expect(error).notTo.beNil();
+	});
+
+	it(@"validates documents without parsing them", ^{
+		NSError *error = nil;
+		expect([GRJson validateData:[@" {\"a\" : [1, -2.5e3, \"caf\u00e9 \\u00e9\", true, null]} " dataUsingEncoding:NSUTF8StringEncoding] error:&error]).to.beTruthy();
+		expect(error).to.beNil();
+		expect([GRJson validateData:[@"{\n  \"a\" : [1,\n  2,,]\n}" dataUsingEncoding:NSUTF8StringEncoding] error:&error]).to.beFalsy();
+		expect(error.userInfo[GRJsonErrorOffsetKey]).to.equal(@18);
+		expect(error.userInfo[GRJsonErrorLineKey]).to.equal(@3);
+		expect(error.userInfo[GRJsonErrorColumnKey]).to.equal(@5);
+		const char invalidUTF8[] = "[\"\xc3\x28\"]";
+		expect([GRJson validateData:[NSData dataWithBytes:invalidUTF8 length:strlen(invalidUTF8)] error:nil]).to.beFalsy();
+		expect([GRJson validateData:[NSData data] error:nil]).to.beFalsy();
+	});
+
+	it(@"decodes unicode escapes and rejects invalid UTF-8", ^{
+		NSError *error = nil;
+		NSArray *strings = [GRJsonParser JSONObjectFromData:[@"[\"\\ud83d\\ude00\", \"a\\ud83db\", \"caf\\u00e9 é\", \"tab\\there\"]" dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+		expect(error).to.beNil();
+		expect(strings).to.equal((@[@"\U0001F600", @"a\uFFFDb", @"café é", @"tab\there"]));
+		expect([GRJson stringWithBytes:(const unsigned char *)"\\u0041\\n" length:8 needsUnescape:YES]).to.equal(@"A\n");
+		const char invalidUTF8[] = "{\"key\" : \"\xed\xa0\x80\"}";
+		expect([GRJsonParser JSONObjectFromData:[NSData dataWithBytes:invalidUTF8 length:strlen(invalidUTF8)] error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+	});
+
+});
+
+describe(@"GRJsonParser", ^{
+
+	it(@"interns repeated object keys", ^{
+		NSMutableString *json = [NSMutableString stringWithString:@"["];
+		for (int i = 0; i < 100; i++) {
+			[json appendFormat:@"%@{\"id\" : %d, \"name\" : \"item %d\", \"status\" : \"ok\"}", i == 0 ? @"" : @",", i, i];
+		}
+		[json appendString:@"]"];
+		GRJsonParser *parser = [[GRJsonParser alloc] init];
+		NSError *error = nil;
+		NSArray<NSDictionary *> *objects = [parser JSONObjectFromData:[json dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+		expect(error).to.beNil();
+		expect(objects.count).to.equal(100);
+		expect(objects[99][@"name"]).to.equal(@"item 99");
+		expect(parser.keyCacheMisses).to.equal(3);
+		expect(parser.keyCacheHits).to.equal(297);
+		NSString *firstKey = [objects[0].allKeys sortedArrayUsingSelector:@selector(compare:)].firstObject;
+		NSString *lastKey = [objects[99].allKeys sortedArrayUsingSelector:@selector(compare:)].firstObject;
+		expect(firstKey).to.beIdenticalTo(lastKey);
+	});
+
+	it(@"can be reused after an error", ^{
+		GRJsonParser *parser = [[GRJsonParser alloc] init];
+		parser.ignoreNulls = YES;
+		NSError *error = nil;
+		expect([parser JSONObjectFromData:[@"{\"a\" : [1, {\"b\" : [2" dataUsingEncoding:NSUTF8StringEncoding] error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+		error = nil;
+		NSDictionary *result = [parser JSONObjectFromData:[@"{\"a\" : 1, \"n\" : null, \"list\" : [null, {}, []], \"a\" : 2}" dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+		expect(error).to.beNil();
+		expect(result).to.equal((@{@"a" : @2, @"list" : @[[NSNull null], @{}, @[]]}));
+		expect([result isKindOfClass:[NSMutableDictionary class]]).to.beFalsy();
+		expect([parser JSONObjectFromData:[@"\"top\"" dataUsingEncoding:NSUTF8StringEncoding] error:&error]).to.equal(@"top");
+	});
+
+	it(@"builds compact containers for small objects", ^{
+		NSMutableString *json = [NSMutableString stringWithString:@"{\"small\" : {\"a\" : 1, \"b\" : [true, \"x\"], \"a\" : 3}, \"large\" : {"];
+		for (int i = 0; i <= GRJSON_COMPACT_DICTIONARY_MAX_COUNT; i++) {
+			[json appendFormat:@"%@\"k%d\" : %d", i == 0 ? @"" : @", ", i, i];
+		}
+		[json appendString:@"}}"];
+		NSError *error = nil;
+		NSDictionary *result = [GRJsonParser JSONObjectFromData:[json dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+		expect(error).to.beNil();
+		expect(result).to.beKindOf([GRJsonCompactDictionary class]);
+		expect(result[@"small"]).to.beKindOf([GRJsonCompactDictionary class]);
+		expect(result[@"small"]).to.equal((@{@"a" : @3, @"b" : @[@YES, @"x"]}));
+		expect(result[@"small"][@"b"]).to.beKindOf([GRJsonCompactArray class]);
+		expect([result[@"large"] isKindOfClass:[GRJsonCompactDictionary class]]).to.beFalsy();
+		expect(result[@"large"][@"k12"]).to.equal(@12);
+		NSMutableArray *keys = [NSMutableArray array];
+		for (NSString *key in result[@"small"]) {
+			[keys addObject:key];
+		}
+		expect(keys).to.equal((@[@"a", @"b"]));
+		expect(result[@"missing"]).to.beNil();
+	});
+
+	it(@"builds compact containers through the Foundation initializers", ^{
+		NSDictionary *parsed = [GRJsonParser JSONObjectFromData:[@"{\"a\" : [1, 2]}" dataUsingEncoding:NSUTF8StringEncoding] error:nil];
+		NSArray *array = parsed[@"a"];
+		id keys[] = {@"x", @"y", @"x"};
+		id objects[] = {@1, @2, @3};
+		expect([[parsed class] dictionaryWithObjects:objects forKeys:keys count:3]).to.equal((@{@"x" : @3, @"y" : @2}));
+		expect([[parsed class] dictionary]).to.equal(@{});
+		expect([[array class] arrayWithObjects:objects count:3]).to.equal((@[@1, @2, @3]));
+		expect([[array class] array]).to.equal(@[]);
+		expect([NSKeyedUnarchiver unarchiveObjectWithData:[NSKeyedArchiver archivedDataWithRootObject:parsed]]).to.equal((@{@"a" : @[@1, @2]}));
+	});
+
+	it(@"parses a memory-mapped file", ^{
+		NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"GRJsonParserMappedTest.json"];
+		NSString *json = @"{\"short\" : \"a\", \"long\" : \"a string that is long enough not to be copied\", \"escaped\" : \"line\\nbreak that is also long enough\", \"list\" : [1, 2, 3]}";
+		[[json dataUsingEncoding:NSUTF8StringEncoding] writeToFile:path atomically:YES];
+		NSError *error = nil;
+		NSDictionary *result = [GRJsonParser JSONObjectFromFileAtPath:path options:GRJsonFileOptionsNoCopyStrings error:&error];
+		[[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+		expect(error).to.beNil();
+		expect(result[@"short"]).to.equal(@"a");
+		expect(result[@"long"]).to.equal(@"a string that is long enough not to be copied");
+		expect(result[@"escaped"]).to.equal(@"line\nbreak that is also long enough");
+		expect(result[@"list"]).to.equal(@[@1, @2, @3]);
+	});
+
+	it(@"reports a missing file", ^{
+		NSError *error = nil;
+		expect([GRJsonParser JSONObjectFromFileAtPath:@"/nonexistent/file.json" options:GRJsonFileOptionsNone error:&error]).to.beNil();
+		expect(error.domain).to.equal(NSPOSIXErrorDomain);
+	});
+
+	it(@"parses compressed JSON as it inflates", ^{
+		NSMutableString *json = [NSMutableString stringWithString:@"["];
+		for (int i = 0; i < 5000; i++) {
+			[json appendFormat:@"%@{\"id\" : %d, \"name\" : \"item %d\"}", i == 0 ? @"" : @",", i, i];
+		}
+		[json appendString:@"]"];
+		NSData *plain = [json dataUsingEncoding:NSUTF8StringEncoding];
+		NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"GRJsonParserCompressedTest.json.gz"];
+		[deflatedData(plain, MAX_WBITS + 16) writeToFile:path atomically:YES];
+		NSError *error = nil;
+		NSArray *result = [GRJsonParser JSONObjectFromCompressedFileAtPath:path error:&error];
+		[[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+		expect(error).to.beNil();
+		expect(result).to.equal([GRJsonParser JSONObjectFromData:plain error:nil]);
+
+		JSONEventRecorder *recorder = [[JSONEventRecorder alloc] init];
+		GRJsonInflater *inflater = [[GRJsonInflater alloc] initWithDelegate:recorder];
+		inflater.chunkSize = 256;
+		inflater.maxPendingChunks = 1;
+		expect([inflater parseData:deflatedData([@"{\"a\" : [true, null, \"text\"]}" dataUsingEncoding:NSUTF8StringEncoding], -MAX_WBITS) error:&error]).to.beTruthy();
+		expect(recorder.events).to.equal((@[@"{", @"key:a", @"[", @"true", @"null", @"string:text", @"]", @"}"]));
+
+		NSData *truncated = [deflatedData(plain, MAX_WBITS) subdataWithRange:NSMakeRange(0, 100)];
+		expect([[[GRJsonInflater alloc] initWithDelegate:[[JSONEventRecorder alloc] init]] parseData:truncated error:&error]).to.beFalsy();
+		expect(error).notTo.beNil();
+	});
+
+	it(@"decodes numbers exactly", ^{
+		NSString *json = @"[0, -7, 9223372036854775807, -9223372036854775808, 18446744073709551616, 0.1, 1e23, 2.2250738585072011e-308, 5e-324, 1.7976931348623157e308, 3.14159265358979323846264338327950288]";
+		NSError *error = nil;
+		NSArray<NSNumber *> *numbers = [GRJsonParser JSONObjectFromData:[json dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+		expect(error).to.beNil();
+		expect(numbers.count).to.equal(11);
+		expect(numbers[0].longLongValue).to.equal(0);
+		expect(numbers[1].longLongValue).to.equal(-7);
+		expect(numbers[2].longLongValue).to.equal(INT64_MAX);
+		expect(numbers[3].longLongValue).to.equal(INT64_MIN);
+		expect(strcmp(numbers[2].objCType, @encode(long long)) == 0 || strcmp(numbers[2].objCType, @encode(long)) == 0).to.beTruthy();
+		const char *doubles[] = {"18446744073709551616", "0.1", "1e23", "2.2250738585072011e-308", "5e-324", "1.7976931348623157e308", "3.14159265358979323846264338327950288"};
+		for (int i = 0; i < 7; i++) {
+			expect(numbers[4 + i].doubleValue).to.equal(strtod(doubles[i], NULL));
+		}
+	});
+
+	it(@"bounds nesting depth without recursing", ^{
+		NSData *(^nested)(NSUInteger) = ^NSData *(NSUInteger depth) {
+			NSMutableString *json = [NSMutableString string];
+			for (NSUInteger i = 0; i < depth; i++) {
+				[json appendString:i & 1 ? @"[" : @"{\"a\":"];
+			}
+			[json appendString:@"1"];
+			for (NSUInteger i = depth; i > 0; i--) {
+				[json appendString:(i - 1) & 1 ? @"]" : @"}"];
+			}
+			return [json dataUsingEncoding:NSUTF8StringEncoding];
+		};
+		NSError *error = nil;
+		expect([GRJsonParser JSONObjectFromData:nested(GRJSON_DEFAULT_MAX_DEPTH) error:&error]).notTo.beNil();
+		expect([GRJsonParser JSONObjectFromData:nested(GRJSON_DEFAULT_MAX_DEPTH + 1) error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+		// validation, and everything that validates before it tokenizes, holds to the same limit
+		expect([GRJson validateData:nested(GRJSON_DEFAULT_MAX_DEPTH) error:nil]).to.beTruthy();
+		expect([GRJson validateData:nested(GRJSON_DEFAULT_MAX_DEPTH + 1) error:nil]).to.beFalsy();
+		error = nil;
+		GRJsonPatch *test = [GRJsonPatch patchWithData:[@"[{\"op\" : \"test\", \"path\" : \"\", \"value\" : 1}]" dataUsingEncoding:NSUTF8StringEncoding] error:nil];
+		expect([test applyToData:nested(2000) error:&error]).to.beNil();
+		expect(error.localizedDescription).notTo.contain(@"out of memory");
+
+		// a deeper limit on a dispatch worker, whose stack is far smaller than the main thread's
+		__block id deep = nil;
+		dispatch_semaphore_t done = dispatch_semaphore_create(0);
+		dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+			GRJsonParser *parser = [[GRJsonParser alloc] init];
+			parser.maxDepth = 2000;
+			deep = [parser JSONObjectFromData:nested(2000) error:nil];
+			dispatch_semaphore_signal(done);
+		});
+		dispatch_semaphore_wait(done, DISPATCH_TIME_FOREVER);
+		expect(deep).notTo.beNil();
+
+		GRJsonParser *shallow = [[GRJsonParser alloc] init];
+		shallow.maxDepth = 2;
+		expect([shallow JSONObjectFromData:nested(2) error:nil]).notTo.beNil();
+		expect([shallow JSONObjectFromData:nested(3) error:nil]).to.beNil();
+	});
+
+});
+
+describe(@"JSON lines", ^{
+
+	it(@"parses every record in order", ^{
+		NSMutableString *lines = [NSMutableString string];
+		for (int i = 0; i < 5000; i++) {
+			[lines appendFormat:@"{\"id\" : %d, \"tags\" : [\"a\", \"b\"]}\r\n", i];
+			if (i % 1000 == 0) {
+				[lines appendString:@"\n"];
+			}
+		}
+		NSError *error = nil;
+		NSArray<NSDictionary *> *records = [GRJsonParser JSONObjectsFromJSONLinesData:[lines dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+		expect(error).to.beNil();
+		expect(records.count).to.equal(5000);
+		for (int i = 0; i < 5000; i++) {
+			expect(records[i][@"id"]).to.equal(@(i));
+		}
+	});
+
+	it(@"reports the index of an invalid record", ^{
+		NSString *lines = @"1\n[2]\n{\"three\" 3}\nnull\n";
+		NSError *error = nil;
+		expect([GRJsonParser JSONObjectsFromJSONLinesData:[lines dataUsingEncoding:NSUTF8StringEncoding] error:&error]).to.beNil();
+		expect(error.userInfo[GRJsonParserRecordIndexKey]).to.equal(@2);
+	});
+
+});
+
+describe(@"GRJson selection", ^{
+
+	it(@"returns only the selected paths", ^{
+		NSString *json = @"{\"meta\" : {\"skipped\" : [1, {\"a\" : \"]}\\\"\"}]}, \"data\" : {\"count\" : 2, \"items\" : [{\"id\" : 1, \"status\" : \"ok\", \"big\" : {\"x\" : [1, 2]}}, {\"id\" : 2, \"status\" : \"bad\"}]}}";
+		NSError *error = nil;
+		NSDictionary *result = [GRJsonParser JSONObjectFromData:[json dataUsingEncoding:NSUTF8StringEncoding] selectingPaths:@[@"data.items[*].id", @"/data/items/1/status"] error:&error];
+		expect(error).to.beNil();
+		expect(result).to.equal(@{@"data" : @{@"items" : @[@{@"id" : @1}, @{@"id" : @2, @"status" : @"bad"}]}});
+	});
+
+	it(@"skips unselected subtrees without delegate events", ^{
+		NSString *json = @"[{\"keep\" : true, \"drop\" : {\"a\" : [1, 2, {\"b\" : null}]}}]";
+		JSONEventRecorder *recorder = [[JSONEventRecorder alloc] init];
+		GRJson *parser = [[GRJson alloc] initWithData:[json dataUsingEncoding:NSUTF8StringEncoding] delegate:recorder];
+		parser.selection = [GRJsonSelection selectionWithPaths:@[@"/0/keep"] error:nil];
+		NSError *error = nil;
+		expect([parser parse:&error]).to.beTruthy();
+		expect(recorder.events).to.equal(@[@"[", @"{", @"key:keep", @"true", @"}", @"]"]);
+	});
+
+	it(@"rejects malformed paths", ^{
+		NSError *error = nil;
+		expect([GRJsonSelection selectionWithPaths:@[@"data..items"] error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+	});
+
+});
+
+describe(@"GRJsonDocument", ^{
+
+	it(@"decodes values lazily behind ordinary collections", ^{
+		NSString *json = @"{\"name\" : \"a\\tb\", \"count\" : 3, \"ratio\" : 0.5, \"ok\" : true, \"none\" : null, \"items\" : [1, [2, 3], {}], \"name\" : \"last\"}";
+		NSError *error = nil;
+		GRJsonDocument *document = [GRJsonDocument documentWithData:[json dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+		expect(error).to.beNil();
+		NSDictionary *root = document.rootObject;
+		expect(root).to.beKindOf([NSDictionary class]);
+		expect(root.count).to.equal(6);
+		expect(root[@"name"]).to.equal(@"last");
+		expect(root[@"count"]).to.equal(@3);
+		expect(root[@"ratio"]).to.equal(@0.5);
+		expect(root[@"ok"]).to.equal(@YES);
+		expect(root[@"none"]).to.equal([NSNull null]);
+		expect(root[@"missing"]).to.beNil();
+		NSArray *items = root[@"items"];
+		expect(items).to.beKindOf([NSArray class]);
+		expect(items).to.equal(@[@1, @[@2, @3], @{}]);
+		expect(root[@"items"]).to.beIdenticalTo(items);
+	});
+
+	it(@"reads documents whose only strings are empty", ^{
+		GRJsonDocument *document = [GRJsonDocument documentWithData:[@"{\"\" : [\"\", \"\"]}" dataUsingEncoding:NSUTF8StringEncoding] error:nil];
+		expect(document.rootObject).to.equal(@{@"" : @[@"", @""]});
+	});
+
+	it(@"can be mapped like a parsed object tree", ^{
+		NSString *json = @"{\"objects\" : [{\"type\" : \"parent\"}, {\"type\" : \"child\"}, {\"type\" : \"childPartTwo\", \"notInParent\" : \"x\"}]}";
+		NSError *error = nil;
+		GRJsonDocument *document = [GRJsonDocument documentWithData:[json dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+		CustomContainerClass *mapped = [GROMapper map:document.rootObject to:[CustomContainerClass class] error:&error];
+		expect(error).to.beNil();
+		expect(@(mapped.objects.count)).to.equal(@(3));
+		expect(mapped.objects[1]).to.beKindOf([CustomChildClass class]);
+		expect(mapped.objects[2]).to.beKindOf([CustomChildClassPartTwo class]);
+		expect(((CustomChildClassPartTwo *)mapped.objects[2]).notInParent).to.equal(@"x");
+	});
+
+	it(@"reports invalid documents", ^{
+		NSError *error = nil;
+		GRJsonDocument *document = [GRJsonDocument documentWithData:[@"[1, 2" dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+		expect(document).to.beNil();
+		expect(error).notTo.beNil();
+	});
+
+});
+
+describe(@"GRJsonValue", ^{
+
+	it(@"parses into an arena of C values", ^{
+		const char *json = "{\"name\" : \"a\\tb\", \"long\" : \"longer than thirteen bytes \\u00e9\", \"count\" : -3, \"ratio\" : 0.5, \"ok\" : true, \"none\" : null, \"items\" : [1, [2, 3], {}], \"name\" : \"last\"}";
+		GRJsonArena arena;
+		GRJsonArenaInit(&arena);
+		GRJsonTokenizer tokenizer;
+		GRJsonTokenizerInit(&tokenizer);
+		const GRJsonValue *root = NULL;
+		expect(GRJsonValueParse(&arena, &tokenizer, (const uint8_t *)json, strlen(json), &root)).to.equal(GRJsonErrorNone);
+		expect(GRJsonValueTypeOf(root)).to.equal(GRJsonValueTypeObject);
+		expect(GRJsonValueCount(root)).to.equal(8);
+		expect(@(GRJsonValueString(GRJsonValueMember(root, "name", 4), NULL))).to.equal(@"last");
+		size_t length = 0;
+		expect(@(GRJsonValueString(GRJsonValueMember(root, "long", 4), &length))).to.equal(@"longer than thirteen bytes \u00e9");
+		expect(length).to.equal(29);
+		expect(GRJsonValueInteger(GRJsonValueMember(root, "count", 5))).to.equal(-3);
+		expect(GRJsonValueDouble(GRJsonValueMember(root, "ratio", 5))).to.equal(0.5);
+		expect(GRJsonValueBool(GRJsonValueMember(root, "ok", 2))).to.beTruthy();
+		expect(GRJsonValueIsNull(GRJsonValueMember(root, "none", 4))).to.beTruthy();
+		expect(GRJsonValueMember(root, "missing", 7) == NULL).to.beTruthy();
+
+		const GRJsonValue *items = GRJsonValueMember(root, "items", 5);
+		expect(GRJsonValueCount(items)).to.equal(3);
+		expect(GRJsonValueInteger(GRJsonValueAt(GRJsonValueAt(items, 1), 1))).to.equal(3);
+		expect(GRJsonValueCount(GRJsonValueAt(items, 2))).to.equal(0);
+		expect(GRJsonValueAt(items, 3) == NULL).to.beTruthy();
+
+		NSMutableArray *keys = [NSMutableArray array];
+		for (size_t i = 0; i < GRJsonValueCount(root); i++) {
+			[keys addObject:@(GRJsonValueString(&GRJsonValueMemberAt(root, i)->key, NULL))];
+		}
+		expect(keys).to.equal(@[@"name", @"long", @"count", @"ratio", @"ok", @"none", @"items", @"name"]);
+		expect(@(GRJsonValueString(&GRJsonValueMemberAt(root, 0)->value, NULL))).to.equal(@"a\tb");
+
+		GRJsonArenaRelease(&arena);
+		GRJsonTokenizerDestroy(&tokenizer);
+	});
+
+	it(@"reuses the arena from one document to the next", ^{
+		NSMutableString *json = [NSMutableString stringWithString:@"["];
+		for (NSInteger i = 0; i < 5000; i++) {
+			[json appendFormat:@"%@{\"id\" : %ld, \"label\" : \"item number %ld\"}", i ? @"," : @"", (long)i, (long)i];
+		}
+		[json appendString:@"]"];
+		NSData *data = [json dataUsingEncoding:NSUTF8StringEncoding];
+		GRJsonArena arena;
+		GRJsonArenaInit(&arena);
+		GRJsonTokenizer tokenizer;
+		GRJsonTokenizerInit(&tokenizer);
+		for (NSInteger round = 0; round < 3; round++) {
+			GRJsonArenaReset(&arena);
+			const GRJsonValue *root = NULL;
+			expect(GRJsonValueParse(&arena, &tokenizer, data.bytes, data.length, &root)).to.equal(GRJsonErrorNone);
+			expect(GRJsonValueCount(root)).to.equal(5000);
+			const GRJsonValue *last = GRJsonValueAt(root, 4999);
+			expect(GRJsonValueInteger(GRJsonValueMember(last, "id", 2))).to.equal(4999);
+			expect(@(GRJsonValueString(GRJsonValueMember(last, "label", 5), NULL))).to.equal(@"item number 4999");
+		}
+		GRJsonArenaRelease(&arena);
+		GRJsonTokenizerDestroy(&tokenizer);
+	});
+
+	it(@"reports invalid documents", ^{
+		GRJsonArena arena;
+		GRJsonArenaInit(&arena);
+		GRJsonTokenizer tokenizer;
+		GRJsonTokenizerInit(&tokenizer);
+		const GRJsonValue *root = NULL;
+		expect(GRJsonValueParse(&arena, &tokenizer, (const uint8_t *)"[1, 2", 5, &root)).notTo.equal(GRJsonErrorNone);
+		expect(root == NULL).to.beTruthy();
+		expect(GRJsonValueParse(&arena, &tokenizer, (const uint8_t *)"[\"\xff\"]", 5, &root)).to.equal(GRJsonErrorInvalidString);
+		expect(@(tokenizer.errorMessage)).to.contain(@"UTF-8");
+		GRJsonArenaRelease(&arena);
+		GRJsonTokenizerDestroy(&tokenizer);
+	});
+
+});
+
+describe(@"GRJsonQuery", ^{
+
+	NSData *orders = [@"{\"id\" : 0, \"orders\" : [{\"id\" : 1, \"total\" : 50}, {\"id\" : 2, \"total\" : 150.5, \"note\" : \"rush\"}, {\"id\" : 3, \"total\" : 101, \"lines\" : [{\"sku\" : \"a\"}]}]}" dataUsingEncoding:NSUTF8StringEncoding];
+
+	it(@"selects members, slices and filtered elements", ^{
+		NSError *error = nil;
+		expect([[GRJsonQuery queryWithString:@"$.orders[?(@.total > 100)].id" error:&error] resultsForData:orders error:&error]).to.equal(@[@2, @3]);
+		expect([[GRJsonQuery queryWithString:@"$..id" error:&error] resultsForData:orders error:&error]).to.equal(@[@0, @1, @2, @3]);
+		expect([[GRJsonQuery queryWithString:@"$.orders[?(@.note == 'rush' || !@.lines)].id" error:&error] resultsForData:orders error:&error]).to.equal(@[@1, @2]);
+		expect([[GRJsonQuery queryWithString:@"$.orders[-1].lines" error:&error] resultsForData:orders error:&error]).to.equal(@[@[@{@"sku" : @"a"}]]);
+		expect([[GRJsonQuery queryWithString:@"$['orders'][::2].id" error:&error] resultsForData:orders error:&error]).to.equal(@[@1, @3]);
+		expect([[GRJsonQuery queryWithString:@"$.orders[5]" error:&error] resultsForData:orders error:&error]).to.equal(@[]);
+		expect(error).to.beNil();
+	});
+
+	it(@"matches empty member names and empty strings", ^{
+		NSData *empty = [@"{\"\" : 1, \"a\" : \"\"}" dataUsingEncoding:NSUTF8StringEncoding];
+		NSError *error = nil;
+		expect([[GRJsonQuery queryWithString:@"$['']" error:&error] resultsForData:empty error:&error]).to.equal(@[@1]);
+		expect([[GRJsonQuery queryWithString:@"$[?(@ == '')]" error:&error] resultsForData:empty error:&error]).to.equal(@[@""]);
+		expect(error).to.beNil();
+	});
+
+	it(@"runs over parsed documents and batches of documents", ^{
+		GRJsonQuery *query = [GRJsonQuery queryWithString:@"$.orders[*].total" error:nil];
+		GRJsonDocument *document = [GRJsonDocument documentWithData:orders error:nil];
+		expect([query resultsInDocument:document]).to.equal(@[@50, @150.5, @101]);
+
+		NSMutableArray<NSData *> *documents = [NSMutableArray array];
+		for (int i = 0; i < 100; i++) {
+			[documents addObject:[[NSString stringWithFormat:@"{\"orders\" : [{\"total\" : %d}]}", i] dataUsingEncoding:NSUTF8StringEncoding]];
+		}
+		[documents addObject:[@"{\"orders\" : [" dataUsingEncoding:NSUTF8StringEncoding]];
+		NSMutableArray *totals = [NSMutableArray arrayWithCapacity:documents.count];
+		for (NSUInteger i = 0; i < documents.count; i++) {
+			[totals addObject:[NSNull null]];
+		}
+		__block NSUInteger failures = 0;
+		NSUInteger queried = [query enumerateResultsForDocuments:documents usingBlock:^(NSUInteger index, NSArray *results, NSError *error, BOOL *stop) {
+			@synchronized (totals) {
+				if (results) {
+					totals[index] = results.firstObject;
+				}
+				else if (error) {
+					failures++;
+				}
+			}
+		}];
+		expect(queried).to.equal(101);
+		expect(failures).to.equal(1);
+		expect(totals[42]).to.equal(@42);
+	});
+
+	it(@"reports malformed queries", ^{
+		NSError *error = nil;
+		expect([GRJsonQuery queryWithString:@"orders[0]" error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+		error = nil;
+		expect([GRJsonQuery queryWithString:@"$.orders[?(@.total >)]" error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+	});
+
+});
+
+describe(@"GRJsonPatch", ^{
+
+	NSData *(^utf8)(NSString *) = ^NSData *(NSString *string) {
+		return [string dataUsingEncoding:NSUTF8StringEncoding];
+	};
+	NSData *document = utf8(@"{\"id\" : 7, \"items\" : [ {\"sku\" : \"a\"}, {\"sku\" : \"b\"} ], \"meta\" : {\"tags\" : [ \"x\" ]}}");
+
+	it(@"applies JSON Patch operations, copying untouched values verbatim", ^{
+		NSError *error = nil;
+		GRJsonPatch *patch = [GRJsonPatch patchWithData:utf8(@"[{\"op\" : \"test\", \"path\" : \"/id\", \"value\" : 7.0}, {\"op\" : \"replace\", \"path\" : \"/id\", \"value\" : 8}, {\"op\" : \"remove\", \"path\" : \"/items/0\"}, {\"op\" : \"add\", \"path\" : \"/items/-\", \"value\" : {\"sku\" : \"c\"}}, {\"op\" : \"move\", \"from\" : \"/meta/tags\", \"path\" : \"/tags\"}, {\"op\" : \"copy\", \"from\" : \"/tags/0\", \"path\" : \"/first\"}]") error:&error];
+		expect(error).to.beNil();
+		NSData *patched = [patch applyToData:document error:&error];
+		expect(error).to.beNil();
+		expect([[NSString alloc] initWithData:patched encoding:NSUTF8StringEncoding]).to.equal(@"{\"id\":8,\"items\":[{\"sku\" : \"b\"},{\"sku\" : \"c\"}],\"meta\":{},\"tags\":[ \"x\" ],\"first\":\"x\"}");
+	});
+
+	it(@"applies merge patches", ^{
+		NSError *error = nil;
+		GRJsonPatch *patch = [GRJsonPatch mergePatchWithData:utf8(@"{\"id\" : null, \"meta\" : {\"tags\" : null, \"seen\" : true}, \"extra\" : {\"a\" : null, \"b\" : 1}}") error:&error];
+		NSData *patched = [patch applyToData:document error:&error];
+		expect(error).to.beNil();
+		expect([[NSString alloc] initWithData:patched encoding:NSUTF8StringEncoding]).to.equal(@"{\"items\":[ {\"sku\" : \"a\"}, {\"sku\" : \"b\"} ],\"meta\":{\"seen\":true},\"extra\":{\"b\":1}}");
+	});
+
+	it(@"writes out a member that a merge patch turned into an object", ^{
+		NSData *scalar = utf8(@"{\"b\" : 1}");
+		NSData *patched = [[GRJsonPatch mergePatchWithData:utf8(@"{\"b\" : {}}") error:nil] applyToData:scalar error:nil];
+		expect([[NSString alloc] initWithData:patched encoding:NSUTF8StringEncoding]).to.equal(@"{\"b\":{}}");
+		patched = [[GRJsonPatch mergePatchWithData:utf8(@"{\"b\" : {\"c\" : null}}") error:nil] applyToData:scalar error:nil];
+		expect([[NSString alloc] initWithData:patched encoding:NSUTF8StringEncoding]).to.equal(@"{\"b\":{}}");
+	});
+
+	it(@"copies values as they were patched, not as they were read", ^{
+		NSError *error = nil;
+		GRJsonPatch *patch = [GRJsonPatch patchWithData:utf8(@"[{\"op\" : \"replace\", \"path\" : \"/0/0\", \"value\" : 2}, {\"op\" : \"copy\", \"from\" : \"/0\", \"path\" : \"/-\"}]") error:&error];
+		NSData *patched = [patch applyToData:utf8(@"[[1]]") error:&error];
+		expect(error).to.beNil();
+		expect([[NSString alloc] initWithData:patched encoding:NSUTF8StringEncoding]).to.equal(@"[[2],[2]]");
+	});
+
+	it(@"follows pointers to empty member names", ^{
+		NSError *error = nil;
+		NSData *patched = [[GRJsonPatch patchWithData:utf8(@"[{\"op\" : \"add\", \"path\" : \"/\", \"value\" : 1}]") error:&error] applyToData:utf8(@"{}") error:&error];
+		expect(error).to.beNil();
+		expect([[NSString alloc] initWithData:patched encoding:NSUTF8StringEncoding]).to.equal(@"{\"\":1}");
+		patched = [[GRJsonPatch patchWithData:utf8(@"[{\"op\" : \"test\", \"path\" : \"/\", \"value\" : [\"\"]}]") error:&error] applyToData:utf8(@"{\"\" : [\"\"]}") error:&error];
+		expect(error).to.beNil();
+		expect(patched).notTo.beNil();
+	});
+
+	it(@"reports failed operations and invalid patches", ^{
+		NSError *error = nil;
+		expect([[GRJsonPatch patchWithData:utf8(@"[{\"op\" : \"test\", \"path\" : \"/id\", \"value\" : 8}]") error:nil] applyToData:document error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+		error = nil;
+		expect([[GRJsonPatch patchWithData:utf8(@"[{\"op\" : \"remove\", \"path\" : \"/items/2\"}]") error:nil] applyToData:document error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+		error = nil;
+		expect([GRJsonPatch patchWithData:utf8(@"[{\"op\" : \"add\", \"path\" : \"/x\"}]") error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+	});
+
+});
+
+describe(@"GRJsonCanonicalizer", ^{
+
+	NSData *(^utf8)(NSString *) = ^NSData *(NSString *string) {
+		return [string dataUsingEncoding:NSUTF8StringEncoding];
+	};
+
+	it(@"writes the RFC 8785 form", ^{
+		NSError *error = nil;
+		NSData *canonical = [GRJsonCanonicalizer canonicalDataWithData:utf8(@"{\n  \"numbers\": [333333333.33333329, 1E30, 4.50, 2e-3, 0.000000000000000000000000001],\n  \"string\": \"\\u20ac$\\u000F\\u000aA'\\u0042\\u0022\\u005c\\\\\\\"\\/\",\n  \"literals\": [null, true, false]\n}") error:&error];
+		expect(error).to.beNil();
+		expect([[NSString alloc] initWithData:canonical encoding:NSUTF8StringEncoding]).to.equal(@"{\"literals\":[null,true,false],\"numbers\":[333333333.3333333,1e+30,4.5,0.002,1e-27],\"string\":\"\u20ac$\\u000f\\nA'B\\\"\\\\\\\\\\\"/\"}");
+	});
+
+	it(@"sorts members by UTF-16 code units", ^{
+		NSData *canonical = [GRJsonCanonicalizer canonicalDataWithData:utf8(@"{\"\\u20ac\" : 1, \"\\ud83d\\ude00\" : 2, \"b\" : {\"z\" : 1e21, \"a\" : -0}, \"a\" : 10, \"\\u0080\" : 0.5}") error:nil];
+		expect([[NSString alloc] initWithData:canonical encoding:NSUTF8StringEncoding]).to.equal(@"{\"a\":10,\"b\":{\"a\":0,\"z\":1e+21},\"\u0080\":0.5,\"\u20ac\":1,\"\U0001F600\":2}");
+	});
+
+	it(@"gives trees and bytes the same form", ^{
+		NSDictionary *object = @{@"name" : @"caf\u00e9", @"values" : @[@1, @2.5, @1e-7, [NSNull null], @YES], @"nested" : @{@"b" : @[], @"a" : @{}}};
+		NSError *error = nil;
+		NSData *fromTree = [GRJsonCanonicalizer canonicalDataWithJSONObject:object error:&error];
+		NSData *fromBytes = [GRJsonCanonicalizer canonicalDataWithData:[GRJsonWriter dataWithJSONObject:object error:&error] error:&error];
+		expect(error).to.beNil();
+		expect(fromTree).to.equal(fromBytes);
+		expect([[NSString alloc] initWithData:fromTree encoding:NSUTF8StringEncoding]).to.equal(@"{\"name\":\"caf\u00e9\",\"nested\":{\"a\":{},\"b\":[]},\"values\":[1,2.5,1e-7,null,true]}");
+	});
+
+	it(@"writes empty strings and keys", ^{
+		NSError *error = nil;
+		expect([GRJsonCanonicalizer canonicalDataWithData:utf8(@"\"\"") error:&error]).to.equal(utf8(@"\"\""));
+		expect([GRJsonCanonicalizer canonicalDataWithData:utf8(@"{\"\" : 1}") error:&error]).to.equal(utf8(@"{\"\":1}"));
+		expect([GRJsonCanonicalizer canonicalDataWithData:utf8(@"[\"\", \"\"]") error:&error]).to.equal(utf8(@"[\"\",\"\"]"));
+		expect(error).to.beNil();
+	});
+
+	it(@"hashes without buffering the canonical form", ^{
+		NSData *json = utf8(@"{ \"b\" : [1.0, 2], \"a\" : \"x\" }");
+		NSData *secret = utf8(@"secret");
+		NSData *canonical = [GRJsonCanonicalizer canonicalDataWithData:json error:nil];
+		NSError *error = nil;
+		expect([GRJsonCanonicalizer hmacSHA1OfData:json secret:secret error:&error]).to.equal([canonical hmacSHA1UsingSecret:secret]);
+		expect([GRJsonCanonicalizer hmacSHA1OfJSONObject:@{@"a" : @"x", @"b" : @[@1, @2]} secret:secret error:&error]).to.equal([canonical hmacSHA1UsingSecret:secret]);
+		expect([GRJsonCanonicalizer SHA256OfData:json error:&error]).to.equal([GRJsonCanonicalizer SHA256OfJSONObject:@{@"b" : @[@1, @2], @"a" : @"x"} error:&error]);
+		expect(error).to.beNil();
+		__block NSUInteger pieces = 0;
+		expect([GRJsonCanonicalizer canonicalizeData:json sink:^BOOL(const uint8_t *bytes, NSUInteger length) {
+			pieces++;
+			return YES;
+		} error:&error]).to.beTruthy();
+		expect(pieces).to.beGreaterThan(0);
+	});
+
+	it(@"rejects what has no canonical form", ^{
+		NSError *error = nil;
+		expect([GRJsonCanonicalizer canonicalDataWithData:utf8(@"{\"a\" : 1, \"a\" : 2}") error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+		error = nil;
+		expect([GRJsonCanonicalizer canonicalDataWithData:utf8(@"[1,") error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+		error = nil;
+		expect([GRJsonCanonicalizer SHA256OfJSONObject:@[@(INFINITY)] error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+	});
+
+});
+
+describe(@"GRJsonFormatter", ^{
+
+	NSData *(^utf8)(NSString *) = ^NSData *(NSString *string) {
+		return [string dataUsingEncoding:NSUTF8StringEncoding];
+	};
+	NSString *(^text)(NSData *) = ^NSString *(NSData *data) {
+		return [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+	};
+	NSData *document = utf8(@" { \"a b\" : [ 1 , 2.50e3,\ttrue ] ,\r\n \"c\\\" {[,: \\\\\" : { } , \"d\":[ ] , \"e\" : {\"f\" : [ [ ] , null ] } } ");
+
+	it(@"rewrites only the whitespace", ^{
+		NSError *error = nil;
+		expect(text([GRJsonFormatter minifiedDataWithData:document error:&error])).to.equal(@"{\"a b\":[1,2.50e3,true],\"c\\\" {[,: \\\\\":{},\"d\":[],\"e\":{\"f\":[[],null]}}");
+		expect(text([GRJsonFormatter prettyPrintedDataWithData:document error:&error])).to.equal(@"{\n  \"a b\": [\n    1,\n    2.50e3,\n    true\n  ],\n  \"c\\\" {[,: \\\\\": {},\n  \"d\": [],\n  \"e\": {\n    \"f\": [\n      [],\n      null\n    ]\n  }\n}");
+		expect(error).to.beNil();
+		NSData *pretty = [GRJsonFormatter prettyPrintedDataWithData:document error:nil];
+		expect([GRJsonFormatter minifiedDataWithData:pretty error:nil]).to.equal([GRJsonFormatter minifiedDataWithData:document error:nil]);
+	});
+
+	it(@"gives the same output however the input is split", ^{
+		NSMutableString *json = [NSMutableString stringWithString:@"[\n"];
+		for (NSInteger i = 0; i < 500; i++) {
+			[json appendFormat:@"%@  { \"key %ld\" : \"value \\\\\\\" \\\\ %ld\" , \"n\" : [ %ld.5 ] }\n", i ? @"," : @"", (long)i, (long)i, (long)i];
+		}
+		[json appendString:@"]"];
+		NSData *data = utf8(json);
+		NSData *whole = [GRJsonFormatter minifiedDataWithData:data error:nil];
+		expect([GRJsonParser JSONObjectFromData:whole error:nil]).to.equal([GRJsonParser JSONObjectFromData:data error:nil]);
+		for (NSUInteger pieceLength = 1; pieceLength < 200; pieceLength += 37) {
+			GRJsonFormatter *formatter = [[GRJsonFormatter alloc] initWithStyle:GRJsonTranscodeMinify indentWidth:0];
+			for (NSUInteger offset = 0; offset < data.length; offset += pieceLength) {
+				expect([formatter feed:[data subdataWithRange:NSMakeRange(offset, MIN(pieceLength, data.length - offset))] error:nil]).to.beTruthy();
+			}
+			expect([formatter finish:nil]).to.beTruthy();
+			expect(formatter.data).to.equal(whole);
+		}
+		NSOutputStream *output = [NSOutputStream outputStreamToMemory];
+		[output open];
+		NSError *error = nil;
+		expect([GRJsonFormatter formatStream:[NSInputStream inputStreamWithData:data] toStream:output style:GRJsonTranscodeMinify error:&error]).to.beTruthy();
+		expect([output propertyForKey:NSStreamDataWrittenToMemoryStreamKey]).to.equal(whole);
+	});
+
+	it(@"reports unterminated strings and unbalanced brackets", ^{
+		NSError *error = nil;
+		expect([GRJsonFormatter minifiedDataWithData:utf8(@"[1, \"abc") error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+		error = nil;
+		expect([GRJsonFormatter prettyPrintedDataWithData:utf8(@"[1, [2]") error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+		error = nil;
+		expect([GRJsonFormatter prettyPrintedDataWithData:utf8(@"{}}") error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+	});
+
+});
+
+describe(@"GRJsonWriter", ^{
+
+	it(@"writes values with escaping and exact numbers", ^{
+		GRJsonWriter *writer = [[GRJsonWriter alloc] init];
+		[writer beginObject];
+		[writer writeKey:@"text"];
+		[writer writeString:@"quote \" slash \\ tab \t bell \x07 caf\u00e9"];
+		[writer writeKey:@"numbers"];
+		[writer beginArray];
+		[writer writeInteger:INT64_MIN];
+		[writer writeNumber:@(UINT64_MAX)];
+		[writer writeDouble:0.1];
+		[writer writeDouble:2.0];
+		[writer writeNumber:@YES];
+		[writer writeNull];
+		[writer endArray];
+		[writer endObject];
+		NSError *error = nil;
+		expect([writer finish:&error]).to.beTruthy();
+		NSString *json = [[NSString alloc] initWithData:writer.data encoding:NSUTF8StringEncoding];
+		expect(json).to.equal(@"{\"text\":\"quote \\\" slash \\\\ tab \\t bell \\u0007 caf\u00e9\",\"numbers\":[-9223372036854775808,18446744073709551615,0.1,2,true,null]}");
+	});
+
+	it(@"writes the shortest digits of every double", ^{
+		GRJsonWriter *writer = [[GRJsonWriter alloc] init];
+		[writer beginArray];
+		[writer writeDouble:5e-324];
+		[writer writeDouble:1e23];
+		[writer writeDouble:1.7976931348623157e308];
+		[writer writeDouble:-0.000001];
+		[writer endArray];
+		expect([writer finish:nil]).to.beTruthy();
+		expect([[NSString alloc] initWithData:writer.data encoding:NSUTF8StringEncoding]).to.equal(@"[5e-324,1e+23,1.7976931348623157e+308,-0.000001]");
+	});
+
+	it(@"round-trips through the parser", ^{
+		NSDictionary *object = @{@"name" : @"\U0001F600 \n", @"values" : @[@1, @2.5, @-0.0, [NSNull null], @NO], @"nested" : @{@"empty" : @[]}};
+		NSError *error = nil;
+		NSData *data = [GRJsonWriter dataWithJSONObject:object error:&error];
+		expect(error).to.beNil();
+		expect([GRJsonParser JSONObjectFromData:data error:&error]).to.equal(object);
+	});
+
+	it(@"reports misuse and unsupported values", ^{
+		GRJsonWriter *writer = [[GRJsonWriter alloc] init];
+		[writer beginArray];
+		[writer writeKey:@"not in an object"];
+		NSError *error = nil;
+		expect([writer finish:&error]).to.beFalsy();
+		expect(error).notTo.beNil();
+		error = nil;
+		expect([GRJsonWriter dataWithJSONObject:@[[NSDate date]] error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+		error = nil;
+		expect([GRJsonWriter dataWithJSONObject:@[@(NAN)] error:&error]).to.beNil();
+		expect(error).notTo.beNil();
+	});
+
+	it(@"streams to an output stream", ^{
+		NSOutputStream *stream = [NSOutputStream outputStreamToMemory];
+		[stream open];
+		GRJsonWriter *writer = [[GRJsonWriter alloc] initWithOutputStream:stream];
+		[writer beginArray];
+		for (NSInteger i = 0; i < 50000; i++) {
+			[writer writeString:@"a string that is repeated"];
+		}
+		[writer endArray];
+		NSError *error = nil;
+		expect([writer finish:&error]).to.beTruthy();
+		NSData *written = [stream propertyForKey:NSStreamDataWrittenToMemoryStreamKey];
+		NSArray *parsed = [GRJsonParser JSONObjectFromData:written error:&error];
+		expect(parsed.count).to.equal(50000);
+		expect(writer.data.length).to.equal(0);
+	});
+
+	it(@"serializes mapped objects in one pass", ^{
+		TestSerializeClassWithConversion *toSerialize = [[TestSerializeClassWithConversion alloc] init];
+		NSError *error = nil;
+		NSData *data = [GROMapper jsonDataFrom:toSerialize error:&error];
+		expect(error).to.beNil();
+		NSDictionary *direct = [GRJsonParser JSONObjectFromData:data error:&error];
+		expect(direct).to.equal([GROMapper jsonObjectFrom:toSerialize error:&error]);
+	});
+
+	it(@"builds URL builder JSON", ^{
+		GRURLBuilder *builder = [GRURLBuilder builder];
+		builder[@"key"] = @"a/b";
+		NSDictionary *parsed = [GRJsonParser JSONObjectFromData:[[builder jsonString] dataUsingEncoding:NSUTF8StringEncoding] error:nil];
+		expect(parsed).to.equal(@{@"key" : @"a/b"});
+	});
+
 });
 
 describe(@"GRKVOObservable", ^{
@@ -17,8 +17,30 @@
 #import <GRFoundation/NSDate+GRExtensions.h>
 #import <GRFoundation/NSString+GRExtensions.h>
 #import <GRFoundation/GRImageMetadata.h>
+#import <GRFoundation/GRJsonStructuralIndex.h>
+#import <GRFoundation/GRJsonTokenizer.h>
+#import <GRFoundation/GRJsonNumber.h>
+#import <GRFoundation/GRJsonString.h>
+#import <GRFoundation/GRJsonPath.h>
+#import <GRFoundation/GRJsonValidator.h>
+#import <GRFoundation/GRJsonSelection.h>
 #import <GRFoundation/GRJson.h>
+#import <GRFoundation/GRJsonContainers.h>
+#import <GRFoundation/GRJsonInflater.h>
 #import <GRFoundation/GRJsonParser.h>
+#import <GRFoundation/GRJsonTape.h>
+#import <GRFoundation/GRJsonValue.h>
+#import <GRFoundation/GRJsonDocument.h>
+#import <GRFoundation/GRJsonQueryPlan.h>
+#import <GRFoundation/GRJsonQuery.h>
+#import <GRFoundation/GRJsonPatchPlan.h>
+#import <GRFoundation/GRJsonPatch.h>
+#import <GRFoundation/GRJsonCanonical.h>
+#import <GRFoundation/GRJsonCanonicalizer.h>
+#import <GRFoundation/GRJsonTranscoder.h>
+#import <GRFoundation/GRJsonFormatter.h>
+#import <GRFoundation/GRJsonEmitter.h>
+#import <GRFoundation/GRJsonWriter.h>
 #import <GRFoundation/GROMapper.h>
 #import <GRFoundation/GRURLBuilder.h>
 #import <GRFoundation/GRReachability.h>
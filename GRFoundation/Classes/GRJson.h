@@ -7,7 +7,16 @@
 //
 
 #import <Foundation/Foundation.h>
+#import "GRJsonStructuralIndex.h"
+#import "GRJsonTokenizer.h"
+#import "GRJsonNumber.h"
+#import "GRJsonString.h"
+#import "GRJsonSelection.h"
 
+/** In the userInfo of an error from +validateData:error:, the byte offset, line and column (both 1-based) of the problem. */
+extern NSString * const GRJsonErrorOffsetKey;
+extern NSString * const GRJsonErrorLineKey;
+extern NSString * const GRJsonErrorColumnKey;
 
 @protocol GRJsonDelegate <NSObject>
 
@@ -22,17 +31,185 @@
 - (void) json_array_begin;
 - (void) json_array_end;
 
+@optional
+
+/**
+ Zero-copy alternative to json_string:.  If the delegate implements it, it is called instead of json_string:
+ and no NSString is created for the value.  The bytes point into the parser's input (or, for a value that
+ was split across two chunks in push mode, into a small internal buffer) and are only valid for the
+ duration of the call.  They have already been checked to be valid UTF-8.
+
+ @param bytes the UTF-8 bytes between the quotes
+ @param len the number of bytes
+ @param needsUnescape YES if the bytes contain backslash escapes; see +[GRJson stringWithBytes:length:needsUnescape:]
+ @param ascii YES if the check found only ASCII; pass it on to +[GRJson stringWithBytes:length:needsUnescape:ascii:scratch:]
+ */
+- (void) json_string_bytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii;
+
+/**
+ Zero-copy alternative to json_object_key:, with the same rules as json_string_bytes:length:needsUnescape:ascii:.
+ */
+- (void) json_object_key_bytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii;
+
+/**
+ Typed alternatives to json_number:length:.  If the delegate implements both, numbers are decoded by the
+ parser and json_number:length: is not called.  Numbers without a fraction or exponent that fit in an
+ int64_t go to json_integer:; everything else is converted to the nearest double (exactly as strtod would)
+ and goes to json_double:.
+
+ @param value the decoded number
+ */
+- (void) json_integer:(int64_t)value;
+- (void) json_double:(double)value;
 
 @end
 
 
 @interface GRJson : NSObject
 
+/**
+ The vectorized classifier used to find quotes, escapes and whitespace.  It is picked automatically the first
+ time a document is parsed; setting it is only useful for benchmarking or for verifying that every backend
+ produces the same delegate events.
+
+ @param backend the backend to use, or GRJsonSimdBackendAuto to go back to the best supported one
+ @return NO if the backend is not supported by this CPU or build
+ */
++ (BOOL) setSimdBackend:(GRJsonSimdBackend)backend;
++ (GRJsonSimdBackend) simdBackend;
+
+/**
+ Creates the string for the bytes handed to one of the zero-copy delegate callbacks.  Escapes are decoded
+ to UTF-8 (a surrogate pair becomes one character, an unpaired surrogate becomes U+FFFD) and the result is
+ a single NSString allocation.
+
+ @param bytes the bytes between the quotes
+ @param len the number of bytes
+ @param needsUnescape whether the bytes contain escapes that need to be decoded
+ @return the decoded string, or nil if the bytes are not valid UTF-8
+ */
++ (NSString *) stringWithBytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape;
+
+/**
+ Like +stringWithBytes:length:needsUnescape:, but decodes escapes into a buffer owned by the caller, so
+ that a parser that creates many strings can reuse one buffer for all of them, and skips the UTF-8 check
+ that was already made before the bytes were handed to the delegate (bytes that are not valid UTF-8
+ still give nil, just more slowly).
+
+ @param ascii what that check found, as passed to the delegate; NO if it is not known
+ @param scratch initialized with GRJsonScratchInit, and destroyed by the caller when it is done
+ */
++ (NSString *) stringWithBytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii scratch:(GRJsonScratch *)scratch;
+
+/**
+ Checks whether data is a single valid JSON document (RFC 8259, including UTF-8 well-formedness) as
+ cheaply as possible: no delegate, no objects, no logging.  See GRJsonValidate in GRJsonValidator.h.
+
+ @param data the document to check
+ @param error an out pointer that describes the first problem, with its offset, line and column under
+        GRJsonErrorOffsetKey, GRJsonErrorLineKey and GRJsonErrorColumnKey; only created when data is invalid
+ @return YES if data is valid JSON
+ */
++ (BOOL) validateData:(NSData *)data error:(NSError *__autoreleasing *)error;
+
+/**
+ Parses newline-delimited JSON (NDJSON / JSON Lines): one complete JSON value per line.  The records are
+ found with a quick scan for newlines and then parsed concurrently with dispatch_apply, in contiguous runs.
+ Each run gets its own parser and its own delegate from makeDelegate, so delegates never see events from two
+ threads at once.  Blank lines (and a '\r' before each '\n') are ignored.
+
+ @param data the records
+ @param makeDelegate creates the delegate for one run of records; called concurrently
+ @param recordHandler called on the same thread right after each record has been parsed into delegate, with
+        the record's index (among the non-blank lines) and its parse error, if any.  Records of one run arrive
+        in order, but runs proceed concurrently.  Set *stop to YES to stop early.
+ @return the number of records that were parsed
+ */
++ (NSUInteger) parseJSONLines:(NSData *)data delegateFactory:(id<GRJsonDelegate> (^)(void))makeDelegate recordHandler:(void (^)(id<GRJsonDelegate> delegate, NSUInteger index, NSError *error, BOOL *stop))recordHandler;
+
+/**
+ Same as +parseJSONLines:delegateFactory:recordHandler:, but first tells countHandler how many records were
+ found, before any of them is parsed, so a caller can set aside one slot per record and fill the slots from
+ recordHandler without locking.
+
+ @param countHandler called once, on the calling thread, with the number of non-blank lines; may be nil
+ */
++ (NSUInteger) parseJSONLines:(NSData *)data recordCount:(void (^)(NSUInteger count))countHandler delegateFactory:(id<GRJsonDelegate> (^)(void))makeDelegate recordHandler:(void (^)(id<GRJsonDelegate> delegate, NSUInteger index, NSError *error, BOOL *stop))recordHandler;
+
 - (instancetype) initWithData:(NSData *)data delegate:(id<GRJsonDelegate>)delegate;
 
+/**
+ Creates a parser for push-mode parsing, where the document is handed over in pieces with -feed:error:
+ as it arrives (from a network download, for example) and -finish: is called after the last piece.
+
+ @param delegate the delegate that receives the parse events
+ @return a parser with no data
+ */
+- (instancetype) initWithDelegate:(id<GRJsonDelegate>)delegate;
+
 @property (nonatomic, strong) NSData *data;
 @property (nonatomic, weak) id<GRJsonDelegate> delegate;
 
+/**
+ Restricts the delegate events to the parts of the document the selection matches: the matched values, plus
+ the objects, arrays and keys that lead to them.  A delegate that builds a tree (like GRJsonParser) therefore
+ ends up with the document pruned down to just the selected paths.  Objects and arrays that no path can match
+ are skipped with a fast bracket-balancing scan, without delegate calls or strings; note that the contents of
+ a skipped value are not validated.  Set it before parsing starts.
+ */
+@property (nonatomic, strong) GRJsonSelection *selection;
+
+/**
+ How deeply objects and arrays may nest; a document that goes deeper fails with an error.  Defaults to
+ GRJSON_DEFAULT_MAX_DEPTH (1024), and 0 goes back to that.  Nesting is tracked in a stack that is allocated
+ once at this size, never by recursion, so no document can exhaust the C stack, and parsing is safe on
+ threads with small stacks (like the 512KB of a dispatch worker).  Set it before parsing starts.
+ */
+@property (nonatomic) NSUInteger maxDepth;
+
 - (BOOL) parse:(NSError *__autoreleasing *)error;
 
+/**
+ Parses the next piece of the document.  Delegate events fire as soon as each token is complete, so a
+ token that is cut off at the end of the chunk is reported during a later call.  Only the bytes of that
+ one token are kept between calls; the chunk itself is not retained.
+
+ @param chunk the next bytes of the document
+ @param error an out pointer that holds the parse error, if any
+ @return NO if the document is known to be invalid
+ */
+- (BOOL) feed:(NSData *)chunk error:(NSError *__autoreleasing *)error;
+
+/**
+ Tells the parser that there is no more data, which flushes a trailing token and checks that the
+ document is complete.
+
+ @param error an out pointer that holds the parse error, if any
+ @return YES if the document that was fed in is a complete, valid JSON document
+ */
+- (BOOL) finish:(NSError *__autoreleasing *)error;
+
+/**
+ The size of the buffer that -parseStream:error: and -parseFileDescriptor:error: read into.  Defaults to 64KB.
+ */
+@property (nonatomic) NSUInteger readBufferSize;
+
+/**
+ Parses a document of any size with bounded memory, pulling it from stream into one fixed buffer of
+ readBufferSize bytes that is refilled once the tokenizer has consumed it.  A token cut off by the end of the
+ buffer is stitched together from just its own bytes (see -feed:error:), so the parser holds the read buffer,
+ the nesting stack (see maxDepth) and the longest single string or number, however large the document is.
+
+ @param stream the document; it is opened if it is not open already, and closed
+ @param error an out pointer that holds the read or parse error, if any
+ @return YES if the stream held one complete, valid JSON document (or nothing but whitespace, as for -parse:)
+ */
+- (BOOL) parseStream:(NSInputStream *)stream error:(NSError *__autoreleasing *)error;
+
+/**
+ Like -parseStream:error:, reading from a file descriptor (a file, pipe or socket) until end of file.  The
+ descriptor is left open.
+ */
+- (BOOL) parseFileDescriptor:(int)fd error:(NSError *__autoreleasing *)error;
+
 @end
@@ -7,37 +7,30 @@
 //
 
 #import "GRJson.h"
+#import "GRJsonTokenizer.h"
+#import "GRJsonPath.h"
+#import "GRJsonValidator.h"
+#import "GRJsonString.h"
 #import "Logging.h"
 
-typedef void (*VoidFunction)(id ptr, SEL cmd);
+#include <errno.h>
+#include <unistd.h>
 
-static VoidFunction parseObject;
-
-static void (*parseMembers)(id, SEL);
-static void (*parsePair)(id, SEL);
-static void (*parseString)(id, SEL, BOOL);
-static void (*parseEscapedString)(id, SEL, NSMutableString*, BOOL);
-static void (*copyStringWithStart)(id, SEL, unsigned long, unsigned long, NSMutableString *);
-static void (*skipWhiteSpace)(id, SEL);
-static void (*parseValue)(id, SEL);
-static void (*parseNumber)(id, SEL);
-static void (*parseArray)(id, SEL);
-static void (*parseArrayElements)(id, SEL);
-static void (*parseBool)(id, SEL);
-static void (*parseNull)(id, SEL);
-static void (*advance)(id, SEL);
-static void (*skip)(id, SEL, int);
-static BOOL (*isEof)(id, SEL);
+#define DEFAULT_READ_BUFFER_SIZE (64 * 1024)
+#define MIN_READ_BUFFER_SIZE 256
 
+NSString * const GRJsonErrorOffsetKey = @"GRJsonErrorOffset";
+NSString * const GRJsonErrorLineKey = @"GRJsonErrorLine";
+NSString * const GRJsonErrorColumnKey = @"GRJsonErrorColumn";
 
-@interface GRJson ()
-{
-	const char *m_buf;     ///< our buffer we are reading from
-	unsigned long m_bufLen; ///< the length of the buffer in bytes
-	unsigned long m_pos;    ///< currrent position
-	int m_objectLevel;     ///< if non-zero, indicates the parser is in the midst of parsing a non-top level object or array
-	NSMutableString *m_errMsg;   ///< error message if there is an error during parsing
-	NSData *data;
+typedef void (*VoidFunction)(id ptr, SEL cmd);
+
+/**
+ * The delegate callbacks, resolved to IMPs once in -initWithData:delegate:.  These are the only
+ * Objective-C dispatches made while parsing; everything else below is plain C.
+ */
+typedef struct GRJsonCallbacks {
+	__unsafe_unretained id delegate;
 	VoidFunction json_null;
 	void (*json_bool)(id, SEL, BOOL);
 	void (*json_number)(id, SEL, const unsigned char *, unsigned long);
@@ -47,535 +40,572 @@ static BOOL (*isEof)(id, SEL);
 	VoidFunction json_object_end;
 	VoidFunction json_array_begin;
 	VoidFunction json_array_end;
+	// optional zero-copy variants, NULL unless the delegate implements them
+	void (*json_string_bytes)(id, SEL, const unsigned char *, unsigned long, BOOL, BOOL);
+	void (*json_object_key_bytes)(id, SEL, const unsigned char *, unsigned long, BOOL, BOOL);
+	// optional typed numbers, NULL unless the delegate implements both
+	void (*json_integer)(id, SEL, int64_t);
+	void (*json_double)(id, SEL, double);
+} GRJsonCallbacks;
+
+/**
+ * All of the state needed while parsing a document.  The grammar lives in the C tokenizer, which can
+ * stop at the end of any chunk and resume when the next one arrives; this just adds the delegate.
+ */
+typedef struct GRJsonState {
+	GRJsonTokenizer tokenizer;
+	GRJsonCallbacks cb;
+	bool selecting;
+	GRJsonSelector selector; ///< only used when a selection is set
+	GRJsonScratch scratch;   ///< where escaped strings are decoded, reused for the whole parse
+} GRJsonState;
 
+@interface GRJson ()
+{
+	GRJsonState m_state;
+	NSData *data;
 }
 
-- (void) parseObject;
-- (void) parseMembers;
-- (void) parsePair;
-- (void) parseString:(BOOL)isObjectKey;
-- (void) parseEscapedString:(NSMutableString *)result isObjectKey:(BOOL)isObjectKey;
-- (void) copyToStringWithStart:(unsigned long)startPos end:(unsigned long)endPos str:(NSMutableString *)str;
-- (void) skipWhiteSpace;
-- (void) parseValue;
-- (void) parseNumber;
-- (void) parseArray;
-- (void) parseArrayElements;
-- (void) parseBool;
-- (void) parseNull;
-- (void) advance;
-- (void) skip:(int)amount;
-- (BOOL)isEof;
-- (void) setError:(NSString *)fmt, ...;
-
 @end
 
-@implementation GRJson
-
-@synthesize delegate, data;
-
-+ (void) initialize {
-	parseObject = (VoidFunction)[self instanceMethodForSelector:@selector(parseObject)];
-	parseMembers = (VoidFunction)[self instanceMethodForSelector:@selector(parseMembers)];
-	parsePair = (VoidFunction)[self instanceMethodForSelector:@selector(parsePair)];
-	parseString = (void (*) (id, SEL, BOOL))[self instanceMethodForSelector:@selector(parseString:)];
-	parseEscapedString = (void (*) (id, SEL, NSMutableString*, BOOL))[self instanceMethodForSelector:@selector(parseEscapedString:isObjectKey:)];
-	copyStringWithStart = (void (*) (id, SEL, unsigned long, unsigned long, NSMutableString*))[self instanceMethodForSelector:@selector(copyToStringWithStart:end:str:)];
-	skipWhiteSpace = (VoidFunction)[self instanceMethodForSelector:@selector(skipWhiteSpace)];
-	parseValue = (VoidFunction)[self instanceMethodForSelector:@selector(parseValue)];
-	parseNumber = (VoidFunction)[self instanceMethodForSelector:@selector(parseNumber)];
-	parseArray = (VoidFunction)[self instanceMethodForSelector:@selector(parseArray)];
-	parseArrayElements = (VoidFunction)[self instanceMethodForSelector:@selector(parseArrayElements)];
-	parseBool = (VoidFunction)[self instanceMethodForSelector:@selector(parseBool)];
-	parseNull = (VoidFunction)[self instanceMethodForSelector:@selector(parseNull)];
-	advance = (VoidFunction)[self instanceMethodForSelector:@selector(advance)];
-	skip = (void (*) (id, SEL, int))[self instanceMethodForSelector:@selector(skip:)];
-	isEof = (BOOL (*) (id, SEL))[self instanceMethodForSelector:@selector(isEof)];
-}
-
-- (instancetype) initWithData:(NSData *)dataIn delegate:(id<GRJsonDelegate>)delegateIn {
-	self = [super init];
-	if (self) {
-		data = dataIn;
-		m_buf = (const char *)[data bytes];
-		m_bufLen = [data length];
-		m_pos = 0;
-		m_objectLevel = 0;
-		delegate = delegateIn;
-		
-		NSObject *object = (NSObject *)delegateIn;
-		
-		json_null = (VoidFunction)[object methodForSelector:@selector(json_null)];
-		json_bool = (void (*)(id, SEL, BOOL))[object methodForSelector:@selector(json_bool:)];
-		json_number = (void (*)(id, SEL, const unsigned char *, unsigned long))[object methodForSelector:@selector(json_number:length:)];
-		json_string = (void (*)(id, SEL, NSString *))[object methodForSelector:@selector(json_string:)];
-		json_object_begin = (VoidFunction)[object methodForSelector:@selector(json_object_begin)];
-		json_object_key = (void (*)(id, SEL, NSString *))[object methodForSelector:@selector(json_object_key:)];
-		json_object_end = (VoidFunction)[object methodForSelector:@selector(json_object_end)];
-		json_array_begin = (VoidFunction)[object methodForSelector:@selector(json_array_begin)];
-		json_array_end = (VoidFunction)[object methodForSelector:@selector(json_array_end)];
-
-	}
-	return self;
-}
-
-- (void) setError:(NSString *)fmt, ... {
-	va_list argList;
-	va_start(argList, fmt);
-	m_errMsg = [[NSMutableString alloc] initWithFormat:fmt arguments:argList];
-	va_end(argList);
-	@throw [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: m_errMsg}];
-}
+#pragma mark - strings
 
-- (BOOL) isEof {
-	return m_pos >= m_bufLen;
-}
-
-- (void) advance {
-	m_pos++;
-	if (isEof(self, @selector(isEof)) && m_objectLevel > 0) {
-		[self setError:@"unexpected EOF"];
-		@throw [NSException exceptionWithName:@"GRJsonParserException" reason:@"unexpected EOF" userInfo:@{}];
+/**
+ * Builds the NSString for a string body that is already known to be valid UTF-8, with a single allocation:
+ * escapes are decoded into the scratch buffer first, and ASCII (by far the most common case) is handed over
+ * as ASCII so NSString can skip decoding it.  Returns nil only if the scratch buffer could not grow.
+ */
+static inline NSString *makeString(const unsigned char *bytes, unsigned long len, bool hasEscapes, GRJsonUTF8Status utf8, GRJsonScratch *scratch) {
+	if (hasEscapes) {
+		uint8_t *out = GRJsonScratchReserve(scratch, len);
+		if (out == NULL) {
+			return nil;
+		}
+		len = GRJsonUnescape(bytes, len, out);
+		bytes = out;
+		// a \u escape can turn an ASCII body into a multi-byte string
+		utf8 = GRJsonUTF8Multibyte;
 	}
+	NSStringEncoding encoding = utf8 == GRJsonUTF8ASCII ? NSASCIIStringEncoding : NSUTF8StringEncoding;
+	return [[NSString alloc] initWithBytes:bytes length:len encoding:encoding];
 }
 
-- (void) skip:(int)amount {
-	m_pos += amount;
-	if (isEof(self, @selector(isEof))) {
-		[self setError:@"unexpected EOF while skipping"];
-		@throw [NSException exceptionWithName:@"GRJsonParserException" reason:@"unexpected EOF while skipping" userInfo:@{}];
+/** builds the string for a body straight from the input, or returns nil if it is not valid UTF-8 */
+static inline NSString *stringForBytes(const unsigned char *bytes, unsigned long len, bool hasEscapes, GRJsonScratch *scratch) {
+	GRJsonUTF8Status utf8 = GRJsonValidateUTF8(bytes, len);
+	if (utf8 == GRJsonUTF8Invalid) {
+		return nil;
 	}
+	return makeString(bytes, len, hasEscapes, utf8, scratch);
 }
 
-/* a lookup table which lets us quickly determine five things:
- * VEC - valid escaped conrol char
- * IJC - invalid json char
- * VHC - valid hex char
- * VWC - valid whitesapce char
- * VNC - valid number character
- * note.  the solidus '/' may be escaped or not.
- * note.  the
- */
-#define VEC 1
-#define VALID_ESC_CHAR 1
-#define IJC 2
-#define INVALID_JSON_CHAR 2
-#define VHC 4
-#define VALID_HEX_CHAR 4
-#define VWC 8
-#define VALID_WHITESPACE_CHAR 8
-#define VNC 16
-#define VALID_NUMERIC_CHAR 16
-static const char charLookupTable[256] =
-{
-	/*00*/ IJC    , IJC    , IJC    , IJC    , IJC    , IJC    , IJC    , IJC    ,
-	/*08*/ IJC    , IJC|VWC, IJC|VWC, IJC    , IJC    , IJC|VWC, IJC    , IJC    ,
-	/*16*/ IJC    , IJC    , IJC    , IJC    , IJC|VWC, IJC    , IJC    , IJC    ,
-	/*24*/ IJC    , IJC    , IJC    , IJC    , IJC    , IJC    , IJC    , IJC    ,
-	
-	/*32*/ VWC    , 0      , VEC|IJC, 0      , 0      , 0      , 0      , 0      ,
-	/*40*/ 0      , 0      , 0      , 0      , 0      , 0      , 0      , VEC    ,
-	/*48*/ VHC|VNC, VHC|VNC, VHC|VNC, VHC|VNC, VHC|VNC, VHC|VNC, VHC|VNC, VHC|VNC,
-	/*56*/ VHC|VNC, VHC|VNC, 0      , 0      , 0      , 0      , 0      , 0      ,
-	
-	/*64*/ 0      , VHC    , VHC    , VHC    , VHC    , VHC    , VHC    , 0      ,
-	/*72*/ 0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	/*80*/ 0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	/*88*/ 0      , 0      , 0      , 0      , VEC|IJC, 0      , 0      , 0      ,
-	
-	/*96*/ 0      , VHC    , VEC|VHC, VHC    , VHC    , VHC    , VEC|VHC, 0      ,
-	/*104*/ 0      , 0      , 0      , 0      , 0      , 0      , VEC    , 0      ,
-	/*112*/ 0      , 0      , VEC    , 0      , VEC    , 0      , 0      , 0      ,
-	/*120*/ 0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	
-	/* include these so we don't have to always check the range of the char */
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0      ,
-	0      , 0      , 0      , 0      , 0      , 0      , 0      , 0
-};
-
+#pragma mark - dispatch
 
-- (BOOL) parse:(NSError *__autoreleasing *)error {
-	BOOL success = YES;
-	@try {
-		bool moreElements = true;
-		while (isEof(self, @selector(isEof)) == false && moreElements == true) {
-			switch (m_buf[m_pos]) {
-				case '{':
-					parseObject(self, @selector(parseObject));
-					moreElements = false;
-					break;
-				case '[':
-					parseArray(self, @selector(parseArray));
-					moreElements = false;
-					break;
-				default:
-					if (charLookupTable[(int)m_buf[m_pos]] & VALID_WHITESPACE_CHAR) {
-						advance(self, @selector(advance));
-						break;
-					}
-					else {
-						@throw [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"invalid char '%c' at pos %lu", m_buf[m_pos], m_pos]}];
-					}
+/** hands one token to the delegate, returning GRJsonErrorNone unless a string could not be delivered */
+static inline GRJsonError deliverToken(const GRJsonCallbacks *cb, __unsafe_unretained id delegate, const GRJsonToken *token, GRJsonScratch *scratch) {
+	switch (token->type) {
+		case GRJsonTokenObjectBegin:
+			cb->json_object_begin(delegate, @selector(json_object_begin));
+			break;
+		case GRJsonTokenObjectEnd:
+			cb->json_object_end(delegate, @selector(json_object_end));
+			break;
+		case GRJsonTokenArrayBegin:
+			cb->json_array_begin(delegate, @selector(json_array_begin));
+			break;
+		case GRJsonTokenArrayEnd:
+			cb->json_array_end(delegate, @selector(json_array_end));
+			break;
+		case GRJsonTokenKey:
+		{
+			// the tokenizer checks the grammar of a string but not its encoding, so that happens here
+			GRJsonUTF8Status utf8 = GRJsonValidateUTF8(token->bytes, token->length);
+			if (utf8 == GRJsonUTF8Invalid) {
+				return GRJsonErrorInvalidString;
+			}
+			if (cb->json_object_key_bytes) {
+				cb->json_object_key_bytes(delegate, @selector(json_object_key_bytes:length:needsUnescape:ascii:), token->bytes, token->length, token->hasEscapes, utf8 == GRJsonUTF8ASCII);
 			}
+			else {
+				NSString *key = makeString(token->bytes, token->length, token->hasEscapes, utf8, scratch);
+				if (key == nil) {
+					return GRJsonErrorOutOfMemory;
+				}
+				cb->json_object_key(delegate, @selector(json_object_key:), key);
+			}
+			break;
 		}
-	} @catch (NSException *exception) {
-		DDLogError(@"exception while parsing JSON: %@", exception.reason);
-		if (error) {
-			*error = [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: exception.reason}];
+		case GRJsonTokenString:
+		{
+			GRJsonUTF8Status utf8 = GRJsonValidateUTF8(token->bytes, token->length);
+			if (utf8 == GRJsonUTF8Invalid) {
+				return GRJsonErrorInvalidString;
+			}
+			if (cb->json_string_bytes) {
+				cb->json_string_bytes(delegate, @selector(json_string_bytes:length:needsUnescape:ascii:), token->bytes, token->length, token->hasEscapes, utf8 == GRJsonUTF8ASCII);
+			}
+			else {
+				NSString *string = makeString(token->bytes, token->length, token->hasEscapes, utf8, scratch);
+				if (string == nil) {
+					return GRJsonErrorOutOfMemory;
+				}
+				cb->json_string(delegate, @selector(json_string:), string);
+			}
+			break;
 		}
-		success = NO;
-	} @catch(NSError *thrown) {
-		DDLogError(@"error while parsing JSON: %@", thrown);
-		if (error) {
-			*error = thrown;
+		case GRJsonTokenNumber:
+		{
+			int64_t integer;
+			double real;
+			GRJsonNumberKind kind = cb->json_integer ? GRJsonParseNumber(token->bytes, token->length, &integer, &real) : GRJsonNumberInvalid;
+			if (kind == GRJsonNumberInteger) {
+				cb->json_integer(delegate, @selector(json_integer:), integer);
+			}
+			else if (kind == GRJsonNumberDouble) {
+				cb->json_double(delegate, @selector(json_double:), real);
+			}
+			else {
+				cb->json_number(delegate, @selector(json_number:length:), token->bytes, token->length);
+			}
+			break;
 		}
-		success = NO;
-	} @finally {
-		
+		case GRJsonTokenTrue:
+			cb->json_bool(delegate, @selector(json_bool:), YES);
+			break;
+		case GRJsonTokenFalse:
+			cb->json_bool(delegate, @selector(json_bool:), NO);
+			break;
+		case GRJsonTokenNull:
+			cb->json_null(delegate, @selector(json_null));
+			break;
+		case GRJsonTokenNone:
+			break;
 	}
-	return success;
+	return GRJsonErrorNone;
 }
 
-- (void) parseObject {
-	json_object_begin(delegate, @selector(json_object_begin));
-	m_objectLevel++;
-	advance(self, @selector(advance));
-	parseMembers(self, @selector(parseMembers));
-	if (m_buf[m_pos] == '}') {
-		m_objectLevel--;
-		advance(self, @selector(advance));
-		json_object_end(delegate, @selector(json_object_end));
+/** stops the tokenizer at a token the delegate could not be given */
+static GRJsonStatus failToken(GRJsonTokenizer *t, const GRJsonToken *token, GRJsonError error) {
+	t->error = error;
+	t->errorOffset = token->offset;
+	if (error == GRJsonErrorOutOfMemory) {
+		snprintf(t->errorMessage, sizeof(t->errorMessage), "out of memory");
 	}
 	else {
-		[self setError:@"expected '}' to close object, got '%c' at pos %lu", m_buf[m_pos], m_pos];
+		snprintf(t->errorMessage, sizeof(t->errorMessage), "invalid UTF-8 in string at pos %llu", (unsigned long long)token->offset);
 	}
+	return GRJsonStatusError;
 }
 
-- (void) parseMembers {
-	char nextSym = '"';
-	bool hasMoreMembers = true;
-	while (hasMoreMembers) {
-		skipWhiteSpace(self, @selector(skipWhiteSpace));
-		if (m_buf[m_pos] != nextSym) {
-			return;
+/** runs the tokenizer over its current input, handing every token (or every selected token) to the delegate */
+static GRJsonStatus dispatchTokens(GRJsonState *st) {
+	GRJsonTokenizer *t = &st->tokenizer;
+	const GRJsonCallbacks *cb = &st->cb;
+	__unsafe_unretained id delegate = cb->delegate;
+	GRJsonScratch *scratch = &st->scratch;
+	GRJsonToken token;
+	GRJsonStatus status;
+	GRJsonError error;
+	if (st->selecting) {
+		while ((status = GRJsonSelectorNext(&st->selector, t, &token)) == GRJsonStatusToken) {
+			if ((error = deliverToken(cb, delegate, &token, scratch)) != GRJsonErrorNone) {
+				return failToken(t, &token, error);
+			}
 		}
-		switch (m_buf[m_pos]) {
-			case '"':
-				parsePair(self, @selector(parsePair));
-				nextSym = ',';
-				break;
-			case ',':
-				advance(self, @selector(advance));
-				nextSym = '"';
-				break;
-			default:
-				[self setError:@"expected ',' or '\"', got '%c' at pos %lu", m_buf[m_pos], m_pos];
+		return status;
+	}
+	while ((status = GRJsonTokenizerNext(t, &token)) == GRJsonStatusToken) {
+		if ((error = deliverToken(cb, delegate, &token, scratch)) != GRJsonErrorNone) {
+			return failToken(t, &token, error);
 		}
 	}
+	return status;
 }
 
-- (void) parsePair {
-	parseString(self, @selector(parseString:), YES);
-	skipWhiteSpace(self, @selector(skipWhiteSpace));
-	if (m_buf[m_pos] != ':') {
-		[self setError:@"expected pair-separator ':', got '%c' at pos %lu", m_buf[m_pos], m_pos];
+#pragma mark - JSON lines
+
+typedef struct GRJsonLine {
+	size_t offset;
+	size_t length;
+} GRJsonLine;
+
+static inline bool isBlank(const uint8_t *bytes, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		uint8_t c = bytes[i];
+		if (c != ' ' && c != '\t' && c != '\r') {
+			return false;
+		}
 	}
-	advance(self, @selector(advance));
-	skipWhiteSpace(self, @selector(skipWhiteSpace));
-	parseValue(self, @selector(parseValue));
-	skipWhiteSpace(self, @selector(skipWhiteSpace));
+	return true;
 }
 
-- (void) skipWhiteSpace {
-	while (charLookupTable[(int)m_buf[m_pos]] & VALID_WHITESPACE_CHAR) {
-		advance(self, @selector(advance));
-		if (m_pos >= m_bufLen) {
-			[self setError:@"hit EOF while skipping whitespace"];
+/**
+ * Finds the records of a newline-delimited buffer.  A raw newline can never appear inside a JSON value (it
+ * is not allowed in strings and is whitespace everywhere else), so every '\n' is a record boundary and the
+ * split needs no tokenizing at all.  Blank lines are dropped.
+ */
+static GRJsonLine *splitLines(const uint8_t *bytes, size_t length, size_t *countOut) {
+	size_t count = 0;
+	size_t capacity = 0;
+	GRJsonLine *lines = NULL;
+	size_t start = 0;
+	while (start < length) {
+		const uint8_t *newline = memchr(bytes + start, '\n', length - start);
+		size_t end = newline ? (size_t)(newline - bytes) : length;
+		size_t lineLength = end - start;
+		if (lineLength && bytes[end - 1] == '\r') {
+			lineLength--;
+		}
+		if (!isBlank(bytes + start, lineLength)) {
+			if (count == capacity) {
+				capacity = capacity ? capacity * 2 : 1024;
+				GRJsonLine *grown = realloc(lines, capacity * sizeof(GRJsonLine));
+				if (grown == NULL) {
+					free(lines);
+					*countOut = 0;
+					return NULL;
+				}
+				lines = grown;
+			}
+			lines[count].offset = start;
+			lines[count].length = lineLength;
+			count++;
 		}
+		start = end + 1;
 	}
+	*countOut = count;
+	return lines;
 }
 
-- (void) copyToStringWithStart:(unsigned long)startPos end:(unsigned long)endPos str:(NSMutableString *)str {
-	if (endPos - startPos > 0) {
-		[str appendString:[[NSString alloc] initWithBytes:m_buf+startPos length:endPos-startPos encoding:NSUTF8StringEncoding]];
-	}
+static NSError *errorFromTokenizer(const GRJsonTokenizer *t) {
+	NSString *reason = [NSString stringWithUTF8String:t->errorMessage] ?: @"invalid JSON";
+	DDLogError(@"error while parsing JSON: %@", reason);
+	return [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: reason}];
 }
 
-- (void) parseEscapedString:(NSMutableString *)result isObjectKey:(BOOL)isObjectKey {
-	unsigned long startPos = m_pos;
-	unsigned long endPos = 0;
-	bool isEos = false;
-	while (isEos == false) {
-		switch (m_buf[m_pos]) {
-			case '\\':
-				// it is an escape char
-				if (charLookupTable[(int)m_buf[m_pos+1]] & VALID_ESC_CHAR) {
-					// valid escape char
-					copyStringWithStart(self, @selector(copyToStringWithStart:end:str:), startPos, m_pos, result);
-					const char *unescaped = "?";
-					switch (m_buf[m_pos+1]) {
-						case 'r': unescaped = "\r"; break;
-						case 'n': unescaped = "\n"; break;
-						case '\\': unescaped = "\\"; break;
-						case '/': unescaped = "/"; break;
-						case '"': unescaped = "\""; break;
-						case 'f': unescaped = "\f"; break;
-						case 'b': unescaped = "\b"; break;
-						case 't': unescaped = "\t"; break;
-						default:
-							DDLogError(@"mismatch between lookup table and escapes");
-							unescaped = "";
-							break;
-					}
-					[result appendFormat:@"%s", unescaped];
-					skip(self, @selector(skip:), 2);
-					startPos = m_pos;
-				}
-				else if (m_buf[m_pos+1] == 'u') {
-					if (m_pos+6 >= m_bufLen) {
-						[self setError:@"un-expected EOF while parsing unicode escape"];
-					}
-					if ((charLookupTable[(int)m_buf[m_pos+2]] & VALID_ESC_CHAR) &&
-						(charLookupTable[(int)m_buf[m_pos+3]] & VALID_ESC_CHAR) &&
-						(charLookupTable[(int)m_buf[m_pos+4]] & VALID_ESC_CHAR) &&
-						(charLookupTable[(int)m_buf[m_pos+5]] & VALID_ESC_CHAR))
-					{
-						char temp[5];
-						memcpy(temp, m_buf+2, 4);
-						temp[4] = '\0';
-						[result appendFormat:@"%C", (unsigned short)strtoul(temp, NULL, 16)];
-						skip(self, @selector(skip:), 6);
-					}
-					else {
-						[self setError:@"invalid HEX character in unicode escape"];
-					}
-				}
-				else {
-					[self setError:@"invalid escape char '%c' at pos %lu", m_buf[m_pos+1], m_pos+1];
-				}
-				break;
-			case '"':
-				endPos = m_pos;
-				isEos = true;
-				advance(self, @selector(advance));
-				break;
-			default:
-				advance(self, @selector(advance));
-				break;
-		}
-	}
-	[self copyToStringWithStart:startPos end:endPos str:result];
-	if (isObjectKey) {
-		json_object_key(delegate, @selector(json_object_key:), result);
+@implementation GRJson
+
+@synthesize delegate, data, selection, readBufferSize;
+
++ (GRJsonSimdBackend) simdBackend {
+	return GRJsonActiveSimdBackend();
+}
+
++ (BOOL) setSimdBackend:(GRJsonSimdBackend)backend {
+	return GRJsonSetSimdBackend(backend);
+}
+
++ (NSString *) stringWithBytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape {
+	if (!needsUnescape) {
+		return stringForBytes(bytes, len, false, NULL);
 	}
-	else {
-		json_string(delegate, @selector(json_string:), result);
+	// most strings fit on the stack; longer ones get a buffer of their own
+	uint8_t stackBuffer[1024];
+	GRJsonScratch scratch = { .bytes = stackBuffer, .capacity = sizeof(stackBuffer) };
+	if (len <= sizeof(stackBuffer)) {
+		return stringForBytes(bytes, len, true, &scratch);
 	}
+	GRJsonScratchInit(&scratch);
+	NSString *string = stringForBytes(bytes, len, true, &scratch);
+	GRJsonScratchDestroy(&scratch);
+	return string;
+}
+
++ (NSString *) stringWithBytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii scratch:(GRJsonScratch *)scratch {
+	// the zero-copy callbacks only ever see bytes that have been validated already
+	return makeString(bytes, len, needsUnescape, ascii ? GRJsonUTF8ASCII : GRJsonUTF8Multibyte, scratch);
 }
 
-- (void) parseString:(BOOL)isObjectKey {
-	if (m_buf[m_pos] != '"') {
-		[self setError:@"expected '\"', got '%c' at pos %lu", m_buf[m_pos], m_pos];
++ (BOOL) validateData:(NSData *)validatedData error:(NSError *__autoreleasing *)error {
+	GRJsonValidation validation;
+	if (GRJsonValidate((const uint8_t *)validatedData.bytes, validatedData.length, &validation)) {
+		return YES;
+	}
+	if (error) {
+		NSString *reason = [NSString stringWithFormat:@"%s at line %lu, column %lu", validation.message, (unsigned long)validation.line, (unsigned long)validation.column];
+		*error = [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: reason, GRJsonErrorOffsetKey: @(validation.offset), GRJsonErrorLineKey: @(validation.line), GRJsonErrorColumnKey: @(validation.column)}];
 	}
-	advance(self, @selector(advance));
-	unsigned long startPos = m_pos;
-	unsigned long endPos = 0;
-	bool isEos = false;
-	while (isEos == false) {
-		switch (m_buf[m_pos]) {
-			case '\\':
-			{
-				NSMutableString *strResult = nil;
-				if ((m_pos - startPos) > 0) {
-					strResult = [NSMutableString stringWithCapacity:m_pos - startPos];
-					[strResult appendString:[[NSString alloc] initWithBytes:m_buf+startPos length:m_pos - startPos encoding:NSUTF8StringEncoding]];
+	return NO;
+}
+
++ (NSUInteger) parseJSONLines:(NSData *)linesData delegateFactory:(id<GRJsonDelegate> (^)(void))makeDelegate recordHandler:(void (^)(id<GRJsonDelegate> delegate, NSUInteger index, NSError *error, BOOL *stop))recordHandler {
+	return [self parseJSONLines:linesData recordCount:nil delegateFactory:makeDelegate recordHandler:recordHandler];
+}
+
++ (NSUInteger) parseJSONLines:(NSData *)linesData recordCount:(void (^)(NSUInteger count))countHandler delegateFactory:(id<GRJsonDelegate> (^)(void))makeDelegate recordHandler:(void (^)(id<GRJsonDelegate> delegate, NSUInteger index, NSError *error, BOOL *stop))recordHandler {
+	const uint8_t *bytes = (const uint8_t *)linesData.bytes;
+	size_t count = 0;
+	GRJsonLine *lines = splitLines(bytes, linesData.length, &count);
+	if (countHandler) {
+		countHandler(count);
+	}
+	if (count == 0) {
+		free(lines);
+		return 0;
+	}
+	// a few contiguous runs of records per core keeps every worker busy without much scheduling overhead
+	size_t stripes = MIN(count, (size_t)[NSProcessInfo processInfo].activeProcessorCount * 4);
+	bool stopped = false;
+	size_t parsed = 0;
+	bool *stoppedPtr = &stopped;
+	size_t *parsedPtr = &parsed;
+	dispatch_apply(stripes, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t stripe) {
+		size_t first = count * stripe / stripes;
+		size_t end = count * (stripe + 1) / stripes;
+		@autoreleasepool {
+			id<GRJsonDelegate> delegate = makeDelegate();
+			GRJson *parser = [[GRJson alloc] initWithDelegate:delegate];
+			for (size_t i = first; i < end && !__atomic_load_n(stoppedPtr, __ATOMIC_RELAXED); i++) {
+				@autoreleasepool {
+					NSError *error = nil;
+					[parser parseBytes:bytes + lines[i].offset length:lines[i].length error:&error];
+					__atomic_add_fetch(parsedPtr, 1, __ATOMIC_RELAXED);
+					BOOL stop = NO;
+					recordHandler(delegate, i, error, &stop);
+					if (stop) {
+						__atomic_store_n(stoppedPtr, true, __ATOMIC_RELAXED);
+					}
 				}
-				parseEscapedString(self, @selector(parseEscapedString:isObjectKey:), strResult, isObjectKey);
-				return;
-				break;
 			}
-			case '"':
-				endPos = m_pos;
-				isEos = true;
-				advance(self, @selector(advance));
-				break;
-			default:
-				advance(self, @selector(advance));
-				break;
 		}
-	}
-	unsigned long len = endPos - startPos;
-	NSString *value = [[NSString alloc] initWithBytes:m_buf+startPos length:len encoding:NSUTF8StringEncoding];
-	if (isObjectKey) {
-		json_object_key(delegate, @selector(json_object_key:), value);
-	}
-	else {
-		json_string(delegate, @selector(json_string:), value);
-	}
+	});
+	free(lines);
+	return parsed;
 }
 
-- (void) parseValue {
-	switch (m_buf[m_pos]) {
-		case '"':
-			return parseString(self, @selector(parseString:), NO);
-			break;
-		case '-':
-		case '0':
-		case '1':
-		case '2':
-		case '3':
-		case '4':
-		case '5':
-		case '6':
-		case '7':
-		case '8':
-		case '9':
-			return parseNumber(self, @selector(parseNumber));
-			break;
-		case '[':
-			return parseArray(self, @selector(parseArray));
-			break;
-		case 'f':
-			return parseBool(self, @selector(parseBool));
-			break;
-		case 'n':
-			return parseNull(self, @selector(parseNull));
-			break;
-		case 't':
-			return parseBool(self, @selector(parseBool));
-			break;
-		case '{':
-			return parseObject(self, @selector(parseObject));
-			break;
-		default:
-			[self setError:@"unexpected char '%c' at pos %lu", m_buf[m_pos], m_pos];
-	}
+- (instancetype) initWithDelegate:(id<GRJsonDelegate>)delegateIn {
+	return [self initWithData:nil delegate:delegateIn];
 }
 
-- (void) parseBool {
-	if ((m_pos+5) >= m_bufLen) {
-		[self setError:@"unexpected EOF while parsing boolean value"];
-	}
-	bool isValid = false;
-	bool val = false;
-	if (strncmp(m_buf+m_pos,"true", 4) == 0) {
-		isValid = true;
-		val = true;
-		skip(self, @selector(skip:), 4);
-	}
-	else if (strncmp(m_buf+m_pos, "false", 5) == 0)
-	{
-		isValid = true;
-		skip(self, @selector(skip:), 5);
-	}
-	else {
-		[self setError:@"invalid boolean value"];
+- (instancetype) initWithData:(NSData *)dataIn delegate:(id<GRJsonDelegate>)delegateIn {
+	self = [super init];
+	if (self) {
+		data = dataIn;
+		delegate = delegateIn;
+		readBufferSize = DEFAULT_READ_BUFFER_SIZE;
+		GRJsonTokenizerInit(&m_state.tokenizer);
+		GRJsonScratchInit(&m_state.scratch);
+
+		NSObject *object = (NSObject *)delegateIn;
+		GRJsonCallbacks *cb = &m_state.cb;
+
+		cb->delegate = delegateIn;
+		cb->json_null = (VoidFunction)[object methodForSelector:@selector(json_null)];
+		cb->json_bool = (void (*)(id, SEL, BOOL))[object methodForSelector:@selector(json_bool:)];
+		cb->json_number = (void (*)(id, SEL, const unsigned char *, unsigned long))[object methodForSelector:@selector(json_number:length:)];
+		cb->json_string = (void (*)(id, SEL, NSString *))[object methodForSelector:@selector(json_string:)];
+		cb->json_object_begin = (VoidFunction)[object methodForSelector:@selector(json_object_begin)];
+		cb->json_object_key = (void (*)(id, SEL, NSString *))[object methodForSelector:@selector(json_object_key:)];
+		cb->json_object_end = (VoidFunction)[object methodForSelector:@selector(json_object_end)];
+		cb->json_array_begin = (VoidFunction)[object methodForSelector:@selector(json_array_begin)];
+		cb->json_array_end = (VoidFunction)[object methodForSelector:@selector(json_array_end)];
+		if ([object respondsToSelector:@selector(json_string_bytes:length:needsUnescape:ascii:)]) {
+			cb->json_string_bytes = (void (*)(id, SEL, const unsigned char *, unsigned long, BOOL, BOOL))[object methodForSelector:@selector(json_string_bytes:length:needsUnescape:ascii:)];
+		}
+		if ([object respondsToSelector:@selector(json_object_key_bytes:length:needsUnescape:ascii:)]) {
+			cb->json_object_key_bytes = (void (*)(id, SEL, const unsigned char *, unsigned long, BOOL, BOOL))[object methodForSelector:@selector(json_object_key_bytes:length:needsUnescape:ascii:)];
+		}
+		if ([object respondsToSelector:@selector(json_integer:)] && [object respondsToSelector:@selector(json_double:)]) {
+			cb->json_integer = (void (*)(id, SEL, int64_t))[object methodForSelector:@selector(json_integer:)];
+			cb->json_double = (void (*)(id, SEL, double))[object methodForSelector:@selector(json_double:)];
+		}
 	}
-	json_bool(delegate, @selector(json_bool:), val == true);
+	return self;
 }
 
-- (void) parseNull {
-	if (m_pos+4 >= m_bufLen) {
-		[self setError:@"unexpected EOF while parsing null value"];
-	}
-	if (strncmp(m_buf+m_pos,"null",4) == 0) {
-		[delegate json_null];
-		skip(self, @selector(skip:), 4);
-	}
-	[self setError:@"bad literal value (null expected)"];
+- (void) dealloc {
+	GRJsonTokenizerDestroy(&m_state.tokenizer);
+	GRJsonSelectorDestroy(&m_state.selector);
+	GRJsonScratchDestroy(&m_state.scratch);
 }
 
-- (void) parseNumber {
-	if (m_buf[m_pos] == '-' && !(m_buf[m_pos+1] & VALID_NUMERIC_CHAR)) {
-		[self setError:@"missing integer after '-', got '%c' at pos %lu", m_buf[m_pos+1], m_pos+1];
+- (NSUInteger) maxDepth {
+	return m_state.tokenizer.maxDepth;
+}
+
+- (void) setMaxDepth:(NSUInteger)maxDepth {
+	GRJsonTokenizerSetMaxDepth(&m_state.tokenizer, maxDepth);
+}
+
+- (void) setSelection:(GRJsonSelection *)selectionIn {
+	selection = selectionIn;
+	GRJsonSelectorDestroy(&m_state.selector);
+	GRJsonSelectorInit(&m_state.selector, selectionIn.pathSet);
+	m_state.selecting = selectionIn != nil;
+}
+
+/**
+ * Runs the tokenizer over whatever input it was just given.  Returns YES if it consumed all of it (or
+ * finished the document) without error.
+ */
+- (BOOL) dispatchInput:(NSError *__autoreleasing *)error {
+	GRJsonState *st = &m_state;
+	// the delegate is weak, so hold on to it while events are being delivered
+	id<GRJsonDelegate> strongDelegate = delegate;
+	if (strongDelegate == nil) {
+		if (error) {
+			*error = [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"no delegate to receive parse events"}];
+		}
+		return NO;
 	}
-	unsigned long startPos = m_pos;
-	advance(self, @selector(advance));
-	while (charLookupTable[(int)m_buf[m_pos]] & VALID_NUMERIC_CHAR) {
-		advance(self, @selector(advance));
+	st->cb.delegate = strongDelegate;
+	GRJsonStatus status = dispatchTokens(st);
+	if (status == GRJsonStatusError) {
+		if (error) {
+			*error = errorFromTokenizer(&st->tokenizer);
+		}
+		return NO;
 	}
-	if (m_buf[m_pos] == '.') {
-		advance(self, @selector(advance));
-		unsigned long fracPos = m_pos;
-		while (charLookupTable[(int)m_buf[m_pos]] & VALID_NUMERIC_CHAR) {
-			advance(self, @selector(advance));
+	return YES;
+}
+
+- (BOOL) parse:(NSError *__autoreleasing *)error {
+	return [self parseBytes:(const uint8_t *)[data bytes] length:[data length] error:error];
+}
+
+/** parses one complete document from a buffer the caller keeps alive for the duration of the call */
+- (BOOL) parseBytes:(const uint8_t *)bytes length:(size_t)length error:(NSError *__autoreleasing *)error {
+	GRJsonTokenizer *t = &m_state.tokenizer;
+	GRJsonTokenizerReset(t);
+	GRJsonSelectorReset(&m_state.selector);
+	GRJsonTokenizerSetInput(t, bytes, length, true);
+	BOOL success = [self dispatchInput:error];
+	if (!success && t->error == GRJsonErrorEmptyDocument) {
+		// nothing but whitespace (or nothing at all) has never been treated as an error here
+		if (error) {
+			*error = nil;
 		}
-		if (fracPos == m_pos) {
-			[self setError:@"missing integer after '.', got '%c' at pos %lu", m_buf[m_pos], m_pos];
+		success = YES;
+	}
+	return success;
+}
+
+- (BOOL) feed:(NSData *)chunk error:(NSError *__autoreleasing *)error {
+	GRJsonTokenizer *t = &m_state.tokenizer;
+	if (t->isFinal) {
+		if (error) {
+			*error = [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"cannot feed more data after -finish:"}];
 		}
+		return NO;
 	}
-	if (m_buf[m_pos] == 'e' || m_buf[m_pos] == 'E') {
-		advance(self, @selector(advance));
-		if (m_buf[m_pos] == '+' || m_buf[m_pos] == '-') {
-			advance(self, @selector(advance));
+	if (chunk.length == 0) {
+		if (t->error != GRJsonErrorNone) {
+			// the error is sticky, so report it again rather than failing with nothing to say why
+			if (error) {
+				*error = errorFromTokenizer(t);
+			}
+			return NO;
 		}
-		unsigned long expPos = m_pos;
-		while (charLookupTable[(int)m_buf[m_pos]] & VALID_NUMERIC_CHAR) {
-			advance(self, @selector(advance));
+		return YES;
+	}
+	__block NSError *feedError = nil;
+	// an NSData may be backed by several discontiguous regions, so walk them instead of flattening it
+	[chunk enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+		@autoreleasepool {
+			NSError *chunkError = nil;
+			GRJsonTokenizerSetInput(t, (const uint8_t *)bytes, byteRange.length, false);
+			if (![self dispatchInput:&chunkError]) {
+				feedError = chunkError;
+				*stop = YES;
+			}
 		}
-		if (expPos == m_pos) {
-			[self setError:@"missing integer after exponent, got '%c' at pos %lu", m_buf[m_pos], m_pos];
+	}];
+	if (feedError) {
+		if (error) {
+			*error = feedError;
 		}
+		return NO;
 	}
-	unsigned long stopPos = m_pos;
-	json_number(delegate, @selector(json_number:length:), (const unsigned char *)m_buf+startPos, stopPos-startPos);
+	return YES;
 }
 
-- (void) parseArray {
-	json_array_begin(delegate, @selector(json_array_begin));
-	m_objectLevel++;
-	advance(self, @selector(advance));
-	skipWhiteSpace(self, @selector(skipWhiteSpace));
-	if (m_buf[m_pos] != ']') {
-		[self parseArrayElements];
-	}
-	if (m_buf[m_pos] == ']') {
-		m_objectLevel--;
-		advance(self, @selector(advance));
-		json_array_end(delegate, @selector(json_array_end));
-	}
-	else {
-		[self setError:@"expected ']' to close array, got '%c' at pos %lu", m_buf[m_pos], m_pos];
+- (BOOL) finish:(NSError *__autoreleasing *)error {
+	GRJsonTokenizer *t = &m_state.tokenizer;
+	if (t->error != GRJsonErrorNone) {
+		if (error) {
+			*error = errorFromTokenizer(t);
+		}
+		return NO;
 	}
+	GRJsonTokenizerSetInput(t, NULL, 0, true);
+	return [self dispatchInput:error];
 }
 
-- (void) parseArrayElements {
-	bool hasMoreMembers = true;
-	char nextSym = '\0';
-	while (hasMoreMembers) {
-		skipWhiteSpace(self, @selector(skipWhiteSpace));
-		if (nextSym != '\0' && m_buf[m_pos] != nextSym) {
-			return;
+#pragma mark - reading
+
+/**
+ * Parses one complete document pulled in by reader, which fills the buffer it is given and returns the number
+ * of bytes, 0 at the end, or -1 with an error.  The buffer is only refilled once the tokenizer has asked for
+ * more, which means it has consumed every byte (keeping a split token in its carry buffer).
+ */
+- (BOOL) parseWithReader:(NSInteger (^)(uint8_t *buffer, size_t capacity, NSError *__autoreleasing *readError))reader error:(NSError *__autoreleasing *)errorOut {
+	GRJsonTokenizer *t = &m_state.tokenizer;
+	GRJsonTokenizerReset(t);
+	GRJsonSelectorReset(&m_state.selector);
+	size_t capacity = MAX(readBufferSize, MIN_READ_BUFFER_SIZE);
+	uint8_t *buffer = malloc(capacity);
+	if (buffer == NULL) {
+		if (errorOut) {
+			*errorOut = [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"out of memory"}];
 		}
-		switch (m_buf[m_pos]) {
-			case ',':
-				advance(self, @selector(advance));
-				nextSym = '\0';
-				break;
-			default:
-				[self parseValue];
-				nextSym = ',';
-				break;
+		return NO;
+	}
+	NSError *error = nil;
+	BOOL success = YES;
+	while (success) {
+		NSInteger bytesRead = reader(buffer, capacity, &error);
+		if (bytesRead < 0) {
+			success = NO;
+			break;
+		}
+		@autoreleasepool {
+			NSError *inputError = nil;
+			GRJsonTokenizerSetInput(t, buffer, (size_t)bytesRead, bytesRead == 0);
+			success = [self dispatchInput:&inputError];
+			error = inputError;
+		}
+		if (bytesRead == 0) {
+			break;
 		}
 	}
+	free(buffer);
+	if (!success && t->error == GRJsonErrorEmptyDocument) {
+		// as in -parseBytes:length:error:, nothing but whitespace is not an error
+		error = nil;
+		success = YES;
+	}
+	if (!success && errorOut) {
+		*errorOut = error;
+	}
+	return success;
+}
+
+- (BOOL) parseStream:(NSInputStream *)stream error:(NSError *__autoreleasing *)error {
+	if (stream.streamStatus == NSStreamStatusNotOpen) {
+		[stream open];
+	}
+	BOOL success = [self parseWithReader:^NSInteger(uint8_t *buffer, size_t capacity, NSError *__autoreleasing *readError) {
+		NSInteger bytesRead = [stream read:buffer maxLength:capacity];
+		if (bytesRead < 0) {
+			*readError = stream.streamError ?: [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"could not read the input"}];
+		}
+		return bytesRead;
+	} error:error];
+	[stream close];
+	return success;
 }
 
+- (BOOL) parseFileDescriptor:(int)fd error:(NSError *__autoreleasing *)error {
+	return [self parseWithReader:^NSInteger(uint8_t *buffer, size_t capacity, NSError *__autoreleasing *readError) {
+		ssize_t bytesRead;
+		do {
+			bytesRead = read(fd, buffer, capacity);
+		} while (bytesRead < 0 && errno == EINTR);
+		if (bytesRead < 0) {
+			*readError = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+		}
+		return (NSInteger)bytesRead;
+	} error:error];
+}
 
 @end
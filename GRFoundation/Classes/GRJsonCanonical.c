@@ -0,0 +1,428 @@
+//
+//  GRJsonCanonical.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonCanonical.h"
+#include "GRJsonNumber.h"
+#include "GRJsonString.h"
+#include "GRJsonTape.h"
+#include "GRJsonTokenizer.h"
+#include "GRJsonValidator.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#pragma mark - numbers
+
+/**
+ * The shortest significant digits of a positive, finite value that read back as the same double, and the
+ * decimal exponent of the first one.  Reading back is exact (see GRJsonNumber.h), and a precision that
+ * reads back means every longer one does too, so the shortest is found by bisecting 1 to 17 digits.
+ */
+static int shortestDigits(double value, char *digits, int *exponent) {
+	locale_t previous = uselocale(GRJsonCLocale());
+	char text[GRJSON_CANONICAL_NUMBER_SIZE];
+	int low = 1, high = 17;
+	while (low < high) {
+		int precision = (low + high) / 2;
+		int length = snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+		int64_t integer;
+		double parsed;
+		if (GRJsonParseNumber((const uint8_t *)text, (size_t)length, &integer, &parsed) != GRJsonNumberInvalid && parsed == value) {
+			high = precision;
+		}
+		else {
+			low = precision + 1;
+		}
+	}
+	snprintf(text, sizeof(text), "%.*e", low - 1, value);
+	uselocale(previous);
+	// text is d[.ddd]e[+-]xx
+	int count = 0;
+	const char *p = text;
+	for (; *p != 'e'; p++) {
+		if (*p != '.') {
+			digits[count++] = *p;
+		}
+	}
+	*exponent = atoi(p + 1);
+	while (count > 1 && digits[count - 1] == '0') {
+		count--;
+	}
+	return count;
+}
+
+size_t GRJsonCanonicalFormatNumber(double value, char *out) {
+	if (!isfinite(value)) {
+		return 0;
+	}
+	if (value == 0) {
+		out[0] = '0';
+		return 1;
+	}
+	size_t length = 0;
+	if (value < 0) {
+		out[length++] = '-';
+		value = -value;
+	}
+	char digits[20];
+	int exponent;
+	int k = shortestDigits(value, digits, &exponent);
+	int n = exponent + 1; // the value is 0.digits times 10^n
+	if (k <= n && n <= 21) {
+		memcpy(out + length, digits, (size_t)k);
+		length += (size_t)k;
+		memset(out + length, '0', (size_t)(n - k));
+		length += (size_t)(n - k);
+	}
+	else if (0 < n && n <= 21) {
+		memcpy(out + length, digits, (size_t)n);
+		length += (size_t)n;
+		out[length++] = '.';
+		memcpy(out + length, digits + n, (size_t)(k - n));
+		length += (size_t)(k - n);
+	}
+	else if (-6 < n && n <= 0) {
+		out[length++] = '0';
+		out[length++] = '.';
+		memset(out + length, '0', (size_t)-n);
+		length += (size_t)-n;
+		memcpy(out + length, digits, (size_t)k);
+		length += (size_t)k;
+	}
+	else {
+		out[length++] = digits[0];
+		if (k > 1) {
+			out[length++] = '.';
+			memcpy(out + length, digits + 1, (size_t)(k - 1));
+			length += (size_t)(k - 1);
+		}
+		length += (size_t)snprintf(out + length, GRJSON_CANONICAL_NUMBER_SIZE - length, "e%c%d", n - 1 < 0 ? '-' : '+', abs(n - 1));
+	}
+	return length;
+}
+
+#pragma mark - member names
+
+/** Reads the next UTF-16 code unit of valid UTF-8, keeping the second half of a surrogate pair in *pending. */
+static uint32_t nextUnit(const uint8_t *s, size_t length, size_t *pos, uint32_t *pending) {
+	if (*pending) {
+		uint32_t unit = *pending;
+		*pending = 0;
+		return unit;
+	}
+	uint8_t lead = s[*pos];
+	uint32_t codePoint;
+	size_t extra;
+	if (lead < 0x80) {
+		codePoint = lead;
+		extra = 0;
+	}
+	else if (lead < 0xE0) {
+		codePoint = lead & 0x1F;
+		extra = 1;
+	}
+	else if (lead < 0xF0) {
+		codePoint = lead & 0x0F;
+		extra = 2;
+	}
+	else {
+		codePoint = lead & 0x07;
+		extra = 3;
+	}
+	(*pos)++;
+	for (; extra > 0 && *pos < length; extra--) {
+		codePoint = (codePoint << 6) | (s[(*pos)++] & 0x3F);
+	}
+	if (codePoint >= 0x10000) {
+		codePoint -= 0x10000;
+		*pending = 0xDC00 | (codePoint & 0x3FF);
+		return 0xD800 | (codePoint >> 10);
+	}
+	return codePoint;
+}
+
+int GRJsonCanonicalCompareKeys(const uint8_t *a, size_t aLength, const uint8_t *b, size_t bLength) {
+	// UTF-8 already sorts by code point, which only disagrees with UTF-16 after the first differing byte
+	size_t common = 0;
+	size_t shorter = aLength < bLength ? aLength : bLength;
+	while (common < shorter && a[common] == b[common]) {
+		common++;
+	}
+	while (common > 0 && (a[common] & 0xC0) == 0x80) {
+		common--;
+	}
+	size_t i = common, j = common;
+	uint32_t pendingA = 0, pendingB = 0;
+	while ((i < aLength || pendingA) && (j < bLength || pendingB)) {
+		uint32_t unitA = nextUnit(a, aLength, &i, &pendingA);
+		uint32_t unitB = nextUnit(b, bLength, &j, &pendingB);
+		if (unitA != unitB) {
+			return unitA < unitB ? -1 : 1;
+		}
+	}
+	bool aDone = i >= aLength && !pendingA;
+	bool bDone = j >= bLength && !pendingB;
+	return aDone == bDone ? 0 : (aDone ? -1 : 1);
+}
+
+#pragma mark - documents
+
+typedef struct GRJsonCanonicalMember {
+	size_t keyOffset; ///< into the key stack
+	size_t keyLength;
+	size_t value;     ///< tape index
+} GRJsonCanonicalMember;
+
+typedef struct GRJsonCanonicalizer {
+	const GRJsonTape *tape;
+	GRJsonEmitter *out;
+	GRJsonCanonicalMember *members; ///< the members of every object being written, innermost last
+	size_t memberCount;
+	size_t memberCapacity;
+	GRJsonCanonicalMember *sorted;  ///< merge sort scratch
+	size_t sortedCapacity;
+	uint8_t *keys;                  ///< the decoded names of those members
+	size_t keysLength;
+	size_t keysCapacity;
+	GRJsonScratch scratch;
+	bool failed;
+	char *errorMessage;
+	size_t errorMessageSize;
+} GRJsonCanonicalizer;
+
+static bool failf(GRJsonCanonicalizer *c, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static bool failf(GRJsonCanonicalizer *c, const char *fmt, ...) {
+	if (!c->failed && c->errorMessage && c->errorMessageSize) {
+		va_list argList;
+		va_start(argList, fmt);
+		vsnprintf(c->errorMessage, c->errorMessageSize, fmt, argList);
+		va_end(argList);
+	}
+	c->failed = true;
+	return false;
+}
+
+static bool emitterFailed(GRJsonCanonicalizer *c) {
+	switch (c->out->error) {
+		case GRJsonEmitterErrorOutOfMemory:
+			return failf(c, "out of memory");
+		case GRJsonEmitterErrorSink:
+			return failf(c, "the output was refused");
+		default:
+			return failf(c, "could not write the canonical form");
+	}
+}
+
+static int compareMembers(const GRJsonCanonicalizer *c, const GRJsonCanonicalMember *a, const GRJsonCanonicalMember *b) {
+	return GRJsonCanonicalCompareKeys(c->keys + a->keyOffset, a->keyLength, c->keys + b->keyOffset, b->keyLength);
+}
+
+/** a stable merge sort of members[first, first + count), since qsort_r is spelled differently everywhere */
+static bool sortMembers(GRJsonCanonicalizer *c, size_t first, size_t count) {
+	if (count > c->sortedCapacity) {
+		GRJsonCanonicalMember *sorted = realloc(c->sorted, count * sizeof(GRJsonCanonicalMember));
+		if (sorted == NULL) {
+			return false;
+		}
+		c->sorted = sorted;
+		c->sortedCapacity = count;
+	}
+	GRJsonCanonicalMember *from = c->members + first;
+	GRJsonCanonicalMember *to = c->sorted;
+	for (size_t width = 1; width < count; width *= 2) {
+		for (size_t left = 0; left < count; left += 2 * width) {
+			size_t middle = left + width < count ? left + width : count;
+			size_t right = left + 2 * width < count ? left + 2 * width : count;
+			size_t i = left, j = middle, k = left;
+			while (i < middle && j < right) {
+				to[k++] = compareMembers(c, &from[j], &from[i]) < 0 ? from[j++] : from[i++];
+			}
+			while (i < middle) {
+				to[k++] = from[i++];
+			}
+			while (j < right) {
+				to[k++] = from[j++];
+			}
+		}
+		GRJsonCanonicalMember *swap = from;
+		from = to;
+		to = swap;
+	}
+	if (from != c->members + first) {
+		memcpy(c->members + first, from, count * sizeof(GRJsonCanonicalMember));
+	}
+	return true;
+}
+
+static bool pushMember(GRJsonCanonicalizer *c, const uint8_t *key, size_t keyLength, size_t value) {
+	if (c->memberCount == c->memberCapacity) {
+		size_t capacity = c->memberCapacity ? c->memberCapacity * 2 : 64;
+		GRJsonCanonicalMember *members = realloc(c->members, capacity * sizeof(GRJsonCanonicalMember));
+		if (members == NULL) {
+			return false;
+		}
+		c->members = members;
+		c->memberCapacity = capacity;
+	}
+	// allocated even for an empty key, so a key's bytes are never NULL
+	if (c->keys == NULL || c->keysLength + keyLength > c->keysCapacity) {
+		size_t capacity = c->keysCapacity ? c->keysCapacity : 1024;
+		while (capacity < c->keysLength + keyLength) {
+			capacity *= 2;
+		}
+		uint8_t *keys = realloc(c->keys, capacity);
+		if (keys == NULL) {
+			return false;
+		}
+		c->keys = keys;
+		c->keysCapacity = capacity;
+	}
+	memcpy(c->keys + c->keysLength, key, keyLength);
+	c->members[c->memberCount++] = (GRJsonCanonicalMember){c->keysLength, keyLength, value};
+	c->keysLength += keyLength;
+	return true;
+}
+
+/** the bytes of a string on the tape with its escapes decoded into the scratch buffer, if it has any */
+static const uint8_t *decodedString(GRJsonCanonicalizer *c, size_t index, size_t *length) {
+	bool hasEscapes;
+	const uint8_t *bytes = GRJsonTapeStringAt(c->tape, index, length, &hasEscapes);
+	if (!hasEscapes) {
+		return bytes;
+	}
+	uint8_t *decoded = GRJsonScratchReserve(&c->scratch, *length ? *length : 1);
+	if (decoded == NULL) {
+		return NULL;
+	}
+	*length = GRJsonUnescape(bytes, *length, decoded);
+	return decoded;
+}
+
+static bool writeNumber(GRJsonCanonicalizer *c, double value) {
+	char text[GRJSON_CANONICAL_NUMBER_SIZE];
+	size_t length = GRJsonCanonicalFormatNumber(value, text);
+	if (length == 0) {
+		return failf(c, "the number %g has no canonical form", value);
+	}
+	return GRJsonEmitterRawValue(c->out, (const uint8_t *)text, length) || emitterFailed(c);
+}
+
+static bool writeValue(GRJsonCanonicalizer *c, size_t index) {
+	const GRJsonTape *tape = c->tape;
+	GRJsonEmitter *out = c->out;
+	switch (GRJsonTapeTypeAt(tape, index)) {
+		case GRJsonTapeObject:
+		{
+			size_t first = c->memberCount;
+			size_t keysMark = c->keysLength;
+			size_t end = GRJsonTapePayloadAt(tape, index) - 1;
+			for (size_t key = GRJsonTapeFirstChild(index); key < end; key = GRJsonTapeNext(tape, key + 2)) {
+				size_t keyLength;
+				const uint8_t *name = decodedString(c, key, &keyLength);
+				if (name == NULL || !pushMember(c, name, keyLength, key + 2)) {
+					return failf(c, "out of memory");
+				}
+			}
+			size_t count = c->memberCount - first;
+			if (!sortMembers(c, first, count)) {
+				return failf(c, "out of memory");
+			}
+			if (!GRJsonEmitterBeginObject(out)) {
+				return emitterFailed(c);
+			}
+			for (size_t i = 0; i < count; i++) {
+				// the member stack can move while a value is written, so it is indexed afresh each time
+				GRJsonCanonicalMember member = c->members[first + i];
+				if (i > 0 && compareMembers(c, &c->members[first + i - 1], &member) == 0) {
+					return failf(c, "the name \"%.*s\" appears twice in one object", (int)(member.keyLength > 64 ? 64 : member.keyLength), (const char *)c->keys + member.keyOffset);
+				}
+				if (!GRJsonEmitterKey(out, c->keys + member.keyOffset, member.keyLength)) {
+					return emitterFailed(c);
+				}
+				if (!writeValue(c, member.value)) {
+					return false;
+				}
+			}
+			c->memberCount = first;
+			c->keysLength = keysMark;
+			return GRJsonEmitterEndObject(out) || emitterFailed(c);
+		}
+		case GRJsonTapeArray:
+		{
+			if (!GRJsonEmitterBeginArray(out)) {
+				return emitterFailed(c);
+			}
+			size_t end = GRJsonTapePayloadAt(tape, index) - 1;
+			for (size_t element = GRJsonTapeFirstChild(index); element < end; element = GRJsonTapeNext(tape, element)) {
+				if (!writeValue(c, element)) {
+					return false;
+				}
+			}
+			return GRJsonEmitterEndArray(out) || emitterFailed(c);
+		}
+		case GRJsonTapeString:
+		{
+			size_t length;
+			const uint8_t *bytes = decodedString(c, index, &length);
+			if (bytes == NULL) {
+				return failf(c, "out of memory");
+			}
+			return GRJsonEmitterString(out, bytes, length) || emitterFailed(c);
+		}
+		case GRJsonTapeInteger:
+			return writeNumber(c, (double)GRJsonTapeIntegerAt(tape, index));
+		case GRJsonTapeDouble:
+			return writeNumber(c, GRJsonTapeDoubleAt(tape, index));
+		case GRJsonTapeTrue:
+			return GRJsonEmitterBool(out, true) || emitterFailed(c);
+		case GRJsonTapeFalse:
+			return GRJsonEmitterBool(out, false) || emitterFailed(c);
+		default:
+			return GRJsonEmitterNull(out) || emitterFailed(c);
+	}
+}
+
+bool GRJsonCanonicalize(const uint8_t *bytes, size_t length, GRJsonEmitter *out, char *errorMessage, size_t errorMessageSize) {
+	GRJsonCanonicalizer canonicalizer;
+	GRJsonCanonicalizer *c = &canonicalizer;
+	memset(c, 0, sizeof(*c));
+	c->out = out;
+	c->errorMessage = errorMessage;
+	c->errorMessageSize = errorMessageSize;
+	// the validator also checks the UTF-8, which the canonical form passes through untouched
+	GRJsonValidation validation;
+	if (!GRJsonValidate(bytes, length, &validation)) {
+		return failf(c, "invalid JSON: %s at line %zu, column %zu", validation.message, validation.line, validation.column);
+	}
+	GRJsonTape tape;
+	GRJsonTokenizer tokenizer;
+	GRJsonTapeInit(&tape);
+	GRJsonTokenizerInit(&tokenizer);
+	GRJsonScratchInit(&c->scratch);
+	GRJsonError result = GRJsonTapeBuild(&tape, &tokenizer, bytes, length);
+	if (result != GRJsonErrorNone) {
+		failf(c, "%s", result == GRJsonErrorOutOfMemory ? "out of memory" : tokenizer.errorMessage);
+	}
+	else {
+		c->tape = &tape;
+		if (writeValue(c, 0) && !GRJsonEmitterFlush(out)) {
+			emitterFailed(c);
+		}
+	}
+	free(c->members);
+	free(c->sorted);
+	free(c->keys);
+	GRJsonScratchDestroy(&c->scratch);
+	GRJsonTokenizerDestroy(&tokenizer);
+	GRJsonTapeDestroy(&tape);
+	return !c->failed;
+}
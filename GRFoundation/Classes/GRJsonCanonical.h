@@ -0,0 +1,54 @@
+//
+//  GRJsonCanonical.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonCanonical_h
+#define GRJsonCanonical_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GRJsonEmitter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GRJSON_CANONICAL_NUMBER_SIZE 32 ///< room for any number GRJsonCanonicalFormatNumber writes
+
+/**
+ * Writes value the way RFC 8785 (and ECMAScript's Number.prototype.toString) spells it: the shortest
+ * digits that read back as the same double, in plain notation from 1e-6 up to 1e21 and as "1.5e+21" or
+ * "1e-7" outside that range, with -0 written as 0.
+ *
+ * @param out at least GRJSON_CANONICAL_NUMBER_SIZE bytes
+ * @return the length written, or 0 for NaN and the infinities, which have no canonical form
+ */
+size_t GRJsonCanonicalFormatNumber(double value, char *out);
+
+/** Orders two UTF-8 member names by their UTF-16 code units, as RFC 8785 sorts them. */
+int GRJsonCanonicalCompareKeys(const uint8_t *a, size_t aLength, const uint8_t *b, size_t bLength);
+
+/**
+ * Writes the RFC 8785 (JSON Canonicalization Scheme) form of a JSON document to out: no whitespace,
+ * members sorted by GRJsonCanonicalCompareKeys, strings with only the escapes JSON requires (see
+ * GRJsonEmitter.h) and every number as a double in GRJsonCanonicalFormatNumber's spelling.
+ *
+ * The document is parsed into a tape (see GRJsonTape.h), never into objects, and the output goes straight
+ * to out; with a sink on the emitter, only GRJSON_EMITTER_FLUSH_SIZE bytes of it are ever held at once.
+ *
+ * @return false, with a description in errorMessage, if the document is not valid JSON, has an object with
+ *         the same name twice, or out failed
+ */
+bool GRJsonCanonicalize(const uint8_t *bytes, size_t length, GRJsonEmitter *out, char *errorMessage, size_t errorMessageSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonCanonical_h */
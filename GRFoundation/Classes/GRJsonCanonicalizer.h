@@ -0,0 +1,56 @@
+//
+//  GRJsonCanonicalizer.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/** Receives the canonical form a piece at a time.  Return NO to stop. */
+typedef BOOL (^GRJsonCanonicalSink)(const uint8_t *bytes, NSUInteger length);
+
+/**
+ Writes the RFC 8785 canonical form of JSON (JCS): members sorted by their UTF-16 code units, no
+ whitespace, minimal string escapes and numbers in ECMAScript's shortest round-trip spelling.  Two documents
+ that mean the same thing produce the same bytes, so the canonical form can be hashed or signed.
+
+ The input is either JSON bytes, which are parsed into a tape rather than objects (see GRJsonCanonical.h),
+ or a tree of NSDictionary, NSArray, NSString, NSNumber and NSNull such as GRJsonParser returns.  The output
+ is handed over in pieces of about 64KB as it is produced, so digesting a document never holds its whole
+ canonical form.
+ */
+@interface GRJsonCanonicalizer : NSObject
+
+/** The canonical form of JSON bytes, or nil if they are not valid JSON or repeat a member name. */
++ (NSData *) canonicalDataWithData:(NSData *)json error:(NSError *__autoreleasing *)error;
+
+/** The canonical form of a tree of Foundation objects, or nil if it holds something with no JSON form. */
++ (NSData *) canonicalDataWithJSONObject:(id)object error:(NSError *__autoreleasing *)error;
+
+/**
+ Streams the canonical form of JSON bytes into sink.
+
+ @param json the document
+ @param sink called with each piece of the canonical form, in order
+ @param error an out pointer that holds the parse error, or the reason sink was stopped
+ @return YES if the whole canonical form was handed to sink
+ */
++ (BOOL) canonicalizeData:(NSData *)json sink:(GRJsonCanonicalSink)sink error:(NSError *__autoreleasing *)error;
+
+/** Same as +canonicalizeData:sink:error:, for a tree of Foundation objects. */
++ (BOOL) canonicalizeJSONObject:(id)object sink:(GRJsonCanonicalSink)sink error:(NSError *__autoreleasing *)error;
+
+/** The SHA-256 digest of the canonical form, computed as the form is produced. */
++ (NSData *) SHA256OfData:(NSData *)json error:(NSError *__autoreleasing *)error;
++ (NSData *) SHA256OfJSONObject:(id)object error:(NSError *__autoreleasing *)error;
+
+/**
+ The HMAC-SHA1 of the canonical form, computed as the form is produced.  This is the same digest that
+ -[NSData hmacSHA1UsingSecret:] would give for the canonical data.
+ */
++ (NSData *) hmacSHA1OfData:(NSData *)json secret:(NSData *)secret error:(NSError *__autoreleasing *)error;
++ (NSData *) hmacSHA1OfJSONObject:(id)object secret:(NSData *)secret error:(NSError *__autoreleasing *)error;
+
+@end
@@ -0,0 +1,244 @@
+//
+//  GRJsonCanonicalizer.m
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import "GRJsonCanonicalizer.h"
+#import "JsonSupport.h"
+#import "GRJsonCanonical.h"
+#import <CommonCrypto/CommonDigest.h>
+#import <CommonCrypto/CommonHMAC.h>
+
+static bool callSink(void *context, const uint8_t *bytes, size_t length) {
+	GRJsonCanonicalSink sink = (__bridge GRJsonCanonicalSink)context;
+	return sink(bytes, (NSUInteger)length);
+}
+
+@interface GRJsonCanonicalizer ()
+{
+	GRJsonEmitter emitter;
+	GRJsonCanonicalSink sinkBlock; ///< kept alive for as long as the emitter points at it
+	GRJsonScratch scratch;   ///< UTF-8 of the string being written, when it can't be read in place
+	NSString *failure;
+}
+
+@end
+
+@implementation GRJsonCanonicalizer
+
+- (instancetype) initWithSink:(GRJsonCanonicalSink)sink {
+	self = [super init];
+	if (self) {
+		GRJsonEmitterInit(&emitter);
+		GRJsonScratchInit(&scratch);
+		sinkBlock = [sink copy];
+		if (sinkBlock) {
+			GRJsonEmitterSetSink(&emitter, callSink, (__bridge void *)sinkBlock);
+		}
+	}
+	return self;
+}
+
+- (void) dealloc {
+	GRJsonEmitterDestroy(&emitter);
+	GRJsonScratchDestroy(&scratch);
+}
+
+#pragma mark - object trees
+
+- (BOOL) failWithReason:(NSString *)reason {
+	if (failure == nil) {
+		failure = reason;
+	}
+	return NO;
+}
+
+- (BOOL) check:(bool)succeeded {
+	if (succeeded) {
+		return YES;
+	}
+	switch (emitter.error) {
+		case GRJsonEmitterErrorOutOfMemory:
+			return [self failWithReason:@"out of memory"];
+		case GRJsonEmitterErrorSink:
+			return [self failWithReason:@"the output was refused"];
+		default:
+			return [self failWithReason:@"could not write the canonical form"];
+	}
+}
+
+- (BOOL) writeString:(NSString *)string isKey:(BOOL)isKey {
+	size_t length = 0;
+	const uint8_t *bytes = GRJsonUTF8BytesOfString(string, &scratch, &length);
+	if (bytes == NULL) {
+		return [self failWithReason:@"out of memory"];
+	}
+	return [self check:isKey ? GRJsonEmitterKey(&emitter, bytes, length) : GRJsonEmitterString(&emitter, bytes, length)];
+}
+
+- (BOOL) writeNumber:(NSNumber *)number {
+	// @YES and @NO are shared instances, which is the only reliable way to tell a boolean from a char
+	if (number == (id)@YES || number == (id)@NO) {
+		return [self check:GRJsonEmitterBool(&emitter, number.boolValue)];
+	}
+	// RFC 8785 numbers are doubles, whatever they were created from
+	char text[GRJSON_CANONICAL_NUMBER_SIZE];
+	size_t length = GRJsonCanonicalFormatNumber(number.doubleValue, text);
+	if (length == 0) {
+		return [self failWithReason:@"NaN and infinity have no canonical form"];
+	}
+	return [self check:GRJsonEmitterRawValue(&emitter, (const uint8_t *)text, length)];
+}
+
+- (BOOL) writeObject:(id)object {
+	if ([object isKindOfClass:[NSString class]]) {
+		return [self writeString:object isKey:NO];
+	}
+	if ([object isKindOfClass:[NSNumber class]]) {
+		return [self writeNumber:object];
+	}
+	if ([object isKindOfClass:[NSDictionary class]]) {
+		NSDictionary *dictionary = object;
+		for (id key in dictionary) {
+			if (![key isKindOfClass:[NSString class]]) {
+				return [self failWithReason:[NSString stringWithFormat:@"object keys must be strings, not %@", NSStringFromClass([key class])]];
+			}
+		}
+		// a literal comparison orders by UTF-16 code units, as RFC 8785 requires
+		NSArray *keys = [dictionary.allKeys sortedArrayUsingComparator:^NSComparisonResult(NSString *a, NSString *b) {
+			return [a compare:b options:NSLiteralSearch];
+		}];
+		if (![self check:GRJsonEmitterBeginObject(&emitter)]) {
+			return NO;
+		}
+		for (NSString *key in keys) {
+			if (![self writeString:key isKey:YES] || ![self writeObject:dictionary[key]]) {
+				return NO;
+			}
+		}
+		return [self check:GRJsonEmitterEndObject(&emitter)];
+	}
+	if ([object isKindOfClass:[NSArray class]]) {
+		if (![self check:GRJsonEmitterBeginArray(&emitter)]) {
+			return NO;
+		}
+		for (id element in (NSArray *)object) {
+			if (![self writeObject:element]) {
+				return NO;
+			}
+		}
+		return [self check:GRJsonEmitterEndArray(&emitter)];
+	}
+	if (object == nil || object == (id)[NSNull null]) {
+		return [self check:GRJsonEmitterNull(&emitter)];
+	}
+	return [self failWithReason:[NSString stringWithFormat:@"%@ has no JSON representation", NSStringFromClass([object class])]];
+}
+
+- (BOOL) finishObject:(id)object error:(NSError *__autoreleasing *)error {
+	if ([self writeObject:object]) {
+		[self check:GRJsonEmitterFlush(&emitter)];
+	}
+	if (failure && error) {
+		*error = GRJsonErrorWithReason(@"GRJsonWriter", failure);
+	}
+	return failure == nil;
+}
+
+- (BOOL) finishData:(NSData *)json error:(NSError *__autoreleasing *)error {
+	char message[200];
+	if (GRJsonCanonicalize((const uint8_t *)json.bytes, json.length, &emitter, message, sizeof(message))) {
+		return YES;
+	}
+	if (error) {
+		*error = GRJsonErrorWithReason(@"GRJsonWriter", [NSString stringWithUTF8String:message] ?: @"could not write the canonical form");
+	}
+	return NO;
+}
+
+- (NSData *) data {
+	return [NSData dataWithBytes:emitter.buf length:emitter.length];
+}
+
+#pragma mark - public
+
++ (NSData *) canonicalDataWithData:(NSData *)json error:(NSError *__autoreleasing *)error {
+	GRJsonCanonicalizer *canonicalizer = [[self alloc] initWithSink:nil];
+	return [canonicalizer finishData:json error:error] ? canonicalizer.data : nil;
+}
+
++ (NSData *) canonicalDataWithJSONObject:(id)object error:(NSError *__autoreleasing *)error {
+	GRJsonCanonicalizer *canonicalizer = [[self alloc] initWithSink:nil];
+	return [canonicalizer finishObject:object error:error] ? canonicalizer.data : nil;
+}
+
++ (BOOL) canonicalizeData:(NSData *)json sink:(GRJsonCanonicalSink)sink error:(NSError *__autoreleasing *)error {
+	return [[[self alloc] initWithSink:sink] finishData:json error:error];
+}
+
++ (BOOL) canonicalizeJSONObject:(id)object sink:(GRJsonCanonicalSink)sink error:(NSError *__autoreleasing *)error {
+	return [[[self alloc] initWithSink:sink] finishObject:object error:error];
+}
+
+#pragma mark - digests
+
+/** Feeds the canonical form of json (NSData) or of a tree into a digest, given as update and final blocks. */
++ (NSData *) digestOf:(id)input isData:(BOOL)isData length:(NSUInteger)digestLength update:(void (^)(const uint8_t *, NSUInteger))update final:(void (^)(uint8_t *))final error:(NSError *__autoreleasing *)error {
+	GRJsonCanonicalSink sink = ^BOOL(const uint8_t *bytes, NSUInteger length) {
+		update(bytes, length);
+		return YES;
+	};
+	BOOL written = isData ? [self canonicalizeData:input sink:sink error:error] : [self canonicalizeJSONObject:input sink:sink error:error];
+	NSMutableData *digest = [NSMutableData dataWithLength:digestLength];
+	final(digest.mutableBytes);
+	return written ? digest : nil;
+}
+
++ (NSData *) SHA256Of:(id)input isData:(BOOL)isData error:(NSError *__autoreleasing *)error {
+	CC_SHA256_CTX context;
+	CC_SHA256_CTX *contextPtr = &context;
+	CC_SHA256_Init(contextPtr);
+	return [self digestOf:input isData:isData length:CC_SHA256_DIGEST_LENGTH update:^(const uint8_t *bytes, NSUInteger length) {
+		// CC_LONG is 32 bits
+		while (length > 0) {
+			CC_LONG piece = (CC_LONG)MIN(length, (NSUInteger)UINT32_MAX);
+			CC_SHA256_Update(contextPtr, bytes, piece);
+			bytes += piece;
+			length -= piece;
+		}
+	} final:^(uint8_t *digest) {
+		CC_SHA256_Final(digest, contextPtr);
+	} error:error];
+}
+
++ (NSData *) hmacSHA1Of:(id)input isData:(BOOL)isData secret:(NSData *)secret error:(NSError *__autoreleasing *)error {
+	CCHmacContext context;
+	CCHmacContext *contextPtr = &context;
+	CCHmacInit(contextPtr, kCCHmacAlgSHA1, secret.bytes, (size_t)secret.length);
+	return [self digestOf:input isData:isData length:CC_SHA1_DIGEST_LENGTH update:^(const uint8_t *bytes, NSUInteger length) {
+		CCHmacUpdate(contextPtr, bytes, (size_t)length);
+	} final:^(uint8_t *digest) {
+		CCHmacFinal(contextPtr, digest);
+	} error:error];
+}
+
++ (NSData *) SHA256OfData:(NSData *)json error:(NSError *__autoreleasing *)error {
+	return [self SHA256Of:json isData:YES error:error];
+}
+
++ (NSData *) SHA256OfJSONObject:(id)object error:(NSError *__autoreleasing *)error {
+	return [self SHA256Of:object isData:NO error:error];
+}
+
++ (NSData *) hmacSHA1OfData:(NSData *)json secret:(NSData *)secret error:(NSError *__autoreleasing *)error {
+	return [self hmacSHA1Of:json isData:YES secret:secret error:error];
+}
+
++ (NSData *) hmacSHA1OfJSONObject:(id)object secret:(NSData *)secret error:(NSError *__autoreleasing *)error {
+	return [self hmacSHA1Of:object isData:NO secret:secret error:error];
+}
+
+@end
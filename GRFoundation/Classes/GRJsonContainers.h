@@ -0,0 +1,50 @@
+//
+//  GRJsonContainers.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/** Objects with at most this many members become a GRJsonCompactDictionary; larger ones get a hash table. */
+#define GRJSON_COMPACT_DICTIONARY_MAX_COUNT 12
+
+/**
+ An immutable dictionary for the small objects that make up most JSON documents.  Its keys, values and key
+ hashes share one buffer sized exactly to the member count, in member order, and a lookup is a linear scan
+ of the hashes followed by a single isEqual:.  Compared to a hash-table NSDictionary there are no empty
+ buckets and nothing to rehash, and enumeration walks the members in document order.
+ */
+@interface GRJsonCompactDictionary : NSDictionary
+
+/**
+ Creates the dictionary for a parsed object.  A key that appears more than once keeps its last value.
+
+ @param objects the values, in member order
+ @param keys the keys, in member order
+ @param count the number of members
+ @return a GRJsonCompactDictionary if there are no more than GRJSON_COMPACT_DICTIONARY_MAX_COUNT members,
+         otherwise a regular immutable NSDictionary; nil if there is no memory for it
+ */
++ (NSDictionary *) dictionaryForObjects:(const id [])objects keys:(const id [])keys count:(NSUInteger)count;
+
+@end
+
+/**
+ An immutable array whose elements live in one buffer sized exactly to the element count.  Fast enumeration
+ hands out the elements in place, without copying them into batches.
+ */
+@interface GRJsonCompactArray : NSArray
+
+/**
+ Creates the array for a parsed array.
+
+ @param objects the elements
+ @param count the number of elements
+ @return a GRJsonCompactArray, or the shared empty NSArray if count is zero; nil if there is no memory for it
+ */
++ (NSArray *) arrayForObjects:(const id [])objects count:(NSUInteger)count;
+
+@end
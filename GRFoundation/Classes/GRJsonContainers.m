@@ -0,0 +1,232 @@
+//
+//  GRJsonContainers.m
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import "GRJsonContainers.h"
+
+/** Hands out the inline slots in one batch: they are already contiguous, so nothing is copied. */
+static NSUInteger enumerateInPlace(NSFastEnumerationState *state, __strong id *slots, NSUInteger count) {
+	if (state->state != 0) {
+		return 0;
+	}
+	state->state = 1;
+	// immutable, so there is nothing for the mutation check to see
+	state->mutationsPtr = &state->extra[0];
+	state->itemsPtr = (__unsafe_unretained id *)(void *)slots;
+	return count;
+}
+
+@interface GRJsonCompactDictionary ()
+{
+	NSUInteger count;
+	// all three point into one calloc'd block, keys first, which -dealloc frees
+	__strong id *keys;
+	__strong id *values;
+	NSUInteger *hashes;
+}
+@end
+
+@implementation GRJsonCompactDictionary
+
+/** a hash-table dictionary for objects too big to scan, where a repeated key keeps its last value */
+static NSDictionary *hashedDictionary(const id objects[], const id<NSCopying> keys[], NSUInteger count) {
+	NSDictionary *dictionary = [[NSDictionary alloc] initWithObjects:objects forKeys:keys count:count];
+	if (dictionary.count < count) {
+		// a repeated key, where the last value has to win no matter how NSDictionary resolves it
+		NSMutableDictionary *lastWins = [NSMutableDictionary dictionaryWithCapacity:count];
+		for (NSUInteger i = 0; i < count; i++) {
+			lastWins[keys[i]] = objects[i];
+		}
+		dictionary = [lastWins copy];
+	}
+	return dictionary;
+}
+
++ (NSDictionary *) dictionaryForObjects:(const id [])objects keys:(const id [])keysIn count:(NSUInteger)countIn {
+	if (countIn == 0) {
+		return [NSDictionary dictionary];
+	}
+	return [[self alloc] initWithObjects:objects forKeys:keysIn count:countIn];
+}
+
+/**
+ The NSDictionary primitive, so copies, decoding and [[x class] dictionaryWith...] build one of these too.  More
+ than GRJSON_COMPACT_DICTIONARY_MAX_COUNT members give a hash-table NSDictionary instead.  NSDictionary's -init
+ comes back here, so this does not call it.
+ */
+- (instancetype) initWithObjects:(const id [])objects forKeys:(const id<NSCopying> [])keysIn count:(NSUInteger)countIn {
+	if (countIn > GRJSON_COMPACT_DICTIONARY_MAX_COUNT) {
+		return (id)hashedDictionary(objects, keysIn, countIn);
+	}
+	// find the unique keys first, so the members can be allocated at exactly the right size
+	NSUInteger memberHashes[GRJSON_COMPACT_DICTIONARY_MAX_COUNT];
+	NSUInteger keyIndexes[GRJSON_COMPACT_DICTIONARY_MAX_COUNT];
+	NSUInteger valueIndexes[GRJSON_COMPACT_DICTIONARY_MAX_COUNT];
+	NSUInteger unique = 0;
+	for (NSUInteger i = 0; i < countIn; i++) {
+		id key = keysIn[i];
+		NSUInteger hash = [key hash];
+		NSUInteger existing = 0;
+		while (existing < unique && !(memberHashes[existing] == hash && [keysIn[keyIndexes[existing]] isEqual:key])) {
+			existing++;
+		}
+		if (existing == unique) {
+			memberHashes[unique] = hash;
+			keyIndexes[unique] = i;
+			unique++;
+		}
+		valueIndexes[existing] = i;
+	}
+	// calloc zeroes the slots, so ARC finds nil in them
+	keys = (__strong id *)calloc(unique, 2 * sizeof(id) + sizeof(NSUInteger));
+	if (keys == NULL && unique > 0) {
+		return nil;
+	}
+	count = unique;
+	values = keys + unique;
+	hashes = (NSUInteger *)(void *)(values + unique);
+	for (NSUInteger i = 0; i < unique; i++) {
+		// NSDictionary copies its keys; for the parser's immutable strings that is only a retain
+		keys[i] = [keysIn[keyIndexes[i]] copyWithZone:nil];
+		values[i] = objects[valueIndexes[i]];
+		hashes[i] = memberHashes[i];
+	}
+	return self;
+}
+
+- (void) dealloc {
+	for (NSUInteger i = 0; i < count; i++) {
+		keys[i] = nil;
+		values[i] = nil;
+	}
+	free(keys);
+}
+
+- (id) copyWithZone:(NSZone *)zone {
+	return self;
+}
+
+- (NSUInteger) count {
+	return count;
+}
+
+- (id) objectForKey:(id)aKey {
+	if (aKey == nil) {
+		return nil;
+	}
+	// parsed keys are interned, and so are most of the literals they get looked up with
+	for (NSUInteger i = 0; i < count; i++) {
+		if (keys[i] == aKey) {
+			return values[i];
+		}
+	}
+	NSUInteger hash = [aKey hash];
+	for (NSUInteger i = 0; i < count; i++) {
+		if (hashes[i] == hash && [keys[i] isEqual:aKey]) {
+			return values[i];
+		}
+	}
+	return nil;
+}
+
+- (NSEnumerator *) keyEnumerator {
+	return [[NSArray arrayWithObjects:keys count:count] objectEnumerator];
+}
+
+- (NSUInteger) countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id __unsafe_unretained [])buffer count:(NSUInteger)len {
+	return enumerateInPlace(state, keys, count);
+}
+
+- (void) getObjects:(id __unsafe_unretained [])objects andKeys:(id __unsafe_unretained [])keysOut count:(NSUInteger)countOut {
+	for (NSUInteger i = 0; i < MIN(count, countOut); i++) {
+		if (objects) {
+			objects[i] = values[i];
+		}
+		if (keysOut) {
+			keysOut[i] = keys[i];
+		}
+	}
+}
+
+- (void) enumerateKeysAndObjectsWithOptions:(NSEnumerationOptions)opts usingBlock:(void (^)(id key, id obj, BOOL *stop))block {
+	BOOL stop = NO;
+	for (NSUInteger i = 0; i < count && !stop; i++) {
+		block(keys[i], values[i], &stop);
+	}
+}
+
+@end
+
+@interface GRJsonCompactArray ()
+{
+	NSUInteger count;
+	__strong id *objects; ///< calloc'd, and freed by -dealloc
+}
+@end
+
+@implementation GRJsonCompactArray
+
++ (NSArray *) arrayForObjects:(const id [])objectsIn count:(NSUInteger)countIn {
+	if (countIn == 0) {
+		return [NSArray array];
+	}
+	return [[self alloc] initWithObjects:objectsIn count:countIn];
+}
+
+/**
+ The NSArray primitive, so copies, decoding and [[x class] arrayWith...] build one of these too.  NSArray's -init
+ comes back here, so this does not call it.
+ */
+- (instancetype) initWithObjects:(const id [])objectsIn count:(NSUInteger)countIn {
+	// calloc zeroes the slots, so ARC finds nil in them
+	objects = (__strong id *)calloc(countIn, sizeof(id));
+	if (objects == NULL && countIn > 0) {
+		return nil;
+	}
+	count = countIn;
+	for (NSUInteger i = 0; i < countIn; i++) {
+		objects[i] = objectsIn[i];
+	}
+	return self;
+}
+
+- (void) dealloc {
+	for (NSUInteger i = 0; i < count; i++) {
+		objects[i] = nil;
+	}
+	free(objects);
+}
+
+- (id) copyWithZone:(NSZone *)zone {
+	return self;
+}
+
+- (NSUInteger) count {
+	return count;
+}
+
+- (id) objectAtIndex:(NSUInteger)index {
+	if (index >= count) {
+		[NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %ld]", (unsigned long)index, (long)count - 1];
+	}
+	return objects[index];
+}
+
+- (void) getObjects:(id __unsafe_unretained [])objectsOut range:(NSRange)range {
+	if (range.location > count || range.length > count - range.location) {
+		[NSException raise:NSRangeException format:@"range %@ beyond bounds [0 .. %ld]", NSStringFromRange(range), (long)count - 1];
+	}
+	for (NSUInteger i = 0; i < range.length; i++) {
+		objectsOut[i] = objects[range.location + i];
+	}
+}
+
+- (NSUInteger) countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id __unsafe_unretained [])buffer count:(NSUInteger)len {
+	return enumerateInPlace(state, objects, count);
+}
+
+@end
@@ -0,0 +1,42 @@
+//
+//  GRJsonDocument.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ A parsed JSON document that creates Foundation objects only for the parts that are actually read.
+
+ The data is parsed up front into a compact tape (see GRJsonTape.h), which is roughly proportional in size
+ to the input.  rootObject is then a read-only NSDictionary or NSArray view of that tape: a child is turned
+ into an object the first time it is accessed and cached after that, and a subtree that is never touched
+ never becomes objects at all.  The views are ordinary NSDictionary and NSArray instances as far as callers
+ are concerned, so they can be handed straight to GROMapper.  null values come back as NSNull.
+
+ Each view keeps the document alive.  Like the mutable containers GRJsonParser returns, a view should only
+ be read from one thread at a time.
+ */
+@interface GRJsonDocument : NSObject
+
++ (instancetype) documentWithData:(NSData *)data error:(NSError *__autoreleasing *)error;
+
+/**
+ Parses data into a new document.  The document copies the bytes it needs, so data is not retained.
+
+ @param data the JSON to parse
+ @param error an out pointer that holds the parse error, if any
+ @return the document, or nil if data is not valid JSON
+ */
+- (instancetype) initWithData:(NSData *)data error:(NSError *__autoreleasing *)error;
+
+/** The top-level value: a lazy NSDictionary or NSArray, or an NSString, NSNumber or NSNull. */
+@property (nonatomic, readonly) id rootObject;
+
+/** The bytes used by the tape and its string buffer. */
+@property (nonatomic, readonly) NSUInteger memoryUsage;
+
+@end
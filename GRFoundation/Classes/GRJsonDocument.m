@@ -0,0 +1,329 @@
+//
+//  GRJsonDocument.m
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import "GRJsonDocument.h"
+#import "GRJson.h"
+#import "GRJsonTape.h"
+#import "Logging.h"
+
+#define LINEAR_LOOKUP_MAX_COUNT 8 ///< objects with at most this many members are searched without a hash table
+
+@interface GRJsonDocument ()
+{
+	GRJsonTape tape;
+	CFMutableDictionaryRef keyStrings; ///< string buffer offset + 1 -> NSString, shared by every view
+	__weak id root;
+}
+
+- (GRJsonTape *) tape;
+- (id) objectAtTapeIndex:(size_t)index;
+- (NSString *) keyAtTapeIndex:(size_t)index;
+
+@end
+
+#pragma mark - views
+
+@interface GRJsonLazyArray : NSArray
+{
+	GRJsonDocument *document;
+	size_t tapeIndex;
+	NSUInteger count;
+	size_t *childIndexes;  ///< tape index of each element, filled on first access
+	__strong id *children; ///< elements that have been materialized
+}
+
+- (instancetype) initWithDocument:(GRJsonDocument *)document tapeIndex:(size_t)tapeIndex;
+
+@end
+
+@interface GRJsonLazyDictionary : NSDictionary
+{
+	GRJsonDocument *document;
+	size_t tapeIndex;
+	NSUInteger count;
+	size_t *valueIndexes;           ///< tape index of each value, filled on first access
+	__strong NSString **keys;
+	__strong id *values;            ///< values that have been materialized
+	NSDictionary<NSString *, NSNumber *> *keyLookup; ///< key -> member number, for larger objects
+}
+
+- (instancetype) initWithDocument:(GRJsonDocument *)document tapeIndex:(size_t)tapeIndex;
+
+@end
+
+@implementation GRJsonLazyArray
+
+- (instancetype) initWithDocument:(GRJsonDocument *)documentIn tapeIndex:(size_t)tapeIndexIn {
+	self = [super init];
+	if (self) {
+		document = documentIn;
+		tapeIndex = tapeIndexIn;
+		count = GRJsonTapeContainerCount([documentIn tape], tapeIndexIn);
+	}
+	return self;
+}
+
+- (void) dealloc {
+	if (children) {
+		for (NSUInteger i = 0; i < count; i++) {
+			children[i] = nil;
+		}
+		free(children);
+	}
+	free(childIndexes);
+}
+
+- (id) copyWithZone:(NSZone *)zone {
+	return self;
+}
+
+- (NSUInteger) count {
+	return count;
+}
+
+- (void) loadChildIndexes {
+	const GRJsonTape *t = [document tape];
+	childIndexes = malloc(count * sizeof(size_t));
+	children = (__strong id *)calloc(count, sizeof(id));
+	size_t child = GRJsonTapeFirstChild(tapeIndex);
+	for (NSUInteger i = 0; i < count; i++) {
+		childIndexes[i] = child;
+		child = GRJsonTapeNext(t, child);
+	}
+}
+
+- (id) objectAtIndex:(NSUInteger)index {
+	if (index >= count) {
+		[NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %ld]", (unsigned long)index, (long)count - 1];
+	}
+	if (childIndexes == NULL) {
+		[self loadChildIndexes];
+	}
+	id child = children[index];
+	if (child == nil) {
+		child = [document objectAtTapeIndex:childIndexes[index]];
+		children[index] = child;
+	}
+	return child;
+}
+
+@end
+
+@implementation GRJsonLazyDictionary
+
+- (instancetype) initWithDocument:(GRJsonDocument *)documentIn tapeIndex:(size_t)tapeIndexIn {
+	self = [super init];
+	if (self) {
+		document = documentIn;
+		tapeIndex = tapeIndexIn;
+		count = GRJsonTapeContainerCount([documentIn tape], tapeIndexIn);
+	}
+	return self;
+}
+
+- (void) dealloc {
+	for (NSUInteger i = 0; keys && i < count; i++) {
+		keys[i] = nil;
+		values[i] = nil;
+	}
+	free(keys);
+	free(values);
+	free(valueIndexes);
+}
+
+- (id) copyWithZone:(NSZone *)zone {
+	return self;
+}
+
+/**
+ * Materializes the keys (but none of the values).  A key that appears more than once keeps only its last
+ * value, which is what GRJsonParser does, so the member list is compacted to unique keys here.
+ */
+- (void) loadKeys {
+	const GRJsonTape *t = [document tape];
+	NSUInteger members = count;
+	// never zero-sized, so a NULL keys always means "not loaded yet"
+	valueIndexes = malloc((members ?: 1) * sizeof(size_t));
+	keys = (__strong NSString **)calloc(members ?: 1, sizeof(NSString *));
+	values = (__strong id *)calloc(members ?: 1, sizeof(id));
+	size_t child = GRJsonTapeFirstChild(tapeIndex);
+	NSUInteger unique = 0;
+	NSMutableDictionary<NSString *, NSNumber *> *lookup = members > LINEAR_LOOKUP_MAX_COUNT ? [NSMutableDictionary dictionaryWithCapacity:members] : nil;
+	for (NSUInteger i = 0; i < members; i++) {
+		NSString *key = [document keyAtTapeIndex:child];
+		size_t valueIndex = GRJsonTapeNext(t, child);
+		child = GRJsonTapeNext(t, valueIndex);
+		NSUInteger existing = NSNotFound;
+		if (lookup) {
+			NSNumber *found = lookup[key];
+			existing = found ? found.unsignedIntegerValue : NSNotFound;
+		}
+		else {
+			for (NSUInteger j = 0; j < unique; j++) {
+				if ([keys[j] isEqualToString:key]) {
+					existing = j;
+					break;
+				}
+			}
+		}
+		if (existing != NSNotFound) {
+			valueIndexes[existing] = valueIndex;
+			continue;
+		}
+		keys[unique] = key;
+		valueIndexes[unique] = valueIndex;
+		lookup[key] = @(unique);
+		unique++;
+	}
+	count = unique;
+	keyLookup = lookup;
+}
+
+- (NSUInteger) count {
+	if (keys == NULL) {
+		[self loadKeys];
+	}
+	return count;
+}
+
+- (id) valueAtMember:(NSUInteger)member {
+	id value = values[member];
+	if (value == nil) {
+		value = [document objectAtTapeIndex:valueIndexes[member]];
+		values[member] = value;
+	}
+	return value;
+}
+
+- (id) objectForKey:(id)aKey {
+	if (![aKey isKindOfClass:[NSString class]]) {
+		return nil;
+	}
+	if (keys == NULL) {
+		[self loadKeys];
+	}
+	if (keyLookup) {
+		NSNumber *member = keyLookup[aKey];
+		return member ? [self valueAtMember:member.unsignedIntegerValue] : nil;
+	}
+	for (NSUInteger i = 0; i < count; i++) {
+		if (keys[i] == aKey || [keys[i] isEqualToString:aKey]) {
+			return [self valueAtMember:i];
+		}
+	}
+	return nil;
+}
+
+- (NSEnumerator *) keyEnumerator {
+	if (keys == NULL) {
+		[self loadKeys];
+	}
+	return [[NSArray arrayWithObjects:keys count:count] objectEnumerator];
+}
+
+@end
+
+#pragma mark - document
+
+@implementation GRJsonDocument
+
++ (instancetype) documentWithData:(NSData *)data error:(NSError *__autoreleasing *)error {
+	return [[self alloc] initWithData:data error:error];
+}
+
+- (instancetype) initWithData:(NSData *)data error:(NSError *__autoreleasing *)error {
+	self = [super init];
+	if (self) {
+		GRJsonTapeInit(&tape);
+		GRJsonTokenizer tokenizer;
+		GRJsonTokenizerInit(&tokenizer);
+		GRJsonError result = GRJsonTapeBuild(&tape, &tokenizer, (const uint8_t *)data.bytes, data.length);
+		NSString *reason = nil;
+		if (result == GRJsonErrorOutOfMemory) {
+			reason = @"out of memory";
+		}
+		else if (result != GRJsonErrorNone) {
+			reason = [NSString stringWithUTF8String:tokenizer.errorMessage] ?: @"invalid JSON";
+		}
+		GRJsonTokenizerDestroy(&tokenizer);
+		if (reason) {
+			DDLogError(@"error while parsing JSON: %@", reason);
+			if (error) {
+				*error = [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: reason}];
+			}
+			return nil;
+		}
+		keyStrings = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, &kCFTypeDictionaryValueCallBacks);
+	}
+	return self;
+}
+
+- (void) dealloc {
+	if (keyStrings) {
+		CFRelease(keyStrings);
+	}
+	GRJsonTapeDestroy(&tape);
+}
+
+- (GRJsonTape *) tape {
+	return &tape;
+}
+
+- (NSUInteger) memoryUsage {
+	return tape.capacity * sizeof(uint64_t) + tape.stringsCapacity;
+}
+
+- (id) rootObject {
+	id rootObject = root;
+	if (rootObject == nil) {
+		rootObject = [self objectAtTapeIndex:0];
+		root = rootObject;
+	}
+	return rootObject;
+}
+
+- (NSString *) stringAtTapeIndex:(size_t)index {
+	size_t length;
+	bool hasEscapes;
+	const uint8_t *bytes = GRJsonTapeStringAt(&tape, index, &length, &hasEscapes);
+	return [GRJson stringWithBytes:bytes length:length needsUnescape:hasEscapes] ?: @"";
+}
+
+/** keys that are stored once in the tape are also created once, no matter how many objects they appear in */
+- (NSString *) keyAtTapeIndex:(size_t)index {
+	const void *offsetKey = (const void *)(uintptr_t)(GRJsonTapeStringOffsetAt(&tape, index) + 1);
+	NSString *key = (__bridge NSString *)CFDictionaryGetValue(keyStrings, offsetKey);
+	if (key == nil) {
+		key = [self stringAtTapeIndex:index];
+		CFDictionarySetValue(keyStrings, offsetKey, (__bridge const void *)key);
+	}
+	return key;
+}
+
+- (id) objectAtTapeIndex:(size_t)index {
+	switch (GRJsonTapeTypeAt(&tape, index)) {
+		case GRJsonTapeObject:
+			return [[GRJsonLazyDictionary alloc] initWithDocument:self tapeIndex:index];
+		case GRJsonTapeArray:
+			return [[GRJsonLazyArray alloc] initWithDocument:self tapeIndex:index];
+		case GRJsonTapeString:
+			return [self stringAtTapeIndex:index];
+		case GRJsonTapeInteger:
+			return @(GRJsonTapeIntegerAt(&tape, index));
+		case GRJsonTapeDouble:
+			return @(GRJsonTapeDoubleAt(&tape, index));
+		case GRJsonTapeTrue:
+			return @YES;
+		case GRJsonTapeFalse:
+			return @NO;
+		default:
+			return [NSNull null];
+	}
+}
+
+@end
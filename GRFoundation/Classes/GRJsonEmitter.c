@@ -0,0 +1,429 @@
+//
+//  GRJsonEmitter.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonEmitter.h"
+#include "GRJsonCanonical.h"
+#include "GRJsonStructuralIndex.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_OBJECT 0x1
+#define FRAME_NOT_EMPTY 0x2
+
+#define SHORT_STRING_LENGTH 16 ///< strings shorter than this are escaped a byte at a time
+
+/** For each byte, 0 if it can be copied as is, 'u' if it needs \u00XX, or the character that follows the backslash */
+static const uint8_t escapes[256] = {
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+	0, 0, '"', [92] = '\\',
+};
+
+static const char hexDigits[16] = "0123456789abcdef";
+
+static const char digitPairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+#pragma mark - lifecycle
+
+void GRJsonEmitterInit(GRJsonEmitter *e) {
+	memset(e, 0, sizeof(*e));
+}
+
+void GRJsonEmitterDestroy(GRJsonEmitter *e) {
+	free(e->buf);
+	free(e->frames);
+	memset(e, 0, sizeof(*e));
+}
+
+void GRJsonEmitterReset(GRJsonEmitter *e) {
+	e->length = 0;
+	e->depth = 0;
+	e->afterKey = false;
+	e->rootDone = false;
+	e->error = GRJsonEmitterErrorNone;
+}
+
+void GRJsonEmitterSetSink(GRJsonEmitter *e, GRJsonEmitterSink sink, void *context) {
+	e->sink = sink;
+	e->sinkContext = context;
+}
+
+bool GRJsonEmitterFlush(GRJsonEmitter *e) {
+	if (e->error != GRJsonEmitterErrorNone) {
+		return false;
+	}
+	if (e->sink == NULL || e->length == 0) {
+		return true;
+	}
+	if (!e->sink(e->sinkContext, e->buf, e->length)) {
+		e->error = GRJsonEmitterErrorSink;
+		return false;
+	}
+	e->length = 0;
+	return true;
+}
+
+#pragma mark - buffer
+
+static bool grow(GRJsonEmitter *e, size_t extra) {
+	size_t capacity = e->capacity ? e->capacity : 256;
+	while (capacity < e->length + extra) {
+		capacity *= 2;
+	}
+	uint8_t *buf = realloc(e->buf, capacity);
+	if (buf == NULL) {
+		e->error = GRJsonEmitterErrorOutOfMemory;
+		return false;
+	}
+	e->buf = buf;
+	e->capacity = capacity;
+	return true;
+}
+
+static inline bool reserve(GRJsonEmitter *e, size_t extra) {
+	return e->length + extra <= e->capacity || grow(e, extra);
+}
+
+/** Called after every complete call; hands a full buffer to the sink. */
+static inline bool finishCall(GRJsonEmitter *e) {
+	if (e->sink && e->length >= GRJSON_EMITTER_FLUSH_SIZE) {
+		return GRJsonEmitterFlush(e);
+	}
+	return true;
+}
+
+#pragma mark - structure
+
+/** Writes the comma that goes before a value, if any, and checks that a value is allowed here. */
+static bool beginValue(GRJsonEmitter *e) {
+	if (e->error != GRJsonEmitterErrorNone) {
+		return false;
+	}
+	if (e->depth == 0) {
+		if (e->rootDone) {
+			e->error = GRJsonEmitterErrorMisplaced;
+			return false;
+		}
+		return true;
+	}
+	uint8_t *frame = &e->frames[e->depth - 1];
+	if (*frame & FRAME_OBJECT) {
+		if (!e->afterKey) {
+			e->error = GRJsonEmitterErrorMisplaced;
+			return false;
+		}
+		e->afterKey = false;
+		return true;
+	}
+	if (*frame & FRAME_NOT_EMPTY) {
+		if (!reserve(e, 1)) {
+			return false;
+		}
+		e->buf[e->length++] = ',';
+	}
+	*frame |= FRAME_NOT_EMPTY;
+	return true;
+}
+
+static inline void endValue(GRJsonEmitter *e) {
+	if (e->depth == 0) {
+		e->rootDone = true;
+	}
+}
+
+static bool beginContainer(GRJsonEmitter *e, uint8_t open, uint8_t frame) {
+	if (!beginValue(e)) {
+		return false;
+	}
+	if (e->depth == e->framesCapacity) {
+		size_t capacity = e->framesCapacity ? e->framesCapacity * 2 : 32;
+		uint8_t *frames = realloc(e->frames, capacity);
+		if (frames == NULL) {
+			e->error = GRJsonEmitterErrorOutOfMemory;
+			return false;
+		}
+		e->frames = frames;
+		e->framesCapacity = capacity;
+	}
+	if (!reserve(e, 1)) {
+		return false;
+	}
+	e->frames[e->depth++] = frame;
+	e->buf[e->length++] = open;
+	return finishCall(e);
+}
+
+static bool endContainer(GRJsonEmitter *e, uint8_t close, bool isObject) {
+	if (e->error != GRJsonEmitterErrorNone) {
+		return false;
+	}
+	if (e->depth == 0 || e->afterKey || ((e->frames[e->depth - 1] & FRAME_OBJECT) != 0) != isObject) {
+		e->error = GRJsonEmitterErrorMisplaced;
+		return false;
+	}
+	if (!reserve(e, 1)) {
+		return false;
+	}
+	e->depth--;
+	e->buf[e->length++] = close;
+	endValue(e);
+	return finishCall(e);
+}
+
+bool GRJsonEmitterBeginObject(GRJsonEmitter *e) {
+	return beginContainer(e, '{', FRAME_OBJECT);
+}
+
+bool GRJsonEmitterEndObject(GRJsonEmitter *e) {
+	return endContainer(e, '}', true);
+}
+
+bool GRJsonEmitterBeginArray(GRJsonEmitter *e) {
+	return beginContainer(e, '[', 0);
+}
+
+bool GRJsonEmitterEndArray(GRJsonEmitter *e) {
+	return endContainer(e, ']', false);
+}
+
+#pragma mark - strings
+
+static inline void putEscape(GRJsonEmitter *e, uint8_t c) {
+	uint8_t escape = escapes[c];
+	uint8_t *out = e->buf + e->length;
+	out[0] = '\\';
+	if (escape == 'u') {
+		out[1] = 'u';
+		out[2] = '0';
+		out[3] = '0';
+		out[4] = (uint8_t)hexDigits[c >> 4];
+		out[5] = (uint8_t)hexDigits[c & 0xF];
+		e->length += 6;
+	}
+	else {
+		out[1] = escape;
+		e->length += 2;
+	}
+}
+
+/**
+ * Writes bytes as a quoted string.  Room for the string plus its quotes is reserved up front, and each
+ * escape reserves the five extra bytes it can take, so the common case of a string with nothing to escape
+ * is one reserve, one scan and one memcpy.
+ */
+static bool putString(GRJsonEmitter *e, const uint8_t *bytes, size_t length) {
+	if (!reserve(e, length + 2)) {
+		return false;
+	}
+	e->buf[e->length++] = '"';
+	size_t pos = 0;
+	if (length < SHORT_STRING_LENGTH) {
+		for (; pos < length; pos++) {
+			uint8_t c = bytes[pos];
+			if (escapes[c] == 0) {
+				e->buf[e->length++] = c;
+				continue;
+			}
+			if (!reserve(e, 6 + (length - pos))) {
+				return false;
+			}
+			putEscape(e, c);
+		}
+	}
+	else {
+		GRJsonStructuralIndex idx;
+		GRJsonStructuralIndexInit(&idx, bytes, length);
+		while (pos < length) {
+			size_t special = GRJsonStructuralIndexNextStringSpecial(&idx, pos);
+			memcpy(e->buf + e->length, bytes + pos, special - pos);
+			e->length += special - pos;
+			if (special == length) {
+				break;
+			}
+			if (!reserve(e, 6 + (length - special))) {
+				return false;
+			}
+			putEscape(e, bytes[special]);
+			pos = special + 1;
+		}
+	}
+	e->buf[e->length++] = '"';
+	return true;
+}
+
+bool GRJsonEmitterKey(GRJsonEmitter *e, const uint8_t *bytes, size_t length) {
+	if (e->error != GRJsonEmitterErrorNone) {
+		return false;
+	}
+	if (e->depth == 0 || e->afterKey || (e->frames[e->depth - 1] & FRAME_OBJECT) == 0) {
+		e->error = GRJsonEmitterErrorMisplaced;
+		return false;
+	}
+	uint8_t *frame = &e->frames[e->depth - 1];
+	if (!reserve(e, length + 4)) {
+		return false;
+	}
+	if (*frame & FRAME_NOT_EMPTY) {
+		e->buf[e->length++] = ',';
+	}
+	*frame |= FRAME_NOT_EMPTY;
+	if (!putString(e, bytes, length) || !reserve(e, 1)) {
+		return false;
+	}
+	e->buf[e->length++] = ':';
+	e->afterKey = true;
+	return true;
+}
+
+bool GRJsonEmitterString(GRJsonEmitter *e, const uint8_t *bytes, size_t length) {
+	if (!beginValue(e) || !putString(e, bytes, length)) {
+		return false;
+	}
+	endValue(e);
+	return finishCall(e);
+}
+
+#pragma mark - numbers
+
+/** Writes the digits of value two at a time from the end of a 20-byte scratch area, returning where they start. */
+static inline char *formatDigits(uint64_t value, char *end) {
+	char *p = end;
+	while (value >= 100) {
+		unsigned pair = (unsigned)(value % 100) * 2;
+		value /= 100;
+		*--p = digitPairs[pair + 1];
+		*--p = digitPairs[pair];
+	}
+	if (value >= 10) {
+		unsigned pair = (unsigned)value * 2;
+		*--p = digitPairs[pair + 1];
+		*--p = digitPairs[pair];
+	}
+	else {
+		*--p = (char)('0' + value);
+	}
+	return p;
+}
+
+static bool putDigits(GRJsonEmitter *e, uint64_t magnitude, bool negative) {
+	char scratch[21];
+	char *end = scratch + sizeof(scratch);
+	char *start = formatDigits(magnitude, end);
+	if (negative) {
+		*--start = '-';
+	}
+	size_t count = (size_t)(end - start);
+	if (!reserve(e, count)) {
+		return false;
+	}
+	memcpy(e->buf + e->length, start, count);
+	e->length += count;
+	return true;
+}
+
+bool GRJsonEmitterInteger(GRJsonEmitter *e, int64_t value) {
+	// negate in unsigned arithmetic so INT64_MIN works
+	uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+	if (!beginValue(e) || !putDigits(e, magnitude, value < 0)) {
+		return false;
+	}
+	endValue(e);
+	return finishCall(e);
+}
+
+bool GRJsonEmitterUnsignedInteger(GRJsonEmitter *e, uint64_t value) {
+	if (!beginValue(e) || !putDigits(e, value, false)) {
+		return false;
+	}
+	endValue(e);
+	return finishCall(e);
+}
+
+bool GRJsonEmitterDouble(GRJsonEmitter *e, double value) {
+	if (e->error != GRJsonEmitterErrorNone) {
+		return false;
+	}
+	if (!isfinite(value)) {
+		e->error = GRJsonEmitterErrorNonFinite;
+		return false;
+	}
+	if (value == 0 && signbit(value)) {
+		// "-0" would read back as the integer 0
+		if (!beginValue(e) || !reserve(e, 4)) {
+			return false;
+		}
+		memcpy(e->buf + e->length, "-0.0", 4);
+		e->length += 4;
+		endValue(e);
+		return finishCall(e);
+	}
+	if (value == floor(value) && fabs(value) < 9007199254740992.0) {
+		return GRJsonEmitterInteger(e, (int64_t)value);
+	}
+	if (!beginValue(e)) {
+		return false;
+	}
+	char scratch[GRJSON_CANONICAL_NUMBER_SIZE];
+	size_t length = GRJsonCanonicalFormatNumber(value, scratch);
+	if (!reserve(e, length)) {
+		return false;
+	}
+	memcpy(e->buf + e->length, scratch, length);
+	e->length += length;
+	endValue(e);
+	return finishCall(e);
+}
+
+#pragma mark - literals
+
+static bool putLiteral(GRJsonEmitter *e, const char *literal, size_t length) {
+	if (!beginValue(e) || !reserve(e, length)) {
+		return false;
+	}
+	memcpy(e->buf + e->length, literal, length);
+	e->length += length;
+	endValue(e);
+	return finishCall(e);
+}
+
+bool GRJsonEmitterBool(GRJsonEmitter *e, bool value) {
+	return value ? putLiteral(e, "true", 4) : putLiteral(e, "false", 5);
+}
+
+bool GRJsonEmitterNull(GRJsonEmitter *e) {
+	return putLiteral(e, "null", 4);
+}
+
+bool GRJsonEmitterRawValue(GRJsonEmitter *e, const uint8_t *bytes, size_t length) {
+	if (e->sink && length >= GRJSON_EMITTER_FLUSH_SIZE) {
+		// a long span goes straight to the sink rather than through the buffer
+		if (!beginValue(e) || !GRJsonEmitterFlush(e)) {
+			return false;
+		}
+		if (!e->sink(e->sinkContext, bytes, length)) {
+			e->error = GRJsonEmitterErrorSink;
+			return false;
+		}
+		endValue(e);
+		return true;
+	}
+	return putLiteral(e, (const char *)bytes, length);
+}
@@ -0,0 +1,110 @@
+//
+//  GRJsonEmitter.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonEmitter_h
+#define GRJsonEmitter_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum GRJsonEmitterError {
+	GRJsonEmitterErrorNone = 0,
+	GRJsonEmitterErrorOutOfMemory,
+	GRJsonEmitterErrorMisplaced, ///< a key outside an object, a value where a key belongs, an unbalanced end, a second root
+	GRJsonEmitterErrorNonFinite, ///< NaN and the infinities have no JSON spelling
+	GRJsonEmitterErrorSink,      ///< the sink refused the output
+} GRJsonEmitterError;
+
+/**
+ * Receives output as it is produced.  Return false to stop the emitter; every call after that fails
+ * with GRJsonEmitterErrorSink.
+ */
+typedef bool (*GRJsonEmitterSink)(void *context, const uint8_t *bytes, size_t length);
+
+#define GRJSON_EMITTER_FLUSH_SIZE (64 * 1024) ///< with a sink, output is handed over in chunks of about this size
+
+/**
+ * A streaming JSON writer.  Values go straight into a growable byte buffer as they are emitted, with
+ * commas and colons placed automatically from a small container stack, so nothing is ever built up as a
+ * tree first.  With a sink attached, the buffer is handed to the sink whenever it passes
+ * GRJSON_EMITTER_FLUSH_SIZE and then reused, so memory stays flat however much is written.
+ *
+ * Strings are escaped by finding quotes, backslashes and control characters 64 bytes at a time with the
+ * structural classifier (see GRJsonStructuralIndex.h) and copying the clean runs between them.  Strings
+ * must be valid UTF-8; nothing but those characters is escaped.
+ *
+ * Errors are sticky: once a call fails, the error stays in error and every later call returns false.
+ * Treat the fields as private.
+ */
+typedef struct GRJsonEmitter {
+	uint8_t *buf;
+	size_t length;
+	size_t capacity;
+	uint8_t *frames; ///< one per open container, see the FRAME_ flags in the implementation
+	size_t depth;
+	size_t framesCapacity;
+	bool afterKey;   ///< a key was written and its value is next
+	bool rootDone;
+	GRJsonEmitterError error;
+	GRJsonEmitterSink sink;
+	void *sinkContext;
+} GRJsonEmitter;
+
+void GRJsonEmitterInit(GRJsonEmitter *e);
+void GRJsonEmitterDestroy(GRJsonEmitter *e);
+
+/** Starts a new document, keeping any memory that was already allocated. */
+void GRJsonEmitterReset(GRJsonEmitter *e);
+
+/** Sends output to sink instead of keeping all of it in the buffer.  Pass NULL to keep everything. */
+void GRJsonEmitterSetSink(GRJsonEmitter *e, GRJsonEmitterSink sink, void *context);
+
+/** Hands everything that is buffered to the sink.  Without a sink this does nothing. */
+bool GRJsonEmitterFlush(GRJsonEmitter *e);
+
+/** True once a complete top-level value has been written. */
+static inline bool GRJsonEmitterIsComplete(const GRJsonEmitter *e) {
+	return e->rootDone && e->error == GRJsonEmitterErrorNone;
+}
+
+bool GRJsonEmitterBeginObject(GRJsonEmitter *e);
+bool GRJsonEmitterEndObject(GRJsonEmitter *e);
+bool GRJsonEmitterBeginArray(GRJsonEmitter *e);
+bool GRJsonEmitterEndArray(GRJsonEmitter *e);
+
+/** Writes a member name, escaping it.  Only valid inside an object, before each value. */
+bool GRJsonEmitterKey(GRJsonEmitter *e, const uint8_t *bytes, size_t length);
+
+bool GRJsonEmitterString(GRJsonEmitter *e, const uint8_t *bytes, size_t length);
+bool GRJsonEmitterInteger(GRJsonEmitter *e, int64_t value);
+bool GRJsonEmitterUnsignedInteger(GRJsonEmitter *e, uint64_t value);
+
+/**
+ * Writes the shortest decimal that reads back as exactly value, independent of the current locale, spelled
+ * as GRJsonCanonicalFormatNumber spells it.  Integral values below 2^53 are written as integers.
+ */
+bool GRJsonEmitterDouble(GRJsonEmitter *e, double value);
+bool GRJsonEmitterBool(GRJsonEmitter *e, bool value);
+bool GRJsonEmitterNull(GRJsonEmitter *e);
+
+/**
+ * Writes text that is already a complete JSON value, such as a span copied out of another document, as
+ * is.  It is not checked, so it must be valid JSON.
+ */
+bool GRJsonEmitterRawValue(GRJsonEmitter *e, const uint8_t *bytes, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonEmitter_h */
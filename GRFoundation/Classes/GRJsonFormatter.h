@@ -0,0 +1,67 @@
+//
+//  GRJsonFormatter.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "GRJsonTranscoder.h"
+
+/**
+ Minifies or pretty-prints JSON without parsing it.  Only the whitespace between tokens is rewritten:
+ strings, numbers and literals are copied through byte for byte, a 64-byte block at a time, so the output
+ has exactly the input's values and member order.  See GRJsonTranscoder.h for the details.
+
+ The input is not validated, beyond unterminated strings and (when pretty-printing) unbalanced brackets;
+ use +[GRJson validateData:error:] first if it may not be valid JSON.
+
+ For documents that do not fit in memory, feed the input in pieces with -feed:error: to a formatter with an
+ output stream, or use +formatStream:toStream:style:error:.  Memory use is then constant.
+ */
+@interface GRJsonFormatter : NSObject
+
+/** The document without any whitespace outside of strings. */
++ (NSData *) minifiedDataWithData:(NSData *)json error:(NSError *__autoreleasing *)error;
+
+/** The document with one member or element per line, indented by 2 spaces per level. */
++ (NSData *) prettyPrintedDataWithData:(NSData *)json error:(NSError *__autoreleasing *)error;
+
+/**
+ Reformats everything that can be read from input into output, 64KB at a time.  input is opened if it is not
+ open already, and closed; output must already be open.
+
+ @return YES if the whole document was read and written
+ */
++ (BOOL) formatStream:(NSInputStream *)input toStream:(NSOutputStream *)output style:(GRJsonTranscodeStyle)style error:(NSError *__autoreleasing *)error;
+
+/**
+ A formatter that keeps its output, for -data.
+
+ @param style minify or pretty-print
+ @param indentWidth the spaces per level when pretty-printing
+ */
+- (instancetype) initWithStyle:(GRJsonTranscodeStyle)style indentWidth:(NSUInteger)indentWidth;
+
+/** A formatter that sends its output to stream in chunks of about 64KB.  The stream must already be open. */
+- (instancetype) initWithStyle:(GRJsonTranscodeStyle)style indentWidth:(NSUInteger)indentWidth outputStream:(NSOutputStream *)stream;
+
+/** Everything written so far, for a formatter without a stream. */
+@property (nonatomic, readonly) NSData *data;
+
+/**
+ Reformats the next piece of the document.  Pieces may be split anywhere, even inside a string or an escape.
+
+ @return NO if the input is known to be malformed or the output could not be written
+ */
+- (BOOL) feed:(NSData *)chunk error:(NSError *__autoreleasing *)error;
+
+/**
+ Checks that the document ended cleanly and flushes the rest of the output to the stream.
+
+ @return YES if the whole document was reformatted
+ */
+- (BOOL) finish:(NSError *__autoreleasing *)error;
+
+@end
@@ -0,0 +1,139 @@
+//
+//  GRJsonFormatter.m
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import "GRJsonFormatter.h"
+#import "JsonSupport.h"
+
+#define STREAM_CHUNK_SIZE (64 * 1024)
+
+@interface GRJsonFormatter ()
+{
+	GRJsonTranscoder transcoder;
+	NSOutputStream *stream;
+}
+
+@end
+
+@implementation GRJsonFormatter
+
++ (NSData *) formatData:(NSData *)json style:(GRJsonTranscodeStyle)style error:(NSError *__autoreleasing *)error {
+	GRJsonFormatter *formatter = [[self alloc] initWithStyle:style indentWidth:2];
+	if (![formatter feed:json error:error] || ![formatter finish:error]) {
+		return nil;
+	}
+	return formatter.data;
+}
+
++ (NSData *) minifiedDataWithData:(NSData *)json error:(NSError *__autoreleasing *)error {
+	return [self formatData:json style:GRJsonTranscodeMinify error:error];
+}
+
++ (NSData *) prettyPrintedDataWithData:(NSData *)json error:(NSError *__autoreleasing *)error {
+	return [self formatData:json style:GRJsonTranscodePretty error:error];
+}
+
++ (BOOL) formatStream:(NSInputStream *)input toStream:(NSOutputStream *)output style:(GRJsonTranscodeStyle)style error:(NSError *__autoreleasing *)error {
+	GRJsonFormatter *formatter = [[self alloc] initWithStyle:style indentWidth:2 outputStream:output];
+	uint8_t *chunk = malloc(STREAM_CHUNK_SIZE);
+	if (chunk == NULL) {
+		if (error) {
+			*error = GRJsonErrorWithReason(@"GRJsonWriter", @"out of memory");
+		}
+		return NO;
+	}
+	if (input.streamStatus == NSStreamStatusNotOpen) {
+		[input open];
+	}
+	BOOL succeeded = YES;
+	while (succeeded) {
+		NSInteger bytesRead = [input read:chunk maxLength:STREAM_CHUNK_SIZE];
+		if (bytesRead < 0) {
+			if (error) {
+				*error = input.streamError ?: GRJsonErrorWithReason(@"GRJsonWriter", @"could not read the input");
+			}
+			succeeded = NO;
+		}
+		else if (bytesRead == 0) {
+			succeeded = [formatter finish:error];
+			break;
+		}
+		else {
+			succeeded = [formatter feed:[NSData dataWithBytesNoCopy:chunk length:(NSUInteger)bytesRead freeWhenDone:NO] error:error];
+		}
+	}
+	[input close];
+	free(chunk);
+	return succeeded;
+}
+
+- (instancetype) initWithStyle:(GRJsonTranscodeStyle)style indentWidth:(NSUInteger)indentWidth {
+	self = [super init];
+	if (self) {
+		GRJsonTranscoderInit(&transcoder, style, indentWidth);
+	}
+	return self;
+}
+
+- (instancetype) initWithStyle:(GRJsonTranscodeStyle)style indentWidth:(NSUInteger)indentWidth outputStream:(NSOutputStream *)streamIn {
+	self = [self initWithStyle:style indentWidth:indentWidth];
+	if (self) {
+		stream = streamIn;
+		GRJsonTranscoderSetSink(&transcoder, GRJsonWriteToStream, (__bridge void *)stream);
+	}
+	return self;
+}
+
+- (void) dealloc {
+	GRJsonTranscoderDestroy(&transcoder);
+}
+
+- (NSData *) data {
+	return [NSData dataWithBytes:transcoder.buf length:transcoder.length];
+}
+
+#pragma mark - errors
+
+- (BOOL) check:(bool)succeeded error:(NSError *__autoreleasing *)error {
+	if (succeeded) {
+		return YES;
+	}
+	if (error) {
+		NSString *reason = nil;
+		switch (transcoder.error) {
+			case GRJsonTranscoderErrorOutOfMemory:
+				reason = @"out of memory";
+				break;
+			case GRJsonTranscoderErrorUnbalanced:
+				reason = @"the brackets in the JSON are unbalanced";
+				break;
+			case GRJsonTranscoderErrorUnterminated:
+				reason = @"the JSON ends inside a string";
+				break;
+			case GRJsonTranscoderErrorSink:
+				reason = [NSString stringWithFormat:@"could not write to the stream: %@", stream.streamError.localizedDescription ?: @"unknown error"];
+				break;
+			case GRJsonTranscoderErrorNone:
+				reason = @"could not reformat the JSON";
+				break;
+		}
+		*error = GRJsonErrorWithReason(@"GRJsonWriter", reason);
+	}
+	return NO;
+}
+
+#pragma mark - input
+
+- (BOOL) feed:(NSData *)chunk error:(NSError *__autoreleasing *)error {
+	return [self check:GRJsonTranscoderFeed(&transcoder, (const uint8_t *)chunk.bytes, chunk.length) error:error];
+}
+
+- (BOOL) finish:(NSError *__autoreleasing *)error {
+	return [self check:GRJsonTranscoderFinish(&transcoder) error:error];
+}
+
+@end
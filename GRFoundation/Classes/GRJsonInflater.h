@@ -0,0 +1,55 @@
+//
+//  GRJsonInflater.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "GRJson.h"
+
+/**
+ Parses compressed JSON without ever holding the whole document, compressed or not.
+
+ The input is read and inflated with zlib one chunk at a time on a private serial queue, and each inflated
+ chunk is handed to a push-mode GRJson (see -[GRJson feed:error:]) on a second serial queue, so that
+ decompression and tokenizing run at the same time.  At most maxPendingChunks inflated chunks are waiting
+ to be tokenized at any moment, which keeps memory bounded by a few chunks no matter how large the file is.
+
+ gzip (RFC 1952, including files made of several concatenated members), zlib (RFC 1950) and raw deflate
+ (RFC 1951) input are all recognized from their first bytes.  The delegate receives its events on the
+ tokenizing queue, one at a time and in document order.  The parse methods block until the document has
+ been parsed.
+ */
+@interface GRJsonInflater : NSObject
+
+- (instancetype) initWithDelegate:(id<GRJsonDelegate>)delegate;
+
+@property (nonatomic, weak) id<GRJsonDelegate> delegate;
+
+/** The size of the compressed reads and of the inflated chunks.  Defaults to 64 KB. */
+@property (nonatomic) NSUInteger chunkSize;
+
+/** How many inflated chunks may be waiting for the tokenizer before inflating pauses.  Defaults to 4. */
+@property (nonatomic) NSUInteger maxPendingChunks;
+
+/** How deeply objects and arrays may nest, as for -[GRJson maxDepth].  Defaults to GRJSON_DEFAULT_MAX_DEPTH. */
+@property (nonatomic) NSUInteger maxDepth;
+
+/**
+ Parses the compressed document read from stream, which is opened (if it is not open already) and closed.
+
+ @param stream the compressed bytes
+ @param error an out pointer that holds a read, decompression or parse error
+ @return YES if the stream held one complete, valid JSON document
+ */
+- (BOOL) parseStream:(NSInputStream *)stream error:(NSError *__autoreleasing *)error;
+
+/** Same as -parseStream:error:, reading the file at path. */
+- (BOOL) parseFileAtPath:(NSString *)path error:(NSError *__autoreleasing *)error;
+
+/** Same as -parseStream:error:, for compressed bytes that are already in memory. */
+- (BOOL) parseData:(NSData *)data error:(NSError *__autoreleasing *)error;
+
+@end
@@ -0,0 +1,226 @@
+//
+//  GRJsonInflater.m
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import "GRJsonInflater.h"
+#import "JsonSupport.h"
+
+#include <zlib.h>
+
+#define DEFAULT_CHUNK_SIZE (64 * 1024)
+#define DEFAULT_MAX_PENDING_CHUNKS 4
+#define MIN_CHUNK_SIZE 256
+
+/**
+ * The windowBits for inflateInit2 that matches the first bytes of the input: gzip starts with 1f 8b, and a
+ * zlib header is a deflate method nibble followed by a check byte that makes the pair a multiple of 31.
+ * Anything else is taken to be raw deflate.  With fewer than two bytes to go on, zlib is left to tell gzip
+ * and zlib apart itself.
+ */
+static int windowBitsForHeader(const uint8_t *bytes, size_t length) {
+	if (length < 2) {
+		return MAX_WBITS + 32;
+	}
+	if (bytes[0] == 0x1f && bytes[1] == 0x8b) {
+		return MAX_WBITS + 16;
+	}
+	if ((bytes[0] & 0x0f) == Z_DEFLATED && ((bytes[0] << 8) | bytes[1]) % 31 == 0) {
+		return MAX_WBITS;
+	}
+	return -MAX_WBITS;
+}
+
+@implementation GRJsonInflater
+
+@synthesize delegate, chunkSize, maxPendingChunks, maxDepth;
+
+- (instancetype) initWithDelegate:(id<GRJsonDelegate>)delegateIn {
+	self = [super init];
+	if (self) {
+		delegate = delegateIn;
+		chunkSize = DEFAULT_CHUNK_SIZE;
+		maxPendingChunks = DEFAULT_MAX_PENDING_CHUNKS;
+		maxDepth = GRJSON_DEFAULT_MAX_DEPTH;
+	}
+	return self;
+}
+
+- (BOOL) parseFileAtPath:(NSString *)path error:(NSError *__autoreleasing *)error {
+	NSInputStream *stream = [NSInputStream inputStreamWithFileAtPath:path];
+	if (stream == nil) {
+		if (error) {
+			*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOENT userInfo:@{NSFilePathErrorKey: path ?: @""}];
+		}
+		return NO;
+	}
+	return [self parseStream:stream error:error];
+}
+
+- (BOOL) parseData:(NSData *)data error:(NSError *__autoreleasing *)error {
+	return [self parseStream:[NSInputStream inputStreamWithData:data ?: [NSData data]] error:error];
+}
+
+- (BOOL) parseStream:(NSInputStream *)stream error:(NSError *__autoreleasing *)errorOut {
+	size_t chunk = MAX(chunkSize, MIN_CHUNK_SIZE);
+	GRJson *json = [[GRJson alloc] initWithDelegate:delegate];
+	json.maxDepth = maxDepth;
+	dispatch_queue_t inflateQueue = dispatch_queue_create("net.mr-r.GRJsonInflater.inflate", DISPATCH_QUEUE_SERIAL);
+	dispatch_queue_t parseQueue = dispatch_queue_create("net.mr-r.GRJsonInflater.parse", DISPATCH_QUEUE_SERIAL);
+	// one token per chunk that may be inflated ahead of the tokenizer
+	dispatch_semaphore_t slots = dispatch_semaphore_create((long)MAX(maxPendingChunks, 1));
+	dispatch_group_t group = dispatch_group_create();
+	__block NSError *inflateFailure = nil; ///< only touched on the inflate queue
+	__block NSError *parseFailure = nil;   ///< only touched on the parse queue
+	__block int parseFailed = 0;           ///< read by the inflate queue to stop early
+
+	BOOL (^deliver)(NSData *) = ^BOOL(NSData *inflated) {
+		dispatch_semaphore_wait(slots, DISPATCH_TIME_FOREVER);
+		dispatch_group_async(group, parseQueue, ^{
+			if (!__atomic_load_n(&parseFailed, __ATOMIC_ACQUIRE)) {
+				NSError *feedError = nil;
+				if (![json feed:inflated error:&feedError]) {
+					parseFailure = feedError;
+					__atomic_store_n(&parseFailed, 1, __ATOMIC_RELEASE);
+				}
+			}
+			dispatch_semaphore_signal(slots);
+		});
+		return !__atomic_load_n(&parseFailed, __ATOMIC_ACQUIRE);
+	};
+
+	dispatch_group_async(group, inflateQueue, ^{
+		inflateFailure = [self inflateStream:stream chunkSize:chunk deliver:deliver];
+		if (inflateFailure == nil) {
+			dispatch_group_async(group, parseQueue, ^{
+				NSError *finishError = nil;
+				if (!__atomic_load_n(&parseFailed, __ATOMIC_ACQUIRE) && ![json finish:&finishError]) {
+					parseFailure = finishError;
+					__atomic_store_n(&parseFailed, 1, __ATOMIC_RELEASE);
+				}
+			});
+		}
+	});
+	dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+	// a parse error stops the inflating, so it is the one that explains what went wrong
+	NSError *failure = parseFailure ?: inflateFailure;
+	if (failure) {
+		if (errorOut) {
+			*errorOut = failure;
+		}
+		return NO;
+	}
+	return YES;
+}
+
+/**
+ * Reads and inflates the whole stream, handing over each chunk as soon as it is full (and the last one,
+ * partly full, at the end).  Stops as soon as deliver returns NO.
+ *
+ * @return the read or decompression error, or nil
+ */
+- (NSError *) inflateStream:(NSInputStream *)stream chunkSize:(size_t)chunk deliver:(BOOL (^)(NSData *))deliver {
+	z_stream z;
+	memset(&z, 0, sizeof(z));
+	uint8_t *input = malloc(chunk);
+	uint8_t *output = malloc(chunk);
+	if (input == NULL || output == NULL) {
+		free(input);
+		free(output);
+		return GRJsonErrorWithReason(@"GRJsonParser", @"out of memory");
+	}
+	z.next_out = output;
+	z.avail_out = (uInt)chunk;
+	if (stream.streamStatus == NSStreamStatusNotOpen) {
+		[stream open];
+	}
+	NSError *failure = nil;
+	BOOL initialized = NO;
+	BOOL multiMember = NO;  ///< gzip, where another member may follow the end of one
+	BOOL memberEnded = NO;
+	BOOL inputDone = NO;
+	BOOL stopped = NO;
+	while (failure == nil && !stopped) {
+		// the format is told from the first two bytes, so a stream that starts with a one-byte read needs another
+		if ((z.avail_in == 0 || (!initialized && z.avail_in < 2)) && !inputDone) {
+			size_t kept = z.avail_in;
+			if (kept > 0) {
+				memmove(input, z.next_in, kept);
+			}
+			NSInteger bytesRead = [stream read:input + kept maxLength:chunk - kept];
+			if (bytesRead < 0) {
+				failure = stream.streamError ?: GRJsonErrorWithReason(@"GRJsonParser", @"could not read the compressed input");
+				break;
+			}
+			inputDone = (bytesRead == 0);
+			z.next_in = input;
+			z.avail_in = (uInt)(kept + bytesRead);
+		}
+		if (!initialized && z.avail_in < 2 && !inputDone) {
+			continue;
+		}
+		if (z.avail_in == 0) {
+			if (inputDone) {
+				if (initialized && !memberEnded) {
+					failure = GRJsonErrorWithReason(@"GRJsonParser", @"the compressed input is truncated");
+				}
+				break;
+			}
+			continue;
+		}
+		if (!initialized) {
+			int windowBits = windowBitsForHeader(z.next_in, z.avail_in);
+			if (inflateInit2(&z, windowBits) != Z_OK) {
+				failure = GRJsonErrorWithReason(@"GRJsonParser", [NSString stringWithFormat:@"could not start inflating: %s", z.msg ?: "out of memory"]);
+				break;
+			}
+			initialized = YES;
+			multiMember = windowBits > MAX_WBITS;
+		}
+		else if (memberEnded) {
+			if (!multiMember) {
+				failure = GRJsonErrorWithReason(@"GRJsonParser", @"unexpected data after the end of the compressed stream");
+				break;
+			}
+			inflateReset(&z);
+			memberEnded = NO;
+		}
+		int status = inflate(&z, Z_NO_FLUSH);
+		if (status == Z_STREAM_END) {
+			memberEnded = YES;
+		}
+		else if (status != Z_OK && status != Z_BUF_ERROR) {
+			failure = GRJsonErrorWithReason(@"GRJsonParser", [NSString stringWithFormat:@"could not inflate the input: %s", z.msg ?: "invalid data"]);
+			break;
+		}
+		if (z.avail_out == 0) {
+			stopped = !deliver([NSData dataWithBytesNoCopy:output length:chunk freeWhenDone:YES]);
+			output = malloc(chunk);
+			if (output == NULL) {
+				failure = GRJsonErrorWithReason(@"GRJsonParser", @"out of memory");
+				break;
+			}
+			z.next_out = output;
+			z.avail_out = (uInt)chunk;
+		}
+	}
+	size_t pending = output ? chunk - z.avail_out : 0;
+	if (failure == nil && !stopped && pending > 0) {
+		deliver([NSData dataWithBytesNoCopy:output length:pending freeWhenDone:YES]);
+	}
+	else {
+		free(output);
+	}
+	if (initialized) {
+		inflateEnd(&z);
+	}
+	free(input);
+	[stream close];
+	return failure;
+}
+
+@end
@@ -0,0 +1,51 @@
+//
+//  GRJsonNumber.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonNumber_h
+#define GRJsonNumber_h
+
+#include <locale.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#if defined(__APPLE__)
+#include <xlocale.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum GRJsonNumberKind {
+	GRJsonNumberInvalid = 0,
+	GRJsonNumberInteger, ///< no fraction or exponent, and fits in an int64_t
+	GRJsonNumberDouble,
+} GRJsonNumberKind;
+
+/**
+ * Decodes the text of a JSON number without allocating and independent of the current locale.
+ *
+ * Integers that fit in an int64_t come back as GRJsonNumberInteger (with *doubleOut set as well).
+ * Everything else is converted to the correctly rounded double, bit-for-bit what strtod would return:
+ * Clinger's fast path handles short mantissas with small exponents, the Eisel-Lemire algorithm handles
+ * almost everything else, and the rare leftovers (more than 19 significant digits, exact ties, subnormals)
+ * go to strtod in the C locale.
+ *
+ * GRJsonNumberInvalid means the text is not a JSON number or, for a leftover longer than 63 bytes, that there
+ * was no memory to copy it for strtod; either way *doubleOut is not a value to use.
+ */
+GRJsonNumberKind GRJsonParseNumber(const uint8_t *bytes, size_t length, int64_t *integerOut, double *doubleOut);
+
+/** The C locale, created on first use, for converting numbers the same way whatever the user's locale. */
+locale_t GRJsonCLocale(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonNumber_h */
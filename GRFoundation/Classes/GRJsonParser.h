@@ -7,18 +7,137 @@
 //
 
 #import <Foundation/Foundation.h>
+#import "GRJsonSelection.h"
 
 
+/** In the userInfo of an error from +JSONObjectsFromJSONLinesData:error:, the index of the record that failed. */
+extern NSString * const GRJsonParserRecordIndexKey;
+
+typedef NS_OPTIONS(NSUInteger, GRJsonFileOptions) {
+	GRJsonFileOptionsNone = 0,
+	/**
+	 Long ASCII strings without escapes are not copied: they point straight into the mapped file, and each
+	 one keeps the mapping alive for as long as it exists.  Saves memory for string-heavy files, at the cost
+	 of the whole mapping staying around while any of those strings does.
+	 */
+	GRJsonFileOptionsNoCopyStrings = 1 << 0,
+};
+
 typedef NS_ENUM(NSInteger, GRJsonParserState) {
 	GRJPSRoot,
 	GRJPSInObject,
 	GRJPSInArray,
 };
 
+/**
+ Builds NSDictionary / NSArray / NSString / NSNumber / NSNull trees from JSON.
+
+ A parser can be used for any number of documents, one at a time, and is cheapest that way: its tokenizer,
+ key intern table and stacks are kept from one document to the next.  The class methods use one such parser
+ per thread.  Open containers are tracked in a C array and their members on a stack of object slots, and
+ each array or object is created in one call, immutable and at its final size, when it closes: objects with
+ up to GRJSON_COMPACT_DICTIONARY_MAX_COUNT members as a GRJsonCompactDictionary, larger ones as an ordinary
+ NSDictionary, and arrays as a GRJsonCompactArray (see GRJsonContainers.h).
+ */
 @interface GRJsonParser : NSObject
 
 @property (nonatomic) BOOL ignoreNulls;
 
+/**
+ How deeply objects and arrays may nest before parsing fails, as for -[GRJson maxDepth].  Defaults to
+ GRJSON_DEFAULT_MAX_DEPTH (1024).  The tree is built without recursion as well, so a parser is safe to use on
+ threads with small stacks.  The class methods always use the default.
+ */
+@property (nonatomic) NSUInteger maxDepth;
+
+/**
+ Object keys are interned in a small, bounded table keyed by their raw bytes, so the same key appearing in
+ thousands of objects resolves to one shared NSString.  These count the keys that were found in the table
+ and the ones that had to be created, across every document this parser has handled.
+ */
+@property (nonatomic, readonly) NSUInteger keyCacheHits;
+@property (nonatomic, readonly) NSUInteger keyCacheMisses;
+
 + (id) JSONObjectFromData:(NSData *)data error:(NSError *__autoreleasing *)error;
 
+/**
+ Parses only the parts of the document that match paths, and returns the document pruned down to them.  For
+ example, selecting @[@"data.items[*].id"] from {"data": {"count": 2, "items": [{"id": 1, "name": "a"}]}}
+ returns {"data": {"items": [{"id": 1}]}}.  Everything else is skipped without being turned into objects.
+
+ @param data the JSON to parse
+ @param paths JSON Pointers or dotted paths, see GRJsonSelection
+ @param error an out pointer that holds a parse error or a malformed path
+ @return the pruned object, or nil on error or if nothing was selected
+ */
++ (id) JSONObjectFromData:(NSData *)data selectingPaths:(NSArray<NSString *> *)paths error:(NSError *__autoreleasing *)error;
+
+/**
+ Parses a JSON file without reading it into memory first: the file is mapped read-only with mmap (with
+ sequential access advised to the kernel) and tokenized straight out of the mapping, so its pages are only
+ ever clean, file-backed page cache rather than a second anonymous copy.
+
+ @param path the file to parse
+ @param options see GRJsonFileOptions
+ @param error an out pointer that holds a file or parse error
+ @return the parsed object, or nil on error
+ */
++ (id) JSONObjectFromFileAtPath:(NSString *)path options:(GRJsonFileOptions)options error:(NSError *__autoreleasing *)error;
+
+/**
+ Parses a gzip, zlib or raw deflate compressed JSON file without inflating it into memory first: fixed-size
+ chunks are inflated and tokenized as they come, on separate queues, so memory stays at a few chunks plus
+ the objects being built, however large the file.  See GRJsonInflater.
+
+ @param path the compressed file
+ @param error an out pointer that holds a file, decompression or parse error
+ @return the parsed object, or nil on error
+ */
++ (id) JSONObjectFromCompressedFileAtPath:(NSString *)path error:(NSError *__autoreleasing *)error;
+
+/**
+ Parses newline-delimited JSON (NDJSON / JSON Lines) using every core; see +[GRJson parseJSONLines:...].
+
+ @param data one JSON value per line
+ @param error an out pointer that describes the first invalid record, with its index under GRJsonParserRecordIndexKey
+ @return the records in their original order, or nil if any record is invalid
+ */
++ (NSArray *) JSONObjectsFromJSONLinesData:(NSData *)data error:(NSError *__autoreleasing *)error;
+
+/**
+ Parses newline-delimited JSON and hands each record to block as soon as it is ready.  The block is called
+ concurrently from several threads, and records arrive in no particular order.
+
+ @param data one JSON value per line
+ @param block receives the record's index among the non-blank lines, its value (nil if it is invalid) and its
+        parse error; set *stop to YES to stop early
+ @return the number of records that were parsed
+ */
++ (NSUInteger) enumerateJSONLinesData:(NSData *)data usingBlock:(void (^)(NSUInteger index, id object, NSError *error, BOOL *stop))block;
+
+/**
+ Same as +JSONObjectFromData:error:, using this parser (and its ignoreNulls setting).
+
+ @param data the JSON to parse
+ @param error an out pointer that holds any parse error
+ @return the parsed object, or nil on error
+ */
+- (id) JSONObjectFromData:(NSData *)data error:(NSError *__autoreleasing *)error;
+
+/**
+ Same as +JSONObjectFromData:selectingPaths:error:, with a selection that was compiled ahead of time.
+
+ @param data the JSON to parse
+ @param selection the paths to keep, or nil for the whole document
+ @param error an out pointer that holds any parse error
+ @return the pruned object, or nil on error
+ */
+- (id) JSONObjectFromData:(NSData *)data selection:(GRJsonSelection *)selection error:(NSError *__autoreleasing *)error;
+
+/** Same as +JSONObjectFromFileAtPath:options:error:, using this parser. */
+- (id) JSONObjectFromFileAtPath:(NSString *)path options:(GRJsonFileOptions)options error:(NSError *__autoreleasing *)error;
+
+/** Same as +JSONObjectFromCompressedFileAtPath:error:, using this parser. */
+- (id) JSONObjectFromCompressedFileAtPath:(NSString *)path error:(NSError *__autoreleasing *)error;
+
 @end
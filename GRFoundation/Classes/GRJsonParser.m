@@ -8,76 +8,449 @@
 
 #import "GRJsonParser.h"
 #import "GRJson.h"
+#import "GRJsonContainers.h"
+#import "GRJsonInflater.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+NSString * const GRJsonParserRecordIndexKey = @"GRJsonParserRecordIndex";
+
+#define KEY_CACHE_SIZE 256       ///< number of interned keys, must be a power of two
+#define KEY_CACHE_MAX_LENGTH 48  ///< longer keys are not worth interning
+#define NO_COPY_MIN_LENGTH 32    ///< shorter strings are cheaper to copy than to tie to the mapped file
+#define INITIAL_DEPTH 32         ///< open containers there is room for before the state stack grows
+#define INITIAL_SLOTS 256        ///< pending values (and keys) there is room for before the value stacks grow
+
+static NSString * const GRJsonParserThreadKey = @"GRJsonParser";
+
+/**
+ * One slot of the key intern table.  The table is direct-mapped: a key's hash picks exactly one slot,
+ * and a different key landing in an occupied slot simply replaces it.  That keeps the table bounded
+ * and the lookup to a single compare, which is all the typical "array of identical objects" needs.
+ */
+typedef struct GRJsonKeyCacheEntry {
+	uint64_t hash;
+	CFStringRef string; ///< retained
+	unsigned long length;
+	unsigned char bytes[KEY_CACHE_MAX_LENGTH];
+} GRJsonKeyCacheEntry;
+
+static inline uint64_t keyHash(const unsigned char *bytes, unsigned long len) {
+	uint64_t head = 0, tail = 0;
+	if (len >= 8) {
+		memcpy(&head, bytes, 8);
+		memcpy(&tail, bytes + len - 8, 8);
+	}
+	else {
+		memcpy(&head, bytes, len);
+	}
+	uint64_t h = (len * 0x9E3779B97F4A7C15ULL) ^ head;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= tail + (h >> 29);
+	h *= 0xC4CEB9FE1A85EC53ULL;
+	return h ^ (h >> 32);
+}
+
+/** One open array or object. */
+typedef struct GRJsonParserFrame {
+	GRJsonParserState state;
+	size_t valueBase; ///< where the container's values start on the value stack
+	size_t keyBase;   ///< where an object's keys start on the key stack
+} GRJsonParserFrame;
+
+/**
+ * Grows a stack of strong slots by doubling, zeroing the new slots so that ARC finds nil in them.  Unlike
+ * __weak references, __strong ones can be moved by realloc.
+ */
+static BOOL reserveSlots(__strong id **slots, size_t *capacity, size_t needed) {
+	if (needed <= *capacity) {
+		return YES;
+	}
+	size_t newCapacity = *capacity ? *capacity * 2 : INITIAL_SLOTS;
+	while (newCapacity < needed) {
+		newCapacity *= 2;
+	}
+	__strong id *grown = (__strong id *)realloc(*slots, newCapacity * sizeof(id));
+	if (grown == NULL) {
+		return NO;
+	}
+	memset(grown + *capacity, 0, (newCapacity - *capacity) * sizeof(id));
+	*slots = grown;
+	*capacity = newCapacity;
+	return YES;
+}
+
+/** releases the slots from index from on (those of a container that has just been built, say) */
+static inline void clearSlots(__strong id *slots, size_t from, size_t *count) {
+	for (size_t i = from; i < *count; i++) {
+		slots[i] = nil;
+	}
+	*count = from;
+}
 
 @interface GRJsonParser () <GRJsonDelegate>
 {
-	NSMutableArray *stack;
-	NSMutableArray <NSNumber*> *parserState;
-	NSNumberFormatter *converter;
+	GRJson *json;                ///< the tokenizer, kept for the next document
+	BOOL parsing;                ///< a document is being parsed right now
+	BOOL outOfMemory;            ///< a stack could not grow during this document
+	// the state stack: open containers, innermost last
+	GRJsonParserFrame *frames;
+	size_t depth;
+	size_t framesCapacity;
+	// the value stacks: finished values (and the keys of open objects) waiting for their container to close
+	__strong id *values;
+	size_t valueCount;
+	size_t valueCapacity;
+	__strong id *keys;
+	size_t keyCount;
+	size_t keyCapacity;
+	GRJsonKeyCacheEntry *keyCache;
+	NSUInteger keyCacheHits;
+	NSUInteger keyCacheMisses;
+	GRJsonScratch scratch; ///< where escaped strings and keys are decoded
+	// set only while parsing a mapped file with GRJsonFileOptionsNoCopyStrings
+	NSData *stringBacking;
+	CFAllocatorRef stringBackingDeallocator;
 }
 
 
 @end
 
+#pragma mark - mapped files
+
+/** the deallocator for strings that point into a mapped file: each string holds one retain on the mapping */
+static void releaseMapping(void *ptr, void *info) {
+	CFRelease(info);
+}
+
+static CFAllocatorRef createMappingDeallocator(NSData *mapping) {
+	CFAllocatorContext context = {0};
+	context.info = (__bridge void *)mapping;
+	context.retain = CFRetain;
+	context.release = CFRelease;
+	context.deallocate = releaseMapping;
+	return CFAllocatorCreate(kCFAllocatorDefault, &context);
+}
+
+static NSError *fileError(int code, NSString *path) {
+	return [NSError errorWithDomain:NSPOSIXErrorDomain code:code userInfo:@{NSFilePathErrorKey: path ?: @"", NSLocalizedDescriptionKey: [NSString stringWithFormat:@"%@: %s", path, strerror(code)]}];
+}
+
+/**
+ * Maps the file read-only.  The returned data unmaps it when it is deallocated, so anything that retains the
+ * data can safely point into the file.
+ */
+static NSData *mapFile(NSString *path, NSError *__autoreleasing *error) {
+	int fd = open(path.fileSystemRepresentation, O_RDONLY);
+	if (fd < 0) {
+		if (error) {
+			*error = fileError(errno, path);
+		}
+		return nil;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		int code = errno;
+		close(fd);
+		if (error) {
+			*error = fileError(code, path);
+		}
+		return nil;
+	}
+	size_t length = (size_t)info.st_size;
+	if (length == 0) {
+		close(fd);
+		return [NSData data];
+	}
+	void *bytes = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	int code = errno;
+	close(fd);
+	if (bytes == MAP_FAILED) {
+		if (error) {
+			*error = fileError(code, path);
+		}
+		return nil;
+	}
+	// the tokenizer reads front to back exactly once, so let the kernel read ahead aggressively
+	madvise(bytes, length, MADV_SEQUENTIAL);
+	return [[NSData alloc] initWithBytesNoCopy:bytes length:length deallocator:^(void *mapped, NSUInteger mappedLength) {
+		munmap(mapped, mappedLength);
+	}];
+}
+
 @implementation GRJsonParser
 
-@synthesize ignoreNulls;
+@synthesize ignoreNulls, maxDepth, keyCacheHits, keyCacheMisses;
+
+/**
+ The parser the class methods use on this thread, so that back-to-back documents don't each pay for a new
+ parser, tokenizer and stacks.  A nested call (from a delegate of some other parse, say) gets a fresh one.
+ */
++ (GRJsonParser *) threadParser {
+	NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+	GRJsonParser *parser = threadDictionary[GRJsonParserThreadKey];
+	if (parser == nil) {
+		parser = [[GRJsonParser alloc] init];
+		threadDictionary[GRJsonParserThreadKey] = parser;
+	}
+	else if (parser->parsing) {
+		return [[GRJsonParser alloc] init];
+	}
+	return parser;
+}
 
 + (id) JSONObjectFromData:(NSData *)data error:(NSError *__autoreleasing *)errorOut {
-	GRJsonParser *myself = [[GRJsonParser alloc] init];
-	GRJson *parser = [[GRJson alloc] initWithData:data delegate:myself];
+	return [[self threadParser] JSONObjectFromData:data error:errorOut];
+}
+
+- (id) init {
+	self = [super init];
+	if (self) {
+		frames = malloc(INITIAL_DEPTH * sizeof(GRJsonParserFrame));
+		framesCapacity = frames ? INITIAL_DEPTH : 0;
+		reserveSlots(&values, &valueCapacity, INITIAL_SLOTS);
+		reserveSlots(&keys, &keyCapacity, INITIAL_SLOTS);
+		GRJsonScratchInit(&scratch);
+		maxDepth = GRJSON_DEFAULT_MAX_DEPTH;
+	}
+	return self;
+}
+
+- (void) dealloc {
+	[self reset];
+	free(frames);
+	free(values);
+	free(keys);
+	if (keyCache) {
+		for (NSUInteger i = 0; i < KEY_CACHE_SIZE; i++) {
+			if (keyCache[i].string) {
+				CFRelease(keyCache[i].string);
+			}
+		}
+		free(keyCache);
+	}
+	GRJsonScratchDestroy(&scratch);
+}
+
++ (id) JSONObjectFromFileAtPath:(NSString *)path options:(GRJsonFileOptions)options error:(NSError *__autoreleasing *)error {
+	return [[self threadParser] JSONObjectFromFileAtPath:path options:options error:error];
+}
+
+- (id) JSONObjectFromFileAtPath:(NSString *)path options:(GRJsonFileOptions)options error:(NSError *__autoreleasing *)error {
+	NSData *mapped = mapFile(path, error);
+	if (mapped == nil) {
+		return nil;
+	}
+	if (options & GRJsonFileOptionsNoCopyStrings) {
+		stringBacking = mapped;
+		stringBackingDeallocator = createMappingDeallocator(mapped);
+	}
+	id result = [self JSONObjectFromData:mapped selection:nil error:error];
+	if (stringBackingDeallocator) {
+		CFRelease(stringBackingDeallocator);
+		stringBackingDeallocator = NULL;
+	}
+	stringBacking = nil;
+	return result;
+}
+
++ (id) JSONObjectFromCompressedFileAtPath:(NSString *)path error:(NSError *__autoreleasing *)error {
+	return [[self threadParser] JSONObjectFromCompressedFileAtPath:path error:error];
+}
+
+- (id) JSONObjectFromCompressedFileAtPath:(NSString *)path error:(NSError *__autoreleasing *)errorOut {
+	[self reset];
+	GRJsonInflater *inflater = [[GRJsonInflater alloc] initWithDelegate:self];
+	inflater.maxDepth = maxDepth;
+	parsing = YES;
+	NSError *error = nil;
+	// the delegate methods run on the inflater's tokenizing queue, while this thread waits
+	BOOL success = [inflater parseFileAtPath:path error:&error];
+	parsing = NO;
+	return [self resultOfParse:success error:error errorOut:errorOut];
+}
+
++ (id) JSONObjectFromData:(NSData *)data selectingPaths:(NSArray<NSString *> *)paths error:(NSError *__autoreleasing *)error {
+	GRJsonSelection *selection = [GRJsonSelection selectionWithPaths:paths error:error];
+	if (selection == nil) {
+		return nil;
+	}
+	return [[self threadParser] JSONObjectFromData:data selection:selection error:error];
+}
+
++ (NSArray *) JSONObjectsFromJSONLinesData:(NSData *)data error:(NSError *__autoreleasing *)errorOut {
+	// one slot per record, each written by the one worker that parses it, so only errors need a lock
+	__block __strong id *slots = NULL;
+	__block size_t slotCount = 0;
+	NSObject *errorLock = [[NSObject alloc] init];
+	__block NSError *firstError = nil;
+	__block NSUInteger firstErrorIndex = NSNotFound;
+	[GRJson parseJSONLines:data recordCount:^(NSUInteger count) {
+		slots = count ? (__strong id *)calloc(count, sizeof(id)) : NULL;
+		slotCount = slots ? count : 0;
+		if (count && slots == NULL) {
+			firstError = [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"out of memory"}];
+		}
+	} delegateFactory:^id<GRJsonDelegate>{
+		return [[GRJsonParser alloc] init];
+	} recordHandler:^(id<GRJsonDelegate> delegate, NSUInteger index, NSError *error, BOOL *stop) {
+		if (slots == NULL) {
+			*stop = YES;
+			return;
+		}
+		id object = [(GRJsonParser *)delegate takeResult];
+		if (error) {
+			@synchronized (errorLock) {
+				// report the earliest bad record, whichever worker happened to find it first
+				if (index < firstErrorIndex) {
+					firstErrorIndex = index;
+					firstError = error;
+				}
+			}
+			return;
+		}
+		slots[index] = object ?: [NSNull null];
+	}];
+	NSArray *objects = nil;
+	if (firstError == nil) {
+		objects = [NSArray arrayWithObjects:slots count:slotCount];
+	}
+	clearSlots(slots, 0, &slotCount);
+	free(slots);
+	if (firstError) {
+		if (errorOut) {
+			if (firstErrorIndex == NSNotFound) {
+				*errorOut = firstError;
+			}
+			else {
+				NSString *reason = [NSString stringWithFormat:@"record %lu: %@", (unsigned long)firstErrorIndex, firstError.localizedDescription];
+				*errorOut = [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: reason, GRJsonParserRecordIndexKey: @(firstErrorIndex), NSUnderlyingErrorKey: firstError}];
+			}
+		}
+		return nil;
+	}
+	return objects;
+}
+
++ (NSUInteger) enumerateJSONLinesData:(NSData *)data usingBlock:(void (^)(NSUInteger index, id object, NSError *error, BOOL *stop))block {
+	return [GRJson parseJSONLines:data delegateFactory:^id<GRJsonDelegate>{
+		return [[GRJsonParser alloc] init];
+	} recordHandler:^(id<GRJsonDelegate> delegate, NSUInteger index, NSError *error, BOOL *stop) {
+		id object = [(GRJsonParser *)delegate takeResult];
+		block(index, error ? nil : object, error, stop);
+	}];
+}
+
+/** releases everything still on the stacks (after an error, say), keeping their memory */
+- (void) reset {
+	for (size_t i = 0; i < valueCount; i++) {
+		values[i] = nil;
+	}
+	for (size_t i = 0; i < keyCount; i++) {
+		keys[i] = nil;
+	}
+	valueCount = 0;
+	keyCount = 0;
+	depth = 0;
+	outOfMemory = NO;
+}
+
+/** the finished value, leaving the parser ready for the next document */
+- (id) takeResult {
+	id result = (depth == 0 && valueCount == 1 && !outOfMemory) ? values[0] : nil;
+	[self reset];
+	return result;
+}
+
+- (id) JSONObjectFromData:(NSData *)data error:(NSError *__autoreleasing *)errorOut {
+	return [self JSONObjectFromData:data selection:nil error:errorOut];
+}
+
+- (id) JSONObjectFromData:(NSData *)data selection:(GRJsonSelection *)selection error:(NSError *__autoreleasing *)errorOut {
+	[self reset];
+	if (json == nil) {
+		json = [[GRJson alloc] initWithDelegate:self];
+	}
+	if (json.selection != selection) {
+		json.selection = selection;
+	}
+	json.maxDepth = maxDepth;
+	json.data = data;
+	parsing = YES;
 	NSError *error = nil;
-	BOOL success = [parser parse:&error];
+	BOOL success = [json parse:&error];
+	parsing = NO;
+	json.data = nil;
+	return [self resultOfParse:success error:error errorOut:errorOut];
+}
+
+/** the finished document, or nil and the error (which is also logged) if parsing failed */
+- (id) resultOfParse:(BOOL)success error:(NSError *)error errorOut:(NSError *__autoreleasing *)errorOut {
+	if (success && outOfMemory) {
+		error = [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"out of memory"}];
+		success = NO;
+	}
 	if (!success || error) {
 		NSLog(@"error parsing JSON: %@", error);
 		if (errorOut) {
 			*errorOut = error;
 		}
+		[self reset];
+		return nil;
 	}
-	return myself->stack.lastObject;
+	return [self takeResult];
 }
 
-- (id) init {
-	self = [super init];
-	if (self) {
-		stack = [NSMutableArray arrayWithCapacity:3];
-		parserState = [@[] mutableCopy];
-		converter = [[NSNumberFormatter alloc] init];
-	}
-	return self;
+- (GRJsonParserState) parserState {
+	return depth ? frames[depth - 1].state : GRJPSRoot;
 }
 
-- (GRJsonParserState) parserState {
-	return parserState.lastObject.integerValue;
+- (void) pushKey:(NSString *)key {
+	if (!reserveSlots(&keys, &keyCapacity, keyCount + 1)) {
+		outOfMemory = YES;
+		return;
+	}
+	keys[keyCount++] = key;
 }
 
 - (void) storeValue:(id)value {
-	switch ([self parserState]) {
-		case GRJPSRoot:
-		{
-			[stack addObject:value];
-			break;
-		}
-		case GRJPSInObject:
-		{
-			NSString *key = stack.lastObject;
-			[stack removeLastObject];
-			NSMutableDictionary *dict = stack.lastObject;
-			if (value == nil && !ignoreNulls) {
-				value = [NSNull null];
+	GRJsonParserState state = [self parserState];
+	if (value == nil) {
+		if (state == GRJPSInObject && ignoreNulls) {
+			// the key that was waiting for this value goes too
+			if (keyCount > frames[depth - 1].keyBase) {
+				keys[--keyCount] = nil;
 			}
-			if (value) {
-				dict[key] = value;
-			}
-			break;
+			return;
 		}
-		case GRJPSInArray:
-		{
-			NSMutableArray *array = stack.lastObject;
-			[array addObject:value];
-			break;
+		value = [NSNull null];
+	}
+	if (!reserveSlots(&values, &valueCapacity, valueCount + 1)) {
+		outOfMemory = YES;
+		return;
+	}
+	values[valueCount++] = value;
+}
+
+- (void) beginContainer:(GRJsonParserState)state {
+	if (depth == framesCapacity) {
+		size_t capacity = framesCapacity ? framesCapacity * 2 : INITIAL_DEPTH;
+		GRJsonParserFrame *grown = realloc(frames, capacity * sizeof(GRJsonParserFrame));
+		if (grown == NULL) {
+			// the document is lost either way; the ends that follow are harmless without their frames
+			outOfMemory = YES;
+			return;
 		}
+		frames = grown;
+		framesCapacity = capacity;
 	}
+	frames[depth].state = state;
+	frames[depth].valueBase = valueCount;
+	frames[depth].keyBase = keyCount;
+	depth++;
 }
 
 - (void) json_null {
@@ -92,44 +465,131 @@
 	[self storeValue:strVal];
 }
 
+- (void) json_string_bytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii {
+	if (stringBackingDeallocator && !needsUnescape && len >= NO_COPY_MIN_LENGTH) {
+		const unsigned char *start = (const unsigned char *)stringBacking.bytes;
+		// only bytes that really are in the file (not a token stitched together in the tokenizer), and only
+		// ASCII, which CFString keeps as-is instead of converting into a copy
+		if (bytes >= start && bytes + len <= start + stringBacking.length && ascii) {
+			CFRetain((__bridge CFTypeRef)stringBacking);
+			CFStringRef str = CFStringCreateWithBytesNoCopy(kCFAllocatorDefault, bytes, (CFIndex)len, kCFStringEncodingASCII, false, stringBackingDeallocator);
+			if (str) {
+				[self storeValue:CFBridgingRelease(str)];
+				return;
+			}
+			CFRelease((__bridge CFTypeRef)stringBacking);
+		}
+	}
+	[self storeValue:[GRJson stringWithBytes:bytes length:len needsUnescape:needsUnescape ascii:ascii scratch:&scratch]];
+}
+
 - (void) json_array_begin {
-	NSMutableArray *array = [NSMutableArray array];
-	[stack addObject:array];
-	[parserState addObject:@(GRJPSInArray)];
+	[self beginContainer:GRJPSInArray];
 }
 
 - (void) json_array_end {
-	[parserState removeLastObject];
-	if ([self parserState] != GRJPSRoot) {
-		NSArray *finished = stack.lastObject;
-		[stack removeLastObject];
-		[self storeValue:finished];
+	if (depth == 0) {
+		return;
 	}
+	GRJsonParserFrame frame = frames[--depth];
+	NSArray *finished = [GRJsonCompactArray arrayForObjects:values + frame.valueBase count:valueCount - frame.valueBase];
+	clearSlots(values, frame.valueBase, &valueCount);
+	if (finished == nil) {
+		outOfMemory = YES;
+		return;
+	}
+	[self storeValue:finished];
 }
 
 - (void) json_object_begin {
-	NSMutableDictionary *dict = [NSMutableDictionary dictionary];
-	[stack addObject:dict];
-	[parserState addObject:@(GRJPSInObject)];
+	[self beginContainer:GRJPSInObject];
 }
 
 - (void) json_object_end {
-	[parserState removeLastObject];
-	if ([self parserState] != GRJPSRoot) {
-		NSDictionary *finished = stack.lastObject;
-		[stack removeLastObject];
-		[self storeValue:finished];
+	if (depth == 0) {
+		return;
+	}
+	GRJsonParserFrame frame = frames[--depth];
+	size_t count = MIN(valueCount - frame.valueBase, keyCount - frame.keyBase);
+	// small objects (the vast majority) get an exactly sized member buffer, larger ones a hash table
+	NSDictionary *finished = [GRJsonCompactDictionary dictionaryForObjects:values + frame.valueBase keys:keys + frame.keyBase count:count];
+	clearSlots(values, frame.valueBase, &valueCount);
+	clearSlots(keys, frame.keyBase, &keyCount);
+	if (finished == nil) {
+		outOfMemory = YES;
+		return;
 	}
+	[self storeValue:finished];
 }
 
 - (void) json_object_key:(NSString *)key {
-	[stack addObject:key];
+	[self pushKey:key];
+}
+
+- (void) json_object_key_bytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii {
+	if (keyCache == NULL && len <= KEY_CACHE_MAX_LENGTH) {
+		keyCache = calloc(KEY_CACHE_SIZE, sizeof(GRJsonKeyCacheEntry));
+	}
+	// long keys, or every key if there was no memory for the cache, are made fresh each time
+	if (len > KEY_CACHE_MAX_LENGTH || keyCache == NULL) {
+		keyCacheMisses++;
+		NSString *key = [GRJson stringWithBytes:bytes length:len needsUnescape:needsUnescape ascii:ascii scratch:&scratch];
+		if (key == nil) {
+			outOfMemory = YES;
+			return;
+		}
+		[self pushKey:key];
+		return;
+	}
+	uint64_t hash = keyHash(bytes, len);
+	GRJsonKeyCacheEntry *entry = &keyCache[hash & (KEY_CACHE_SIZE - 1)];
+	if (entry->string && entry->hash == hash && entry->length == len && memcmp(entry->bytes, bytes, len) == 0) {
+		keyCacheHits++;
+		[self pushKey:(__bridge NSString *)entry->string];
+		return;
+	}
+	keyCacheMisses++;
+	NSString *key = [GRJson stringWithBytes:bytes length:len needsUnescape:needsUnescape ascii:ascii scratch:&scratch];
+	if (key == nil) {
+		// the document is lost, as when a stack cannot grow
+		outOfMemory = YES;
+		return;
+	}
+	if (entry->string) {
+		CFRelease(entry->string);
+	}
+	entry->string = CFBridgingRetain(key);
+	entry->hash = hash;
+	entry->length = len;
+	memcpy(entry->bytes, bytes, len);
+	[self pushKey:key];
 }
 
 
 - (void) json_number:(const unsigned char *)numberVal length:(unsigned long)len {
-	NSString *str = [[NSString alloc] initWithBytes:numberVal length:len encoding:NSUTF8StringEncoding];
-	[self storeValue:[converter numberFromString:str]];
+	int64_t integer;
+	double real;
+	switch (GRJsonParseNumber(numberVal, len, &integer, &real)) {
+		case GRJsonNumberInteger:
+			[self json_integer:integer];
+			break;
+		case GRJsonNumberDouble:
+			[self json_double:real];
+			break;
+		case GRJsonNumberInvalid:
+			// GRJson only hands over numbers the tokenizer has checked, so this is strtod running out of memory
+			outOfMemory = YES;
+			break;
+	}
+}
+
+- (void) json_integer:(int64_t)value {
+	// small integers come back from the boxing literal as tagged pointers, with no allocation at all
+	[self storeValue:@(value)];
+}
+
+- (void) json_double:(double)value {
+	[self storeValue:@(value)];
 }
 
 @end
@@ -0,0 +1,62 @@
+//
+//  GRJsonPatch.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "GRJsonPatchPlan.h"
+
+/**
+ A compiled JSON Patch (RFC 6902) or JSON Merge Patch (RFC 7386), applied straight from document bytes to
+ patched bytes.
+
+ The document is never parsed into objects: only the objects and arrays on the paths the patch touches are
+ split into their members, every other value is copied to the output byte for byte, and only the edited
+ containers are re-encoded (without whitespace).  See GRJsonPatchPlan.h for the details.  A patch can be
+ applied to any number of documents, from any number of threads.
+ */
+@interface GRJsonPatch : NSObject
+
+/** Compiles a JSON Patch: an array of add, remove, replace, move, copy and test operations. */
++ (instancetype) patchWithData:(NSData *)patch error:(NSError *__autoreleasing *)error;
+
+/** Compiles a JSON Merge Patch: a document whose members replace the target's, and whose nulls remove them. */
++ (instancetype) mergePatchWithData:(NSData *)patch error:(NSError *__autoreleasing *)error;
+
+/**
+ Compiles a patch.  The patch bytes are copied.
+
+ @param patch the patch document
+ @param format whether patch is a JSON Patch or a merge patch
+ @param error an out pointer that describes why the patch is invalid
+ @return the patch, or nil if it is not valid JSON or not a valid patch
+ */
+- (instancetype) initWithData:(NSData *)patch format:(GRJsonPatchFormat)format error:(NSError *__autoreleasing *)error;
+
+@property (nonatomic, readonly) GRJsonPatchFormat format;
+
+/**
+ Applies the patch.
+
+ @param document the JSON document to patch
+ @param error an out pointer that holds the reason the patch could not be applied: an invalid document, a
+        path that leads nowhere or a failed test
+ @return the patched document, or nil on error
+ */
+- (NSData *) applyToData:(NSData *)document error:(NSError *__autoreleasing *)error;
+
+/**
+ Applies the patch, writing the patched document to stream as it is produced.  Every operation is applied
+ before anything is written, so a patch that fails writes nothing.
+
+ @param document the JSON document to patch
+ @param stream an open output stream
+ @param error an out pointer that holds the reason the patch could not be applied or written
+ @return YES if the whole patched document was written
+ */
+- (BOOL) applyToData:(NSData *)document outputStream:(NSOutputStream *)stream error:(NSError *__autoreleasing *)error;
+
+@end
@@ -0,0 +1,85 @@
+//
+//  GRJsonPatch.m
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import "GRJsonPatch.h"
+#import "JsonSupport.h"
+
+@interface GRJsonPatch ()
+{
+	GRJsonPatchPlan plan;
+	NSData *patchData; ///< the plan points into these bytes
+}
+
+@end
+
+@implementation GRJsonPatch
+
+@synthesize format;
+
++ (instancetype) patchWithData:(NSData *)patch error:(NSError *__autoreleasing *)error {
+	return [[self alloc] initWithData:patch format:GRJsonPatchFormatJSONPatch error:error];
+}
+
++ (instancetype) mergePatchWithData:(NSData *)patch error:(NSError *__autoreleasing *)error {
+	return [[self alloc] initWithData:patch format:GRJsonPatchFormatMergePatch error:error];
+}
+
+- (instancetype) initWithData:(NSData *)patch format:(GRJsonPatchFormat)formatIn error:(NSError *__autoreleasing *)error {
+	self = [super init];
+	if (self) {
+		GRJsonPatchPlanInit(&plan);
+		patchData = [patch copy] ?: [NSData data];
+		format = formatIn;
+		char message[200];
+		if (!GRJsonPatchPlanCompile(&plan, formatIn, (const uint8_t *)patchData.bytes, patchData.length, message, sizeof(message))) {
+			if (error) {
+				*error = GRJsonErrorWithReason(@"GRJsonParser", [NSString stringWithUTF8String:message] ?: @"invalid patch");
+			}
+			return nil;
+		}
+	}
+	return self;
+}
+
+- (void) dealloc {
+	GRJsonPatchPlanDestroy(&plan);
+}
+
+- (BOOL) applyToData:(NSData *)document emitter:(GRJsonEmitter *)emitter error:(NSError *__autoreleasing *)error {
+	char message[200];
+	GRJsonPatchError result = GRJsonPatchPlanApply(&plan, (const uint8_t *)document.bytes, document.length, emitter, message, sizeof(message));
+	if (result == GRJsonPatchErrorNone && GRJsonEmitterFlush(emitter)) {
+		return YES;
+	}
+	if (error) {
+		*error = GRJsonErrorWithReason(@"GRJsonParser", result == GRJsonPatchErrorNone ? @"could not write the patched document" : ([NSString stringWithUTF8String:message] ?: @"could not apply the patch"));
+	}
+	return NO;
+}
+
+- (NSData *) applyToData:(NSData *)document error:(NSError *__autoreleasing *)error {
+	GRJsonEmitter emitter;
+	GRJsonEmitterInit(&emitter);
+	NSData *patched = nil;
+	if ([self applyToData:document emitter:&emitter error:error]) {
+		patched = [NSData dataWithBytes:emitter.buf length:emitter.length];
+	}
+	GRJsonEmitterDestroy(&emitter);
+	return patched;
+}
+
+- (BOOL) applyToData:(NSData *)document outputStream:(NSOutputStream *)stream error:(NSError *__autoreleasing *)error {
+	GRJsonEmitter emitter;
+	GRJsonEmitterInit(&emitter);
+	GRJsonEmitterSetSink(&emitter, GRJsonWriteToStream, (__bridge void *)stream);
+	BOOL written = [self applyToData:document emitter:&emitter error:error];
+	GRJsonEmitterDestroy(&emitter);
+	return written;
+}
+
+@end
@@ -0,0 +1,910 @@
+//
+//  GRJsonPatchPlan.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonPatchPlan.h"
+#include "GRJsonString.h"
+#include "GRJsonTape.h"
+#include "GRJsonTokenizer.h"
+#include "GRJsonValidator.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_NODE SIZE_MAX
+
+/** makes room for one more item in a growing array */
+static bool reserveOne(void **items, size_t *capacity, size_t count, size_t itemSize) {
+	if (count < *capacity) {
+		return true;
+	}
+	size_t newCapacity = *capacity ? *capacity * 2 : 16;
+	void *grown = realloc(*items, newCapacity * itemSize);
+	if (grown == NULL) {
+		return false;
+	}
+	*items = grown;
+	*capacity = newCapacity;
+	return true;
+}
+
+static void describe(char *errorMessage, size_t errorMessageSize, const char *fmt, va_list argList) {
+	if (errorMessage && errorMessageSize) {
+		vsnprintf(errorMessage, errorMessageSize, fmt, argList);
+	}
+}
+
+static void trim(const uint8_t **bytes, size_t *length) {
+	while (*length && (**bytes == ' ' || **bytes == '\t' || **bytes == '\n' || **bytes == '\r')) {
+		(*bytes)++;
+		(*length)--;
+	}
+	while (*length) {
+		uint8_t c = (*bytes)[*length - 1];
+		if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+			break;
+		}
+		(*length)--;
+	}
+}
+
+#pragma mark - spans
+
+/** A member or element of a container, as spans of the container's text. */
+typedef struct GRJsonPatchChild {
+	const uint8_t *key;   ///< the member name between the quotes, still escaped; NULL for elements
+	size_t keyLength;
+	bool keyEscaped;
+	const uint8_t *value; ///< the complete text of the value
+	size_t valueLength;
+} GRJsonPatchChild;
+
+typedef struct GRJsonPatchChildren {
+	GRJsonPatchChild *items;
+	size_t count;
+	size_t capacity;
+} GRJsonPatchChildren;
+
+/**
+ * Finds the spans of the direct members or elements of the object or array in bytes, which must be valid
+ * JSON.  Nested containers are hopped over with GRJsonTokenizerSkipContainer rather than tokenized.
+ *
+ * @return false if out of memory
+ */
+static bool collectChildren(GRJsonTokenizer *t, const uint8_t *bytes, size_t length, GRJsonPatchChildren *children) {
+	children->count = 0;
+	GRJsonTokenizerReset(t);
+	GRJsonTokenizerSetInput(t, bytes, length, true);
+	GRJsonToken token;
+	if (GRJsonTokenizerNext(t, &token) != GRJsonStatusToken) {
+		return false;
+	}
+	bool isObject = (token.type == GRJsonTokenObjectBegin);
+	while (GRJsonTokenizerNext(t, &token) == GRJsonStatusToken) {
+		if (token.type == GRJsonTokenObjectEnd || token.type == GRJsonTokenArrayEnd) {
+			return true;
+		}
+		GRJsonPatchChild child;
+		memset(&child, 0, sizeof(child));
+		if (isObject) {
+			child.key = token.bytes;
+			child.keyLength = token.length;
+			child.keyEscaped = token.hasEscapes;
+			if (GRJsonTokenizerNext(t, &token) != GRJsonStatusToken) {
+				return false;
+			}
+		}
+		if (token.type == GRJsonTokenObjectBegin || token.type == GRJsonTokenArrayBegin) {
+			GRJsonTokenizerSkipContainer(t);
+		}
+		child.value = bytes + token.offset;
+		child.valueLength = (size_t)(GRJsonTokenizerOffset(t) - token.offset);
+		if (!reserveOne((void **)&children->items, &children->capacity, children->count, sizeof(GRJsonPatchChild))) {
+			return false;
+		}
+		children->items[children->count++] = child;
+	}
+	return false;
+}
+
+/** The decoded bytes of a string body, using scratch only if it has escapes.  NULL if out of memory. */
+static const uint8_t *decoded(const uint8_t *bytes, size_t *length, bool hasEscapes, GRJsonScratch *scratch) {
+	if (!hasEscapes) {
+		return bytes;
+	}
+	uint8_t *out = GRJsonScratchReserve(scratch, *length ? *length : 1);
+	if (out == NULL) {
+		return NULL;
+	}
+	*length = GRJsonUnescape(bytes, *length, out);
+	return out;
+}
+
+#pragma mark - compiling
+
+void GRJsonPatchPlanInit(GRJsonPatchPlan *plan) {
+	memset(plan, 0, sizeof(*plan));
+}
+
+void GRJsonPatchPlanDestroy(GRJsonPatchPlan *plan) {
+	free(plan->ops);
+	free(plan->tokens);
+	free(plan->names);
+	memset(plan, 0, sizeof(*plan));
+}
+
+typedef struct GRJsonPatchCompiler {
+	GRJsonPatchPlan *plan;
+	GRJsonTokenizer tokenizer;
+	GRJsonPatchChildren ops;
+	GRJsonPatchChildren members;
+	GRJsonScratch scratch;
+	char *errorMessage;
+	size_t errorMessageSize;
+} GRJsonPatchCompiler;
+
+static bool compileFail(GRJsonPatchCompiler *c, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static bool compileFail(GRJsonPatchCompiler *c, const char *fmt, ...) {
+	va_list argList;
+	va_start(argList, fmt);
+	describe(c->errorMessage, c->errorMessageSize, fmt, argList);
+	va_end(argList);
+	return false;
+}
+
+static bool appendName(GRJsonPatchPlan *plan, uint8_t byte) {
+	if (!reserveOne((void **)&plan->names, &plan->namesCapacity, plan->namesLength, 1)) {
+		return false;
+	}
+	plan->names[plan->namesLength++] = byte;
+	return true;
+}
+
+/** decodes a JSON Pointer (RFC 6901), given as the still escaped body of a JSON string, into tokens */
+static bool compilePointer(GRJsonPatchCompiler *c, size_t opIndex, const GRJsonPatchChild *member, size_t *first, size_t *count) {
+	GRJsonPatchPlan *plan = c->plan;
+	if (member->value[0] != '"') {
+		return compileFail(c, "operation %zu: '%.*s' must be a string", opIndex, (int)member->keyLength, (const char *)member->key);
+	}
+	size_t length = member->valueLength - 2;
+	const uint8_t *pointer = decoded(member->value + 1, &length, memchr(member->value + 1, '\\', length) != NULL, &c->scratch);
+	if (pointer == NULL) {
+		return compileFail(c, "out of memory");
+	}
+	*first = plan->tokenCount;
+	*count = 0;
+	if (length == 0) {
+		return true;
+	}
+	if (pointer[0] != '/') {
+		return compileFail(c, "operation %zu: the pointer '%.*s' must start with '/'", opIndex, (int)length, (const char *)pointer);
+	}
+	// names is allocated even if every token is empty, so a token's name is never NULL
+	if (!reserveOne((void **)&plan->names, &plan->namesCapacity, plan->namesLength, 1)) {
+		return compileFail(c, "out of memory");
+	}
+	for (size_t i = 0; i < length; ) {
+		if (!reserveOne((void **)&plan->tokens, &plan->tokenCapacity, plan->tokenCount, sizeof(GRJsonPatchToken))) {
+			return compileFail(c, "out of memory");
+		}
+		GRJsonPatchToken *token = &plan->tokens[plan->tokenCount++];
+		token->nameOffset = plan->namesLength;
+		for (i++; i < length && pointer[i] != '/'; i++) {
+			uint8_t byte = pointer[i];
+			if (byte == '~') {
+				if (i + 1 < length && (pointer[i + 1] == '0' || pointer[i + 1] == '1')) {
+					byte = pointer[++i] == '0' ? '~' : '/';
+				}
+				else {
+					return compileFail(c, "operation %zu: '~' must be followed by '0' or '1' in '%.*s'", opIndex, (int)length, (const char *)pointer);
+				}
+			}
+			if (!appendName(plan, byte)) {
+				return compileFail(c, "out of memory");
+			}
+		}
+		token->nameLength = plan->namesLength - token->nameOffset;
+		(*count)++;
+	}
+	return true;
+}
+
+static bool compileOp(GRJsonPatchCompiler *c, size_t opIndex, const GRJsonPatchChild *element) {
+	static const char *opNames[] = {"add", "remove", "replace", "move", "copy", "test"};
+	if (element->value[0] != '{') {
+		return compileFail(c, "operation %zu is not an object", opIndex);
+	}
+	if (!collectChildren(&c->tokenizer, element->value, element->valueLength, &c->members)) {
+		return compileFail(c, "out of memory");
+	}
+	GRJsonPatchPlan *plan = c->plan;
+	if (!reserveOne((void **)&plan->ops, &plan->opCapacity, plan->opCount, sizeof(GRJsonPatchOp))) {
+		return compileFail(c, "out of memory");
+	}
+	GRJsonPatchOp op;
+	memset(&op, 0, sizeof(op));
+	bool hasOp = false, hasPath = false, hasFrom = false;
+	for (size_t m = 0; m < c->members.count; m++) {
+		const GRJsonPatchChild *member = &c->members.items[m];
+		size_t keyLength = member->keyLength;
+		const uint8_t *key = decoded(member->key, &keyLength, member->keyEscaped, &c->scratch);
+		if (key == NULL) {
+			return compileFail(c, "out of memory");
+		}
+		if (keyLength == 2 && memcmp(key, "op", 2) == 0) {
+			hasOp = false;
+			for (size_t k = 0; k < sizeof(opNames) / sizeof(opNames[0]) && member->value[0] == '"'; k++) {
+				size_t nameLength = strlen(opNames[k]);
+				if (member->valueLength == nameLength + 2 && memcmp(member->value + 1, opNames[k], nameLength) == 0) {
+					op.kind = (GRJsonPatchOpKind)k;
+					hasOp = true;
+				}
+			}
+			if (!hasOp) {
+				return compileFail(c, "operation %zu: unknown op %.*s", opIndex, (int)(member->valueLength > 32 ? 32 : member->valueLength), (const char *)member->value);
+			}
+		}
+		else if (keyLength == 4 && memcmp(key, "path", 4) == 0) {
+			if (!compilePointer(c, opIndex, member, &op.pathFirst, &op.pathCount)) {
+				return false;
+			}
+			hasPath = true;
+		}
+		else if (keyLength == 4 && memcmp(key, "from", 4) == 0) {
+			if (!compilePointer(c, opIndex, member, &op.fromFirst, &op.fromCount)) {
+				return false;
+			}
+			hasFrom = true;
+		}
+		else if (keyLength == 5 && memcmp(key, "value", 5) == 0) {
+			op.value = member->value;
+			op.valueLength = member->valueLength;
+		}
+	}
+	if (!hasOp || !hasPath) {
+		return compileFail(c, "operation %zu needs both \"op\" and \"path\"", opIndex);
+	}
+	if ((op.kind == GRJsonPatchMove || op.kind == GRJsonPatchCopy) && !hasFrom) {
+		return compileFail(c, "operation %zu (%s) needs \"from\"", opIndex, opNames[op.kind]);
+	}
+	if ((op.kind == GRJsonPatchAdd || op.kind == GRJsonPatchReplace || op.kind == GRJsonPatchTest) && op.value == NULL) {
+		return compileFail(c, "operation %zu (%s) needs \"value\"", opIndex, opNames[op.kind]);
+	}
+	plan->ops[plan->opCount++] = op;
+	return true;
+}
+
+bool GRJsonPatchPlanCompile(GRJsonPatchPlan *plan, GRJsonPatchFormat format, const uint8_t *patch, size_t length, char *errorMessage, size_t errorMessageSize) {
+	GRJsonPatchCompiler compiler;
+	memset(&compiler, 0, sizeof(compiler));
+	compiler.plan = plan;
+	compiler.errorMessage = errorMessage;
+	compiler.errorMessageSize = errorMessageSize;
+	GRJsonValidation validation;
+	if (!GRJsonValidate(patch, length, &validation)) {
+		return compileFail(&compiler, "invalid patch: %s at line %zu, column %zu", validation.message, validation.line, validation.column);
+	}
+	trim(&patch, &length);
+	plan->format = format;
+	if (format == GRJsonPatchFormatMergePatch) {
+		plan->mergePatch = patch;
+		plan->mergePatchLength = length;
+		return true;
+	}
+	if (patch[0] != '[') {
+		return compileFail(&compiler, "a JSON Patch must be an array of operations");
+	}
+	GRJsonTokenizerInit(&compiler.tokenizer);
+	GRJsonScratchInit(&compiler.scratch);
+	bool ok = collectChildren(&compiler.tokenizer, patch, length, &compiler.ops) || compileFail(&compiler, "out of memory");
+	for (size_t i = 0; ok && i < compiler.ops.count; i++) {
+		ok = compileOp(&compiler, i, &compiler.ops.items[i]);
+	}
+	free(compiler.ops.items);
+	free(compiler.members.items);
+	GRJsonScratchDestroy(&compiler.scratch);
+	GRJsonTokenizerDestroy(&compiler.tokenizer);
+	return ok;
+}
+
+#pragma mark - the overlay
+
+/**
+ * A value in the document being patched.  Until it is expanded it is just the span of its text (in the
+ * document or in the patch); expanding an object or array replaces that with a list of child nodes, one
+ * per member or element, each of them again just a span.
+ */
+typedef struct GRJsonPatchNode {
+	const uint8_t *bytes;
+	size_t length;
+	const uint8_t *key;  ///< the member name when the node is in an object
+	size_t keyLength;
+	bool keyEscaped;
+	uint8_t expanded;    ///< '{' or '[' once the children are authoritative, otherwise 0
+	bool modified;       ///< the text was replaced, or the children no longer match it
+	size_t *children;
+	size_t childCount;
+	size_t childCapacity;
+} GRJsonPatchNode;
+
+typedef struct GRJsonPatchContext {
+	const GRJsonPatchPlan *plan;
+	GRJsonPatchNode *nodes;
+	size_t nodeCount;
+	size_t nodeCapacity;
+	size_t root;
+	GRJsonTokenizer tokenizer;
+	GRJsonPatchChildren spans;
+	GRJsonScratch left;
+	GRJsonScratch right;
+	size_t opIndex;
+	GRJsonPatchError error;
+	char *errorMessage;
+	size_t errorMessageSize;
+} GRJsonPatchContext;
+
+static bool fail(GRJsonPatchContext *ctx, GRJsonPatchError error, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+static bool fail(GRJsonPatchContext *ctx, GRJsonPatchError error, const char *fmt, ...) {
+	if (ctx->error == GRJsonPatchErrorNone) {
+		ctx->error = error;
+		va_list argList;
+		va_start(argList, fmt);
+		describe(ctx->errorMessage, ctx->errorMessageSize, fmt, argList);
+		va_end(argList);
+	}
+	return false;
+}
+
+static bool outOfMemory(GRJsonPatchContext *ctx) {
+	return fail(ctx, GRJsonPatchErrorOutOfMemory, "out of memory");
+}
+
+static size_t newNode(GRJsonPatchContext *ctx, const uint8_t *bytes, size_t length) {
+	if (!reserveOne((void **)&ctx->nodes, &ctx->nodeCapacity, ctx->nodeCount, sizeof(GRJsonPatchNode))) {
+		outOfMemory(ctx);
+		return NO_NODE;
+	}
+	GRJsonPatchNode *node = &ctx->nodes[ctx->nodeCount];
+	memset(node, 0, sizeof(*node));
+	node->bytes = bytes;
+	node->length = length;
+	return ctx->nodeCount++;
+}
+
+static void setKey(GRJsonPatchContext *ctx, size_t node, const uint8_t *key, size_t keyLength, bool keyEscaped) {
+	ctx->nodes[node].key = key;
+	ctx->nodes[node].keyLength = keyLength;
+	ctx->nodes[node].keyEscaped = keyEscaped;
+}
+
+/** makes node the text bytes again, dropping any children */
+static void setText(GRJsonPatchContext *ctx, size_t node, const uint8_t *bytes, size_t length) {
+	GRJsonPatchNode *n = &ctx->nodes[node];
+	n->bytes = bytes;
+	n->length = length;
+	n->expanded = 0;
+	n->childCount = 0;
+	n->modified = true;
+}
+
+static uint8_t containerType(const GRJsonPatchNode *node) {
+	if (node->expanded) {
+		return node->expanded;
+	}
+	return node->length && (node->bytes[0] == '{' || node->bytes[0] == '[') ? node->bytes[0] : 0;
+}
+
+static bool insertChild(GRJsonPatchContext *ctx, size_t parent, size_t position, size_t child) {
+	GRJsonPatchNode *p = &ctx->nodes[parent];
+	if (!reserveOne((void **)&p->children, &p->childCapacity, p->childCount, sizeof(size_t))) {
+		return outOfMemory(ctx);
+	}
+	memmove(p->children + position + 1, p->children + position, (p->childCount - position) * sizeof(size_t));
+	p->children[position] = child;
+	p->childCount++;
+	p->modified = true;
+	return true;
+}
+
+static void removeChild(GRJsonPatchContext *ctx, size_t parent, size_t position) {
+	GRJsonPatchNode *p = &ctx->nodes[parent];
+	memmove(p->children + position, p->children + position + 1, (p->childCount - position - 1) * sizeof(size_t));
+	p->childCount--;
+	p->modified = true;
+}
+
+/** splits an object or array node into its children; the caller checks that it is one */
+static bool expand(GRJsonPatchContext *ctx, size_t node) {
+	if (ctx->nodes[node].expanded) {
+		return true;
+	}
+	// the children are the same value as the text, so expanding leaves the node as dirty as it was
+	bool modified = ctx->nodes[node].modified;
+	if (!collectChildren(&ctx->tokenizer, ctx->nodes[node].bytes, ctx->nodes[node].length, &ctx->spans)) {
+		return outOfMemory(ctx);
+	}
+	for (size_t i = 0; i < ctx->spans.count; i++) {
+		const GRJsonPatchChild *span = &ctx->spans.items[i];
+		size_t child = newNode(ctx, span->value, span->valueLength);
+		if (child == NO_NODE) {
+			return false;
+		}
+		setKey(ctx, child, span->key, span->keyLength, span->keyEscaped);
+		if (!insertChild(ctx, node, ctx->nodes[node].childCount, child)) {
+			return false;
+		}
+	}
+	ctx->nodes[node].expanded = ctx->nodes[node].bytes[0];
+	ctx->nodes[node].modified = modified;
+	return true;
+}
+
+/** the position of the (last) member of an expanded object with this name, or NO_NODE */
+static size_t findMember(GRJsonPatchContext *ctx, size_t object, const uint8_t *name, size_t nameLength, bool nameEscaped) {
+	name = decoded(name, &nameLength, nameEscaped, &ctx->right);
+	if (name == NULL) {
+		outOfMemory(ctx);
+		return NO_NODE;
+	}
+	const GRJsonPatchNode *o = &ctx->nodes[object];
+	size_t found = NO_NODE;
+	for (size_t i = 0; i < o->childCount; i++) {
+		const GRJsonPatchNode *member = &ctx->nodes[o->children[i]];
+		size_t keyLength = member->keyLength;
+		const uint8_t *key = decoded(member->key, &keyLength, member->keyEscaped, &ctx->left);
+		if (key && keyLength == nameLength && memcmp(key, name, nameLength) == 0) {
+			found = i;
+		}
+	}
+	return found;
+}
+
+static const GRJsonPatchToken *tokenAt(GRJsonPatchContext *ctx, size_t index) {
+	return &ctx->plan->tokens[index];
+}
+
+/** an array index token: digits without leading zeros, or "-" for the end when allowEnd is set */
+static bool arrayIndex(GRJsonPatchContext *ctx, const GRJsonPatchToken *token, size_t count, bool allowEnd, size_t *index) {
+	const uint8_t *name = ctx->plan->names + token->nameOffset;
+	if (allowEnd && token->nameLength == 1 && name[0] == '-') {
+		*index = count;
+		return true;
+	}
+	size_t value = 0;
+	bool valid = token->nameLength > 0 && token->nameLength <= 18 && !(name[0] == '0' && token->nameLength > 1);
+	for (size_t i = 0; valid && i < token->nameLength; i++) {
+		valid = name[i] >= '0' && name[i] <= '9';
+		value = value * 10 + (size_t)(name[i] - '0');
+	}
+	if (!valid || value > count || (value == count && !allowEnd)) {
+		return fail(ctx, GRJsonPatchErrorNoTarget, "operation %zu: '%.*s' is not an index into an array of %zu", ctx->opIndex, (int)token->nameLength, (const char *)name, count);
+	}
+	*index = value;
+	return true;
+}
+
+/** follows count tokens from the root, leaving the node at the end of them in *node */
+static bool resolve(GRJsonPatchContext *ctx, size_t first, size_t count, size_t *node) {
+	size_t current = ctx->root;
+	for (size_t i = 0; i < count; i++) {
+		const GRJsonPatchToken *token = tokenAt(ctx, first + i);
+		uint8_t type = containerType(&ctx->nodes[current]);
+		if (type == 0) {
+			return fail(ctx, GRJsonPatchErrorNoTarget, "operation %zu: there is no '%.*s' inside a value that is not an object or array", ctx->opIndex, (int)token->nameLength, (const char *)ctx->plan->names + token->nameOffset);
+		}
+		if (!expand(ctx, current)) {
+			return false;
+		}
+		size_t position;
+		if (type == '{') {
+			position = findMember(ctx, current, ctx->plan->names + token->nameOffset, token->nameLength, false);
+			if (position == NO_NODE) {
+				return fail(ctx, GRJsonPatchErrorNoTarget, "operation %zu: there is no member '%.*s'", ctx->opIndex, (int)token->nameLength, (const char *)ctx->plan->names + token->nameOffset);
+			}
+		}
+		else if (!arrayIndex(ctx, token, ctx->nodes[current].childCount, false, &position)) {
+			return false;
+		}
+		current = ctx->nodes[current].children[position];
+	}
+	*node = current;
+	return true;
+}
+
+/** resolves all but the last token to an expanded object or array */
+static bool resolveParent(GRJsonPatchContext *ctx, size_t first, size_t count, size_t *parent) {
+	if (!resolve(ctx, first, count - 1, parent)) {
+		return false;
+	}
+	if (containerType(&ctx->nodes[*parent]) == 0) {
+		const GRJsonPatchToken *token = tokenAt(ctx, first + count - 1);
+		return fail(ctx, GRJsonPatchErrorNoTarget, "operation %zu: there is no '%.*s' inside a value that is not an object or array", ctx->opIndex, (int)token->nameLength, (const char *)ctx->plan->names + token->nameOffset);
+	}
+	return expand(ctx, *parent);
+}
+
+/** puts node at the location, replacing an existing member or inserting into an array */
+static bool addNode(GRJsonPatchContext *ctx, size_t first, size_t count, size_t node) {
+	if (count == 0) {
+		ctx->root = node;
+		return true;
+	}
+	size_t parent;
+	if (!resolveParent(ctx, first, count, &parent)) {
+		return false;
+	}
+	const GRJsonPatchToken *token = tokenAt(ctx, first + count - 1);
+	if (ctx->nodes[parent].expanded == '{') {
+		setKey(ctx, node, ctx->plan->names + token->nameOffset, token->nameLength, false);
+		size_t position = findMember(ctx, parent, ctx->plan->names + token->nameOffset, token->nameLength, false);
+		if (position != NO_NODE) {
+			ctx->nodes[parent].children[position] = node;
+			ctx->nodes[parent].modified = true;
+			return true;
+		}
+		return ctx->error == GRJsonPatchErrorNone && insertChild(ctx, parent, ctx->nodes[parent].childCount, node);
+	}
+	size_t index;
+	if (!arrayIndex(ctx, token, ctx->nodes[parent].childCount, true, &index)) {
+		return false;
+	}
+	setKey(ctx, node, NULL, 0, false);
+	return insertChild(ctx, parent, index, node);
+}
+
+/** finds the parent and position of an existing value */
+static bool locate(GRJsonPatchContext *ctx, size_t first, size_t count, size_t *parent, size_t *position) {
+	if (!resolveParent(ctx, first, count, parent)) {
+		return false;
+	}
+	const GRJsonPatchToken *token = tokenAt(ctx, first + count - 1);
+	if (ctx->nodes[*parent].expanded == '{') {
+		*position = findMember(ctx, *parent, ctx->plan->names + token->nameOffset, token->nameLength, false);
+		return *position != NO_NODE || fail(ctx, GRJsonPatchErrorNoTarget, "operation %zu: there is no member '%.*s'", ctx->opIndex, (int)token->nameLength, (const char *)ctx->plan->names + token->nameOffset);
+	}
+	return arrayIndex(ctx, token, ctx->nodes[*parent].childCount, false, position);
+}
+
+static size_t cloneNode(GRJsonPatchContext *ctx, size_t node) {
+	size_t copy = newNode(ctx, ctx->nodes[node].bytes, ctx->nodes[node].length);
+	if (copy == NO_NODE) {
+		return NO_NODE;
+	}
+	ctx->nodes[copy].expanded = ctx->nodes[node].expanded;
+	for (size_t i = 0; i < ctx->nodes[node].childCount; i++) {
+		size_t child = ctx->nodes[node].children[i];
+		size_t childCopy = cloneNode(ctx, child);
+		if (childCopy == NO_NODE) {
+			return NO_NODE;
+		}
+		setKey(ctx, childCopy, ctx->nodes[child].key, ctx->nodes[child].keyLength, ctx->nodes[child].keyEscaped);
+		if (!insertChild(ctx, copy, i, childCopy)) {
+			return NO_NODE;
+		}
+	}
+	ctx->nodes[copy].modified = ctx->nodes[node].modified;
+	return copy;
+}
+
+#pragma mark - output
+
+/** true if node's text is still exactly its value: an edit only dirties the containers on its path */
+static bool isUnchanged(const GRJsonPatchContext *ctx, size_t node) {
+	const GRJsonPatchNode *n = &ctx->nodes[node];
+	if (n->modified) {
+		return false;
+	}
+	for (size_t i = 0; i < n->childCount; i++) {
+		if (!isUnchanged(ctx, n->children[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool emitNode(GRJsonPatchContext *ctx, GRJsonEmitter *out, size_t node) {
+	const GRJsonPatchNode *n = &ctx->nodes[node];
+	if (!n->expanded || isUnchanged(ctx, node)) {
+		return GRJsonEmitterRawValue(out, n->bytes, n->length);
+	}
+	bool isObject = (n->expanded == '{');
+	if (!(isObject ? GRJsonEmitterBeginObject(out) : GRJsonEmitterBeginArray(out))) {
+		return false;
+	}
+	for (size_t i = 0; i < ctx->nodes[node].childCount; i++) {
+		const GRJsonPatchNode *child = &ctx->nodes[ctx->nodes[node].children[i]];
+		if (isObject) {
+			size_t keyLength = child->keyLength;
+			const uint8_t *key = decoded(child->key, &keyLength, child->keyEscaped, &ctx->left);
+			if (key == NULL || !GRJsonEmitterKey(out, key, keyLength)) {
+				return false;
+			}
+		}
+		if (!emitNode(ctx, out, ctx->nodes[node].children[i])) {
+			return false;
+		}
+	}
+	return isObject ? GRJsonEmitterEndObject(out) : GRJsonEmitterEndArray(out);
+}
+
+#pragma mark - comparing
+
+static bool tapeStringsEqual(const GRJsonTape *a, size_t ia, const GRJsonTape *b, size_t ib) {
+	size_t lengthA, lengthB;
+	bool escapedA, escapedB;
+	const uint8_t *bytesA = GRJsonTapeStringAt(a, ia, &lengthA, &escapedA);
+	const uint8_t *bytesB = GRJsonTapeStringAt(b, ib, &lengthB, &escapedB);
+	if (!escapedA && !escapedB) {
+		return lengthA == lengthB && memcmp(bytesA, bytesB, lengthA) == 0;
+	}
+	uint8_t *decodedA = malloc(lengthA + lengthB + 1);
+	if (decodedA == NULL) {
+		return false;
+	}
+	uint8_t *decodedB = decodedA + lengthA;
+	size_t outA = escapedA ? GRJsonUnescape(bytesA, lengthA, decodedA) : lengthA;
+	size_t outB = escapedB ? GRJsonUnescape(bytesB, lengthB, decodedB) : lengthB;
+	bool equal = outA == outB && memcmp(escapedA ? decodedA : bytesA, escapedB ? decodedB : bytesB, outA) == 0;
+	free(decodedA);
+	return equal;
+}
+
+/** structural equality, as RFC 6902 defines it for test: member order does not matter, numbers compare by value */
+static bool tapeValuesEqual(const GRJsonTape *a, size_t ia, const GRJsonTape *b, size_t ib) {
+	GRJsonTapeType typeA = GRJsonTapeTypeAt(a, ia);
+	GRJsonTapeType typeB = GRJsonTapeTypeAt(b, ib);
+	bool numberA = typeA == GRJsonTapeInteger || typeA == GRJsonTapeDouble;
+	bool numberB = typeB == GRJsonTapeInteger || typeB == GRJsonTapeDouble;
+	if (numberA && numberB) {
+		if (typeA == GRJsonTapeInteger && typeB == GRJsonTapeInteger) {
+			return GRJsonTapeIntegerAt(a, ia) == GRJsonTapeIntegerAt(b, ib);
+		}
+		double valueA = typeA == GRJsonTapeInteger ? (double)GRJsonTapeIntegerAt(a, ia) : GRJsonTapeDoubleAt(a, ia);
+		double valueB = typeB == GRJsonTapeInteger ? (double)GRJsonTapeIntegerAt(b, ib) : GRJsonTapeDoubleAt(b, ib);
+		return valueA == valueB;
+	}
+	if (typeA != typeB) {
+		return false;
+	}
+	switch (typeA) {
+		case GRJsonTapeString:
+			return tapeStringsEqual(a, ia, b, ib);
+		case GRJsonTapeArray:
+		{
+			if (GRJsonTapeContainerCount(a, ia) != GRJsonTapeContainerCount(b, ib)) {
+				return false;
+			}
+			size_t endA = GRJsonTapePayloadAt(a, ia) - 1;
+			for (size_t ca = GRJsonTapeFirstChild(ia), cb = GRJsonTapeFirstChild(ib); ca < endA; ca = GRJsonTapeNext(a, ca), cb = GRJsonTapeNext(b, cb)) {
+				if (!tapeValuesEqual(a, ca, b, cb)) {
+					return false;
+				}
+			}
+			return true;
+		}
+		case GRJsonTapeObject:
+		{
+			if (GRJsonTapeContainerCount(a, ia) != GRJsonTapeContainerCount(b, ib)) {
+				return false;
+			}
+			size_t endA = GRJsonTapePayloadAt(a, ia) - 1;
+			size_t endB = GRJsonTapePayloadAt(b, ib) - 1;
+			for (size_t ka = GRJsonTapeFirstChild(ia); ka < endA; ka = GRJsonTapeNext(a, ka + 2)) {
+				bool found = false;
+				for (size_t kb = GRJsonTapeFirstChild(ib); kb < endB && !found; kb = GRJsonTapeNext(b, kb + 2)) {
+					found = tapeStringsEqual(a, ka, b, kb) && tapeValuesEqual(a, ka + 2, b, kb + 2);
+				}
+				if (!found) {
+					return false;
+				}
+			}
+			return true;
+		}
+		default:
+			// true, false and null
+			return true;
+	}
+}
+
+static bool valueEquals(GRJsonPatchContext *ctx, size_t node, const uint8_t *value, size_t valueLength, bool *equal) {
+	GRJsonEmitter text;
+	GRJsonEmitterInit(&text);
+	const uint8_t *bytes = ctx->nodes[node].bytes;
+	size_t length = ctx->nodes[node].length;
+	if (ctx->nodes[node].expanded) {
+		if (!emitNode(ctx, &text, node)) {
+			GRJsonEmitterDestroy(&text);
+			return outOfMemory(ctx);
+		}
+		bytes = text.buf;
+		length = text.length;
+	}
+	GRJsonTape a, b;
+	GRJsonTapeInit(&a);
+	GRJsonTapeInit(&b);
+	GRJsonError built = GRJsonTapeBuild(&a, &ctx->tokenizer, bytes, length);
+	if (built == GRJsonErrorNone) {
+		built = GRJsonTapeBuild(&b, &ctx->tokenizer, value, valueLength);
+	}
+	if (built == GRJsonErrorNone) {
+		*equal = tapeValuesEqual(&a, 0, &b, 0);
+	}
+	else if (built == GRJsonErrorOutOfMemory) {
+		outOfMemory(ctx);
+	}
+	else {
+		// a patch can nest values more deeply than the tokenizer allows
+		fail(ctx, GRJsonPatchErrorInvalidDocument, "operation %zu: %s", ctx->opIndex, ctx->tokenizer.errorMessage);
+	}
+	GRJsonTapeDestroy(&a);
+	GRJsonTapeDestroy(&b);
+	GRJsonEmitterDestroy(&text);
+	return built == GRJsonErrorNone;
+}
+
+#pragma mark - applying
+
+static bool tokensEqual(GRJsonPatchContext *ctx, size_t a, size_t b, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		const GRJsonPatchToken *ta = tokenAt(ctx, a + i);
+		const GRJsonPatchToken *tb = tokenAt(ctx, b + i);
+		if (ta->nameLength != tb->nameLength || memcmp(ctx->plan->names + ta->nameOffset, ctx->plan->names + tb->nameOffset, ta->nameLength) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool applyOp(GRJsonPatchContext *ctx, const GRJsonPatchOp *op) {
+	size_t parent, position, node;
+	switch (op->kind) {
+		case GRJsonPatchAdd:
+			node = newNode(ctx, op->value, op->valueLength);
+			return node != NO_NODE && addNode(ctx, op->pathFirst, op->pathCount, node);
+		case GRJsonPatchRemove:
+			if (op->pathCount == 0) {
+				return fail(ctx, GRJsonPatchErrorNoTarget, "operation %zu: the whole document cannot be removed", ctx->opIndex);
+			}
+			if (!locate(ctx, op->pathFirst, op->pathCount, &parent, &position)) {
+				return false;
+			}
+			removeChild(ctx, parent, position);
+			return true;
+		case GRJsonPatchReplace:
+			if (op->pathCount == 0) {
+				setText(ctx, ctx->root, op->value, op->valueLength);
+				return true;
+			}
+			if (!locate(ctx, op->pathFirst, op->pathCount, &parent, &position)) {
+				return false;
+			}
+			setText(ctx, ctx->nodes[parent].children[position], op->value, op->valueLength);
+			return true;
+		case GRJsonPatchMove:
+			if (op->fromCount == op->pathCount && tokensEqual(ctx, op->fromFirst, op->pathFirst, op->pathCount)) {
+				return resolve(ctx, op->pathFirst, op->pathCount, &node);
+			}
+			if (op->fromCount < op->pathCount && tokensEqual(ctx, op->fromFirst, op->pathFirst, op->fromCount)) {
+				return fail(ctx, GRJsonPatchErrorNoTarget, "operation %zu: a value cannot be moved into itself", ctx->opIndex);
+			}
+			if (op->fromCount == 0) {
+				return fail(ctx, GRJsonPatchErrorNoTarget, "operation %zu: the whole document cannot be moved", ctx->opIndex);
+			}
+			if (!locate(ctx, op->fromFirst, op->fromCount, &parent, &position)) {
+				return false;
+			}
+			node = ctx->nodes[parent].children[position];
+			removeChild(ctx, parent, position);
+			return addNode(ctx, op->pathFirst, op->pathCount, node);
+		case GRJsonPatchCopy:
+			if (!resolve(ctx, op->fromFirst, op->fromCount, &node)) {
+				return false;
+			}
+			node = cloneNode(ctx, node);
+			return node != NO_NODE && addNode(ctx, op->pathFirst, op->pathCount, node);
+		case GRJsonPatchTest:
+		{
+			bool equal = false;
+			if (!resolve(ctx, op->pathFirst, op->pathCount, &node) || !valueEquals(ctx, node, op->value, op->valueLength, &equal)) {
+				return false;
+			}
+			return equal || fail(ctx, GRJsonPatchErrorTestFailed, "operation %zu: test failed", ctx->opIndex);
+		}
+	}
+	return true;
+}
+
+/** RFC 7386 MergePatch(target, patch), with the patch's own members found the same way as the document's */
+static bool merge(GRJsonPatchContext *ctx, size_t target, const uint8_t *patch, size_t length) {
+	if (patch[0] != '{') {
+		setText(ctx, target, patch, length);
+		return true;
+	}
+	if (containerType(&ctx->nodes[target]) != '{') {
+		setText(ctx, target, (const uint8_t *)"{}", 2);
+	}
+	size_t members = newNode(ctx, patch, length);
+	if (members == NO_NODE || !expand(ctx, target) || !expand(ctx, members)) {
+		return false;
+	}
+	for (size_t i = 0; i < ctx->nodes[members].childCount; i++) {
+		GRJsonPatchNode member = ctx->nodes[ctx->nodes[members].children[i]];
+		size_t position = findMember(ctx, target, member.key, member.keyLength, member.keyEscaped);
+		if (ctx->error != GRJsonPatchErrorNone) {
+			return false;
+		}
+		if (member.bytes[0] == 'n') {
+			if (position != NO_NODE) {
+				removeChild(ctx, target, position);
+			}
+			continue;
+		}
+		size_t child;
+		if (position != NO_NODE) {
+			child = ctx->nodes[target].children[position];
+		}
+		else {
+			child = newNode(ctx, NULL, 0);
+			if (child == NO_NODE || !insertChild(ctx, target, ctx->nodes[target].childCount, child)) {
+				return false;
+			}
+			setKey(ctx, child, member.key, member.keyLength, member.keyEscaped);
+		}
+		if (!merge(ctx, child, member.bytes, member.length)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+GRJsonPatchError GRJsonPatchPlanApply(const GRJsonPatchPlan *plan, const uint8_t *document, size_t length, GRJsonEmitter *out, char *errorMessage, size_t errorMessageSize) {
+	GRJsonPatchContext context;
+	GRJsonPatchContext *ctx = &context;
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->plan = plan;
+	ctx->errorMessage = errorMessage;
+	ctx->errorMessageSize = errorMessageSize;
+	GRJsonValidation validation;
+	if (!GRJsonValidate(document, length, &validation)) {
+		fail(ctx, GRJsonPatchErrorInvalidDocument, "invalid document: %s at line %zu, column %zu", validation.message, validation.line, validation.column);
+		return ctx->error;
+	}
+	trim(&document, &length);
+	GRJsonTokenizerInit(&ctx->tokenizer);
+	GRJsonScratchInit(&ctx->left);
+	GRJsonScratchInit(&ctx->right);
+	ctx->root = newNode(ctx, document, length);
+	bool ok = ctx->root != NO_NODE;
+	if (ok && plan->format == GRJsonPatchFormatMergePatch) {
+		ok = merge(ctx, ctx->root, plan->mergePatch, plan->mergePatchLength);
+	}
+	for (size_t i = 0; ok && plan->format == GRJsonPatchFormatJSONPatch && i < plan->opCount; i++) {
+		ctx->opIndex = i;
+		ok = applyOp(ctx, &plan->ops[i]);
+	}
+	if (ok && !emitNode(ctx, out, ctx->root)) {
+		if (out->error == GRJsonEmitterErrorOutOfMemory) {
+			outOfMemory(ctx);
+		}
+		else {
+			fail(ctx, GRJsonPatchErrorOutput, "could not write the patched document");
+		}
+	}
+	for (size_t i = 0; i < ctx->nodeCount; i++) {
+		free(ctx->nodes[i].children);
+	}
+	free(ctx->nodes);
+	free(ctx->spans.items);
+	GRJsonScratchDestroy(&ctx->left);
+	GRJsonScratchDestroy(&ctx->right);
+	GRJsonTokenizerDestroy(&ctx->tokenizer);
+	return ctx->error;
+}
@@ -0,0 +1,112 @@
+//
+//  GRJsonPatchPlan.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonPatchPlan_h
+#define GRJsonPatchPlan_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GRJsonEmitter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum GRJsonPatchFormat {
+	GRJsonPatchFormatJSONPatch,  ///< RFC 6902: an array of add, remove, replace, move, copy and test operations
+	GRJsonPatchFormatMergePatch, ///< RFC 7386: a document to merge in, where null removes a member
+} GRJsonPatchFormat;
+
+typedef enum GRJsonPatchError {
+	GRJsonPatchErrorNone = 0,
+	GRJsonPatchErrorOutOfMemory,
+	GRJsonPatchErrorInvalidDocument, ///< the document is not valid JSON
+	GRJsonPatchErrorNoTarget,        ///< a path leads nowhere, or an index is out of range
+	GRJsonPatchErrorTestFailed,      ///< a test operation found a different value
+	GRJsonPatchErrorOutput,          ///< the emitter failed
+} GRJsonPatchError;
+
+typedef enum GRJsonPatchOpKind {
+	GRJsonPatchAdd,
+	GRJsonPatchRemove,
+	GRJsonPatchReplace,
+	GRJsonPatchMove,
+	GRJsonPatchCopy,
+	GRJsonPatchTest,
+} GRJsonPatchOpKind;
+
+/** One reference token of a JSON Pointer, with its escapes decoded. */
+typedef struct GRJsonPatchToken {
+	size_t nameOffset; ///< into the plan's name buffer
+	size_t nameLength;
+} GRJsonPatchToken;
+
+typedef struct GRJsonPatchOp {
+	GRJsonPatchOpKind kind;
+	size_t pathFirst;     ///< into the plan's tokens
+	size_t pathCount;
+	size_t fromFirst;
+	size_t fromCount;
+	const uint8_t *value; ///< the text of the value, in the patch
+	size_t valueLength;
+} GRJsonPatchOp;
+
+/**
+ * A compiled patch.  The patch text is validated and its operations and paths are decoded once; values are
+ * not parsed at all but kept as spans of the patch text, so the patch bytes must outlive the plan.
+ *
+ * Applying a plan never turns the document into a tree.  The document is validated, and then each
+ * operation works on a small overlay that only covers the objects and arrays on its path: each of those is
+ * split into the spans of its direct children (hopping over the children's own contents), and everything
+ * else stays a span of the original bytes.  The output is written by copying the untouched spans verbatim
+ * and re-encoding only the containers that were edited, so the cost is a pass over the document plus a
+ * little for each edit, whatever the document holds.
+ *
+ * Edited containers are written without whitespace; everything else keeps the document's formatting.
+ * A plan is immutable once compiled and can be applied on several threads at once.
+ */
+typedef struct GRJsonPatchPlan {
+	GRJsonPatchFormat format;
+	GRJsonPatchOp *ops;
+	size_t opCount;
+	size_t opCapacity;
+	GRJsonPatchToken *tokens;
+	size_t tokenCount;
+	size_t tokenCapacity;
+	uint8_t *names;
+	size_t namesLength;
+	size_t namesCapacity;
+	const uint8_t *mergePatch; ///< the whole patch, for GRJsonPatchFormatMergePatch
+	size_t mergePatchLength;
+} GRJsonPatchPlan;
+
+void GRJsonPatchPlanInit(GRJsonPatchPlan *plan);
+void GRJsonPatchPlanDestroy(GRJsonPatchPlan *plan);
+
+/**
+ * Compiles a patch into an empty plan.
+ *
+ * @return false, with a description in errorMessage, if the patch is not valid JSON or not a valid patch
+ */
+bool GRJsonPatchPlanCompile(GRJsonPatchPlan *plan, GRJsonPatchFormat format, const uint8_t *patch, size_t length, char *errorMessage, size_t errorMessageSize);
+
+/**
+ * Applies the plan to document, writing the patched document to out as one top-level value.  A JSON
+ * Patch is all or nothing: if an operation fails, nothing is written.
+ *
+ * @return GRJsonPatchErrorNone, or the reason the patch could not be applied, described in errorMessage
+ */
+GRJsonPatchError GRJsonPatchPlanApply(const GRJsonPatchPlan *plan, const uint8_t *document, size_t length, GRJsonEmitter *out, char *errorMessage, size_t errorMessageSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonPatchPlan_h */
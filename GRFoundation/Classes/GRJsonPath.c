@@ -0,0 +1,516 @@
+//
+//  GRJsonPath.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonPath.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#pragma mark - lifecycle
+
+void GRJsonPathSetInit(GRJsonPathSet *set) {
+	memset(set, 0, sizeof(*set));
+}
+
+void GRJsonPathSetDestroy(GRJsonPathSet *set) {
+	free(set->steps);
+	free(set->names);
+	memset(set, 0, sizeof(*set));
+}
+
+#pragma mark - compiling
+
+static bool failf(char *errorMessage, size_t errorMessageSize, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+static bool failf(char *errorMessage, size_t errorMessageSize, const char *fmt, ...) {
+	if (errorMessage && errorMessageSize) {
+		va_list argList;
+		va_start(argList, fmt);
+		vsnprintf(errorMessage, errorMessageSize, fmt, argList);
+		va_end(argList);
+	}
+	return false;
+}
+
+static GRJsonPathStep *addStep(GRJsonPathSet *set, GRJsonPathStepKind kind) {
+	if (set->stepCount == set->stepCapacity) {
+		size_t capacity = set->stepCapacity ? set->stepCapacity * 2 : 16;
+		GRJsonPathStep *steps = realloc(set->steps, capacity * sizeof(GRJsonPathStep));
+		if (steps == NULL) {
+			return NULL;
+		}
+		set->steps = steps;
+		set->stepCapacity = capacity;
+	}
+	GRJsonPathStep *step = &set->steps[set->stepCount++];
+	memset(step, 0, sizeof(*step));
+	step->kind = kind;
+	step->nameOffset = set->namesLength;
+	return step;
+}
+
+static bool appendName(GRJsonPathSet *set, GRJsonPathStep *step, const char *bytes, size_t length) {
+	if (set->namesLength + length > set->namesCapacity) {
+		size_t capacity = set->namesCapacity ? set->namesCapacity : 64;
+		while (capacity < set->namesLength + length) {
+			capacity *= 2;
+		}
+		uint8_t *names = realloc(set->names, capacity);
+		if (names == NULL) {
+			return false;
+		}
+		set->names = names;
+		set->namesCapacity = capacity;
+	}
+	memcpy(set->names + set->namesLength, bytes, length);
+	set->namesLength += length;
+	step->nameLength += length;
+	return true;
+}
+
+/** parses a run of digits as an array index; false if it has a leading zero or is too long to be one */
+static bool parseIndex(const char *p, size_t length, size_t *index) {
+	if (length == 0 || length > 18 || (length > 1 && p[0] == '0')) {
+		return false;
+	}
+	size_t value = 0;
+	for (size_t i = 0; i < length; i++) {
+		if (p[i] < '0' || p[i] > '9') {
+			return false;
+		}
+		value = value * 10 + (size_t)(p[i] - '0');
+	}
+	*index = value;
+	return true;
+}
+
+static bool compilePointer(GRJsonPathSet *set, const char *p, const char *end, char *errorMessage, size_t errorMessageSize) {
+	while (p < end) {
+		// p is at a '/'
+		const char *token = ++p;
+		while (p < end && *p != '/') {
+			p++;
+		}
+		size_t index;
+		bool isIndex = parseIndex(token, (size_t)(p - token), &index);
+		GRJsonPathStep *step = addStep(set, isIndex ? GRJsonPathStepKeyOrIndex : GRJsonPathStepKey);
+		if (step == NULL) {
+			return failf(errorMessage, errorMessageSize, "out of memory");
+		}
+		step->index = isIndex ? index : 0;
+		for (const char *c = token; c < p; c++) {
+			char decoded = *c;
+			if (*c == '~') {
+				if (c + 1 == p || (c[1] != '0' && c[1] != '1')) {
+					return failf(errorMessage, errorMessageSize, "invalid '~' escape in JSON Pointer at %ld", (long)(c - token));
+				}
+				decoded = c[1] == '0' ? '~' : '/';
+				c++;
+			}
+			if (!appendName(set, step, &decoded, 1)) {
+				return failf(errorMessage, errorMessageSize, "out of memory");
+			}
+		}
+	}
+	return true;
+}
+
+static bool compileDotted(GRJsonPathSet *set, const char *p, const char *end, char *errorMessage, size_t errorMessageSize) {
+	const char *start = p;
+	if (p < end && *p == '$') {
+		p++;
+		if (p < end && *p == '.') {
+			p++;
+		}
+	}
+	while (p < end) {
+		if (*p == '[') {
+			const char *close = memchr(p, ']', (size_t)(end - p));
+			if (close == NULL) {
+				return failf(errorMessage, errorMessageSize, "unterminated '[' at %ld", (long)(p - start));
+			}
+			GRJsonPathStep *step;
+			size_t index;
+			if (close - p == 2 && p[1] == '*') {
+				step = addStep(set, GRJsonPathStepWildcard);
+			}
+			else if (parseIndex(p + 1, (size_t)(close - p - 1), &index)) {
+				step = addStep(set, GRJsonPathStepIndex);
+				if (step) {
+					step->index = index;
+				}
+			}
+			else {
+				return failf(errorMessage, errorMessageSize, "expected an index or '*' inside '[]' at %ld", (long)(p - start));
+			}
+			if (step == NULL) {
+				return failf(errorMessage, errorMessageSize, "out of memory");
+			}
+			p = close + 1;
+			if (p < end && *p == '.') {
+				p++;
+			}
+			continue;
+		}
+		const char *name = p;
+		while (p < end && *p != '.' && *p != '[') {
+			p++;
+		}
+		if (p == name) {
+			return failf(errorMessage, errorMessageSize, "empty name at %ld", (long)(p - start));
+		}
+		GRJsonPathStep *step;
+		if (p - name == 1 && *name == '*') {
+			step = addStep(set, GRJsonPathStepWildcard);
+		}
+		else {
+			step = addStep(set, GRJsonPathStepKey);
+			if (step && !appendName(set, step, name, (size_t)(p - name))) {
+				step = NULL;
+			}
+		}
+		if (step == NULL) {
+			return failf(errorMessage, errorMessageSize, "out of memory");
+		}
+		if (p < end && *p == '.') {
+			p++;
+			if (p == end) {
+				return failf(errorMessage, errorMessageSize, "trailing '.'");
+			}
+		}
+	}
+	return true;
+}
+
+bool GRJsonPathSetAdd(GRJsonPathSet *set, const char *pattern, size_t length, char *errorMessage, size_t errorMessageSize) {
+	if (set->patternCount == GRJSON_PATH_MAX_PATTERNS) {
+		return failf(errorMessage, errorMessageSize, "too many patterns (the limit is %d)", GRJSON_PATH_MAX_PATTERNS);
+	}
+	size_t firstStep = set->stepCount;
+	size_t namesLength = set->namesLength;
+	const char *end = pattern + length;
+	bool ok = length > 0 && pattern[0] != '/' ? compileDotted(set, pattern, end, errorMessage, errorMessageSize) : compilePointer(set, pattern, end, errorMessage, errorMessageSize);
+	if (!ok) {
+		set->stepCount = firstStep;
+		set->namesLength = namesLength;
+		return false;
+	}
+	GRJsonPathPattern *compiled = &set->patterns[set->patternCount++];
+	compiled->firstStep = firstStep;
+	compiled->stepCount = set->stepCount - firstStep;
+	return true;
+}
+
+#pragma mark - matching
+
+static inline unsigned hexValue(uint8_t c) {
+	if (c <= '9') {
+		return c - '0';
+	}
+	return (c | 0x20) - 'a' + 10;
+}
+
+/** decodes the escape at bytes[*pos] (which is a backslash) into UTF-8, returning the number of bytes written */
+static size_t decodeEscape(const uint8_t *bytes, size_t length, size_t *pos, uint8_t out[4]) {
+	size_t p = *pos + 1;
+	uint8_t c = bytes[p++];
+	size_t written = 1;
+	switch (c) {
+		case 'b': out[0] = '\b'; break;
+		case 'f': out[0] = '\f'; break;
+		case 'n': out[0] = '\n'; break;
+		case 'r': out[0] = '\r'; break;
+		case 't': out[0] = '\t'; break;
+		case 'u':
+		{
+			uint32_t cp = (hexValue(bytes[p]) << 12) | (hexValue(bytes[p + 1]) << 8) | (hexValue(bytes[p + 2]) << 4) | hexValue(bytes[p + 3]);
+			p += 4;
+			if (cp >= 0xD800 && cp < 0xDC00 && p + 6 <= length && bytes[p] == '\\' && bytes[p + 1] == 'u') {
+				uint32_t low = (hexValue(bytes[p + 2]) << 12) | (hexValue(bytes[p + 3]) << 8) | (hexValue(bytes[p + 4]) << 4) | hexValue(bytes[p + 5]);
+				if (low >= 0xDC00 && low < 0xE000) {
+					cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+					p += 6;
+				}
+			}
+			if (cp < 0x80) {
+				out[0] = (uint8_t)cp;
+			}
+			else if (cp < 0x800) {
+				out[0] = (uint8_t)(0xC0 | (cp >> 6));
+				out[1] = (uint8_t)(0x80 | (cp & 0x3F));
+				written = 2;
+			}
+			else if (cp < 0x10000) {
+				out[0] = (uint8_t)(0xE0 | (cp >> 12));
+				out[1] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+				out[2] = (uint8_t)(0x80 | (cp & 0x3F));
+				written = 3;
+			}
+			else {
+				out[0] = (uint8_t)(0xF0 | (cp >> 18));
+				out[1] = (uint8_t)(0x80 | ((cp >> 12) & 0x3F));
+				out[2] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+				out[3] = (uint8_t)(0x80 | (cp & 0x3F));
+				written = 4;
+			}
+			break;
+		}
+		default: out[0] = c; break;
+	}
+	*pos = p;
+	return written;
+}
+
+/** compares an escaped key with a plain name without decoding the whole key first */
+static bool escapedKeyEquals(const uint8_t *key, size_t length, const uint8_t *name, size_t nameLength) {
+	size_t pos = 0, matched = 0;
+	while (pos < length) {
+		if (key[pos] != '\\') {
+			if (matched == nameLength || key[pos] != name[matched]) {
+				return false;
+			}
+			pos++;
+			matched++;
+			continue;
+		}
+		uint8_t decoded[4];
+		size_t n = decodeEscape(key, length, &pos, decoded);
+		if (matched + n > nameLength || memcmp(decoded, name + matched, n) != 0) {
+			return false;
+		}
+		matched += n;
+	}
+	return matched == nameLength;
+}
+
+uint64_t GRJsonPathSetCompleteAt(const GRJsonPathSet *set, uint64_t alive, size_t depth) {
+	uint64_t complete = 0;
+	for (uint64_t bits = alive; bits; bits &= bits - 1) {
+		unsigned i = (unsigned)__builtin_ctzll(bits);
+		if (set->patterns[i].stepCount == depth) {
+			complete |= 1ULL << i;
+		}
+	}
+	return complete;
+}
+
+uint64_t GRJsonPathSetMatchKey(const GRJsonPathSet *set, uint64_t alive, size_t depth, const uint8_t *key, size_t length, bool hasEscapes) {
+	uint64_t matched = 0;
+	for (uint64_t bits = alive; bits; bits &= bits - 1) {
+		unsigned i = (unsigned)__builtin_ctzll(bits);
+		const GRJsonPathPattern *pattern = &set->patterns[i];
+		if (pattern->stepCount <= depth) {
+			continue;
+		}
+		const GRJsonPathStep *step = &set->steps[pattern->firstStep + depth];
+		bool match;
+		switch (step->kind) {
+			case GRJsonPathStepWildcard:
+				match = true;
+				break;
+			case GRJsonPathStepIndex:
+				match = false;
+				break;
+			default:
+			{
+				const uint8_t *name = set->names + step->nameOffset;
+				if (hasEscapes) {
+					match = escapedKeyEquals(key, length, name, step->nameLength);
+				}
+				else {
+					match = step->nameLength == length && memcmp(name, key, length) == 0;
+				}
+				break;
+			}
+		}
+		if (match) {
+			matched |= 1ULL << i;
+		}
+	}
+	return matched;
+}
+
+uint64_t GRJsonPathSetMatchIndex(const GRJsonPathSet *set, uint64_t alive, size_t depth, size_t index) {
+	uint64_t matched = 0;
+	for (uint64_t bits = alive; bits; bits &= bits - 1) {
+		unsigned i = (unsigned)__builtin_ctzll(bits);
+		const GRJsonPathPattern *pattern = &set->patterns[i];
+		if (pattern->stepCount <= depth) {
+			continue;
+		}
+		const GRJsonPathStep *step = &set->steps[pattern->firstStep + depth];
+		if (step->kind == GRJsonPathStepWildcard || (step->kind != GRJsonPathStepKey && step->index == index)) {
+			matched |= 1ULL << i;
+		}
+	}
+	return matched;
+}
+
+#pragma mark - selecting
+
+void GRJsonSelectorInit(GRJsonSelector *s, const GRJsonPathSet *set) {
+	memset(s, 0, sizeof(*s));
+	s->set = set;
+}
+
+void GRJsonSelectorDestroy(GRJsonSelector *s) {
+	free(s->frames);
+	free(s->pendingKey);
+	s->frames = NULL;
+	s->pendingKey = NULL;
+	s->capacity = 0;
+	s->pendingKeyCapacity = 0;
+}
+
+void GRJsonSelectorReset(GRJsonSelector *s) {
+	s->depth = 0;
+	s->pendingAlive = 0;
+	s->pendingEmitAll = false;
+	s->hasPendingKey = false;
+	s->hasQueuedToken = false;
+}
+
+static bool pushFrame(GRJsonSelector *s, uint64_t alive, bool isArray, bool emitAll) {
+	if (s->depth == s->capacity) {
+		size_t capacity = s->capacity ? s->capacity * 2 : 32;
+		GRJsonSelectFrame *frames = realloc(s->frames, capacity * sizeof(GRJsonSelectFrame));
+		if (frames == NULL) {
+			return false;
+		}
+		s->frames = frames;
+		s->capacity = capacity;
+	}
+	GRJsonSelectFrame *frame = &s->frames[s->depth++];
+	frame->alive = alive;
+	frame->nextIndex = 0;
+	frame->isArray = isArray;
+	frame->emitAll = emitAll;
+	return true;
+}
+
+static bool holdKey(GRJsonSelector *s, const GRJsonToken *token) {
+	if (token->length > s->pendingKeyCapacity) {
+		size_t capacity = s->pendingKeyCapacity ? s->pendingKeyCapacity : 64;
+		while (capacity < token->length) {
+			capacity *= 2;
+		}
+		uint8_t *key = realloc(s->pendingKey, capacity);
+		if (key == NULL) {
+			return false;
+		}
+		s->pendingKey = key;
+		s->pendingKeyCapacity = capacity;
+	}
+	if (token->length) {
+		memcpy(s->pendingKey, token->bytes, token->length);
+	}
+	s->pendingKeyLength = token->length;
+	s->pendingKeyHasEscapes = token->hasEscapes;
+	s->pendingKeyOffset = token->offset;
+	s->hasPendingKey = true;
+	return true;
+}
+
+static GRJsonStatus outOfMemory(GRJsonTokenizer *t, uint64_t offset) {
+	t->error = GRJsonErrorOutOfMemory;
+	t->errorOffset = offset;
+	snprintf(t->errorMessage, sizeof(t->errorMessage), "out of memory");
+	return GRJsonStatusError;
+}
+
+GRJsonStatus GRJsonSelectorNext(GRJsonSelector *s, GRJsonTokenizer *t, GRJsonToken *token) {
+	if (s->hasQueuedToken) {
+		s->hasQueuedToken = false;
+		*token = s->queuedToken;
+		return GRJsonStatusToken;
+	}
+	const GRJsonPathSet *set = s->set;
+	GRJsonStatus status;
+	while ((status = GRJsonTokenizerNext(t, token)) == GRJsonStatusToken) {
+		size_t depth = s->depth;
+		GRJsonSelectFrame *frame = depth ? &s->frames[depth - 1] : NULL;
+		switch (token->type) {
+			case GRJsonTokenObjectEnd:
+			case GRJsonTokenArrayEnd:
+				// only containers that were returned are ever closed here; skipped ones end inside the tokenizer
+				s->depth--;
+				return GRJsonStatusToken;
+			case GRJsonTokenKey:
+			{
+				s->hasPendingKey = false;
+				if (frame->emitAll) {
+					s->pendingAlive = 0;
+					s->pendingEmitAll = true;
+					return GRJsonStatusToken;
+				}
+				uint64_t alive = GRJsonPathSetMatchKey(set, frame->alive, depth - 1, token->bytes, token->length, token->hasEscapes);
+				s->pendingAlive = alive;
+				s->pendingEmitAll = GRJsonPathSetCompleteAt(set, alive, depth) != 0;
+				if (s->pendingEmitAll) {
+					return GRJsonStatusToken;
+				}
+				if (alive && !holdKey(s, token)) {
+					return outOfMemory(t, token->offset);
+				}
+				continue;
+			}
+			default:
+			{
+				uint64_t alive;
+				bool emitAll;
+				bool hadPendingKey = false;
+				if (frame == NULL) {
+					alive = GRJsonPathSetAllPatterns(set);
+					emitAll = GRJsonPathSetCompleteAt(set, alive, 0) != 0;
+				}
+				else if (frame->isArray) {
+					size_t index = frame->nextIndex++;
+					if (frame->emitAll) {
+						alive = 0;
+						emitAll = true;
+					}
+					else {
+						alive = GRJsonPathSetMatchIndex(set, frame->alive, depth - 1, index);
+						emitAll = GRJsonPathSetCompleteAt(set, alive, depth) != 0;
+					}
+				}
+				else {
+					alive = s->pendingAlive;
+					emitAll = s->pendingEmitAll;
+					hadPendingKey = s->hasPendingKey;
+					s->hasPendingKey = false;
+				}
+				bool isContainer = token->type == GRJsonTokenObjectBegin || token->type == GRJsonTokenArrayBegin;
+				if (!emitAll && !(isContainer && alive)) {
+					if (isContainer) {
+						GRJsonTokenizerSkipContainer(t);
+					}
+					continue;
+				}
+				if (isContainer && !pushFrame(s, alive, token->type == GRJsonTokenArrayBegin, emitAll)) {
+					return outOfMemory(t, token->offset);
+				}
+				if (hadPendingKey) {
+					// deliver the held key now, and the container right after it
+					s->queuedToken = *token;
+					s->queuedToken.bytes = (const uint8_t *)(token->type == GRJsonTokenObjectBegin ? "{" : "[");
+					s->hasQueuedToken = true;
+					token->type = GRJsonTokenKey;
+					token->bytes = s->pendingKey;
+					token->length = s->pendingKeyLength;
+					token->hasEscapes = s->pendingKeyHasEscapes;
+					token->offset = s->pendingKeyOffset;
+				}
+				return GRJsonStatusToken;
+			}
+		}
+	}
+	return status;
+}
@@ -0,0 +1,137 @@
+//
+//  GRJsonPath.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonPath_h
+#define GRJsonPath_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GRJsonTokenizer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GRJSON_PATH_MAX_PATTERNS 64
+
+typedef enum GRJsonPathStepKind {
+	GRJsonPathStepKey,        ///< an object member with this name
+	GRJsonPathStepIndex,      ///< an array element at this index
+	GRJsonPathStepKeyOrIndex, ///< a JSON Pointer token made of digits, which may name either
+	GRJsonPathStepWildcard,   ///< any member or element
+} GRJsonPathStepKind;
+
+typedef struct GRJsonPathStep {
+	GRJsonPathStepKind kind;
+	size_t nameOffset; ///< into the set's name buffer
+	size_t nameLength;
+	size_t index;
+} GRJsonPathStep;
+
+typedef struct GRJsonPathPattern {
+	size_t firstStep;
+	size_t stepCount;
+} GRJsonPathPattern;
+
+/**
+ * A compiled set of up to GRJSON_PATH_MAX_PATTERNS path patterns, matched against a document one level at
+ * a time.  The state for a position in the document is a bitmask of the patterns that are still alive
+ * there, so deciding what to do with a member or element is a handful of compares and never allocates.
+ *
+ * Two spellings are accepted:
+ *   - a JSON Pointer (RFC 6901), "/data/items/0/id", where a token of digits matches an array index or an
+ *     object member of that name and "~1" and "~0" stand for '/' and '~'.  "" selects the whole document.
+ *   - a dotted path, "data.items[*].id" (optionally starting with "$."), where "*" or "[*]" matches
+ *     any member or element and "[n]" matches one element.
+ */
+typedef struct GRJsonPathSet {
+	GRJsonPathPattern patterns[GRJSON_PATH_MAX_PATTERNS];
+	size_t patternCount;
+	GRJsonPathStep *steps;
+	size_t stepCount;
+	size_t stepCapacity;
+	uint8_t *names;
+	size_t namesLength;
+	size_t namesCapacity;
+} GRJsonPathSet;
+
+void GRJsonPathSetInit(GRJsonPathSet *set);
+void GRJsonPathSetDestroy(GRJsonPathSet *set);
+
+/**
+ * Compiles one pattern into the set.
+ *
+ * @return false, with a description in errorMessage, if the pattern is malformed or the set is full
+ */
+bool GRJsonPathSetAdd(GRJsonPathSet *set, const char *pattern, size_t length, char *errorMessage, size_t errorMessageSize);
+
+/** The mask of every pattern in the set, which is the state at the root. */
+static inline uint64_t GRJsonPathSetAllPatterns(const GRJsonPathSet *set) {
+	return set->patternCount == GRJSON_PATH_MAX_PATTERNS ? UINT64_MAX : ((1ULL << set->patternCount) - 1);
+}
+
+/** The patterns in alive that end exactly at depth (depth 0 being the root). */
+uint64_t GRJsonPathSetCompleteAt(const GRJsonPathSet *set, uint64_t alive, size_t depth);
+
+/**
+ * The patterns in alive (the state of an object at depth) that still match after stepping into the member
+ * named key.  The key is the raw body of a JSON string, escaped if hasEscapes is set.
+ */
+uint64_t GRJsonPathSetMatchKey(const GRJsonPathSet *set, uint64_t alive, size_t depth, const uint8_t *key, size_t length, bool hasEscapes);
+
+/** The patterns in alive (the state of an array at depth) that still match after stepping into element index. */
+uint64_t GRJsonPathSetMatchIndex(const GRJsonPathSet *set, uint64_t alive, size_t depth, size_t index);
+
+typedef struct GRJsonSelectFrame {
+	uint64_t alive;   ///< patterns that can still match somewhere inside this container
+	size_t nextIndex; ///< for arrays, the index of the next element
+	bool isArray;
+	bool emitAll;     ///< a pattern matched this container (or an ancestor), so everything inside is wanted
+} GRJsonSelectFrame;
+
+/**
+ * Filters a tokenizer's output down to the parts of the document a GRJsonPathSet selects.  The result is
+ * still a well-formed token stream: the matched values, plus the objects, arrays and keys that lead to them,
+ * so a delegate that builds a tree ends up with the original document pruned to the selected paths.
+ *
+ * An object or array that no pattern can match is skipped with GRJsonTokenizerSkipContainer, so none of its
+ * contents are tokenized.  Unselected scalars are tokenized (which only finds their bounds) and dropped.
+ */
+typedef struct GRJsonSelector {
+	const GRJsonPathSet *set;
+	GRJsonSelectFrame *frames;
+	size_t depth;
+	size_t capacity;
+	uint64_t pendingAlive;   ///< state for the value of the key that was just read
+	bool pendingEmitAll;
+	bool hasPendingKey;      ///< a key that leads towards a match is held until its value turns out to be a container
+	bool pendingKeyHasEscapes;
+	uint8_t *pendingKey;
+	size_t pendingKeyLength;
+	size_t pendingKeyCapacity;
+	uint64_t pendingKeyOffset;
+	bool hasQueuedToken;
+	GRJsonToken queuedToken;
+} GRJsonSelector;
+
+void GRJsonSelectorInit(GRJsonSelector *s, const GRJsonPathSet *set);
+void GRJsonSelectorDestroy(GRJsonSelector *s);
+
+/** Resets to the start of a new document, keeping any memory that was already allocated. */
+void GRJsonSelectorReset(GRJsonSelector *s);
+
+/** Like GRJsonTokenizerNext, but only returns the selected tokens. */
+GRJsonStatus GRJsonSelectorNext(GRJsonSelector *s, GRJsonTokenizer *t, GRJsonToken *token);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonPath_h */
@@ -0,0 +1,60 @@
+//
+//  GRJsonQuery.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class GRJsonDocument;
+
+/**
+ A compiled JSONPath query, such as "$.orders[?(@.total > 100)].id".  See GRJsonQueryPlan.h for the
+ supported subset: members, wildcards, recursive descent, indexes, slices and simple filters.
+
+ The query is compiled once and can then be run against any number of documents, from any number of threads.
+ It runs over the document's tape (see GRJsonTape.h), hopping over every subtree that is not on the query's
+ path, so only the matching values ever become Foundation objects.
+ */
+@interface GRJsonQuery : NSObject
+
++ (instancetype) queryWithString:(NSString *)query error:(NSError *__autoreleasing *)error;
+
+/**
+ Compiles a query.
+
+ @param query the JSONPath, starting with '$'
+ @param error an out pointer that describes where the query is malformed
+ @return the query, or nil if it could not be compiled
+ */
+- (instancetype) initWithString:(NSString *)query error:(NSError *__autoreleasing *)error;
+
+@property (nonatomic, readonly, copy) NSString *queryString;
+
+/**
+ Runs the query over JSON bytes.
+
+ @param data the JSON document
+ @param error an out pointer that holds the parse error, if any
+ @return the matching values in document order (an empty array if nothing matches), or nil if data is not valid JSON
+ */
+- (NSArray *) resultsForData:(NSData *)data error:(NSError *__autoreleasing *)error;
+
+/** Runs the query over an already parsed document.  Containers come back as the document's lazy views. */
+- (NSArray *) resultsInDocument:(GRJsonDocument *)document;
+
+/**
+ Runs the query over many documents concurrently with dispatch_apply, in contiguous runs of documents that
+ each reuse one tape and one set of working memory.
+
+ @param documents the JSON documents
+ @param block called on the worker thread right after each document has been queried, with its index, its
+        results (nil if the document could not be parsed) and the parse error.  Documents of one run arrive
+        in order, but runs proceed concurrently.  Set *stop to YES to stop early.
+ @return the number of documents that were queried
+ */
+- (NSUInteger) enumerateResultsForDocuments:(NSArray<NSData *> *)documents usingBlock:(void (^)(NSUInteger index, NSArray *results, NSError *error, BOOL *stop))block;
+
+@end
@@ -0,0 +1,209 @@
+//
+//  GRJsonQuery.m
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import "GRJsonQuery.h"
+#import "GRJson.h"
+#import "GRJsonContainers.h"
+#import "GRJsonDocument.h"
+#import "GRJsonQueryPlan.h"
+#import "GRJsonTape.h"
+#import "JsonSupport.h"
+
+@interface GRJsonDocument (GRJsonQuery)
+
+- (GRJsonTape *) tape;
+- (id) objectAtTapeIndex:(size_t)index;
+
+@end
+
+/** builds the Foundation objects for one matched value, and nothing else on the tape */
+static id objectAtTapeIndex(const GRJsonTape *tape, size_t index, GRJsonScratch *scratch) {
+	switch (GRJsonTapeTypeAt(tape, index)) {
+		case GRJsonTapeObject:
+		case GRJsonTapeArray:
+		{
+			BOOL isObject = GRJsonTapeTypeAt(tape, index) == GRJsonTapeObject;
+			size_t count = GRJsonTapeContainerCount(tape, index);
+			__strong id *values = (__strong id *)calloc(count ? count * 2 : 1, sizeof(id));
+			if (values == NULL) {
+				return nil;
+			}
+			__strong id *keys = values + count;
+			size_t child = GRJsonTapeFirstChild(index);
+			for (size_t i = 0; i < count; i++) {
+				if (isObject) {
+					keys[i] = objectAtTapeIndex(tape, child, scratch);
+					child += 2;
+				}
+				values[i] = objectAtTapeIndex(tape, child, scratch) ?: [NSNull null];
+				child = GRJsonTapeNext(tape, child);
+			}
+			id container = isObject ? [GRJsonCompactDictionary dictionaryForObjects:values keys:keys count:count] : [GRJsonCompactArray arrayForObjects:values count:count];
+			for (size_t i = 0; i < count * 2; i++) {
+				values[i] = nil;
+			}
+			free(values);
+			return container;
+		}
+		case GRJsonTapeString:
+		{
+			size_t length;
+			bool hasEscapes;
+			const uint8_t *bytes = GRJsonTapeStringAt(tape, index, &length, &hasEscapes);
+			return [GRJson stringWithBytes:bytes length:length needsUnescape:hasEscapes ascii:NO scratch:scratch] ?: @"";
+		}
+		case GRJsonTapeInteger:
+			return @(GRJsonTapeIntegerAt(tape, index));
+		case GRJsonTapeDouble:
+			return @(GRJsonTapeDoubleAt(tape, index));
+		case GRJsonTapeTrue:
+			return @YES;
+		case GRJsonTapeFalse:
+			return @NO;
+		default:
+			return [NSNull null];
+	}
+}
+
+@interface GRJsonQuery ()
+{
+	GRJsonQueryPlan plan;
+}
+
+@end
+
+@implementation GRJsonQuery
+
+@synthesize queryString;
+
++ (instancetype) queryWithString:(NSString *)query error:(NSError *__autoreleasing *)error {
+	return [[self alloc] initWithString:query error:error];
+}
+
+- (instancetype) initWithString:(NSString *)query error:(NSError *__autoreleasing *)error {
+	self = [super init];
+	if (self) {
+		GRJsonQueryPlanInit(&plan);
+		char message[160];
+		const char *utf8 = query.UTF8String ?: "";
+		if (!GRJsonQueryPlanCompile(&plan, utf8, strlen(utf8), message, sizeof(message))) {
+			if (error) {
+				*error = GRJsonErrorWithReason(@"GRJsonParser", [NSString stringWithFormat:@"invalid query '%@': %s", query, message]);
+			}
+			return nil;
+		}
+		queryString = [query copy];
+	}
+	return self;
+}
+
+- (void) dealloc {
+	GRJsonQueryPlanDestroy(&plan);
+}
+
+/**
+ Parses data into tape and evaluates the plan into run, materializing the matches.  The tape, tokenizer and
+ run keep their memory for the next document.
+ */
+- (NSArray *) resultsForData:(NSData *)data tape:(GRJsonTape *)tape tokenizer:(GRJsonTokenizer *)tokenizer run:(GRJsonQueryRun *)run error:(NSError *__autoreleasing *)error {
+	GRJsonError result = GRJsonTapeBuild(tape, tokenizer, (const uint8_t *)data.bytes, data.length);
+	if (result != GRJsonErrorNone) {
+		if (error) {
+			NSString *reason = result == GRJsonErrorOutOfMemory ? @"out of memory" : ([NSString stringWithUTF8String:tokenizer->errorMessage] ?: @"invalid JSON");
+			*error = GRJsonErrorWithReason(@"GRJsonParser", reason);
+		}
+		return nil;
+	}
+	if (!GRJsonQueryPlanEvaluate(&plan, tape, run)) {
+		if (error) {
+			*error = GRJsonErrorWithReason(@"GRJsonParser", @"out of memory");
+		}
+		return nil;
+	}
+	NSMutableArray *results = [NSMutableArray arrayWithCapacity:run->matches.count];
+	for (size_t i = 0; i < run->matches.count; i++) {
+		id value = objectAtTapeIndex(tape, run->matches.indexes[i], &run->left);
+		if (value == nil) {
+			if (error) {
+				*error = GRJsonErrorWithReason(@"GRJsonParser", @"out of memory");
+			}
+			return nil;
+		}
+		[results addObject:value];
+	}
+	return results;
+}
+
+- (NSArray *) resultsForData:(NSData *)data error:(NSError *__autoreleasing *)error {
+	GRJsonTape tape;
+	GRJsonTokenizer tokenizer;
+	GRJsonQueryRun run;
+	GRJsonTapeInit(&tape);
+	GRJsonTokenizerInit(&tokenizer);
+	GRJsonQueryRunInit(&run);
+	NSArray *results = [self resultsForData:data tape:&tape tokenizer:&tokenizer run:&run error:error];
+	GRJsonQueryRunDestroy(&run);
+	GRJsonTokenizerDestroy(&tokenizer);
+	GRJsonTapeDestroy(&tape);
+	return results;
+}
+
+- (NSArray *) resultsInDocument:(GRJsonDocument *)document {
+	GRJsonQueryRun run;
+	GRJsonQueryRunInit(&run);
+	NSMutableArray *results = nil;
+	if (GRJsonQueryPlanEvaluate(&plan, [document tape], &run)) {
+		results = [NSMutableArray arrayWithCapacity:run.matches.count];
+		for (size_t i = 0; i < run.matches.count; i++) {
+			[results addObject:[document objectAtTapeIndex:run.matches.indexes[i]]];
+		}
+	}
+	GRJsonQueryRunDestroy(&run);
+	return results;
+}
+
+- (NSUInteger) enumerateResultsForDocuments:(NSArray<NSData *> *)documents usingBlock:(void (^)(NSUInteger, NSArray *, NSError *, BOOL *))block {
+	size_t count = documents.count;
+	if (count == 0) {
+		return 0;
+	}
+	// the same striping as +[GRJson parseJSONLines:delegateFactory:recordHandler:]
+	size_t stripes = MIN(count, (size_t)[NSProcessInfo processInfo].activeProcessorCount * 4);
+	bool stopped = false;
+	size_t queried = 0;
+	bool *stoppedPtr = &stopped;
+	size_t *queriedPtr = &queried;
+	dispatch_apply(stripes, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t stripe) {
+		size_t first = count * stripe / stripes;
+		size_t end = count * (stripe + 1) / stripes;
+		GRJsonTape tape;
+		GRJsonTokenizer tokenizer;
+		GRJsonQueryRun run;
+		GRJsonTapeInit(&tape);
+		GRJsonTokenizerInit(&tokenizer);
+		GRJsonQueryRunInit(&run);
+		for (size_t i = first; i < end && !__atomic_load_n(stoppedPtr, __ATOMIC_RELAXED); i++) {
+			@autoreleasepool {
+				NSError *error = nil;
+				NSArray *results = [self resultsForData:documents[i] tape:&tape tokenizer:&tokenizer run:&run error:&error];
+				__atomic_add_fetch(queriedPtr, 1, __ATOMIC_RELAXED);
+				BOOL stop = NO;
+				block(i, results, error, &stop);
+				if (stop) {
+					__atomic_store_n(stoppedPtr, true, __ATOMIC_RELAXED);
+				}
+			}
+		}
+		GRJsonQueryRunDestroy(&run);
+		GRJsonTokenizerDestroy(&tokenizer);
+		GRJsonTapeDestroy(&tape);
+	});
+	return queried;
+}
+
+@end
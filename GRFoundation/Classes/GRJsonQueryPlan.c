@@ -0,0 +1,917 @@
+//
+//  GRJsonQueryPlan.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonQueryPlan.h"
+#include "GRJsonNumber.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_NODE SIZE_MAX
+
+#pragma mark - lifecycle
+
+void GRJsonQueryPlanInit(GRJsonQueryPlan *plan) {
+	memset(plan, 0, sizeof(*plan));
+}
+
+void GRJsonQueryPlanDestroy(GRJsonQueryPlan *plan) {
+	free(plan->steps);
+	free(plan->exprs);
+	free(plan->members);
+	free(plan->names);
+	memset(plan, 0, sizeof(*plan));
+}
+
+void GRJsonQueryRunInit(GRJsonQueryRun *run) {
+	memset(run, 0, sizeof(*run));
+	GRJsonScratchInit(&run->left);
+	GRJsonScratchInit(&run->right);
+}
+
+void GRJsonQueryRunDestroy(GRJsonQueryRun *run) {
+	free(run->matches.indexes);
+	free(run->next.indexes);
+	GRJsonScratchDestroy(&run->left);
+	GRJsonScratchDestroy(&run->right);
+	memset(run, 0, sizeof(*run));
+}
+
+/** makes room for one more item in a growing array */
+static bool reserveOne(void **items, size_t *capacity, size_t count, size_t itemSize) {
+	if (count < *capacity) {
+		return true;
+	}
+	size_t newCapacity = *capacity ? *capacity * 2 : 16;
+	void *grown = realloc(*items, newCapacity * itemSize);
+	if (grown == NULL) {
+		return false;
+	}
+	*items = grown;
+	*capacity = newCapacity;
+	return true;
+}
+
+#pragma mark - compiling
+
+typedef struct GRJsonQueryParser {
+	GRJsonQueryPlan *plan;
+	const char *start;
+	const char *p;
+	const char *end;
+	char *errorMessage;
+	size_t errorMessageSize;
+} GRJsonQueryParser;
+
+static bool failf(GRJsonQueryParser *ps, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static bool failf(GRJsonQueryParser *ps, const char *fmt, ...) {
+	if (ps->errorMessage && ps->errorMessageSize) {
+		char reason[120];
+		va_list argList;
+		va_start(argList, fmt);
+		vsnprintf(reason, sizeof(reason), fmt, argList);
+		va_end(argList);
+		snprintf(ps->errorMessage, ps->errorMessageSize, "%s at %ld", reason, (long)(ps->p - ps->start));
+	}
+	return false;
+}
+
+static void skipSpace(GRJsonQueryParser *ps) {
+	while (ps->p < ps->end && (*ps->p == ' ' || *ps->p == '\t' || *ps->p == '\n' || *ps->p == '\r')) {
+		ps->p++;
+	}
+}
+
+/** consumes text if it comes next */
+static bool accept(GRJsonQueryParser *ps, const char *text) {
+	size_t length = strlen(text);
+	if ((size_t)(ps->end - ps->p) >= length && memcmp(ps->p, text, length) == 0) {
+		ps->p += length;
+		return true;
+	}
+	return false;
+}
+
+static bool appendNameBytes(GRJsonQueryPlan *plan, const void *bytes, size_t length) {
+	// allocated even for an empty name, so a name's bytes are never NULL
+	if (plan->names == NULL || plan->namesLength + length > plan->namesCapacity) {
+		size_t capacity = plan->namesCapacity ? plan->namesCapacity : 64;
+		while (capacity < plan->namesLength + length) {
+			capacity *= 2;
+		}
+		uint8_t *names = realloc(plan->names, capacity);
+		if (names == NULL) {
+			return false;
+		}
+		plan->names = names;
+		plan->namesCapacity = capacity;
+	}
+	memcpy(plan->names + plan->namesLength, bytes, length);
+	plan->namesLength += length;
+	return true;
+}
+
+static bool isNameByte(char c) {
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-' || c == '$' || (unsigned char)c >= 0x80;
+}
+
+/** a bare member name, as in .name */
+static bool parseName(GRJsonQueryParser *ps, size_t *offset, size_t *length) {
+	const char *name = ps->p;
+	while (ps->p < ps->end && isNameByte(*ps->p)) {
+		ps->p++;
+	}
+	if (ps->p == name) {
+		return failf(ps, "expected a member name");
+	}
+	*offset = ps->plan->namesLength;
+	*length = (size_t)(ps->p - name);
+	return appendNameBytes(ps->plan, name, *length) || failf(ps, "out of memory");
+}
+
+/** a single- or double-quoted string, with the JSON escapes (and \') decoded into the name buffer */
+static bool parseQuoted(GRJsonQueryParser *ps, size_t *offset, size_t *length) {
+	char quote = *ps->p++;
+	const char *body = ps->p;
+	bool hasEscapes = false;
+	while (ps->p < ps->end && *ps->p != quote) {
+		if (*ps->p == '\\') {
+			hasEscapes = true;
+			ps->p++;
+		}
+		ps->p++;
+	}
+	if (ps->p >= ps->end) {
+		return failf(ps, "unterminated string");
+	}
+	size_t bodyLength = (size_t)(ps->p - body);
+	ps->p++;
+	*offset = ps->plan->namesLength;
+	if (!hasEscapes) {
+		*length = bodyLength;
+		return appendNameBytes(ps->plan, body, bodyLength) || failf(ps, "out of memory");
+	}
+	// \' is not a JSON escape, so it is resolved first and the rest is left to GRJsonUnescape
+	uint8_t *unquoted = malloc(bodyLength * 2 + 1);
+	if (unquoted == NULL) {
+		return failf(ps, "out of memory");
+	}
+	uint8_t *decoded = unquoted + bodyLength;
+	size_t unquotedLength = 0;
+	for (size_t i = 0; i < bodyLength; i++) {
+		if (body[i] == '\\' && i + 1 < bodyLength && body[i + 1] == '\'') {
+			unquoted[unquotedLength++] = '\'';
+			i++;
+			continue;
+		}
+		if (body[i] == '\\' && i + 1 < bodyLength) {
+			unquoted[unquotedLength++] = (uint8_t)body[i++];
+		}
+		unquoted[unquotedLength++] = (uint8_t)body[i];
+	}
+	*length = GRJsonUnescape(unquoted, unquotedLength, decoded);
+	bool ok = appendNameBytes(ps->plan, decoded, *length);
+	free(unquoted);
+	return ok || failf(ps, "out of memory");
+}
+
+/** an optionally negative integer; present is false if there are no digits */
+static bool parseInteger(GRJsonQueryParser *ps, int64_t *value, bool *present) {
+	const char *digits = ps->p;
+	bool negative = ps->p < ps->end && *ps->p == '-';
+	if (negative) {
+		ps->p++;
+	}
+	int64_t result = 0;
+	const char *first = ps->p;
+	while (ps->p < ps->end && *ps->p >= '0' && *ps->p <= '9') {
+		if (ps->p - first >= 18) {
+			return failf(ps, "index too large");
+		}
+		result = result * 10 + (*ps->p - '0');
+		ps->p++;
+	}
+	*present = ps->p > first;
+	if (!*present && negative) {
+		ps->p = digits;
+		return failf(ps, "expected digits after '-'");
+	}
+	*value = negative ? -result : result;
+	return true;
+}
+
+static GRJsonQueryStep *addStep(GRJsonQueryParser *ps, GRJsonQuerySelectorKind kind, bool descendant) {
+	GRJsonQueryPlan *plan = ps->plan;
+	if (!reserveOne((void **)&plan->steps, &plan->stepCapacity, plan->stepCount, sizeof(GRJsonQueryStep))) {
+		failf(ps, "out of memory");
+		return NULL;
+	}
+	GRJsonQueryStep *step = &plan->steps[plan->stepCount++];
+	memset(step, 0, sizeof(*step));
+	step->kind = kind;
+	step->descendant = descendant;
+	return step;
+}
+
+static size_t addExpr(GRJsonQueryParser *ps, GRJsonQueryExprKind kind) {
+	GRJsonQueryPlan *plan = ps->plan;
+	if (!reserveOne((void **)&plan->exprs, &plan->exprCapacity, plan->exprCount, sizeof(GRJsonQueryExpr))) {
+		failf(ps, "out of memory");
+		return NO_NODE;
+	}
+	GRJsonQueryExpr *expr = &plan->exprs[plan->exprCount];
+	memset(expr, 0, sizeof(*expr));
+	expr->kind = kind;
+	return plan->exprCount++;
+}
+
+static bool addMember(GRJsonQueryParser *ps, GRJsonQueryOperand *path, bool isIndex, size_t nameOffset, size_t nameLength, int64_t index) {
+	GRJsonQueryPlan *plan = ps->plan;
+	if (!reserveOne((void **)&plan->members, &plan->memberCapacity, plan->memberCount, sizeof(GRJsonQueryMember))) {
+		return failf(ps, "out of memory");
+	}
+	GRJsonQueryMember *member = &plan->members[plan->memberCount++];
+	member->isIndex = isIndex;
+	member->nameOffset = nameOffset;
+	member->nameLength = nameLength;
+	member->index = index;
+	path->memberCount++;
+	return true;
+}
+
+static bool parseOperand(GRJsonQueryParser *ps, GRJsonQueryOperand *operand) {
+	memset(operand, 0, sizeof(*operand));
+	skipSpace(ps);
+	if (ps->p >= ps->end) {
+		return failf(ps, "expected a value");
+	}
+	char c = *ps->p;
+	if (c == '@') {
+		ps->p++;
+		operand->kind = GRJsonQueryOperandPath;
+		operand->firstMember = ps->plan->memberCount;
+		while (ps->p < ps->end) {
+			size_t offset = 0, length = 0;
+			if (*ps->p == '.' && !(ps->p + 1 < ps->end && ps->p[1] == '.')) {
+				ps->p++;
+				if (!parseName(ps, &offset, &length) || !addMember(ps, operand, false, offset, length, 0)) {
+					return false;
+				}
+			}
+			else if (*ps->p == '[') {
+				ps->p++;
+				skipSpace(ps);
+				if (ps->p < ps->end && (*ps->p == '\'' || *ps->p == '"')) {
+					if (!parseQuoted(ps, &offset, &length) || !addMember(ps, operand, false, offset, length, 0)) {
+						return false;
+					}
+				}
+				else {
+					int64_t index = 0;
+					bool present = false;
+					if (!parseInteger(ps, &index, &present)) {
+						return false;
+					}
+					if (!present) {
+						return failf(ps, "expected a name or an index");
+					}
+					if (!addMember(ps, operand, true, 0, 0, index)) {
+						return false;
+					}
+				}
+				skipSpace(ps);
+				if (!accept(ps, "]")) {
+					return failf(ps, "expected ']'");
+				}
+			}
+			else {
+				break;
+			}
+		}
+		return true;
+	}
+	if (c == '\'' || c == '"') {
+		operand->kind = GRJsonQueryOperandString;
+		size_t offset, length;
+		if (!parseQuoted(ps, &offset, &length)) {
+			return false;
+		}
+		operand->firstMember = offset;
+		operand->memberCount = length;
+		return true;
+	}
+	if (c == '-' || (c >= '0' && c <= '9')) {
+		const char *number = ps->p;
+		ps->p++;
+		while (ps->p < ps->end && ((*ps->p >= '0' && *ps->p <= '9') || *ps->p == '.' || *ps->p == 'e' || *ps->p == 'E' || *ps->p == '+' || *ps->p == '-')) {
+			ps->p++;
+		}
+		operand->kind = GRJsonQueryOperandNumber;
+		GRJsonNumberKind kind = GRJsonParseNumber((const uint8_t *)number, (size_t)(ps->p - number), &operand->integer, &operand->number);
+		if (kind == GRJsonNumberInvalid) {
+			ps->p = number;
+			return failf(ps, "invalid number");
+		}
+		operand->isInteger = (kind == GRJsonNumberInteger);
+		return true;
+	}
+	if (accept(ps, "true")) {
+		operand->kind = GRJsonQueryOperandTrue;
+		return true;
+	}
+	if (accept(ps, "false")) {
+		operand->kind = GRJsonQueryOperandFalse;
+		return true;
+	}
+	if (accept(ps, "null")) {
+		operand->kind = GRJsonQueryOperandNull;
+		return true;
+	}
+	return failf(ps, "expected '@', a number, a string, true, false or null");
+}
+
+static size_t parseOr(GRJsonQueryParser *ps, int depth);
+
+static size_t parseUnary(GRJsonQueryParser *ps, int depth) {
+	if (depth > 64) {
+		failf(ps, "filter nested too deeply");
+		return NO_NODE;
+	}
+	skipSpace(ps);
+	if (accept(ps, "!") ) {
+		size_t operand = parseUnary(ps, depth + 1);
+		if (operand == NO_NODE) {
+			return NO_NODE;
+		}
+		size_t expr = addExpr(ps, GRJsonQueryExprNot);
+		if (expr != NO_NODE) {
+			ps->plan->exprs[expr].left = operand;
+		}
+		return expr;
+	}
+	if (accept(ps, "(")) {
+		size_t inner = parseOr(ps, depth + 1);
+		if (inner == NO_NODE) {
+			return NO_NODE;
+		}
+		skipSpace(ps);
+		if (!accept(ps, ")")) {
+			failf(ps, "expected ')'");
+			return NO_NODE;
+		}
+		return inner;
+	}
+	GRJsonQueryOperand lhs;
+	if (!parseOperand(ps, &lhs)) {
+		return NO_NODE;
+	}
+	skipSpace(ps);
+	static const struct { const char *text; GRJsonQueryOperator op; } operators[] = {
+		{"==", GRJsonQueryEqual}, {"!=", GRJsonQueryNotEqual}, {"<=", GRJsonQueryLessOrEqual},
+		{">=", GRJsonQueryGreaterOrEqual}, {"<", GRJsonQueryLess}, {">", GRJsonQueryGreater},
+	};
+	for (size_t i = 0; i < sizeof(operators) / sizeof(operators[0]); i++) {
+		if (accept(ps, operators[i].text)) {
+			GRJsonQueryOperand rhs;
+			if (!parseOperand(ps, &rhs)) {
+				return NO_NODE;
+			}
+			size_t expr = addExpr(ps, GRJsonQueryExprCompare);
+			if (expr != NO_NODE) {
+				ps->plan->exprs[expr].op = operators[i].op;
+				ps->plan->exprs[expr].lhs = lhs;
+				ps->plan->exprs[expr].rhs = rhs;
+			}
+			return expr;
+		}
+	}
+	if (lhs.kind != GRJsonQueryOperandPath) {
+		failf(ps, "expected a comparison");
+		return NO_NODE;
+	}
+	size_t expr = addExpr(ps, GRJsonQueryExprExists);
+	if (expr != NO_NODE) {
+		ps->plan->exprs[expr].lhs = lhs;
+	}
+	return expr;
+}
+
+static size_t parseAnd(GRJsonQueryParser *ps, int depth) {
+	size_t left = parseUnary(ps, depth);
+	while (left != NO_NODE) {
+		skipSpace(ps);
+		if (!accept(ps, "&&")) {
+			break;
+		}
+		size_t right = parseUnary(ps, depth);
+		if (right == NO_NODE) {
+			return NO_NODE;
+		}
+		size_t expr = addExpr(ps, GRJsonQueryExprAnd);
+		if (expr != NO_NODE) {
+			ps->plan->exprs[expr].left = left;
+			ps->plan->exprs[expr].right = right;
+		}
+		left = expr;
+	}
+	return left;
+}
+
+static size_t parseOr(GRJsonQueryParser *ps, int depth) {
+	size_t left = parseAnd(ps, depth);
+	while (left != NO_NODE) {
+		skipSpace(ps);
+		if (!accept(ps, "||")) {
+			break;
+		}
+		size_t right = parseAnd(ps, depth);
+		if (right == NO_NODE) {
+			return NO_NODE;
+		}
+		size_t expr = addExpr(ps, GRJsonQueryExprOr);
+		if (expr != NO_NODE) {
+			ps->plan->exprs[expr].left = left;
+			ps->plan->exprs[expr].right = right;
+		}
+		left = expr;
+	}
+	return left;
+}
+
+/** everything between '[' and ']' */
+static bool parseBracket(GRJsonQueryParser *ps, bool descendant) {
+	skipSpace(ps);
+	if (ps->p >= ps->end) {
+		return failf(ps, "unterminated '['");
+	}
+	GRJsonQueryStep *step = NULL;
+	if (accept(ps, "*")) {
+		step = addStep(ps, GRJsonQueryWildcard, descendant);
+	}
+	else if (*ps->p == '\'' || *ps->p == '"') {
+		size_t offset, length;
+		if (!parseQuoted(ps, &offset, &length)) {
+			return false;
+		}
+		step = addStep(ps, GRJsonQueryName, descendant);
+		if (step) {
+			step->nameOffset = offset;
+			step->nameLength = length;
+		}
+	}
+	else if (accept(ps, "?")) {
+		size_t filter = parseOr(ps, 0);
+		if (filter == NO_NODE) {
+			return false;
+		}
+		step = addStep(ps, GRJsonQueryFilter, descendant);
+		if (step) {
+			step->filter = filter;
+		}
+	}
+	else {
+		int64_t start = 0, end = 0, stride = 1;
+		bool hasStart = false, hasEnd = false, hasStride = false;
+		if (!parseInteger(ps, &start, &hasStart)) {
+			return false;
+		}
+		skipSpace(ps);
+		if (accept(ps, ":")) {
+			skipSpace(ps);
+			if (!parseInteger(ps, &end, &hasEnd)) {
+				return false;
+			}
+			skipSpace(ps);
+			if (accept(ps, ":")) {
+				skipSpace(ps);
+				if (!parseInteger(ps, &stride, &hasStride)) {
+					return false;
+				}
+				if (!hasStride) {
+					stride = 1;
+				}
+				else if (stride <= 0) {
+					return failf(ps, "the step of a slice must be positive");
+				}
+			}
+			step = addStep(ps, GRJsonQuerySlice, descendant);
+			if (step) {
+				step->index = start;
+				step->hasStart = hasStart;
+				step->end = end;
+				step->hasEnd = hasEnd;
+				step->stride = stride;
+			}
+		}
+		else if (hasStart) {
+			step = addStep(ps, GRJsonQueryIndex, descendant);
+			if (step) {
+				step->index = start;
+			}
+		}
+		else {
+			return failf(ps, "expected '*', a name, an index, a slice or a filter");
+		}
+	}
+	if (step == NULL) {
+		return false;
+	}
+	skipSpace(ps);
+	return accept(ps, "]") || failf(ps, "expected ']'");
+}
+
+bool GRJsonQueryPlanCompile(GRJsonQueryPlan *plan, const char *query, size_t length, char *errorMessage, size_t errorMessageSize) {
+	GRJsonQueryParser parser = {plan, query, query, query + length, errorMessage, errorMessageSize};
+	GRJsonQueryParser *ps = &parser;
+	skipSpace(ps);
+	if (!accept(ps, "$")) {
+		return failf(ps, "a query starts with '$'");
+	}
+	while (ps->p < ps->end) {
+		bool descendant = accept(ps, "..");
+		if (descendant || accept(ps, ".")) {
+			if (accept(ps, "*")) {
+				if (!addStep(ps, GRJsonQueryWildcard, descendant)) {
+					return false;
+				}
+				continue;
+			}
+			if (descendant && accept(ps, "[")) {
+				if (!parseBracket(ps, true)) {
+					return false;
+				}
+				continue;
+			}
+			size_t offset, nameLength;
+			if (!parseName(ps, &offset, &nameLength)) {
+				return false;
+			}
+			GRJsonQueryStep *step = addStep(ps, GRJsonQueryName, descendant);
+			if (step == NULL) {
+				return false;
+			}
+			step->nameOffset = offset;
+			step->nameLength = nameLength;
+		}
+		else if (accept(ps, "[")) {
+			if (!parseBracket(ps, false)) {
+				return false;
+			}
+		}
+		else {
+			skipSpace(ps);
+			if (ps->p < ps->end) {
+				return failf(ps, "unexpected '%c'", *ps->p);
+			}
+		}
+	}
+	return true;
+}
+
+#pragma mark - evaluating
+
+static bool pushNode(GRJsonQueryNodes *nodes, size_t index) {
+	if (!reserveOne((void **)&nodes->indexes, &nodes->capacity, nodes->count, sizeof(size_t))) {
+		return false;
+	}
+	nodes->indexes[nodes->count++] = index;
+	return true;
+}
+
+/** the bytes of a string on the tape with its escapes decoded, using scratch only if it has any */
+static const uint8_t *decodedString(const GRJsonTape *tape, size_t index, GRJsonScratch *scratch, size_t *length) {
+	bool hasEscapes;
+	const uint8_t *bytes = GRJsonTapeStringAt(tape, index, length, &hasEscapes);
+	if (!hasEscapes) {
+		return bytes;
+	}
+	uint8_t *decoded = GRJsonScratchReserve(scratch, *length ? *length : 1);
+	if (decoded == NULL) {
+		return NULL;
+	}
+	*length = GRJsonUnescape(bytes, *length, decoded);
+	return decoded;
+}
+
+/** the value of the last member of object named name (the one a parser keeps), or NO_NODE */
+static size_t memberNamed(const GRJsonTape *tape, size_t object, const uint8_t *name, size_t nameLength, GRJsonQueryRun *run) {
+	if (GRJsonTapeTypeAt(tape, object) != GRJsonTapeObject) {
+		return NO_NODE;
+	}
+	size_t found = NO_NODE;
+	size_t end = GRJsonTapePayloadAt(tape, object) - 1;
+	for (size_t key = GRJsonTapeFirstChild(object); key < end; ) {
+		size_t value = key + 2;
+		size_t length;
+		const uint8_t *bytes = decodedString(tape, key, &run->left, &length);
+		if (bytes && length == nameLength && memcmp(bytes, name, nameLength) == 0) {
+			found = value;
+		}
+		key = GRJsonTapeNext(tape, value);
+	}
+	return found;
+}
+
+/** element index of array (negative counts from the end), or NO_NODE */
+static size_t elementAt(const GRJsonTape *tape, size_t array, int64_t index) {
+	if (GRJsonTapeTypeAt(tape, array) != GRJsonTapeArray) {
+		return NO_NODE;
+	}
+	int64_t count = (int64_t)GRJsonTapeContainerCount(tape, array);
+	if (index < 0) {
+		index += count;
+	}
+	if (index < 0 || index >= count) {
+		return NO_NODE;
+	}
+	size_t element = GRJsonTapeFirstChild(array);
+	for (int64_t i = 0; i < index; i++) {
+		element = GRJsonTapeNext(tape, element);
+	}
+	return element;
+}
+
+typedef enum GRJsonQueryValueKind {
+	GRJsonQueryValueNothing,
+	GRJsonQueryValueNumber,
+	GRJsonQueryValueString,
+	GRJsonQueryValueTrue,
+	GRJsonQueryValueFalse,
+	GRJsonQueryValueNull,
+	GRJsonQueryValueContainer,
+} GRJsonQueryValueKind;
+
+typedef struct GRJsonQueryValue {
+	GRJsonQueryValueKind kind;
+	bool isInteger;
+	int64_t integer;
+	double number;
+	const uint8_t *bytes;
+	size_t length;
+} GRJsonQueryValue;
+
+static void resolveOperand(const GRJsonQueryPlan *plan, const GRJsonQueryOperand *operand, const GRJsonTape *tape, size_t node, GRJsonQueryRun *run, GRJsonScratch *scratch, GRJsonQueryValue *value) {
+	memset(value, 0, sizeof(*value));
+	switch (operand->kind) {
+		case GRJsonQueryOperandNumber:
+			value->kind = GRJsonQueryValueNumber;
+			value->isInteger = operand->isInteger;
+			value->integer = operand->integer;
+			value->number = operand->number;
+			return;
+		case GRJsonQueryOperandString:
+			value->kind = GRJsonQueryValueString;
+			value->bytes = plan->names + operand->firstMember;
+			value->length = operand->memberCount;
+			return;
+		case GRJsonQueryOperandTrue:
+			value->kind = GRJsonQueryValueTrue;
+			return;
+		case GRJsonQueryOperandFalse:
+			value->kind = GRJsonQueryValueFalse;
+			return;
+		case GRJsonQueryOperandNull:
+			value->kind = GRJsonQueryValueNull;
+			return;
+		case GRJsonQueryOperandPath:
+			break;
+	}
+	for (size_t i = 0; i < operand->memberCount && node != NO_NODE; i++) {
+		const GRJsonQueryMember *member = &plan->members[operand->firstMember + i];
+		node = member->isIndex ? elementAt(tape, node, member->index) : memberNamed(tape, node, plan->names + member->nameOffset, member->nameLength, run);
+	}
+	if (node == NO_NODE) {
+		return;
+	}
+	switch (GRJsonTapeTypeAt(tape, node)) {
+		case GRJsonTapeString:
+			value->bytes = decodedString(tape, node, scratch, &value->length);
+			value->kind = value->bytes ? GRJsonQueryValueString : GRJsonQueryValueNothing;
+			break;
+		case GRJsonTapeInteger:
+			value->kind = GRJsonQueryValueNumber;
+			value->isInteger = true;
+			value->integer = GRJsonTapeIntegerAt(tape, node);
+			value->number = (double)value->integer;
+			break;
+		case GRJsonTapeDouble:
+			value->kind = GRJsonQueryValueNumber;
+			value->number = GRJsonTapeDoubleAt(tape, node);
+			break;
+		case GRJsonTapeTrue:
+			value->kind = GRJsonQueryValueTrue;
+			break;
+		case GRJsonTapeFalse:
+			value->kind = GRJsonQueryValueFalse;
+			break;
+		case GRJsonTapeNull:
+			value->kind = GRJsonQueryValueNull;
+			break;
+		default:
+			value->kind = GRJsonQueryValueContainer;
+			break;
+	}
+}
+
+/**
+ * Compares two values: returns true if they can be ordered, with *order negative, zero or positive, and
+ * false (with *equal telling whether they are the same) if they cannot.
+ */
+static bool orderValues(const GRJsonQueryValue *a, const GRJsonQueryValue *b, int *order, bool *equal) {
+	*equal = false;
+	if (a->kind != b->kind) {
+		return false;
+	}
+	switch (a->kind) {
+		case GRJsonQueryValueNumber:
+			if (a->isInteger && b->isInteger) {
+				*order = (a->integer > b->integer) - (a->integer < b->integer);
+			}
+			else {
+				if (a->number != a->number || b->number != b->number) {
+					return false;
+				}
+				*order = (a->number > b->number) - (a->number < b->number);
+			}
+			*equal = (*order == 0);
+			return true;
+		case GRJsonQueryValueString:
+		{
+			size_t common = a->length < b->length ? a->length : b->length;
+			int result = common ? memcmp(a->bytes, b->bytes, common) : 0;
+			*order = result ? (result > 0 ? 1 : -1) : (a->length > b->length) - (a->length < b->length);
+			*equal = (*order == 0);
+			return true;
+		}
+		case GRJsonQueryValueContainer:
+			// not compared structurally
+			return false;
+		default:
+			// nothing == nothing, true == true, and so on
+			*equal = true;
+			return false;
+	}
+}
+
+static bool evaluateExpr(const GRJsonQueryPlan *plan, size_t exprIndex, const GRJsonTape *tape, size_t node, GRJsonQueryRun *run) {
+	const GRJsonQueryExpr *expr = &plan->exprs[exprIndex];
+	switch (expr->kind) {
+		case GRJsonQueryExprOr:
+			return evaluateExpr(plan, expr->left, tape, node, run) || evaluateExpr(plan, expr->right, tape, node, run);
+		case GRJsonQueryExprAnd:
+			return evaluateExpr(plan, expr->left, tape, node, run) && evaluateExpr(plan, expr->right, tape, node, run);
+		case GRJsonQueryExprNot:
+			return !evaluateExpr(plan, expr->left, tape, node, run);
+		case GRJsonQueryExprExists:
+		{
+			GRJsonQueryValue value;
+			resolveOperand(plan, &expr->lhs, tape, node, run, &run->right, &value);
+			return value.kind != GRJsonQueryValueNothing;
+		}
+		case GRJsonQueryExprCompare:
+		{
+			GRJsonQueryValue lhs, rhs;
+			// the two sides decode escaped strings into different buffers
+			resolveOperand(plan, &expr->lhs, tape, node, run, &run->right, &lhs);
+			GRJsonScratch second;
+			GRJsonScratchInit(&second);
+			bool bothEscaped = expr->lhs.kind == GRJsonQueryOperandPath && expr->rhs.kind == GRJsonQueryOperandPath;
+			resolveOperand(plan, &expr->rhs, tape, node, run, bothEscaped ? &second : &run->right, &rhs);
+			int order = 0;
+			bool equal = false;
+			bool ordered = orderValues(&lhs, &rhs, &order, &equal);
+			GRJsonScratchDestroy(&second);
+			switch (expr->op) {
+				case GRJsonQueryEqual:
+					return equal;
+				case GRJsonQueryNotEqual:
+					return !equal;
+				case GRJsonQueryLess:
+					return ordered && order < 0;
+				case GRJsonQueryLessOrEqual:
+					return ordered && order <= 0;
+				case GRJsonQueryGreater:
+					return ordered && order > 0;
+				case GRJsonQueryGreaterOrEqual:
+					return ordered && order >= 0;
+			}
+			return false;
+		}
+	}
+	return false;
+}
+
+/** adds what one selector picks out of node (an object or array; anything else has nothing to pick) */
+static bool applySelector(const GRJsonQueryPlan *plan, const GRJsonQueryStep *step, const GRJsonTape *tape, size_t node, GRJsonQueryRun *run) {
+	GRJsonTapeType type = GRJsonTapeTypeAt(tape, node);
+	if (type != GRJsonTapeObject && type != GRJsonTapeArray) {
+		return true;
+	}
+	bool isObject = (type == GRJsonTapeObject);
+	size_t end = GRJsonTapePayloadAt(tape, node) - 1;
+	switch (step->kind) {
+		case GRJsonQueryName:
+		{
+			size_t value = memberNamed(tape, node, plan->names + step->nameOffset, step->nameLength, run);
+			return value == NO_NODE || pushNode(&run->next, value);
+		}
+		case GRJsonQueryIndex:
+		{
+			size_t element = elementAt(tape, node, step->index);
+			return element == NO_NODE || pushNode(&run->next, element);
+		}
+		case GRJsonQuerySlice:
+		{
+			if (isObject) {
+				return true;
+			}
+			int64_t count = (int64_t)GRJsonTapeContainerCount(tape, node);
+			int64_t start = step->hasStart ? step->index : 0;
+			int64_t stop = step->hasEnd ? step->end : count;
+			start = start < 0 ? (start + count < 0 ? 0 : start + count) : (start > count ? count : start);
+			stop = stop < 0 ? (stop + count < 0 ? 0 : stop + count) : (stop > count ? count : stop);
+			size_t element = GRJsonTapeFirstChild(node);
+			for (int64_t i = 0; i < stop; i++) {
+				if (i >= start && (i - start) % step->stride == 0 && !pushNode(&run->next, element)) {
+					return false;
+				}
+				element = GRJsonTapeNext(tape, element);
+			}
+			return true;
+		}
+		case GRJsonQueryWildcard:
+		case GRJsonQueryFilter:
+		{
+			size_t child = GRJsonTapeFirstChild(node);
+			while (child < end) {
+				size_t value = isObject ? child + 2 : child;
+				if (step->kind == GRJsonQueryWildcard || evaluateExpr(plan, step->filter, tape, value, run)) {
+					if (!pushNode(&run->next, value)) {
+						return false;
+					}
+				}
+				child = GRJsonTapeNext(tape, value);
+			}
+			return true;
+		}
+	}
+	return true;
+}
+
+static bool applyStep(const GRJsonQueryPlan *plan, const GRJsonQueryStep *step, const GRJsonTape *tape, size_t node, GRJsonQueryRun *run) {
+	if (!step->descendant) {
+		return applySelector(plan, step, tape, node, run);
+	}
+	// every object and array from node down, in document order; scalars are hopped over
+	size_t end = GRJsonTapeNext(tape, node);
+	for (size_t i = node; i < end; ) {
+		switch (GRJsonTapeTypeAt(tape, i)) {
+			case GRJsonTapeObject:
+			case GRJsonTapeArray:
+				if (!applySelector(plan, step, tape, i, run)) {
+					return false;
+				}
+				i = GRJsonTapeFirstChild(i);
+				break;
+			case GRJsonTapeObjectEnd:
+			case GRJsonTapeArrayEnd:
+				i++;
+				break;
+			default:
+				i = GRJsonTapeNext(tape, i);
+				break;
+		}
+	}
+	return true;
+}
+
+bool GRJsonQueryPlanEvaluate(const GRJsonQueryPlan *plan, const GRJsonTape *tape, GRJsonQueryRun *run) {
+	run->matches.count = 0;
+	if (tape->count == 0 || !pushNode(&run->matches, 0)) {
+		return tape->count == 0;
+	}
+	for (size_t s = 0; s < plan->stepCount; s++) {
+		run->next.count = 0;
+		for (size_t i = 0; i < run->matches.count; i++) {
+			if (!applyStep(plan, &plan->steps[s], tape, run->matches.indexes[i], run)) {
+				run->matches.count = 0;
+				return false;
+			}
+		}
+		GRJsonQueryNodes swap = run->matches;
+		run->matches = run->next;
+		run->next = swap;
+		if (run->matches.count == 0) {
+			break;
+		}
+	}
+	return true;
+}
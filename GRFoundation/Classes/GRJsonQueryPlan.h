@@ -0,0 +1,171 @@
+//
+//  GRJsonQueryPlan.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonQueryPlan_h
+#define GRJsonQueryPlan_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GRJsonTape.h"
+#include "GRJsonString.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum GRJsonQuerySelectorKind {
+	GRJsonQueryName,     ///< the member with this name
+	GRJsonQueryWildcard, ///< every member or element
+	GRJsonQueryIndex,    ///< one element; a negative index counts from the end
+	GRJsonQuerySlice,    ///< the elements start:end:step, as in Python
+	GRJsonQueryFilter,   ///< the members or elements a filter expression holds for
+} GRJsonQuerySelectorKind;
+
+typedef struct GRJsonQueryStep {
+	GRJsonQuerySelectorKind kind;
+	bool descendant;     ///< reached with "..": applied to the node and to every object and array below it
+	size_t nameOffset;   ///< into the plan's name buffer
+	size_t nameLength;
+	int64_t index;       ///< the index, or the start of a slice
+	int64_t end;
+	int64_t stride;
+	bool hasStart;
+	bool hasEnd;
+	size_t filter;       ///< the root of the filter expression
+} GRJsonQueryStep;
+
+/** One step of a relative path ("@.a[0]") inside a filter. */
+typedef struct GRJsonQueryMember {
+	bool isIndex;
+	size_t nameOffset;
+	size_t nameLength;
+	int64_t index;
+} GRJsonQueryMember;
+
+typedef enum GRJsonQueryOperandKind {
+	GRJsonQueryOperandPath,   ///< the current node, or a member of it
+	GRJsonQueryOperandNumber,
+	GRJsonQueryOperandString,
+	GRJsonQueryOperandTrue,
+	GRJsonQueryOperandFalse,
+	GRJsonQueryOperandNull,
+} GRJsonQueryOperandKind;
+
+typedef struct GRJsonQueryOperand {
+	GRJsonQueryOperandKind kind;
+	size_t firstMember;       ///< a path's members, or a string's bytes (offset and length in the name buffer)
+	size_t memberCount;
+	bool isInteger;
+	int64_t integer;
+	double number;
+} GRJsonQueryOperand;
+
+typedef enum GRJsonQueryExprKind {
+	GRJsonQueryExprOr,
+	GRJsonQueryExprAnd,
+	GRJsonQueryExprNot,
+	GRJsonQueryExprExists,    ///< "@.a": the path leads somewhere
+	GRJsonQueryExprCompare,
+} GRJsonQueryExprKind;
+
+typedef enum GRJsonQueryOperator {
+	GRJsonQueryEqual,
+	GRJsonQueryNotEqual,
+	GRJsonQueryLess,
+	GRJsonQueryLessOrEqual,
+	GRJsonQueryGreater,
+	GRJsonQueryGreaterOrEqual,
+} GRJsonQueryOperator;
+
+typedef struct GRJsonQueryExpr {
+	GRJsonQueryExprKind kind;
+	size_t left;              ///< child expressions of || && and !
+	size_t right;
+	GRJsonQueryOperator op;
+	GRJsonQueryOperand lhs;
+	GRJsonQueryOperand rhs;
+} GRJsonQueryExpr;
+
+/**
+ * A compiled JSONPath query.  The supported subset:
+ *
+ *   $                     the root
+ *   .name  ['name']       a member ("name" may also be double-quoted inside brackets)
+ *   .*  [*]               every member or element
+ *   ..name  ..*  ..[...]  recursive descent: the selector applied at every depth
+ *   [2]  [-1]             an element, counting from the end if negative
+ *   [1:5]  [::2]  [-3:]   a slice; the step must be positive
+ *   [?(@.total > 100)]    the members or elements a filter holds for
+ *
+ * A filter compares relative paths (@, @.a.b, @['a'][0]) with each other or with numbers, strings, true,
+ * false and null using == != < <= > >=, tests that a path exists (?(@.isbn)), and combines those with
+ * && || ! and parentheses.  Numbers compare numerically and strings by their UTF-8 bytes; values of
+ * different types are never equal, and never less or greater than each other.
+ *
+ * A plan is immutable once compiled, so one plan can be evaluated on any number of threads at once, each
+ * with its own GRJsonQueryRun.
+ */
+typedef struct GRJsonQueryPlan {
+	GRJsonQueryStep *steps;
+	size_t stepCount;
+	size_t stepCapacity;
+	GRJsonQueryExpr *exprs;
+	size_t exprCount;
+	size_t exprCapacity;
+	GRJsonQueryMember *members;
+	size_t memberCount;
+	size_t memberCapacity;
+	uint8_t *names;
+	size_t namesLength;
+	size_t namesCapacity;
+} GRJsonQueryPlan;
+
+void GRJsonQueryPlanInit(GRJsonQueryPlan *plan);
+void GRJsonQueryPlanDestroy(GRJsonQueryPlan *plan);
+
+/**
+ * Compiles a query into an empty plan.
+ *
+ * @return false, with a description (and the offset of the problem) in errorMessage, if the query is malformed
+ */
+bool GRJsonQueryPlanCompile(GRJsonQueryPlan *plan, const char *query, size_t length, char *errorMessage, size_t errorMessageSize);
+
+/** A list of tape indexes. */
+typedef struct GRJsonQueryNodes {
+	size_t *indexes;
+	size_t count;
+	size_t capacity;
+} GRJsonQueryNodes;
+
+/** The working memory for evaluating plans, kept from one document to the next. */
+typedef struct GRJsonQueryRun {
+	GRJsonQueryNodes matches; ///< the result of the last evaluation, in the order they were found
+	GRJsonQueryNodes next;
+	GRJsonScratch left;       ///< for unescaping strings that are compared
+	GRJsonScratch right;
+} GRJsonQueryRun;
+
+void GRJsonQueryRunInit(GRJsonQueryRun *run);
+void GRJsonQueryRunDestroy(GRJsonQueryRun *run);
+
+/**
+ * Evaluates the plan against a tape, leaving the tape indexes of the matching values in run->matches.
+ * Only the parts of the tape a step can match are visited: a member that is not selected is hopped over
+ * whole, so subtrees off the query's path are never looked at, let alone turned into objects.
+ *
+ * @return false if the run ran out of memory
+ */
+bool GRJsonQueryPlanEvaluate(const GRJsonQueryPlan *plan, const GRJsonTape *tape, GRJsonQueryRun *run);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonQueryPlan_h */
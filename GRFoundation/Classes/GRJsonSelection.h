@@ -0,0 +1,33 @@
+//
+//  GRJsonSelection.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "GRJsonPath.h"
+
+/**
+ A compiled set of paths for selective parsing (see GRJson's selection property).  Each path is either a
+ JSON Pointer ("/data/items/0/id") or a dotted path ("data.items[*].id"); see GRJsonPath.h for the details.
+ A selection is immutable once created and can be shared by any number of parsers.
+ */
+@interface GRJsonSelection : NSObject
+
++ (instancetype) selectionWithPaths:(NSArray<NSString *> *)paths error:(NSError *__autoreleasing *)error;
+
+/**
+ Compiles the paths.
+
+ @param paths up to 64 JSON Pointers or dotted paths
+ @param error an out pointer that describes the first path that could not be compiled
+ @return the selection, or nil if a path is malformed
+ */
+- (instancetype) initWithPaths:(NSArray<NSString *> *)paths error:(NSError *__autoreleasing *)error;
+
+@property (nonatomic, readonly, copy) NSArray<NSString *> *paths;
+@property (nonatomic, readonly) const GRJsonPathSet *pathSet;
+
+@end
@@ -0,0 +1,54 @@
+//
+//  GRJsonSelection.m
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import "GRJsonSelection.h"
+
+@interface GRJsonSelection ()
+{
+	GRJsonPathSet pathSet;
+}
+
+@end
+
+@implementation GRJsonSelection
+
+@synthesize paths;
+
++ (instancetype) selectionWithPaths:(NSArray<NSString *> *)paths error:(NSError *__autoreleasing *)error {
+	return [[self alloc] initWithPaths:paths error:error];
+}
+
+- (instancetype) initWithPaths:(NSArray<NSString *> *)pathsIn error:(NSError *__autoreleasing *)error {
+	self = [super init];
+	if (self) {
+		GRJsonPathSetInit(&pathSet);
+		for (NSString *path in pathsIn) {
+			char message[160];
+			const char *utf8 = path.UTF8String;
+			if (!GRJsonPathSetAdd(&pathSet, utf8, strlen(utf8), message, sizeof(message))) {
+				if (error) {
+					NSString *reason = [NSString stringWithFormat:@"invalid path '%@': %s", path, message];
+					*error = [NSError errorWithDomain:@"GRJsonParser" code:-1 userInfo:@{NSLocalizedDescriptionKey: reason}];
+				}
+				return nil;
+			}
+		}
+		paths = [pathsIn copy];
+	}
+	return self;
+}
+
+- (void) dealloc {
+	GRJsonPathSetDestroy(&pathSet);
+}
+
+- (const GRJsonPathSet *) pathSet {
+	return &pathSet;
+}
+
+@end
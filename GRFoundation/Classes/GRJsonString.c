@@ -0,0 +1,419 @@
+//
+//  GRJsonString.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonString.h"
+#include "GRJsonStructuralIndex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GRJSON_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define GRJSON_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#pragma mark - scalar UTF-8
+
+/** the offset of the first byte at or after pos that is not ASCII, or length */
+static inline size_t skipASCII(const uint8_t *bytes, size_t pos, size_t length) {
+	while (pos + 8 <= length) {
+		uint64_t word;
+		memcpy(&word, bytes + pos, 8);
+		if (word & 0x8080808080808080ULL) {
+			break;
+		}
+		pos += 8;
+	}
+	while (pos < length && bytes[pos] < 0x80) {
+		pos++;
+	}
+	return pos;
+}
+
+static bool validateScalar(const uint8_t *bytes, size_t length) {
+	size_t pos = 0;
+	while ((pos = skipASCII(bytes, pos, length)) < length) {
+		uint8_t c = bytes[pos];
+		size_t need;
+		uint8_t low = 0x80, high = 0xBF; // the allowed range of the second byte
+		if (c >= 0xC2 && c <= 0xDF) {
+			need = 1;
+		}
+		else if (c >= 0xE0 && c <= 0xEF) {
+			need = 2;
+			if (c == 0xE0) {
+				low = 0xA0; // overlong
+			}
+			else if (c == 0xED) {
+				high = 0x9F; // surrogates
+			}
+		}
+		else if (c >= 0xF0 && c <= 0xF4) {
+			need = 3;
+			if (c == 0xF0) {
+				low = 0x90; // overlong
+			}
+			else if (c == 0xF4) {
+				high = 0x8F; // above U+10FFFF
+			}
+		}
+		else {
+			return false;
+		}
+		if (length - pos <= need || bytes[pos + 1] < low || bytes[pos + 1] > high) {
+			return false;
+		}
+		for (size_t i = 2; i <= need; i++) {
+			if ((bytes[pos + i] & 0xC0) != 0x80) {
+				return false;
+			}
+		}
+		pos += need + 1;
+	}
+	return true;
+}
+
+#pragma mark - vectorized UTF-8
+
+/*
+ * The lookup method (John Keiser and Daniel Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte").
+ * Every error in a two-byte window can be recognized from the high nibble of the first byte, its low nibble
+ * and the high nibble of the second: each of the three tables maps a nibble to the set of errors it is
+ * consistent with, and a bit that survives in all three is a real error.  Third and fourth bytes are then
+ * checked by requiring that two continuations in a row (the TWO_CONTS bit) happen exactly where a three- or
+ * four-byte lead two or three bytes back says they should.
+ */
+#define TOO_SHORT      (1 << 0) ///< a lead byte followed by a lead byte or ASCII
+#define TOO_LONG       (1 << 1) ///< ASCII followed by a continuation
+#define OVERLONG_3     (1 << 2)
+#define TOO_LARGE      (1 << 3)
+#define SURROGATE      (1 << 4)
+#define OVERLONG_2     (1 << 5)
+#define TOO_LARGE_1000 (1 << 6)
+#define OVERLONG_4     (1 << 6)
+#define TWO_CONTS      (1 << 7) ///< two continuations in a row
+#define CARRY          (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+static const uint8_t byte1High[16] = {
+	// 0xxx: ASCII
+	TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+	// 10xx: continuation
+	TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+	// 1100, 1101: two-byte lead
+	TOO_SHORT | OVERLONG_2,
+	TOO_SHORT,
+	// 1110: three-byte lead
+	TOO_SHORT | OVERLONG_3 | SURROGATE,
+	// 1111: four-byte lead
+	TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+};
+
+static const uint8_t byte1Low[16] = {
+	CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+	CARRY | OVERLONG_2,
+	CARRY,
+	CARRY,
+	CARRY | TOO_LARGE,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+};
+
+static const uint8_t byte2High[16] = {
+	// 0xxx: ASCII
+	TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+	// 1000, 1001, 101x: continuation
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+	// 11xx: lead
+	TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+};
+
+/** a block ending in one of these cannot be followed by ASCII: the last three bytes must be below 0xF0, 0xE0 and 0xC0 */
+static const uint8_t incompleteMax[32] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF,
+};
+
+#if GRJSON_HAVE_X86
+
+__attribute__((target("avx2")))
+static inline __m256i table256(const uint8_t *table) {
+	return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)table));
+}
+
+__attribute__((target("avx2")))
+static bool validateAVX2(const uint8_t *bytes, size_t length) {
+	const __m256i high1 = table256(byte1High), low1 = table256(byte1Low), high2 = table256(byte2High);
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+	const __m256i maxima = _mm256_loadu_si256((const __m256i *)incompleteMax);
+	__m256i error = _mm256_setzero_si256();
+	__m256i previous = _mm256_setzero_si256();
+	__m256i previousIncomplete = _mm256_setzero_si256();
+	for (size_t pos = 0; pos < length; pos += 32) {
+		__m256i input;
+		if (length - pos >= 32) {
+			input = _mm256_loadu_si256((const __m256i *)(bytes + pos));
+		}
+		else {
+			// zeros behave like ASCII, so a sequence cut off by the end of the input shows up as TOO_SHORT
+			uint8_t tail[32] = {0};
+			memcpy(tail, bytes + pos, length - pos);
+			input = _mm256_loadu_si256((const __m256i *)tail);
+		}
+		if (_mm256_movemask_epi8(input) == 0) {
+			error = _mm256_or_si256(error, previousIncomplete);
+		}
+		else {
+			// the input shifted right by one, two and three bytes, pulling in the end of the previous block
+			__m256i carried = _mm256_permute2x128_si256(previous, input, 0x21);
+			__m256i prev1 = _mm256_alignr_epi8(input, carried, 15);
+			__m256i prev2 = _mm256_alignr_epi8(input, carried, 14);
+			__m256i prev3 = _mm256_alignr_epi8(input, carried, 13);
+			__m256i special = _mm256_and_si256(_mm256_and_si256(
+				_mm256_shuffle_epi8(high1, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+				_mm256_shuffle_epi8(low1, _mm256_and_si256(prev1, nibble))),
+				_mm256_shuffle_epi8(high2, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+			__m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80)));
+			__m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80)));
+			__m256i expected = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+			error = _mm256_or_si256(error, _mm256_xor_si256(expected, special));
+			previousIncomplete = _mm256_subs_epu8(input, maxima);
+		}
+		previous = input;
+	}
+	error = _mm256_or_si256(error, previousIncomplete);
+	return _mm256_testz_si256(error, error);
+}
+
+#endif
+
+#if GRJSON_HAVE_NEON
+
+static bool validateNEON(const uint8_t *bytes, size_t length) {
+	const uint8x16_t high1 = vld1q_u8(byte1High), low1 = vld1q_u8(byte1Low), high2 = vld1q_u8(byte2High);
+	const uint8x16_t nibble = vdupq_n_u8(0x0F);
+	const uint8x16_t maxima = vld1q_u8(incompleteMax + 16);
+	uint8x16_t error = vdupq_n_u8(0);
+	uint8x16_t previous = vdupq_n_u8(0);
+	uint8x16_t previousIncomplete = vdupq_n_u8(0);
+	for (size_t pos = 0; pos < length; pos += 16) {
+		uint8x16_t input;
+		if (length - pos >= 16) {
+			input = vld1q_u8(bytes + pos);
+		}
+		else {
+			uint8_t tail[16] = {0};
+			memcpy(tail, bytes + pos, length - pos);
+			input = vld1q_u8(tail);
+		}
+		if (vmaxvq_u8(input) < 0x80) {
+			error = vorrq_u8(error, previousIncomplete);
+		}
+		else {
+			uint8x16_t prev1 = vextq_u8(previous, input, 15);
+			uint8x16_t prev2 = vextq_u8(previous, input, 14);
+			uint8x16_t prev3 = vextq_u8(previous, input, 13);
+			uint8x16_t special = vandq_u8(vandq_u8(
+				vqtbl1q_u8(high1, vshrq_n_u8(prev1, 4)),
+				vqtbl1q_u8(low1, vandq_u8(prev1, nibble))),
+				vqtbl1q_u8(high2, vshrq_n_u8(input, 4)));
+			uint8x16_t third = vqsubq_u8(prev2, vdupq_n_u8(0xE0 - 0x80));
+			uint8x16_t fourth = vqsubq_u8(prev3, vdupq_n_u8(0xF0 - 0x80));
+			uint8x16_t expected = vandq_u8(vorrq_u8(third, fourth), vdupq_n_u8(0x80));
+			error = vorrq_u8(error, veorq_u8(expected, special));
+			previousIncomplete = vqsubq_u8(input, maxima);
+		}
+		previous = input;
+	}
+	error = vorrq_u8(error, previousIncomplete);
+	return vmaxvq_u8(error) == 0;
+}
+
+#endif
+
+GRJsonUTF8Status GRJsonValidateUTF8(const uint8_t *bytes, size_t length) {
+	// everything before the first non-ASCII byte is fine, and can't be part of a sequence that follows it
+	size_t start = skipASCII(bytes, 0, length);
+	if (start == length) {
+		return GRJsonUTF8ASCII;
+	}
+	bytes += start;
+	length -= start;
+	bool valid;
+	switch (GRJsonActiveSimdBackend()) {
+#if GRJSON_HAVE_X86
+		case GRJsonSimdBackendAVX2:
+			valid = length >= 16 ? validateAVX2(bytes, length) : validateScalar(bytes, length);
+			break;
+#endif
+#if GRJSON_HAVE_NEON
+		case GRJsonSimdBackendNEON:
+			valid = length >= 16 ? validateNEON(bytes, length) : validateScalar(bytes, length);
+			break;
+#endif
+		default:
+			valid = validateScalar(bytes, length);
+			break;
+	}
+	return valid ? GRJsonUTF8Multibyte : GRJsonUTF8Invalid;
+}
+
+#pragma mark - unescaping
+
+/** the value of four hex digits, or -1 if they aren't */
+static inline int32_t hex4(const uint8_t *digits) {
+	int32_t value = 0;
+	for (int i = 0; i < 4; i++) {
+		uint8_t c = digits[i];
+		int32_t digit;
+		if (c >= '0' && c <= '9') {
+			digit = c - '0';
+		}
+		else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+			digit = (c | 0x20) - 'a' + 10;
+		}
+		else {
+			return -1;
+		}
+		value = (value << 4) | digit;
+	}
+	return value;
+}
+
+static inline size_t encodeUTF8(uint32_t codepoint, uint8_t *out) {
+	if (codepoint < 0x80) {
+		out[0] = (uint8_t)codepoint;
+		return 1;
+	}
+	if (codepoint < 0x800) {
+		out[0] = (uint8_t)(0xC0 | (codepoint >> 6));
+		out[1] = (uint8_t)(0x80 | (codepoint & 0x3F));
+		return 2;
+	}
+	if (codepoint < 0x10000) {
+		out[0] = (uint8_t)(0xE0 | (codepoint >> 12));
+		out[1] = (uint8_t)(0x80 | ((codepoint >> 6) & 0x3F));
+		out[2] = (uint8_t)(0x80 | (codepoint & 0x3F));
+		return 3;
+	}
+	out[0] = (uint8_t)(0xF0 | (codepoint >> 18));
+	out[1] = (uint8_t)(0x80 | ((codepoint >> 12) & 0x3F));
+	out[2] = (uint8_t)(0x80 | ((codepoint >> 6) & 0x3F));
+	out[3] = (uint8_t)(0x80 | (codepoint & 0x3F));
+	return 4;
+}
+
+size_t GRJsonUnescape(const uint8_t *bytes, size_t length, uint8_t *out) {
+	const uint8_t *end = bytes + length;
+	uint8_t *start = out;
+	while (bytes < end) {
+		const uint8_t *backslash = memchr(bytes, '\\', (size_t)(end - bytes));
+		if (backslash == NULL) {
+			memcpy(out, bytes, (size_t)(end - bytes));
+			out += end - bytes;
+			break;
+		}
+		memcpy(out, bytes, (size_t)(backslash - bytes));
+		out += backslash - bytes;
+		bytes = backslash;
+		if (end - bytes < 2) {
+			*out++ = *bytes++;
+			break;
+		}
+		uint8_t unescaped;
+		switch (bytes[1]) {
+			case '"': unescaped = '"'; break;
+			case '\\': unescaped = '\\'; break;
+			case '/': unescaped = '/'; break;
+			case 'b': unescaped = '\b'; break;
+			case 'f': unescaped = '\f'; break;
+			case 'n': unescaped = '\n'; break;
+			case 'r': unescaped = '\r'; break;
+			case 't': unescaped = '\t'; break;
+			case 'u':
+			{
+				int32_t codepoint = end - bytes >= 6 ? hex4(bytes + 2) : -1;
+				if (codepoint < 0) {
+					unescaped = 0;
+					break;
+				}
+				bytes += 6;
+				if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+					int32_t low = (end - bytes >= 6 && bytes[0] == '\\' && bytes[1] == 'u') ? hex4(bytes + 2) : -1;
+					if (low >= 0xDC00 && low <= 0xDFFF) {
+						codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+						bytes += 6;
+					}
+					else {
+						codepoint = 0xFFFD;
+					}
+				}
+				else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+					codepoint = 0xFFFD;
+				}
+				out += encodeUTF8((uint32_t)codepoint, out);
+				continue;
+			}
+			default:
+				unescaped = 0;
+				break;
+		}
+		if (unescaped) {
+			*out++ = unescaped;
+		}
+		else {
+			// not an escape we know, so keep it as written
+			*out++ = bytes[0];
+			*out++ = bytes[1];
+		}
+		bytes += 2;
+	}
+	return (size_t)(out - start);
+}
+
+#pragma mark - scratch
+
+void GRJsonScratchInit(GRJsonScratch *scratch) {
+	scratch->bytes = NULL;
+	scratch->capacity = 0;
+}
+
+void GRJsonScratchDestroy(GRJsonScratch *scratch) {
+	free(scratch->bytes);
+	GRJsonScratchInit(scratch);
+}
+
+uint8_t *GRJsonScratchGrow(GRJsonScratch *scratch, size_t size) {
+	size_t capacity = scratch->capacity ? scratch->capacity : 256;
+	while (capacity < size) {
+		capacity *= 2;
+	}
+	uint8_t *grown = realloc(scratch->bytes, capacity);
+	if (grown == NULL) {
+		return NULL;
+	}
+	scratch->bytes = grown;
+	scratch->capacity = capacity;
+	return grown;
+}
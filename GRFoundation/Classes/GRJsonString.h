@@ -0,0 +1,65 @@
+//
+//  GRJsonString.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonString_h
+#define GRJsonString_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum GRJsonUTF8Status {
+	GRJsonUTF8Invalid = 0,
+	GRJsonUTF8ASCII,     ///< valid, and every byte is below 0x80
+	GRJsonUTF8Multibyte, ///< valid, with at least one multi-byte sequence
+} GRJsonUTF8Status;
+
+/**
+ * Checks that bytes are well-formed UTF-8 (RFC 3629: no overlong forms, no surrogates, nothing above
+ * U+10FFFF, no truncated sequences).  ASCII is skipped eight bytes at a time; from the first non-ASCII byte
+ * on, the AVX2 and NEON backends (see GRJsonSetSimdBackend) check 32 or 16 bytes per step with the
+ * table-lookup method of Keiser and Lemire, and the others fall back to decoding one sequence at a time.
+ */
+GRJsonUTF8Status GRJsonValidateUTF8(const uint8_t *bytes, size_t length);
+
+/**
+ * Decodes the escapes in a string body into out, which must have room for length bytes (decoding never
+ * makes a string longer).  \uXXXX escapes become UTF-8, with a surrogate pair combined into one four-byte
+ * sequence and an unpaired surrogate replaced by U+FFFD.  A malformed escape is copied as it is.
+ *
+ * @return the number of bytes written
+ */
+size_t GRJsonUnescape(const uint8_t *bytes, size_t length, uint8_t *out);
+
+/** A buffer that grows as needed and is reused from one string to the next. */
+typedef struct GRJsonScratch {
+	uint8_t *bytes;
+	size_t capacity;
+} GRJsonScratch;
+
+void GRJsonScratchInit(GRJsonScratch *scratch);
+void GRJsonScratchDestroy(GRJsonScratch *scratch);
+uint8_t *GRJsonScratchGrow(GRJsonScratch *scratch, size_t size);
+
+/** Makes room for at least size bytes, returning the buffer, or NULL if it could not grow. */
+static inline uint8_t *GRJsonScratchReserve(GRJsonScratch *scratch, size_t size) {
+	if (size <= scratch->capacity) {
+		return scratch->bytes;
+	}
+	return GRJsonScratchGrow(scratch, size);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonString_h */
@@ -0,0 +1,431 @@
+//
+//  GRJsonStructuralIndex.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonStructuralIndex.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GRJSON_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+/* vpaddq_u8 (used to emulate movemask) is only available on AArch64 */
+#if defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define GRJSON_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef void (*GRJsonClassifyFunction)(const uint8_t *block, GRJsonBlockMasks *masks);
+typedef size_t (*GRJsonCompactFunction)(const uint8_t *block, uint64_t keep, uint8_t *out);
+
+#pragma mark - compaction table
+
+/** For each 8-bit mask, the positions of its set bits in order (then zeros): a shuffle that packs those bytes. */
+static uint64_t compactShuffles[256];
+
+static void buildCompactShuffles(void) {
+	for (unsigned mask = 0; mask < 256; mask++) {
+		uint64_t shuffle = 0;
+		unsigned count = 0;
+		for (unsigned bit = 0; bit < 8; bit++) {
+			if (mask & (1u << bit)) {
+				shuffle |= (uint64_t)bit << (count++ * 8);
+			}
+		}
+		compactShuffles[mask] = shuffle;
+	}
+}
+
+static inline void loadCompactShuffles(void) {
+	static pthread_once_t once = PTHREAD_ONCE_INIT;
+	pthread_once(&once, buildCompactShuffles);
+}
+
+#pragma mark - scalar
+
+static void classifyScalar(const uint8_t *block, GRJsonBlockMasks *masks) {
+	uint64_t quote = 0, backslash = 0, structural = 0, whitespace = 0, control = 0;
+	for (unsigned i = 0; i < GRJSON_BLOCK_SIZE; i++) {
+		uint64_t bit = 1ULL << i;
+		switch (block[i]) {
+			case '"':
+				quote |= bit;
+				break;
+			case '\\':
+				backslash |= bit;
+				break;
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case ':':
+			case ',':
+				structural |= bit;
+				break;
+			case ' ':
+				whitespace |= bit;
+				break;
+			case '\t':
+			case '\n':
+			case '\r':
+				whitespace |= bit;
+				control |= bit;
+				break;
+			default:
+				if (block[i] < 0x20) {
+					control |= bit;
+				}
+				break;
+		}
+	}
+	masks->quote = quote;
+	masks->backslash = backslash;
+	masks->structural = structural;
+	masks->whitespace = whitespace;
+	masks->control = control;
+}
+
+/** Packs each 8-byte lane through the shuffle table, a byte at a time; every store is unconditional. */
+static size_t compactScalar(const uint8_t *block, uint64_t keep, uint8_t *out) {
+	uint8_t *start = out;
+	for (unsigned i = 0; i < GRJSON_BLOCK_SIZE; i += 8) {
+		unsigned mask = (unsigned)(keep >> i) & 0xFF;
+		if (mask == 0xFF) {
+			memcpy(out, block + i, 8);
+			out += 8;
+			continue;
+		}
+		uint64_t shuffle = compactShuffles[mask];
+		for (unsigned j = 0; j < 8; j++) {
+			out[j] = block[i + (shuffle >> (j * 8) & 7)];
+		}
+		out += __builtin_popcount(mask);
+	}
+	return (size_t)(out - start);
+}
+
+#pragma mark - x86
+
+#if GRJSON_HAVE_X86
+
+static void classifySSE2(const uint8_t *block, GRJsonBlockMasks *masks) {
+	const __m128i quoteChar = _mm_set1_epi8('"');
+	const __m128i backslashChar = _mm_set1_epi8('\\');
+	const __m128i spaceChar = _mm_set1_epi8(' ');
+	const __m128i tabChar = _mm_set1_epi8('\t');
+	const __m128i newlineChar = _mm_set1_epi8('\n');
+	const __m128i returnChar = _mm_set1_epi8('\r');
+	const __m128i colonChar = _mm_set1_epi8(':');
+	const __m128i commaChar = _mm_set1_epi8(',');
+	// setting 0x20 folds '[' onto '{' and ']' onto '}' (and nothing else onto either)
+	const __m128i bracketFold = _mm_set1_epi8(0x20);
+	const __m128i openBrace = _mm_set1_epi8('{');
+	const __m128i closeBrace = _mm_set1_epi8('}');
+	const __m128i controlMax = _mm_set1_epi8(0x1f);
+
+	uint64_t quote = 0, backslash = 0, structural = 0, whitespace = 0, control = 0;
+	for (unsigned i = 0; i < GRJSON_BLOCK_SIZE; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(block + i));
+		__m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, spaceChar), _mm_cmpeq_epi8(v, tabChar)),
+								  _mm_or_si128(_mm_cmpeq_epi8(v, newlineChar), _mm_cmpeq_epi8(v, returnChar)));
+		__m128i st = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, colonChar), _mm_cmpeq_epi8(v, commaChar)),
+								  _mm_or_si128(_mm_cmpeq_epi8(_mm_or_si128(v, bracketFold), openBrace),
+											   _mm_cmpeq_epi8(_mm_or_si128(v, bracketFold), closeBrace)));
+		__m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(v, controlMax), v);
+		quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, quoteChar)) << i;
+		backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslashChar)) << i;
+		structural |= (uint64_t)(uint16_t)_mm_movemask_epi8(st) << i;
+		whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(ws) << i;
+		control |= (uint64_t)(uint16_t)_mm_movemask_epi8(ctl) << i;
+	}
+	masks->quote = quote;
+	masks->backslash = backslash;
+	masks->structural = structural;
+	masks->whitespace = whitespace;
+	masks->control = control;
+}
+
+__attribute__((target("avx2")))
+static void classifyAVX2(const uint8_t *block, GRJsonBlockMasks *masks) {
+	const __m256i quoteChar = _mm256_set1_epi8('"');
+	const __m256i backslashChar = _mm256_set1_epi8('\\');
+	const __m256i spaceChar = _mm256_set1_epi8(' ');
+	const __m256i tabChar = _mm256_set1_epi8('\t');
+	const __m256i newlineChar = _mm256_set1_epi8('\n');
+	const __m256i returnChar = _mm256_set1_epi8('\r');
+	const __m256i colonChar = _mm256_set1_epi8(':');
+	const __m256i commaChar = _mm256_set1_epi8(',');
+	const __m256i bracketFold = _mm256_set1_epi8(0x20);
+	const __m256i openBrace = _mm256_set1_epi8('{');
+	const __m256i closeBrace = _mm256_set1_epi8('}');
+	const __m256i controlMax = _mm256_set1_epi8(0x1f);
+
+	uint64_t quote = 0, backslash = 0, structural = 0, whitespace = 0, control = 0;
+	for (unsigned i = 0; i < GRJSON_BLOCK_SIZE; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(block + i));
+		__m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, spaceChar), _mm256_cmpeq_epi8(v, tabChar)),
+									 _mm256_or_si256(_mm256_cmpeq_epi8(v, newlineChar), _mm256_cmpeq_epi8(v, returnChar)));
+		__m256i st = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, colonChar), _mm256_cmpeq_epi8(v, commaChar)),
+									 _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_or_si256(v, bracketFold), openBrace),
+												   _mm256_cmpeq_epi8(_mm256_or_si256(v, bracketFold), closeBrace)));
+		__m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, controlMax), v);
+		quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quoteChar)) << i;
+		backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, backslashChar)) << i;
+		structural |= (uint64_t)(uint32_t)_mm256_movemask_epi8(st) << i;
+		whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ws) << i;
+		control |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ctl) << i;
+	}
+	masks->quote = quote;
+	masks->backslash = backslash;
+	masks->structural = structural;
+	masks->whitespace = whitespace;
+	masks->control = control;
+}
+
+/** pshufb packs 16 bytes at a time, 8 per shuffle table entry, with the upper entry offset by 8. */
+__attribute__((target("avx2")))
+static size_t compactAVX2(const uint8_t *block, uint64_t keep, uint8_t *out) {
+	uint8_t *start = out;
+	for (unsigned i = 0; i < GRJSON_BLOCK_SIZE; i += 16) {
+		unsigned low = (unsigned)(keep >> i) & 0xFF;
+		unsigned high = (unsigned)(keep >> (i + 8)) & 0xFF;
+		__m128i shuffle = _mm_set_epi64x((long long)(compactShuffles[high] + 0x0808080808080808ULL), (long long)compactShuffles[low]);
+		__m128i packed = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(block + i)), shuffle);
+		_mm_storel_epi64((__m128i *)out, packed);
+		out += __builtin_popcount(low);
+		_mm_storel_epi64((__m128i *)out, _mm_unpackhi_epi64(packed, packed));
+		out += __builtin_popcount(high);
+	}
+	return (size_t)(out - start);
+}
+
+static bool cpuSupportsAVX2(void) {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+#pragma mark - ARM
+
+#if GRJSON_HAVE_NEON
+
+/** the NEON equivalent of movemask for four 16-byte compare results (each byte 0x00 or 0xff) */
+static inline uint64_t neonMovemask64(uint8x16_t v0, uint8x16_t v1, uint8x16_t v2, uint8x16_t v3) {
+	const uint8x16_t bitMask = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+								0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+	uint8x16_t t0 = vandq_u8(v0, bitMask);
+	uint8x16_t t1 = vandq_u8(v1, bitMask);
+	uint8x16_t t2 = vandq_u8(v2, bitMask);
+	uint8x16_t t3 = vandq_u8(v3, bitMask);
+	uint8x16_t sum0 = vpaddq_u8(t0, t1);
+	uint8x16_t sum1 = vpaddq_u8(t2, t3);
+	sum0 = vpaddq_u8(sum0, sum1);
+	sum0 = vpaddq_u8(sum0, sum0);
+	return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+static void classifyNEON(const uint8_t *block, GRJsonBlockMasks *masks) {
+	const uint8x16_t quoteChar = vdupq_n_u8('"');
+	const uint8x16_t backslashChar = vdupq_n_u8('\\');
+	const uint8x16_t spaceChar = vdupq_n_u8(' ');
+	const uint8x16_t tabChar = vdupq_n_u8('\t');
+	const uint8x16_t newlineChar = vdupq_n_u8('\n');
+	const uint8x16_t returnChar = vdupq_n_u8('\r');
+	const uint8x16_t colonChar = vdupq_n_u8(':');
+	const uint8x16_t commaChar = vdupq_n_u8(',');
+	const uint8x16_t bracketFold = vdupq_n_u8(0x20);
+	const uint8x16_t openBrace = vdupq_n_u8('{');
+	const uint8x16_t closeBrace = vdupq_n_u8('}');
+	const uint8x16_t controlLimit = vdupq_n_u8(0x20);
+
+	uint8x16_t q[4], b[4], s[4], w[4], c[4];
+	for (unsigned i = 0; i < 4; i++) {
+		uint8x16_t v = vld1q_u8(block + i * 16);
+		q[i] = vceqq_u8(v, quoteChar);
+		b[i] = vceqq_u8(v, backslashChar);
+		s[i] = vorrq_u8(vorrq_u8(vceqq_u8(v, colonChar), vceqq_u8(v, commaChar)),
+						vorrq_u8(vceqq_u8(vorrq_u8(v, bracketFold), openBrace), vceqq_u8(vorrq_u8(v, bracketFold), closeBrace)));
+		w[i] = vorrq_u8(vorrq_u8(vceqq_u8(v, spaceChar), vceqq_u8(v, tabChar)),
+						vorrq_u8(vceqq_u8(v, newlineChar), vceqq_u8(v, returnChar)));
+		c[i] = vcltq_u8(v, controlLimit);
+	}
+	masks->quote = neonMovemask64(q[0], q[1], q[2], q[3]);
+	masks->backslash = neonMovemask64(b[0], b[1], b[2], b[3]);
+	masks->structural = neonMovemask64(s[0], s[1], s[2], s[3]);
+	masks->whitespace = neonMovemask64(w[0], w[1], w[2], w[3]);
+	masks->control = neonMovemask64(c[0], c[1], c[2], c[3]);
+}
+
+/** tbl packs 16 bytes at a time, like pshufb on x86. */
+static size_t compactNEON(const uint8_t *block, uint64_t keep, uint8_t *out) {
+	uint8_t *start = out;
+	for (unsigned i = 0; i < GRJSON_BLOCK_SIZE; i += 16) {
+		unsigned low = (unsigned)(keep >> i) & 0xFF;
+		unsigned high = (unsigned)(keep >> (i + 8)) & 0xFF;
+		uint64x2_t shuffle = vcombine_u64(vcreate_u64(compactShuffles[low]), vcreate_u64(compactShuffles[high] + 0x0808080808080808ULL));
+		uint8x16_t packed = vqtbl1q_u8(vld1q_u8(block + i), vreinterpretq_u8_u64(shuffle));
+		vst1_u8(out, vget_low_u8(packed));
+		out += __builtin_popcount(low);
+		vst1_u8(out, vget_high_u8(packed));
+		out += __builtin_popcount(high);
+	}
+	return (size_t)(out - start);
+}
+
+#endif
+
+#pragma mark - backend selection
+
+static GRJsonSimdBackend bestBackend(void) {
+#if GRJSON_HAVE_NEON
+	return GRJsonSimdBackendNEON;
+#elif GRJSON_HAVE_X86
+	if (cpuSupportsAVX2()) {
+		return GRJsonSimdBackendAVX2;
+	}
+	return GRJsonSimdBackendSSE2;
+#else
+	return GRJsonSimdBackendScalar;
+#endif
+}
+
+static GRJsonClassifyFunction functionForBackend(GRJsonSimdBackend backend) {
+	switch (backend) {
+		case GRJsonSimdBackendScalar:
+			return classifyScalar;
+#if GRJSON_HAVE_X86
+		case GRJsonSimdBackendSSE2:
+			return classifySSE2;
+		case GRJsonSimdBackendAVX2:
+			return cpuSupportsAVX2() ? classifyAVX2 : NULL;
+#endif
+#if GRJSON_HAVE_NEON
+		case GRJsonSimdBackendNEON:
+			return classifyNEON;
+#endif
+		default:
+			return NULL;
+	}
+}
+
+/** SSE2 has no byte shuffle, so only the AVX2 and NEON backends have their own compaction. */
+static GRJsonCompactFunction compactFunctionForBackend(GRJsonSimdBackend backend) {
+	switch (backend) {
+#if GRJSON_HAVE_X86
+		case GRJsonSimdBackendAVX2:
+			return compactAVX2;
+#endif
+#if GRJSON_HAVE_NEON
+		case GRJsonSimdBackendNEON:
+			return compactNEON;
+#endif
+		default:
+			return compactScalar;
+	}
+}
+
+static void classifyResolving(const uint8_t *block, GRJsonBlockMasks *masks);
+static size_t compactResolving(const uint8_t *block, uint64_t keep, uint8_t *out);
+
+/* every thread resolves to the same backend, so a racing first use is harmless */
+static GRJsonClassifyFunction classifyBlock = classifyResolving;
+static GRJsonCompactFunction compactBlock = compactResolving;
+static GRJsonSimdBackend activeBackend = GRJsonSimdBackendAuto;
+
+static void resolveBackend(void) {
+	GRJsonSimdBackend backend = bestBackend();
+	loadCompactShuffles();
+	__atomic_store_n(&activeBackend, backend, __ATOMIC_RELAXED);
+	__atomic_store_n(&compactBlock, compactFunctionForBackend(backend), __ATOMIC_RELEASE);
+	__atomic_store_n(&classifyBlock, functionForBackend(backend), __ATOMIC_RELEASE);
+}
+
+static void classifyResolving(const uint8_t *block, GRJsonBlockMasks *masks) {
+	resolveBackend();
+	classifyBlock(block, masks);
+}
+
+static size_t compactResolving(const uint8_t *block, uint64_t keep, uint8_t *out) {
+	resolveBackend();
+	return compactBlock(block, keep, out);
+}
+
+void GRJsonClassifyBlock(const uint8_t *block, GRJsonBlockMasks *masks) {
+	__atomic_load_n(&classifyBlock, __ATOMIC_ACQUIRE)(block, masks);
+}
+
+size_t GRJsonCompactBlock(const uint8_t *block, uint64_t keep, uint8_t *out) {
+	return __atomic_load_n(&compactBlock, __ATOMIC_ACQUIRE)(block, keep, out);
+}
+
+bool GRJsonSetSimdBackend(GRJsonSimdBackend backend) {
+	if (backend == GRJsonSimdBackendAuto) {
+		resolveBackend();
+		return true;
+	}
+	GRJsonClassifyFunction function = functionForBackend(backend);
+	if (function == NULL) {
+		return false;
+	}
+	loadCompactShuffles();
+	__atomic_store_n(&activeBackend, backend, __ATOMIC_RELAXED);
+	__atomic_store_n(&compactBlock, compactFunctionForBackend(backend), __ATOMIC_RELEASE);
+	__atomic_store_n(&classifyBlock, function, __ATOMIC_RELEASE);
+	return true;
+}
+
+GRJsonSimdBackend GRJsonActiveSimdBackend(void) {
+	if (__atomic_load_n(&activeBackend, __ATOMIC_RELAXED) == GRJsonSimdBackendAuto) {
+		resolveBackend();
+	}
+	return __atomic_load_n(&activeBackend, __ATOMIC_RELAXED);
+}
+
+const char *GRJsonSimdBackendName(GRJsonSimdBackend backend) {
+	switch (backend) {
+		case GRJsonSimdBackendAuto: return "auto";
+		case GRJsonSimdBackendScalar: return "scalar";
+		case GRJsonSimdBackendSSE2: return "sse2";
+		case GRJsonSimdBackendAVX2: return "avx2";
+		case GRJsonSimdBackendNEON: return "neon";
+	}
+	return "unknown";
+}
+
+#pragma mark - index
+
+void GRJsonStructuralIndexInit(GRJsonStructuralIndex *idx, const uint8_t *buf, size_t len) {
+	idx->buf = buf;
+	idx->len = len;
+	idx->blockStart = SIZE_MAX;
+	memset(&idx->masks, 0, sizeof(idx->masks));
+}
+
+void GRJsonStructuralIndexLoad(GRJsonStructuralIndex *idx, size_t pos) {
+	size_t blockStart = pos & ~(size_t)(GRJSON_BLOCK_SIZE - 1);
+	size_t remaining = idx->len - blockStart;
+	idx->blockStart = blockStart;
+	if (remaining >= GRJSON_BLOCK_SIZE) {
+		GRJsonClassifyBlock(idx->buf + blockStart, &idx->masks);
+		return;
+	}
+	// the last, partial block: classify a padded copy so we never read past the end of the buffer
+	uint8_t padded[GRJSON_BLOCK_SIZE];
+	memcpy(padded, idx->buf + blockStart, remaining);
+	memset(padded + remaining, 'x', GRJSON_BLOCK_SIZE - remaining);
+	GRJsonClassifyBlock(padded, &idx->masks);
+	uint64_t valid = (1ULL << remaining) - 1;
+	idx->masks.quote &= valid;
+	idx->masks.backslash &= valid;
+	idx->masks.structural &= valid;
+	idx->masks.whitespace &= valid;
+	idx->masks.control &= valid;
+}
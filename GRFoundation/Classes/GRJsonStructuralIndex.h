@@ -0,0 +1,152 @@
+//
+//  GRJsonStructuralIndex.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonStructuralIndex_h
+#define GRJsonStructuralIndex_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The vectorized classifiers available to the JSON scanner.  GRJsonSimdBackendAuto picks the best one
+ * the CPU supports the first time a block is classified (AVX2, then SSE2 on x86; NEON on ARM), falling
+ * back to the portable scalar classifier everywhere else.  Every backend produces identical masks.
+ */
+typedef enum GRJsonSimdBackend {
+	GRJsonSimdBackendAuto = 0,
+	GRJsonSimdBackendScalar,
+	GRJsonSimdBackendSSE2,
+	GRJsonSimdBackendAVX2,
+	GRJsonSimdBackendNEON,
+} GRJsonSimdBackend;
+
+#define GRJSON_BLOCK_SIZE 64
+
+/**
+ * Bitmaps for one 64-byte block of input.  Bit N of each mask describes byte N of the block.
+ */
+typedef struct GRJsonBlockMasks {
+	uint64_t quote;      ///< '"'
+	uint64_t backslash;  ///< '\\'
+	uint64_t structural; ///< '{', '}', '[', ']', ':' and ','
+	uint64_t whitespace; ///< ' ', '\t', '\n' and '\r'
+	uint64_t control;    ///< bytes below 0x20, which may not appear un-escaped inside a string
+} GRJsonBlockMasks;
+
+/**
+ * Classifies exactly GRJSON_BLOCK_SIZE bytes starting at block using the active backend.
+ */
+void GRJsonClassifyBlock(const uint8_t *block, GRJsonBlockMasks *masks);
+
+/**
+ * Copies the bytes of the GRJSON_BLOCK_SIZE bytes at block whose bits are set in keep to out, in order,
+ * and returns how many there were.  out must have room for GRJSON_BLOCK_SIZE bytes whatever keep is, since
+ * the vectorized backends store whole lanes and only then advance past the bytes that were kept.
+ */
+size_t GRJsonCompactBlock(const uint8_t *block, uint64_t keep, uint8_t *out);
+
+/**
+ * Forces a particular backend (mostly useful for tests and benchmarks).  Returns false, leaving the
+ * current backend in place, if the CPU or the build does not support the requested one.
+ */
+bool GRJsonSetSimdBackend(GRJsonSimdBackend backend);
+
+/** The backend that is currently classifying blocks, resolving GRJsonSimdBackendAuto if needed. */
+GRJsonSimdBackend GRJsonActiveSimdBackend(void);
+
+/** A short name for the backend ("scalar", "sse2", "avx2", "neon"). */
+const char *GRJsonSimdBackendName(GRJsonSimdBackend backend);
+
+/**
+ * A lazily built structural index over a buffer.  The scanner only ever moves forward, so the index keeps
+ * the masks for the one 64-byte block it is currently in, and classifies the next block when the scanner
+ * crosses into it.  Each block is therefore classified exactly once per pass.
+ */
+typedef struct GRJsonStructuralIndex {
+	const uint8_t *buf;
+	size_t len;
+	size_t blockStart; ///< offset of the block described by masks, or SIZE_MAX if there is none yet
+	GRJsonBlockMasks masks;
+} GRJsonStructuralIndex;
+
+void GRJsonStructuralIndexInit(GRJsonStructuralIndex *idx, const uint8_t *buf, size_t len);
+
+/** Classifies the block containing pos (which must be < idx->len).  Bits past the end of the buffer are cleared. */
+void GRJsonStructuralIndexLoad(GRJsonStructuralIndex *idx, size_t pos);
+
+static inline const GRJsonBlockMasks *GRJsonStructuralIndexBlockAt(GRJsonStructuralIndex *idx, size_t pos) {
+	size_t blockStart = pos & ~(size_t)(GRJSON_BLOCK_SIZE - 1);
+	if (blockStart != idx->blockStart) {
+		GRJsonStructuralIndexLoad(idx, pos);
+	}
+	return &idx->masks;
+}
+
+/**
+ * Returns the position of the first quote, backslash or control character at or after pos,
+ * or idx->len if there is none.  This is how string bodies are scanned.
+ */
+static inline size_t GRJsonStructuralIndexNextStringSpecial(GRJsonStructuralIndex *idx, size_t pos) {
+	while (pos < idx->len) {
+		const GRJsonBlockMasks *m = GRJsonStructuralIndexBlockAt(idx, pos);
+		unsigned shift = (unsigned)(pos & (GRJSON_BLOCK_SIZE - 1));
+		uint64_t bits = (m->quote | m->backslash | m->control) >> shift;
+		if (bits) {
+			return pos + (size_t)__builtin_ctzll(bits);
+		}
+		pos = idx->blockStart + GRJSON_BLOCK_SIZE;
+	}
+	return idx->len;
+}
+
+/**
+ * Returns the position of the first quote or structural character at or after pos, or idx->len if there
+ * is none.  This is how a value that is being skipped is scanned outside of its strings.
+ */
+static inline size_t GRJsonStructuralIndexNextQuoteOrStructural(GRJsonStructuralIndex *idx, size_t pos) {
+	while (pos < idx->len) {
+		const GRJsonBlockMasks *m = GRJsonStructuralIndexBlockAt(idx, pos);
+		unsigned shift = (unsigned)(pos & (GRJSON_BLOCK_SIZE - 1));
+		uint64_t bits = (m->quote | m->structural) >> shift;
+		if (bits) {
+			return pos + (size_t)__builtin_ctzll(bits);
+		}
+		pos = idx->blockStart + GRJSON_BLOCK_SIZE;
+	}
+	return idx->len;
+}
+
+/**
+ * Returns the position of the first non-whitespace byte at or after pos, or idx->len if there is none.
+ */
+static inline size_t GRJsonStructuralIndexSkipWhitespace(GRJsonStructuralIndex *idx, size_t pos) {
+	while (pos < idx->len) {
+		const GRJsonBlockMasks *m = GRJsonStructuralIndexBlockAt(idx, pos);
+		unsigned shift = (unsigned)(pos & (GRJSON_BLOCK_SIZE - 1));
+		uint64_t bits = (~m->whitespace) >> shift;
+		size_t blockEnd = idx->blockStart + GRJSON_BLOCK_SIZE;
+		if (bits) {
+			size_t found = pos + (size_t)__builtin_ctzll(bits);
+			// bits past the end of the buffer are never whitespace, so clamp to the buffer length
+			return found < idx->len ? found : idx->len;
+		}
+		pos = blockEnd;
+	}
+	return idx->len;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonStructuralIndex_h */
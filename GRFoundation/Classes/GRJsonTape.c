@@ -0,0 +1,255 @@
+//
+//  GRJsonTape.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonTape.h"
+#include "GRJsonNumber.h"
+
+#include <stdlib.h>
+
+#define KEY_SLOT_COUNT 256       ///< must be a power of two
+#define KEY_SLOT_MAX_LENGTH 48   ///< longer keys are stored every time they appear
+
+/**
+ * Remembers where a recently seen key was stored, so repeated keys (the usual array of objects that all
+ * have the same shape) are stored once.  Direct-mapped, like the key cache in GRJsonParser.
+ */
+struct GRJsonTapeKeySlot {
+	uint64_t hash;
+	size_t offset;
+	size_t length;
+	bool escaped;
+	bool used;
+};
+
+static inline uint64_t keyHash(const uint8_t *bytes, size_t len) {
+	uint64_t head = 0, tail = 0;
+	if (len >= 8) {
+		memcpy(&head, bytes, 8);
+		memcpy(&tail, bytes + len - 8, 8);
+	}
+	else {
+		memcpy(&head, bytes, len);
+	}
+	uint64_t h = (len * 0x9E3779B97F4A7C15ULL) ^ head;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= tail + (h >> 29);
+	h *= 0xC4CEB9FE1A85EC53ULL;
+	return h ^ (h >> 32);
+}
+
+#pragma mark - lifecycle
+
+void GRJsonTapeInit(GRJsonTape *tape) {
+	memset(tape, 0, sizeof(*tape));
+}
+
+void GRJsonTapeDestroy(GRJsonTape *tape) {
+	free(tape->entries);
+	free(tape->strings);
+	free(tape->open);
+	free(tape->keySlots);
+	memset(tape, 0, sizeof(*tape));
+}
+
+#pragma mark - building
+
+static bool reserveEntries(GRJsonTape *tape, size_t extra) {
+	if (tape->count + extra <= tape->capacity) {
+		return true;
+	}
+	size_t capacity = tape->capacity ? tape->capacity : 64;
+	while (capacity < tape->count + extra) {
+		capacity *= 2;
+	}
+	uint64_t *entries = realloc(tape->entries, capacity * sizeof(uint64_t));
+	if (entries == NULL) {
+		return false;
+	}
+	tape->entries = entries;
+	tape->capacity = capacity;
+	return true;
+}
+
+static inline bool append2(GRJsonTape *tape, uint64_t first, uint64_t second) {
+	if (tape->count + 2 > tape->capacity && !reserveEntries(tape, 2)) {
+		return false;
+	}
+	tape->entries[tape->count++] = first;
+	tape->entries[tape->count++] = second;
+	return true;
+}
+
+static inline bool append1(GRJsonTape *tape, uint64_t entry) {
+	if (tape->count + 1 > tape->capacity && !reserveEntries(tape, 1)) {
+		return false;
+	}
+	tape->entries[tape->count++] = entry;
+	return true;
+}
+
+static inline uint64_t makeEntry(GRJsonTapeType type, uint64_t payload) {
+	return ((uint64_t)type << 56) | payload;
+}
+
+static bool reserveStrings(GRJsonTape *tape, size_t extra) {
+	if (tape->stringsLength + extra <= tape->stringsCapacity) {
+		return true;
+	}
+	size_t capacity = tape->stringsCapacity ? tape->stringsCapacity : 256;
+	while (capacity < tape->stringsLength + extra) {
+		capacity *= 2;
+	}
+	uint8_t *strings = realloc(tape->strings, capacity);
+	if (strings == NULL) {
+		return false;
+	}
+	tape->strings = strings;
+	tape->stringsCapacity = capacity;
+	return true;
+}
+
+static bool appendStringBytes(GRJsonTape *tape, const uint8_t *bytes, size_t length, size_t *offset) {
+	if (!reserveStrings(tape, length)) {
+		return false;
+	}
+	*offset = tape->stringsLength;
+	if (length) {
+		memcpy(tape->strings + tape->stringsLength, bytes, length);
+	}
+	tape->stringsLength += length;
+	return true;
+}
+
+static bool appendString(GRJsonTape *tape, const GRJsonToken *token, bool isKey) {
+	size_t offset;
+	struct GRJsonTapeKeySlot *slot = NULL;
+	uint64_t hash = 0;
+	if (isKey && token->length <= KEY_SLOT_MAX_LENGTH && tape->keySlots) {
+		hash = keyHash(token->bytes, token->length);
+		slot = &tape->keySlots[hash & (KEY_SLOT_COUNT - 1)];
+		if (slot->used && slot->hash == hash && slot->length == token->length && slot->escaped == token->hasEscapes && memcmp(tape->strings + slot->offset, token->bytes, token->length) == 0) {
+			return append2(tape, makeEntry(GRJsonTapeString, slot->offset | (token->hasEscapes ? GRJSON_TAPE_ESCAPED_FLAG : 0)), token->length);
+		}
+	}
+	if (!appendStringBytes(tape, token->bytes, token->length, &offset)) {
+		return false;
+	}
+	if (slot) {
+		slot->hash = hash;
+		slot->offset = offset;
+		slot->length = token->length;
+		slot->escaped = token->hasEscapes;
+		slot->used = true;
+	}
+	return append2(tape, makeEntry(GRJsonTapeString, offset | (token->hasEscapes ? GRJSON_TAPE_ESCAPED_FLAG : 0)), token->length);
+}
+
+static bool pushOpen(GRJsonTape *tape, size_t depth, size_t index) {
+	if (depth == tape->openCapacity) {
+		size_t capacity = tape->openCapacity ? tape->openCapacity * 2 : 32;
+		size_t *open = realloc(tape->open, capacity * sizeof(size_t));
+		if (open == NULL) {
+			return false;
+		}
+		tape->open = open;
+		tape->openCapacity = capacity;
+	}
+	tape->open[depth] = index;
+	return true;
+}
+
+GRJsonError GRJsonTapeBuild(GRJsonTape *tape, GRJsonTokenizer *t, const uint8_t *buf, size_t len) {
+	tape->count = 0;
+	tape->stringsLength = 0;
+	if (tape->keySlots == NULL) {
+		tape->keySlots = calloc(KEY_SLOT_COUNT, sizeof(struct GRJsonTapeKeySlot));
+	}
+	else {
+		memset(tape->keySlots, 0, KEY_SLOT_COUNT * sizeof(struct GRJsonTapeKeySlot));
+	}
+	// a rough guess that avoids most of the regrowth for typical documents
+	// strings is allocated even when every string is empty, so a string's bytes are never NULL
+	if (!reserveEntries(tape, len / 4 + 16) || !reserveStrings(tape, 1)) {
+		return GRJsonErrorOutOfMemory;
+	}
+
+	GRJsonTokenizerReset(t);
+	GRJsonTokenizerSetInput(t, buf, len, true);
+	size_t depth = 0;
+	GRJsonToken token;
+	GRJsonStatus status;
+	while ((status = GRJsonTokenizerNext(t, &token)) == GRJsonStatusToken) {
+		bool ok = true;
+		// every value inside an array, and every key inside an object, adds one to the container's count
+		if (depth > 0 && token.type != GRJsonTokenObjectEnd && token.type != GRJsonTokenArrayEnd) {
+			size_t parent = tape->open[depth - 1];
+			bool parentIsArray = GRJsonTapeTypeAt(tape, parent) == GRJsonTapeArray;
+			if (parentIsArray || token.type == GRJsonTokenKey) {
+				tape->entries[parent + 1]++;
+			}
+		}
+		switch (token.type) {
+			case GRJsonTokenObjectBegin:
+			case GRJsonTokenArrayBegin:
+				ok = pushOpen(tape, depth, tape->count) && append2(tape, makeEntry(token.type == GRJsonTokenObjectBegin ? GRJsonTapeObject : GRJsonTapeArray, 0), 0);
+				depth++;
+				break;
+			case GRJsonTokenObjectEnd:
+			case GRJsonTokenArrayEnd:
+			{
+				size_t open = tape->open[--depth];
+				ok = append1(tape, makeEntry(token.type == GRJsonTokenObjectEnd ? GRJsonTapeObjectEnd : GRJsonTapeArrayEnd, open));
+				tape->entries[open] |= tape->count;
+				break;
+			}
+			case GRJsonTokenKey:
+				ok = appendString(tape, &token, true);
+				break;
+			case GRJsonTokenString:
+				ok = appendString(tape, &token, false);
+				break;
+			case GRJsonTokenNumber:
+			{
+				int64_t integer;
+				double real;
+				// the tokenizer has checked the grammar, so an invalid number means strtod had no memory
+				GRJsonNumberKind kind = GRJsonParseNumber(token.bytes, token.length, &integer, &real);
+				if (kind == GRJsonNumberInvalid) {
+					ok = false;
+				}
+				else if (kind == GRJsonNumberInteger) {
+					ok = append2(tape, makeEntry(GRJsonTapeInteger, 0), (uint64_t)integer);
+				}
+				else {
+					uint64_t bits;
+					memcpy(&bits, &real, sizeof(bits));
+					ok = append2(tape, makeEntry(GRJsonTapeDouble, 0), bits);
+				}
+				break;
+			}
+			case GRJsonTokenTrue:
+				ok = append1(tape, makeEntry(GRJsonTapeTrue, 0));
+				break;
+			case GRJsonTokenFalse:
+				ok = append1(tape, makeEntry(GRJsonTapeFalse, 0));
+				break;
+			case GRJsonTokenNull:
+				ok = append1(tape, makeEntry(GRJsonTapeNull, 0));
+				break;
+			case GRJsonTokenNone:
+				break;
+		}
+		if (!ok) {
+			return GRJsonErrorOutOfMemory;
+		}
+	}
+	if (status == GRJsonStatusError) {
+		return t->error;
+	}
+	return GRJsonErrorNone;
+}
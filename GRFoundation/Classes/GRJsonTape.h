@@ -0,0 +1,135 @@
+//
+//  GRJsonTape.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonTape_h
+#define GRJsonTape_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "GRJsonTokenizer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The type of a tape entry, stored in its top byte.
+ */
+typedef enum GRJsonTapeType {
+	GRJsonTapeObject = '{',    ///< 2 words: payload is the index just past the matching '}', then the member count
+	GRJsonTapeObjectEnd = '}', ///< payload is the index of the matching '{'
+	GRJsonTapeArray = '[',     ///< 2 words: payload is the index just past the matching ']', then the element count
+	GRJsonTapeArrayEnd = ']',  ///< payload is the index of the matching '['
+	GRJsonTapeString = '"',    ///< 2 words: payload is the offset in the string buffer (bit 48 set if escaped), then the length
+	GRJsonTapeInteger = 'l',   ///< 2 words: the second is the int64_t
+	GRJsonTapeDouble = 'd',    ///< 2 words: the second is the bits of the double
+	GRJsonTapeTrue = 't',
+	GRJsonTapeFalse = 'f',
+	GRJsonTapeNull = 'n',
+} GRJsonTapeType;
+
+#define GRJSON_TAPE_PAYLOAD_MASK 0x00FFFFFFFFFFFFFFULL
+#define GRJSON_TAPE_ESCAPED_FLAG (1ULL << 48)
+
+/**
+ * A parsed document flattened into one array of 64-bit entries in document order, plus a buffer holding
+ * the bytes of every string.  Containers record where they end, so a reader can hop over a whole subtree
+ * in one step, and nothing is decoded until somebody asks for it: strings are stored exactly as they
+ * appeared between the quotes (still escaped), and identical keys share a single copy in the buffer.
+ *
+ * The root value is always at index 0.  Object members are stored as a key (a string entry) followed by
+ * the value.
+ */
+typedef struct GRJsonTape {
+	uint64_t *entries;
+	size_t count;
+	size_t capacity;
+	uint8_t *strings;
+	size_t stringsLength;
+	size_t stringsCapacity;
+
+	// scratch space used while building
+	size_t *open;             ///< tape index of each open container
+	size_t openCapacity;
+	struct GRJsonTapeKeySlot *keySlots;
+} GRJsonTape;
+
+void GRJsonTapeInit(GRJsonTape *tape);
+void GRJsonTapeDestroy(GRJsonTape *tape);
+
+/**
+ * Parses buf into the tape, replacing whatever it held before but keeping its memory.  The tokenizer is
+ * reset and used for the grammar; on a syntax error its errorMessage and errorOffset describe the problem.
+ *
+ * @return GRJsonErrorNone on success
+ */
+GRJsonError GRJsonTapeBuild(GRJsonTape *tape, GRJsonTokenizer *tokenizer, const uint8_t *buf, size_t len);
+
+static inline GRJsonTapeType GRJsonTapeTypeAt(const GRJsonTape *tape, size_t index) {
+	return (GRJsonTapeType)(tape->entries[index] >> 56);
+}
+
+static inline uint64_t GRJsonTapePayloadAt(const GRJsonTape *tape, size_t index) {
+	return tape->entries[index] & GRJSON_TAPE_PAYLOAD_MASK;
+}
+
+/** The index of the value that follows the one at index, skipping over any children. */
+static inline size_t GRJsonTapeNext(const GRJsonTape *tape, size_t index) {
+	switch (GRJsonTapeTypeAt(tape, index)) {
+		case GRJsonTapeObject:
+		case GRJsonTapeArray:
+			return (size_t)GRJsonTapePayloadAt(tape, index);
+		case GRJsonTapeString:
+		case GRJsonTapeInteger:
+		case GRJsonTapeDouble:
+			return index + 2;
+		default:
+			return index + 1;
+	}
+}
+
+/** The number of members of an object or elements of an array. */
+static inline size_t GRJsonTapeContainerCount(const GRJsonTape *tape, size_t index) {
+	return (size_t)tape->entries[index + 1];
+}
+
+/** The index of the first child of an object or array (which is its end entry if it is empty). */
+static inline size_t GRJsonTapeFirstChild(size_t index) {
+	return index + 2;
+}
+
+static inline const uint8_t *GRJsonTapeStringAt(const GRJsonTape *tape, size_t index, size_t *length, bool *hasEscapes) {
+	uint64_t payload = GRJsonTapePayloadAt(tape, index);
+	*length = (size_t)tape->entries[index + 1];
+	*hasEscapes = (payload & GRJSON_TAPE_ESCAPED_FLAG) != 0;
+	return tape->strings + (payload & (GRJSON_TAPE_ESCAPED_FLAG - 1));
+}
+
+/** The offset of a string in the string buffer; identical keys share an offset. */
+static inline size_t GRJsonTapeStringOffsetAt(const GRJsonTape *tape, size_t index) {
+	return (size_t)(GRJsonTapePayloadAt(tape, index) & (GRJSON_TAPE_ESCAPED_FLAG - 1));
+}
+
+static inline int64_t GRJsonTapeIntegerAt(const GRJsonTape *tape, size_t index) {
+	return (int64_t)tape->entries[index + 1];
+}
+
+static inline double GRJsonTapeDoubleAt(const GRJsonTape *tape, size_t index) {
+	double value;
+	memcpy(&value, &tape->entries[index + 1], sizeof(value));
+	return value;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonTape_h */
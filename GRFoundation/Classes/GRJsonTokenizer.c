@@ -0,0 +1,671 @@
+//
+//  GRJsonTokenizer.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonTokenizer.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	EXPECT_ROOT,          ///< the top-level value
+	EXPECT_VALUE,         ///< after ':' or after ',' in an array
+	EXPECT_VALUE_OR_END,  ///< right after '['
+	EXPECT_KEY_OR_END,    ///< right after '{'
+	EXPECT_KEY,           ///< after ',' in an object
+	EXPECT_COLON,         ///< after a key
+	EXPECT_COMMA_OR_END,  ///< after a value inside a container
+	EXPECT_DONE,          ///< the top-level value is complete
+};
+
+enum {
+	PARTIAL_NONE = 0,
+	PARTIAL_STRING,
+	PARTIAL_NUMBER,
+	PARTIAL_LITERAL,
+};
+
+/* escapeState values while scanning a string body: 0 is plain text, 1 follows a backslash,
+ * and 2-5 count the hex digits of a \u escape that are still to come */
+enum {
+	ESCAPE_NONE = 0,
+	ESCAPE_BACKSLASH = 1,
+	ESCAPE_HEX_FIRST = 2,
+	ESCAPE_HEX_LAST = 5,
+};
+
+#define CC_NUMBER 1  ///< may appear in a number token
+#define CC_HEX 2
+#define CC_LITERAL 4 ///< may appear in true/false/null
+#define CC_ESCAPE 8  ///< valid after a backslash (other than 'u')
+
+static uint8_t charClass[256];
+
+static void buildCharClass(void) {
+	uint8_t *table = charClass;
+	for (int c = '0'; c <= '9'; c++) {
+		table[c] |= CC_NUMBER | CC_HEX;
+	}
+	table['-'] |= CC_NUMBER;
+	table['+'] |= CC_NUMBER;
+	table['.'] |= CC_NUMBER;
+	table['e'] |= CC_NUMBER;
+	table['E'] |= CC_NUMBER;
+	for (int c = 'a'; c <= 'f'; c++) {
+		table[c] |= CC_HEX;
+		table[c - 'a' + 'A'] |= CC_HEX;
+	}
+	for (int c = 'a'; c <= 'z'; c++) {
+		table[c] |= CC_LITERAL;
+	}
+	const char *escapes = "\"\\/bfnrt";
+	for (const char *e = escapes; *e; e++) {
+		table[(uint8_t)*e] |= CC_ESCAPE;
+	}
+}
+
+static void initCharClass(void) {
+	static pthread_once_t once = PTHREAD_ONCE_INIT;
+	pthread_once(&once, buildCharClass);
+}
+
+#pragma mark - errors
+
+static GRJsonStatus fail(GRJsonTokenizer *t, GRJsonError error, uint64_t offset, const char *fmt, ...) __attribute__((format(printf, 4, 5)));
+
+static GRJsonStatus fail(GRJsonTokenizer *t, GRJsonError error, uint64_t offset, const char *fmt, ...) {
+	va_list argList;
+	va_start(argList, fmt);
+	vsnprintf(t->errorMessage, sizeof(t->errorMessage), fmt, argList);
+	va_end(argList);
+	t->error = error;
+	t->errorOffset = offset;
+	return GRJsonStatusError;
+}
+
+static GRJsonStatus failUnexpected(GRJsonTokenizer *t, const char *expected) {
+	uint8_t c = t->buf[t->pos];
+	uint64_t offset = t->base + t->pos;
+	if (c >= 0x20 && c < 0x7f) {
+		return fail(t, GRJsonErrorUnexpectedCharacter, offset, "expected %s, got '%c' at pos %llu", expected, c, (unsigned long long)offset);
+	}
+	return fail(t, GRJsonErrorUnexpectedCharacter, offset, "expected %s, got byte 0x%02x at pos %llu", expected, c, (unsigned long long)offset);
+}
+
+#pragma mark - lifecycle
+
+void GRJsonTokenizerInit(GRJsonTokenizer *t) {
+	initCharClass();
+	memset(t, 0, sizeof(*t));
+	t->maxDepth = GRJSON_DEFAULT_MAX_DEPTH;
+	GRJsonTokenizerReset(t);
+}
+
+void GRJsonTokenizerDestroy(GRJsonTokenizer *t) {
+	free(t->stack);
+	free(t->carry);
+	t->stack = NULL;
+	t->carry = NULL;
+	t->stackCapacity = 0;
+	t->carryCapacity = 0;
+}
+
+void GRJsonTokenizerReset(GRJsonTokenizer *t) {
+	t->buf = NULL;
+	t->len = 0;
+	t->pos = 0;
+	t->isFinal = false;
+	t->base = 0;
+	GRJsonStructuralIndexInit(&t->index, NULL, 0);
+	t->expect = EXPECT_ROOT;
+	t->depth = 0;
+	t->sawToken = false;
+	t->partial = PARTIAL_NONE;
+	t->partialIsKey = false;
+	t->partialHasEscapes = false;
+	t->escapeState = ESCAPE_NONE;
+	t->partialOffset = 0;
+	t->carryLength = 0;
+	t->skipDepth = 0;
+	t->skipInString = false;
+	t->skipEscape = false;
+	t->error = GRJsonErrorNone;
+	t->errorOffset = 0;
+	t->errorMessage[0] = '\0';
+}
+
+void GRJsonTokenizerSetMaxDepth(GRJsonTokenizer *t, size_t maxDepth) {
+	t->maxDepth = maxDepth ? maxDepth : GRJSON_DEFAULT_MAX_DEPTH;
+}
+
+void GRJsonTokenizerSetInput(GRJsonTokenizer *t, const uint8_t *buf, size_t len, bool isFinal) {
+	t->base += t->len;
+	t->buf = buf;
+	t->len = len;
+	t->pos = 0;
+	t->isFinal = isFinal;
+	GRJsonStructuralIndexInit(&t->index, buf, len);
+}
+
+#pragma mark - helpers
+
+static bool appendCarry(GRJsonTokenizer *t, const uint8_t *bytes, size_t length) {
+	if (length == 0) {
+		return true;
+	}
+	if (t->carryLength + length > t->carryCapacity) {
+		size_t capacity = t->carryCapacity ? t->carryCapacity : 64;
+		while (capacity < t->carryLength + length) {
+			capacity *= 2;
+		}
+		uint8_t *carry = realloc(t->carry, capacity);
+		if (carry == NULL) {
+			return false;
+		}
+		t->carry = carry;
+		t->carryCapacity = capacity;
+	}
+	memcpy(t->carry + t->carryLength, bytes, length);
+	t->carryLength += length;
+	return true;
+}
+
+/** Only called below the maximum depth, which the stack is sized for in one go so nesting never grows it. */
+static bool pushContainer(GRJsonTokenizer *t, uint8_t container) {
+	if (t->depth == t->stackCapacity) {
+		uint8_t *stack = realloc(t->stack, t->maxDepth);
+		if (stack == NULL) {
+			return false;
+		}
+		t->stack = stack;
+		t->stackCapacity = t->maxDepth;
+	}
+	t->stack[t->depth++] = container;
+	return true;
+}
+
+static inline void valueDone(GRJsonTokenizer *t) {
+	t->expect = t->depth == 0 ? EXPECT_DONE : EXPECT_COMMA_OR_END;
+}
+
+/**
+ * Scans a string body from pos, continuing in whatever escape state the previous buffer left off in.
+ * Returns the position of the closing quote, t->len if the buffer ran out first, or SIZE_MAX on error.
+ */
+static size_t scanStringBody(GRJsonTokenizer *t, size_t pos, bool *hasEscapes) {
+	const uint8_t *buf = t->buf;
+	size_t len = t->len;
+	uint8_t escapeState = t->escapeState;
+	while (pos < len) {
+		if (escapeState == ESCAPE_NONE) {
+			pos = GRJsonStructuralIndexNextStringSpecial(&t->index, pos);
+			if (pos >= len) {
+				break;
+			}
+			uint8_t c = buf[pos];
+			if (c == '"') {
+				t->escapeState = ESCAPE_NONE;
+				return pos;
+			}
+			if (c != '\\') {
+				fail(t, GRJsonErrorInvalidString, t->base + pos, "invalid control character 0x%02x in string at pos %llu", c, (unsigned long long)(t->base + pos));
+				return SIZE_MAX;
+			}
+			*hasEscapes = true;
+			escapeState = ESCAPE_BACKSLASH;
+			pos++;
+		}
+		else if (escapeState == ESCAPE_BACKSLASH) {
+			uint8_t c = buf[pos];
+			if (charClass[c] & CC_ESCAPE) {
+				escapeState = ESCAPE_NONE;
+			}
+			else if (c == 'u') {
+				escapeState = ESCAPE_HEX_FIRST;
+			}
+			else {
+				fail(t, GRJsonErrorInvalidString, t->base + pos, "invalid escape char '%c' at pos %llu", c, (unsigned long long)(t->base + pos));
+				return SIZE_MAX;
+			}
+			pos++;
+		}
+		else {
+			if (!(charClass[buf[pos]] & CC_HEX)) {
+				fail(t, GRJsonErrorInvalidString, t->base + pos, "invalid HEX character in unicode escape at pos %llu", (unsigned long long)(t->base + pos));
+				return SIZE_MAX;
+			}
+			escapeState = escapeState == ESCAPE_HEX_LAST ? ESCAPE_NONE : escapeState + 1;
+			pos++;
+		}
+	}
+	t->escapeState = escapeState;
+	return len;
+}
+
+/** the RFC 8259 number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+static bool isValidNumber(const uint8_t *p, size_t length) {
+	const uint8_t *end = p + length;
+	if (p < end && *p == '-') {
+		p++;
+	}
+	if (p == end) {
+		return false;
+	}
+	if (*p == '0') {
+		p++;
+	}
+	else if (*p >= '1' && *p <= '9') {
+		while (p < end && *p >= '0' && *p <= '9') {
+			p++;
+		}
+	}
+	else {
+		return false;
+	}
+	if (p < end && *p == '.') {
+		p++;
+		const uint8_t *digits = p;
+		while (p < end && *p >= '0' && *p <= '9') {
+			p++;
+		}
+		if (p == digits) {
+			return false;
+		}
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		p++;
+		if (p < end && (*p == '+' || *p == '-')) {
+			p++;
+		}
+		const uint8_t *digits = p;
+		while (p < end && *p >= '0' && *p <= '9') {
+			p++;
+		}
+		if (p == digits) {
+			return false;
+		}
+	}
+	return p == end;
+}
+
+static GRJsonStatus emitNumber(GRJsonTokenizer *t, GRJsonToken *token, const uint8_t *bytes, size_t length, uint64_t offset) {
+	if (!isValidNumber(bytes, length)) {
+		return fail(t, GRJsonErrorInvalidNumber, offset, "invalid number '%.*s' at pos %llu", (int)(length > 32 ? 32 : length), (const char *)bytes, (unsigned long long)offset);
+	}
+	token->type = GRJsonTokenNumber;
+	token->bytes = bytes;
+	token->length = length;
+	token->hasEscapes = false;
+	token->offset = offset;
+	valueDone(t);
+	return GRJsonStatusToken;
+}
+
+static GRJsonStatus emitLiteral(GRJsonTokenizer *t, GRJsonToken *token, const uint8_t *bytes, size_t length, uint64_t offset) {
+	if (length == 4 && memcmp(bytes, "true", 4) == 0) {
+		token->type = GRJsonTokenTrue;
+	}
+	else if (length == 5 && memcmp(bytes, "false", 5) == 0) {
+		token->type = GRJsonTokenFalse;
+	}
+	else if (length == 4 && memcmp(bytes, "null", 4) == 0) {
+		token->type = GRJsonTokenNull;
+	}
+	else {
+		return fail(t, GRJsonErrorInvalidLiteral, offset, "bad literal value '%.*s' at pos %llu", (int)(length > 8 ? 8 : length), (const char *)bytes, (unsigned long long)offset);
+	}
+	token->bytes = bytes;
+	token->length = length;
+	token->hasEscapes = false;
+	token->offset = offset;
+	valueDone(t);
+	return GRJsonStatusToken;
+}
+
+static GRJsonStatus emitString(GRJsonTokenizer *t, GRJsonToken *token, const uint8_t *bytes, size_t length, bool isKey, bool hasEscapes, uint64_t offset) {
+	token->type = isKey ? GRJsonTokenKey : GRJsonTokenString;
+	token->bytes = bytes;
+	token->length = length;
+	token->hasEscapes = hasEscapes;
+	token->offset = offset;
+	if (isKey) {
+		t->expect = EXPECT_COLON;
+	}
+	else {
+		valueDone(t);
+	}
+	return GRJsonStatusToken;
+}
+
+/** saves buf[start, len) as the beginning of a token that continues in the next input */
+static GRJsonStatus savePartial(GRJsonTokenizer *t, uint8_t kind, size_t start, bool isKey, bool hasEscapes) {
+	t->carryLength = 0;
+	if (!appendCarry(t, t->buf + start, t->len - start)) {
+		return fail(t, GRJsonErrorOutOfMemory, t->base + start, "out of memory");
+	}
+	t->partial = kind;
+	t->partialIsKey = isKey;
+	t->partialHasEscapes = hasEscapes;
+	t->pos = t->len;
+	return GRJsonStatusNeedMore;
+}
+
+#pragma mark - tokens
+
+static GRJsonStatus scanString(GRJsonTokenizer *t, GRJsonToken *token, bool isKey) {
+	size_t quotePos = t->pos;
+	size_t start = quotePos + 1;
+	bool hasEscapes = false;
+	t->escapeState = ESCAPE_NONE;
+	size_t end = scanStringBody(t, start, &hasEscapes);
+	if (end == SIZE_MAX) {
+		return GRJsonStatusError;
+	}
+	if (end < t->len) {
+		t->pos = end + 1;
+		return emitString(t, token, t->buf + start, end - start, isKey, hasEscapes, t->base + quotePos);
+	}
+	if (t->isFinal) {
+		return fail(t, GRJsonErrorUnexpectedEOF, t->base + t->len, "unexpected EOF while parsing string");
+	}
+	t->partialOffset = t->base + quotePos;
+	return savePartial(t, PARTIAL_STRING, start, isKey, hasEscapes);
+}
+
+static inline size_t scanClass(const GRJsonTokenizer *t, size_t pos, uint8_t cls) {
+	const uint8_t *buf = t->buf;
+	size_t len = t->len;
+	while (pos < len && (charClass[buf[pos]] & cls)) {
+		pos++;
+	}
+	return pos;
+}
+
+static GRJsonStatus scanNumberOrLiteral(GRJsonTokenizer *t, GRJsonToken *token, uint8_t kind) {
+	size_t start = t->pos;
+	size_t end = scanClass(t, start, kind == PARTIAL_NUMBER ? CC_NUMBER : CC_LITERAL);
+	if (end == t->len && !t->isFinal) {
+		t->partialOffset = t->base + start;
+		return savePartial(t, kind, start, false, false);
+	}
+	t->pos = end;
+	if (kind == PARTIAL_NUMBER) {
+		return emitNumber(t, token, t->buf + start, end - start, t->base + start);
+	}
+	return emitLiteral(t, token, t->buf + start, end - start, t->base + start);
+}
+
+/** finishes a token that was started in a previous input */
+static GRJsonStatus continuePartial(GRJsonTokenizer *t, GRJsonToken *token) {
+	uint8_t kind = t->partial;
+	if (kind == PARTIAL_STRING) {
+		bool hasEscapes = t->partialHasEscapes;
+		size_t end = scanStringBody(t, t->pos, &hasEscapes);
+		if (end == SIZE_MAX) {
+			return GRJsonStatusError;
+		}
+		if (!appendCarry(t, t->buf + t->pos, end - t->pos)) {
+			return fail(t, GRJsonErrorOutOfMemory, t->base + t->pos, "out of memory");
+		}
+		t->partialHasEscapes = hasEscapes;
+		if (end == t->len) {
+			t->pos = end;
+			if (t->isFinal) {
+				return fail(t, GRJsonErrorUnexpectedEOF, t->base + t->len, "unexpected EOF while parsing string");
+			}
+			return GRJsonStatusNeedMore;
+		}
+		t->pos = end + 1;
+		t->partial = PARTIAL_NONE;
+		return emitString(t, token, t->carry, t->carryLength, t->partialIsKey, hasEscapes, t->partialOffset);
+	}
+	size_t end = scanClass(t, t->pos, kind == PARTIAL_NUMBER ? CC_NUMBER : CC_LITERAL);
+	if (!appendCarry(t, t->buf + t->pos, end - t->pos)) {
+		return fail(t, GRJsonErrorOutOfMemory, t->base + t->pos, "out of memory");
+	}
+	t->pos = end;
+	if (end == t->len && !t->isFinal) {
+		return GRJsonStatusNeedMore;
+	}
+	t->partial = PARTIAL_NONE;
+	if (kind == PARTIAL_NUMBER) {
+		return emitNumber(t, token, t->carry, t->carryLength, t->partialOffset);
+	}
+	return emitLiteral(t, token, t->carry, t->carryLength, t->partialOffset);
+}
+
+static inline GRJsonStatus beginContainer(GRJsonTokenizer *t, GRJsonToken *token, uint8_t container) {
+	if (t->depth >= t->maxDepth) {
+		return fail(t, GRJsonErrorTooDeep, t->base + t->pos, "nested more than %zu levels deep", t->maxDepth);
+	}
+	if (!pushContainer(t, container)) {
+		return fail(t, GRJsonErrorOutOfMemory, t->base + t->pos, "out of memory");
+	}
+	token->type = container == '{' ? GRJsonTokenObjectBegin : GRJsonTokenArrayBegin;
+	token->bytes = t->buf + t->pos;
+	token->length = 1;
+	token->hasEscapes = false;
+	token->offset = t->base + t->pos;
+	t->expect = container == '{' ? EXPECT_KEY_OR_END : EXPECT_VALUE_OR_END;
+	t->pos++;
+	return GRJsonStatusToken;
+}
+
+static inline GRJsonStatus endContainer(GRJsonTokenizer *t, GRJsonToken *token) {
+	token->type = t->stack[t->depth - 1] == '{' ? GRJsonTokenObjectEnd : GRJsonTokenArrayEnd;
+	token->bytes = t->buf + t->pos;
+	token->length = 1;
+	token->hasEscapes = false;
+	token->offset = t->base + t->pos;
+	t->depth--;
+	t->pos++;
+	valueDone(t);
+	return GRJsonStatusToken;
+}
+
+static inline GRJsonStatus scanValue(GRJsonTokenizer *t, GRJsonToken *token) {
+	switch (t->buf[t->pos]) {
+		case '{':
+			return beginContainer(t, token, '{');
+		case '[':
+			return beginContainer(t, token, '[');
+		case '"':
+			return scanString(t, token, false);
+		case '-':
+		case '0':
+		case '1':
+		case '2':
+		case '3':
+		case '4':
+		case '5':
+		case '6':
+		case '7':
+		case '8':
+		case '9':
+			return scanNumberOrLiteral(t, token, PARTIAL_NUMBER);
+		case 't':
+		case 'f':
+		case 'n':
+			return scanNumberOrLiteral(t, token, PARTIAL_LITERAL);
+		default:
+			return failUnexpected(t, "a value");
+	}
+}
+
+#pragma mark - skipping
+
+static bool skipContainerBytes(GRJsonTokenizer *t);
+
+void GRJsonTokenizerSkipContainer(GRJsonTokenizer *t) {
+	t->skipDepth = 1;
+	t->skipInString = false;
+	t->skipEscape = false;
+	// skip right away when the end is in this input, so GRJsonTokenizerOffset lands just past it
+	if (skipContainerBytes(t)) {
+		t->depth--;
+		valueDone(t);
+	}
+}
+
+/**
+ * Moves past the bytes of the container being skipped, counting brackets and ignoring anything inside
+ * strings.  Returns true once the matching end has been passed, or false if the input ran out first.
+ */
+static bool skipContainerBytes(GRJsonTokenizer *t) {
+	const uint8_t *buf = t->buf;
+	size_t len = t->len;
+	size_t pos = t->pos;
+	size_t depth = t->skipDepth;
+	bool inString = t->skipInString;
+	if (t->skipEscape && pos < len) {
+		t->skipEscape = false;
+		pos++;
+	}
+	while (pos < len) {
+		if (inString) {
+			pos = GRJsonStructuralIndexNextStringSpecial(&t->index, pos);
+			if (pos >= len) {
+				break;
+			}
+			uint8_t c = buf[pos++];
+			if (c == '"') {
+				inString = false;
+			}
+			else if (c == '\\') {
+				if (pos == len) {
+					t->skipEscape = true;
+					break;
+				}
+				pos++;
+			}
+		}
+		else {
+			pos = GRJsonStructuralIndexNextQuoteOrStructural(&t->index, pos);
+			if (pos >= len) {
+				break;
+			}
+			uint8_t c = buf[pos++];
+			if (c == '"') {
+				inString = true;
+			}
+			else if (c == '{' || c == '[') {
+				depth++;
+			}
+			else if ((c == '}' || c == ']') && --depth == 0) {
+				t->pos = pos;
+				t->skipDepth = 0;
+				return true;
+			}
+		}
+	}
+	t->pos = len;
+	t->skipDepth = depth;
+	t->skipInString = inString;
+	return false;
+}
+
+GRJsonStatus GRJsonTokenizerNext(GRJsonTokenizer *t, GRJsonToken *token) {
+	if (t->error != GRJsonErrorNone) {
+		return GRJsonStatusError;
+	}
+	if (t->skipDepth) {
+		if (!skipContainerBytes(t)) {
+			if (!t->isFinal) {
+				return GRJsonStatusNeedMore;
+			}
+			return fail(t, GRJsonErrorUnexpectedEOF, t->base + t->len, "unexpected EOF while skipping a value");
+		}
+		t->depth--;
+		valueDone(t);
+	}
+	if (t->partial != PARTIAL_NONE) {
+		if (t->pos >= t->len && !t->isFinal) {
+			return GRJsonStatusNeedMore;
+		}
+		GRJsonStatus status = continuePartial(t, token);
+		if (status == GRJsonStatusToken) {
+			t->sawToken = true;
+		}
+		return status;
+	}
+	while (true) {
+		size_t pos = t->pos;
+		if (pos < t->len && t->buf[pos] <= ' ') {
+			pos = GRJsonStructuralIndexSkipWhitespace(&t->index, pos);
+			t->pos = pos;
+		}
+		if (pos >= t->len) {
+			if (!t->isFinal) {
+				return GRJsonStatusNeedMore;
+			}
+			if (t->expect == EXPECT_DONE) {
+				return GRJsonStatusEnd;
+			}
+			if (!t->sawToken) {
+				return fail(t, GRJsonErrorEmptyDocument, t->base + pos, "empty document");
+			}
+			return fail(t, GRJsonErrorUnexpectedEOF, t->base + pos, "unexpected EOF");
+		}
+		uint8_t c = t->buf[pos];
+		GRJsonStatus status;
+		switch (t->expect) {
+			case EXPECT_COLON:
+				if (c != ':') {
+					return failUnexpected(t, "pair-separator ':'");
+				}
+				t->pos++;
+				t->expect = EXPECT_VALUE;
+				continue;
+			case EXPECT_COMMA_OR_END:
+			{
+				uint8_t container = t->stack[t->depth - 1];
+				if (c == ',') {
+					t->pos++;
+					t->expect = container == '{' ? EXPECT_KEY : EXPECT_VALUE;
+					continue;
+				}
+				if (c == (container == '{' ? '}' : ']')) {
+					status = endContainer(t, token);
+					break;
+				}
+				return failUnexpected(t, container == '{' ? "',' or '}'" : "',' or ']'");
+			}
+			case EXPECT_KEY_OR_END:
+				if (c == '}') {
+					status = endContainer(t, token);
+					break;
+				}
+				// fall through
+			case EXPECT_KEY:
+				if (c != '"') {
+					return failUnexpected(t, "'\"' to start an object key");
+				}
+				status = scanString(t, token, true);
+				break;
+			case EXPECT_VALUE_OR_END:
+				if (c == ']') {
+					status = endContainer(t, token);
+					break;
+				}
+				// fall through
+			case EXPECT_ROOT:
+			case EXPECT_VALUE:
+				status = scanValue(t, token);
+				break;
+			case EXPECT_DONE:
+			default:
+				return fail(t, GRJsonErrorTrailingCharacters, t->base + pos, "unexpected '%c' after the end of the document at pos %llu", c, (unsigned long long)(t->base + pos));
+		}
+		if (status == GRJsonStatusToken) {
+			t->sawToken = true;
+		}
+		return status;
+	}
+}
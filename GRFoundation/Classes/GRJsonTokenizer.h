@@ -0,0 +1,164 @@
+//
+//  GRJsonTokenizer.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonTokenizer_h
+#define GRJsonTokenizer_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GRJsonStructuralIndex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GRJSON_DEFAULT_MAX_DEPTH 1024 ///< how deeply objects and arrays may nest, unless GRJsonTokenizerSetMaxDepth says otherwise
+
+typedef enum GRJsonTokenType {
+	GRJsonTokenNone = 0,
+	GRJsonTokenObjectBegin,
+	GRJsonTokenObjectEnd,
+	GRJsonTokenArrayBegin,
+	GRJsonTokenArrayEnd,
+	GRJsonTokenKey,
+	GRJsonTokenString,
+	GRJsonTokenNumber,
+	GRJsonTokenTrue,
+	GRJsonTokenFalse,
+	GRJsonTokenNull,
+} GRJsonTokenType;
+
+/**
+ * One token.  For keys and strings, bytes/length is the body between the quotes, still escaped (check
+ * hasEscapes).  For numbers it is the literal text of the number.  The bytes point either into the input
+ * buffer or, for a token that was split across two inputs, into the tokenizer's carry buffer; either way
+ * they are only valid until the next call to GRJsonTokenizerNext.
+ */
+typedef struct GRJsonToken {
+	GRJsonTokenType type;
+	const uint8_t *bytes;
+	size_t length;
+	bool hasEscapes;
+	uint64_t offset; ///< stream offset of the first byte of the token (the opening quote for strings)
+} GRJsonToken;
+
+typedef enum GRJsonStatus {
+	GRJsonStatusToken,    ///< a token was produced
+	GRJsonStatusNeedMore, ///< the current input has been consumed, supply the next chunk
+	GRJsonStatusEnd,      ///< the document is complete
+	GRJsonStatusError,    ///< the input is not valid JSON, see error/errorMessage/errorOffset
+} GRJsonStatus;
+
+typedef enum GRJsonError {
+	GRJsonErrorNone = 0,
+	GRJsonErrorEmptyDocument,
+	GRJsonErrorUnexpectedEOF,
+	GRJsonErrorUnexpectedCharacter,
+	GRJsonErrorInvalidString,
+	GRJsonErrorInvalidNumber,
+	GRJsonErrorInvalidLiteral,
+	GRJsonErrorTrailingCharacters,
+	GRJsonErrorOutOfMemory,
+	GRJsonErrorTooDeep,
+} GRJsonError;
+
+/**
+ * A resumable JSON tokenizer.  It validates the full grammar as it goes and keeps its position in the
+ * grammar in an explicit container stack rather than on the C stack, so it can stop at the end of any
+ * input buffer and pick up again when the next one is supplied, and nesting costs one byte of that stack
+ * per level rather than a call frame.  The stack is allocated once, at the maximum depth, the first time a
+ * container opens; nesting past the maximum fails with GRJsonErrorTooDeep.  A token that straddles two buffers is
+ * stitched together in a small carry buffer; only the bytes of that one token are ever copied.
+ *
+ * Treat the fields as private.
+ */
+typedef struct GRJsonTokenizer {
+	const uint8_t *buf;       ///< current input
+	size_t len;
+	size_t pos;
+	bool isFinal;             ///< no more input will follow the current buffer
+	uint64_t base;            ///< stream offset of buf[0]
+	GRJsonStructuralIndex index;
+
+	uint8_t expect;           ///< what the grammar allows next
+	uint8_t *stack;           ///< '{' or '[' for each open container
+	size_t depth;
+	size_t stackCapacity;
+	size_t maxDepth;
+	bool sawToken;
+
+	uint8_t partial;          ///< the kind of token split across inputs, or 0
+	bool partialIsKey;
+	bool partialHasEscapes;
+	uint8_t escapeState;
+	uint64_t partialOffset;
+	uint8_t *carry;
+	size_t carryLength;
+	size_t carryCapacity;
+
+	size_t skipDepth;         ///< nesting depth inside a container being skipped, or 0
+	bool skipInString;
+	bool skipEscape;          ///< the previous input ended right after a backslash inside a skipped string
+
+	GRJsonError error;
+	uint64_t errorOffset;
+	char errorMessage[160];
+} GRJsonTokenizer;
+
+void GRJsonTokenizerInit(GRJsonTokenizer *t);
+void GRJsonTokenizerDestroy(GRJsonTokenizer *t);
+
+/** Resets to the start of a new document, keeping the maximum depth and any memory that was already allocated. */
+void GRJsonTokenizerReset(GRJsonTokenizer *t);
+
+/**
+ * Sets how deeply objects and arrays may nest (GRJSON_DEFAULT_MAX_DEPTH to begin with; 0 goes back to it).
+ * Only valid between documents.
+ */
+void GRJsonTokenizerSetMaxDepth(GRJsonTokenizer *t, size_t maxDepth);
+
+/**
+ * Supplies the next buffer.  Only valid once GRJsonTokenizerNext has returned GRJsonStatusNeedMore (or
+ * before the first call).  The buffer must stay valid until the tokenizer asks for more.  Pass isFinal
+ * with the last buffer (an empty buffer is fine) so trailing numbers and truncated documents are detected.
+ */
+void GRJsonTokenizerSetInput(GRJsonTokenizer *t, const uint8_t *buf, size_t len, bool isFinal);
+
+GRJsonStatus GRJsonTokenizerNext(GRJsonTokenizer *t, GRJsonToken *token);
+
+/**
+ * Skips the rest of the object or array that was just opened.  Only valid immediately after
+ * GRJsonTokenizerNext has returned GRJsonTokenObjectBegin or GRJsonTokenArrayBegin.  The next call to
+ * GRJsonTokenizerNext returns the first token after the matching end, which itself is not returned.
+ *
+ * Skipped bytes are only balanced (brackets outside of strings, quotes and escapes inside them), not
+ * validated or tokenized, so the scan is much faster than tokenizing; the flip side is that an error
+ * inside a skipped value goes unnoticed.  Skipping works across inputs like everything else.
+ */
+void GRJsonTokenizerSkipContainer(GRJsonTokenizer *t);
+
+/**
+ * The stream offset just past the last token returned, or past the container that was just skipped if its
+ * end was in the current input.  Together with a token's offset this gives the exact span of its text.
+ */
+static inline uint64_t GRJsonTokenizerOffset(const GRJsonTokenizer *t) {
+	return t->base + t->pos;
+}
+
+/** The number of open objects and arrays. */
+static inline size_t GRJsonTokenizerDepth(const GRJsonTokenizer *t) {
+	return t->depth;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonTokenizer_h */
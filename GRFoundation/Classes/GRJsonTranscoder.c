@@ -0,0 +1,312 @@
+//
+//  GRJsonTranscoder.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonTranscoder.h"
+#include "GRJsonStructuralIndex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ODD_BITS 0xAAAAAAAAAAAAAAAAULL
+
+/** A run of input bytes that will be copied to the output as is; runs that touch are merged before copying. */
+typedef struct Span {
+	const uint8_t *bytes;
+	size_t length;
+} Span;
+
+#pragma mark - lifecycle
+
+void GRJsonTranscoderInit(GRJsonTranscoder *t, GRJsonTranscodeStyle style, size_t indentWidth) {
+	memset(t, 0, sizeof(*t));
+	t->style = style;
+	t->indentWidth = indentWidth;
+}
+
+void GRJsonTranscoderDestroy(GRJsonTranscoder *t) {
+	free(t->buf);
+	memset(t, 0, sizeof(*t));
+}
+
+void GRJsonTranscoderReset(GRJsonTranscoder *t) {
+	t->inStringCarry = 0;
+	t->nextIsEscaped = 0;
+	t->depth = 0;
+	t->openPending = false;
+	t->length = 0;
+	t->error = GRJsonTranscoderErrorNone;
+}
+
+void GRJsonTranscoderSetSink(GRJsonTranscoder *t, GRJsonEmitterSink sink, void *context) {
+	t->sink = sink;
+	t->sinkContext = context;
+}
+
+#pragma mark - output
+
+static bool flushBuffer(GRJsonTranscoder *t) {
+	if (t->sink == NULL || t->length == 0) {
+		return true;
+	}
+	if (!t->sink(t->sinkContext, t->buf, t->length)) {
+		t->error = GRJsonTranscoderErrorSink;
+		return false;
+	}
+	t->length = 0;
+	return true;
+}
+
+static bool grow(GRJsonTranscoder *t, size_t extra) {
+	size_t capacity = t->capacity ? t->capacity : 256;
+	while (capacity < t->length + extra) {
+		capacity *= 2;
+	}
+	uint8_t *buf = realloc(t->buf, capacity);
+	if (buf == NULL) {
+		t->error = GRJsonTranscoderErrorOutOfMemory;
+		return false;
+	}
+	t->buf = buf;
+	t->capacity = capacity;
+	return true;
+}
+
+static bool put(GRJsonTranscoder *t, const void *bytes, size_t length) {
+	if (t->sink && length >= GRJSON_EMITTER_FLUSH_SIZE) {
+		// a long run goes straight to the sink rather than through the buffer
+		if (!flushBuffer(t)) {
+			return false;
+		}
+		if (!t->sink(t->sinkContext, bytes, length)) {
+			t->error = GRJsonTranscoderErrorSink;
+			return false;
+		}
+		return true;
+	}
+	if (t->length + length > t->capacity && !grow(t, length)) {
+		return false;
+	}
+	memcpy(t->buf + t->length, bytes, length);
+	t->length += length;
+	if (t->sink && t->length >= GRJSON_EMITTER_FLUSH_SIZE) {
+		return flushBuffer(t);
+	}
+	return true;
+}
+
+static inline bool flushSpan(GRJsonTranscoder *t, Span *span) {
+	if (span->length == 0) {
+		return true;
+	}
+	bool written = put(t, span->bytes, span->length);
+	span->length = 0;
+	return written;
+}
+
+/** Adds each run of set bits in keep, a mask over the 64 bytes at block, to the bytes to copy. */
+static bool keepRuns(GRJsonTranscoder *t, Span *span, const uint8_t *block, uint64_t keep) {
+	while (keep) {
+		unsigned start = (unsigned)__builtin_ctzll(keep);
+		uint64_t rest = ~(keep >> start);
+		unsigned length = rest ? (unsigned)__builtin_ctzll(rest) : GRJSON_BLOCK_SIZE - start;
+		const uint8_t *bytes = block + start;
+		if (span->length && span->bytes + span->length == bytes) {
+			span->length += length;
+		}
+		else {
+			if (!flushSpan(t, span)) {
+				return false;
+			}
+			span->bytes = bytes;
+			span->length = length;
+		}
+		keep = start + length < GRJSON_BLOCK_SIZE ? keep & (~0ULL << (start + length)) : 0;
+	}
+	return true;
+}
+
+/**
+ * Minifies one block.  A block with nothing to drop joins the run being copied; any other block is packed
+ * straight into the output buffer by the vectorized compaction (see GRJsonCompactBlock).
+ */
+static bool compact(GRJsonTranscoder *t, Span *span, const uint8_t *block, size_t blockLength, uint64_t keep) {
+	if (blockLength == GRJSON_BLOCK_SIZE && keep == UINT64_MAX) {
+		return keepRuns(t, span, block, keep);
+	}
+	if (!flushSpan(t, span)) {
+		return false;
+	}
+	if (t->length + GRJSON_BLOCK_SIZE > t->capacity && !grow(t, GRJSON_BLOCK_SIZE)) {
+		return false;
+	}
+	uint8_t padded[GRJSON_BLOCK_SIZE];
+	if (blockLength < GRJSON_BLOCK_SIZE) {
+		// never read past the end of the input
+		memcpy(padded, block, blockLength);
+		block = padded;
+	}
+	t->length += GRJsonCompactBlock(block, keep, t->buf + t->length);
+	if (t->sink && t->length >= GRJSON_EMITTER_FLUSH_SIZE) {
+		return flushBuffer(t);
+	}
+	return true;
+}
+
+#pragma mark - pretty-printing
+
+static bool newline(GRJsonTranscoder *t, Span *span) {
+	if (!flushSpan(t, span)) {
+		return false;
+	}
+	size_t indent = t->depth * t->indentWidth;
+	if (t->length + 1 + indent > t->capacity && !grow(t, 1 + indent)) {
+		return false;
+	}
+	t->buf[t->length] = '\n';
+	memset(t->buf + t->length + 1, ' ', indent);
+	t->length += 1 + indent;
+	if (t->sink && t->length >= GRJSON_EMITTER_FLUSH_SIZE) {
+		return flushBuffer(t);
+	}
+	return true;
+}
+
+/** Starts the line of the first value in a container, once it is known not to be empty. */
+static inline bool beginValue(GRJsonTranscoder *t, Span *span) {
+	if (!t->openPending) {
+		return true;
+	}
+	t->openPending = false;
+	return newline(t, span);
+}
+
+static bool structural(GRJsonTranscoder *t, Span *span, uint8_t c) {
+	switch (c) {
+		case '{':
+		case '[':
+			if (!beginValue(t, span) || !flushSpan(t, span) || !put(t, &c, 1)) {
+				return false;
+			}
+			t->depth++;
+			t->openPending = true;
+			return true;
+		case '}':
+		case ']':
+			if (t->depth == 0) {
+				t->error = GRJsonTranscoderErrorUnbalanced;
+				return false;
+			}
+			t->depth--;
+			if (t->openPending) {
+				t->openPending = false;
+			}
+			else if (!newline(t, span)) {
+				return false;
+			}
+			return flushSpan(t, span) && put(t, &c, 1);
+		case ',':
+			return flushSpan(t, span) && put(t, ",", 1) && newline(t, span);
+		default:
+			return flushSpan(t, span) && put(t, ": ", 2);
+	}
+}
+
+#pragma mark - block masks
+
+/** Bit i of the result is the XOR of bits 0..i of x: set from each opening quote up to its closing quote. */
+static inline uint64_t prefixXor(uint64_t x) {
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return x;
+}
+
+/**
+ * The characters escaped by a backslash, as in GRJsonValidator.c, except that a piece of input may end
+ * part way through a block, so the run of backslashes carried over is the one that ends at lastBit.
+ */
+static inline uint64_t escapedCharacters(uint64_t backslash, uint64_t *nextIsEscaped, unsigned lastBit) {
+	if (backslash == 0) {
+		uint64_t escaped = *nextIsEscaped;
+		*nextIsEscaped = 0;
+		return escaped;
+	}
+	uint64_t potentialEscape = backslash & ~*nextIsEscaped;
+	uint64_t maybeEscaped = potentialEscape << 1;
+	uint64_t escapeAndTerminalCode = ((maybeEscaped | ODD_BITS) - potentialEscape) ^ ODD_BITS;
+	uint64_t escaped = escapeAndTerminalCode ^ (backslash | *nextIsEscaped);
+	*nextIsEscaped = (escapeAndTerminalCode & backslash) >> lastBit & 1;
+	return escaped;
+}
+
+#pragma mark - transcoding
+
+bool GRJsonTranscoderFeed(GRJsonTranscoder *t, const uint8_t *bytes, size_t length) {
+	if (t->error != GRJsonTranscoderErrorNone) {
+		return false;
+	}
+	GRJsonStructuralIndex idx;
+	GRJsonStructuralIndexInit(&idx, bytes, length);
+	Span span = { NULL, 0 };
+	bool pretty = t->style == GRJsonTranscodePretty;
+
+	for (size_t blockStart = 0; blockStart < length; blockStart += GRJSON_BLOCK_SIZE) {
+		size_t blockLength = length - blockStart > GRJSON_BLOCK_SIZE ? GRJSON_BLOCK_SIZE : length - blockStart;
+		uint64_t valid = blockLength == GRJSON_BLOCK_SIZE ? UINT64_MAX : (1ULL << blockLength) - 1;
+		GRJsonStructuralIndexLoad(&idx, blockStart);
+		const GRJsonBlockMasks *m = &idx.masks;
+		const uint8_t *block = bytes + blockStart;
+
+		uint64_t escaped = escapedCharacters(m->backslash, &t->nextIsEscaped, (unsigned)blockLength - 1);
+		uint64_t inString = prefixXor(m->quote & ~escaped) ^ t->inStringCarry;
+		t->inStringCarry = (uint64_t)((int64_t)inString >> 63);
+		uint64_t keep = valid & ~(m->whitespace & ~inString);
+
+		if (!pretty) {
+			if (!compact(t, &span, block, blockLength, keep)) {
+				return false;
+			}
+			continue;
+		}
+		for (uint64_t special = m->structural & ~inString & valid; special; special &= special - 1) {
+			unsigned at = (unsigned)__builtin_ctzll(special);
+			uint64_t before = keep & ((1ULL << at) - 1);
+			if (before && (!beginValue(t, &span) || !keepRuns(t, &span, block, before))) {
+				return false;
+			}
+			if (!structural(t, &span, block[at])) {
+				return false;
+			}
+			// everything up to and including the structural character is done (2 << 63 wraps to 0)
+			keep &= ~((2ULL << at) - 1);
+		}
+		if (keep && (!beginValue(t, &span) || !keepRuns(t, &span, block, keep))) {
+			return false;
+		}
+	}
+	// the input is only valid during this call, so nothing of it may be left pending
+	return flushSpan(t, &span);
+}
+
+bool GRJsonTranscoderFinish(GRJsonTranscoder *t) {
+	if (t->error != GRJsonTranscoderErrorNone) {
+		return false;
+	}
+	if (t->inStringCarry) {
+		t->error = GRJsonTranscoderErrorUnterminated;
+		return false;
+	}
+	if (t->depth != 0) {
+		t->error = GRJsonTranscoderErrorUnbalanced;
+		return false;
+	}
+	return flushBuffer(t);
+}
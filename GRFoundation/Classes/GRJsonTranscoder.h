@@ -0,0 +1,87 @@
+//
+//  GRJsonTranscoder.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonTranscoder_h
+#define GRJsonTranscoder_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GRJsonEmitter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum GRJsonTranscodeStyle {
+	GRJsonTranscodeMinify, ///< no whitespace at all outside of strings
+	GRJsonTranscodePretty, ///< one member or element per line, indented, with a space after each colon
+} GRJsonTranscodeStyle;
+
+typedef enum GRJsonTranscoderError {
+	GRJsonTranscoderErrorNone = 0,
+	GRJsonTranscoderErrorOutOfMemory,
+	GRJsonTranscoderErrorUnbalanced,   ///< a closing bracket with nothing open, or a container left open at the end
+	GRJsonTranscoderErrorUnterminated, ///< the input ended inside a string
+	GRJsonTranscoderErrorSink,         ///< the sink refused the output
+} GRJsonTranscoderError;
+
+/**
+ * Reformats one JSON document by rewriting only the whitespace between tokens.  Strings, numbers and
+ * literals are never decoded: the input is classified 64 bytes at a time (see GRJsonStructuralIndex.h),
+ * the bytes inside strings are told apart from the rest with the same quote and escape masks the validator
+ * uses, and then whole runs of significant bytes are copied to the output in one go.  Minifying just drops
+ * the whitespace bits between runs; pretty-printing also stops at each bracket, comma and colon outside of
+ * strings to write the line breaks and indentation around it.  Empty objects and arrays stay as {} and [].
+ *
+ * Input can be fed in pieces of any size, split anywhere, and output goes to a sink in chunks of about
+ * GRJSON_EMITTER_FLUSH_SIZE, so memory stays constant however large the document is.
+ *
+ * The input is expected to be valid JSON and is not validated (check it with GRJsonValidate first if it may
+ * not be); only unterminated strings and, when pretty-printing, unbalanced brackets are caught.  Since all
+ * whitespace between tokens goes, the input must be a single value, not several separated by whitespace.
+ *
+ * Errors are sticky, as with GRJsonEmitter.  Treat the fields as private.
+ */
+typedef struct GRJsonTranscoder {
+	GRJsonTranscodeStyle style;
+	size_t indentWidth;      ///< spaces per level when pretty-printing
+	uint64_t inStringCarry;  ///< all ones if the last block ended inside a string
+	uint64_t nextIsEscaped;  ///< 1 if the last block ended with an unpaired backslash
+	size_t depth;
+	bool openPending;        ///< a container was just opened; its line break waits to see if it is empty
+
+	uint8_t *buf;
+	size_t length;
+	size_t capacity;
+	GRJsonEmitterSink sink;
+	void *sinkContext;
+	GRJsonTranscoderError error;
+} GRJsonTranscoder;
+
+void GRJsonTranscoderInit(GRJsonTranscoder *t, GRJsonTranscodeStyle style, size_t indentWidth);
+void GRJsonTranscoderDestroy(GRJsonTranscoder *t);
+
+/** Starts a new document, keeping the style and any memory that was already allocated. */
+void GRJsonTranscoderReset(GRJsonTranscoder *t);
+
+/** Sends output to sink instead of keeping all of it in the buffer.  Pass NULL to keep everything. */
+void GRJsonTranscoderSetSink(GRJsonTranscoder *t, GRJsonEmitterSink sink, void *context);
+
+/** Reformats the next piece of the document. */
+bool GRJsonTranscoderFeed(GRJsonTranscoder *t, const uint8_t *bytes, size_t length);
+
+/** Checks that the document ended cleanly and hands the rest of the output to the sink. */
+bool GRJsonTranscoderFinish(GRJsonTranscoder *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonTranscoder_h */
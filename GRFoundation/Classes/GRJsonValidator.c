@@ -0,0 +1,419 @@
+//
+//  GRJsonValidator.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonValidator.h"
+#include "GRJsonStructuralIndex.h"
+
+#include <string.h>
+
+#define ASCII_MASK 0x8080808080808080ULL
+#define ODD_BITS 0xAAAAAAAAAAAAAAAAULL
+
+typedef enum ValidatorState {
+	EXPECT_VALUE,
+	EXPECT_VALUE_OR_END, ///< just after '['
+	EXPECT_KEY,
+	EXPECT_KEY_OR_END,   ///< just after '{'
+	EXPECT_COLON,
+	EXPECT_COMMA_OR_END,
+	EXPECT_NOTHING,      ///< the document is complete
+} ValidatorState;
+
+#pragma mark - UTF-8
+
+/**
+ * Validates the UTF-8 sequences that start in [pos, end), reading up to length for a sequence that runs past
+ * end.  Returns the position just past the last sequence, or SIZE_MAX with *invalidAt set to the start of
+ * the first one that is not well-formed (RFC 3629: no overlong forms, no surrogates, nothing above U+10FFFF).
+ */
+static size_t validateUTF8(const uint8_t *bytes, size_t pos, size_t end, size_t length, size_t *invalidAt) {
+	while (pos < end) {
+		if (end - pos >= 8) {
+			uint64_t word;
+			memcpy(&word, bytes + pos, 8);
+			if ((word & ASCII_MASK) == 0) {
+				pos += 8;
+				continue;
+			}
+		}
+		uint8_t c = bytes[pos];
+		if (c < 0x80) {
+			pos++;
+			continue;
+		}
+		size_t trailing;
+		uint8_t low = 0x80, high = 0xBF; // allowed range of the first continuation byte
+		if (c >= 0xC2 && c <= 0xDF) {
+			trailing = 1;
+		}
+		else if (c >= 0xE0 && c <= 0xEF) {
+			trailing = 2;
+			if (c == 0xE0) {
+				low = 0xA0;
+			}
+			else if (c == 0xED) {
+				high = 0x9F;
+			}
+		}
+		else if (c >= 0xF0 && c <= 0xF4) {
+			trailing = 3;
+			if (c == 0xF0) {
+				low = 0x90;
+			}
+			else if (c == 0xF4) {
+				high = 0x8F;
+			}
+		}
+		else {
+			*invalidAt = pos;
+			return SIZE_MAX;
+		}
+		if (length - pos <= trailing || bytes[pos + 1] < low || bytes[pos + 1] > high) {
+			*invalidAt = pos;
+			return SIZE_MAX;
+		}
+		for (size_t i = 2; i <= trailing; i++) {
+			if ((bytes[pos + i] & 0xC0) != 0x80) {
+				*invalidAt = pos;
+				return SIZE_MAX;
+			}
+		}
+		pos += trailing + 1;
+	}
+	return pos;
+}
+
+#pragma mark - block masks
+
+/** Bit i of the result is the XOR of bits 0..i of x: set from each opening quote up to its closing quote. */
+static inline uint64_t prefixXor(uint64_t x) {
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return x;
+}
+
+/**
+ * The characters that are escaped by a backslash: the one after each backslash that is at an odd position
+ * in a run of backslashes.  *nextIsEscaped carries a run that ends the block over to the next one.
+ */
+static inline uint64_t escapedCharacters(uint64_t backslash, uint64_t *nextIsEscaped) {
+	if (backslash == 0) {
+		uint64_t escaped = *nextIsEscaped;
+		*nextIsEscaped = 0;
+		return escaped;
+	}
+	uint64_t potentialEscape = backslash & ~*nextIsEscaped;
+	uint64_t maybeEscaped = potentialEscape << 1;
+	uint64_t escapeAndTerminalCode = ((maybeEscaped | ODD_BITS) - potentialEscape) ^ ODD_BITS;
+	uint64_t escaped = escapeAndTerminalCode ^ (backslash | *nextIsEscaped);
+	*nextIsEscaped = (escapeAndTerminalCode & backslash) >> 63;
+	return escaped;
+}
+
+#pragma mark - scalars
+
+static inline bool isHex(uint8_t c) {
+	return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+}
+
+static inline bool isDigit(uint8_t c) {
+	return c >= '0' && c <= '9';
+}
+
+/** whitespace or a structural character, the only things that may follow a number or literal */
+static inline bool isDelimiter(uint8_t c) {
+	switch (c) {
+		case ' ': case '\t': case '\n': case '\r': case ',': case ':': case '[': case ']': case '{': case '}':
+			return true;
+		default:
+			return false;
+	}
+}
+
+/** Checks the escape whose character (the one after the backslash) is at pos, returning the offset of the first bad byte or SIZE_MAX. */
+static size_t checkEscape(const uint8_t *bytes, size_t pos, size_t length) {
+	switch (bytes[pos]) {
+		case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+			return SIZE_MAX;
+		case 'u':
+			for (size_t i = 1; i <= 4; i++) {
+				if (pos + i >= length || !isHex(bytes[pos + i])) {
+					return pos + i < length ? pos + i : length;
+				}
+			}
+			return SIZE_MAX;
+		default:
+			return pos;
+	}
+}
+
+/** Scans -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? from pos, returning where it ends or SIZE_MAX. */
+static size_t scanNumber(const uint8_t *bytes, size_t pos, size_t length, size_t *failedAt) {
+	if (bytes[pos] == '-') {
+		pos++;
+	}
+	if (pos < length && bytes[pos] == '0') {
+		pos++;
+	}
+	else if (pos < length && bytes[pos] >= '1' && bytes[pos] <= '9') {
+		while (pos < length && isDigit(bytes[pos])) {
+			pos++;
+		}
+	}
+	else {
+		*failedAt = pos;
+		return SIZE_MAX;
+	}
+	if (pos < length && bytes[pos] == '.') {
+		pos++;
+		if (pos == length || !isDigit(bytes[pos])) {
+			*failedAt = pos;
+			return SIZE_MAX;
+		}
+		while (pos < length && isDigit(bytes[pos])) {
+			pos++;
+		}
+	}
+	if (pos < length && (bytes[pos] | 0x20) == 'e') {
+		pos++;
+		if (pos < length && (bytes[pos] == '+' || bytes[pos] == '-')) {
+			pos++;
+		}
+		if (pos == length || !isDigit(bytes[pos])) {
+			*failedAt = pos;
+			return SIZE_MAX;
+		}
+		while (pos < length && isDigit(bytes[pos])) {
+			pos++;
+		}
+	}
+	return pos;
+}
+
+#pragma mark - validation
+
+static bool fail(const uint8_t *bytes, GRJsonValidation *result, GRJsonError error, size_t offset, const char *message) {
+	if (result == NULL) {
+		return false;
+	}
+	// only now is it worth counting lines
+	size_t line = 1, lineStart = 0;
+	for (const uint8_t *p = bytes, *end = bytes + offset; (p = memchr(p, '\n', (size_t)(end - p))) != NULL; p++) {
+		line++;
+		lineStart = (size_t)(p - bytes) + 1;
+	}
+	size_t column = 1;
+	for (size_t i = lineStart; i < offset; i++) {
+		// continuation bytes don't start a character
+		column += (bytes[i] & 0xC0) != 0x80;
+	}
+	result->error = error;
+	result->offset = offset;
+	result->line = line;
+	result->column = column;
+	result->message = message;
+	return false;
+}
+
+/**
+ * Validation works a 64-byte block at a time, in two steps, so the grammar is only ever checked at the
+ * handful of positions where a token starts rather than at every byte.
+ *
+ * First the block's masks are combined into the set of token starts: structural characters outside strings,
+ * opening quotes, and the first byte of every run of other characters outside strings (a number, a literal,
+ * or junk).  Everything inside strings is settled here as well: which quotes are escaped, control
+ * characters, and escape sequences (checked one by one, but only in blocks that have a backslash).  UTF-8 is
+ * checked for the whole block, which also covers strings, since a non-ASCII byte anywhere else is an error.
+ *
+ * Then a small state machine walks the token starts.  Numbers and literals are scanned where they start, and
+ * must be followed by whitespace or a structural character, which accounts for every byte of their run.
+ */
+bool GRJsonValidate(const uint8_t *bytes, size_t length, GRJsonValidation *result) {
+	// bit set for each open object, clear for each open array
+	uint64_t objects[GRJSON_DEFAULT_MAX_DEPTH / 64];
+	size_t depth = 0;
+	ValidatorState state = EXPECT_VALUE;
+	bool sawToken = false;
+	GRJsonStructuralIndex idx;
+	GRJsonStructuralIndexInit(&idx, bytes, length);
+	uint64_t inStringCarry = 0;  ///< all ones if the previous block ended inside a string
+	uint64_t nextIsEscaped = 0;
+	uint64_t otherCarry = 0;     ///< 1 if the previous block ended in the middle of a number or literal
+	size_t utf8Pos = 0;          ///< everything before this is known to be valid UTF-8
+	size_t failedAt = 0;
+
+	for (size_t blockStart = 0; blockStart < length; blockStart += GRJSON_BLOCK_SIZE) {
+		size_t blockEnd = length - blockStart > GRJSON_BLOCK_SIZE ? blockStart + GRJSON_BLOCK_SIZE : length;
+		uint64_t valid = blockEnd - blockStart == GRJSON_BLOCK_SIZE ? UINT64_MAX : (1ULL << (blockEnd - blockStart)) - 1;
+		GRJsonStructuralIndexLoad(&idx, blockStart);
+		const GRJsonBlockMasks *m = &idx.masks;
+
+		uint64_t escaped = escapedCharacters(m->backslash, &nextIsEscaped);
+		uint64_t quotes = m->quote & ~escaped;
+		uint64_t inString = prefixXor(quotes) ^ inStringCarry;
+		inStringCarry = (uint64_t)((int64_t)inString >> 63);
+		uint64_t openingQuotes = quotes & inString;
+		uint64_t other = ~(m->structural | m->whitespace | m->quote | inString) & valid;
+		uint64_t tokens = (m->structural & ~inString) | openingQuotes | (other & ~((other << 1) | otherCarry));
+		otherCarry = other >> 63;
+
+		// the first problem inside a string (or with the encoding) in this block, if any
+		size_t firstBad = SIZE_MAX;
+		GRJsonError badError = GRJsonErrorInvalidString;
+		const char *badMessage = NULL;
+		uint64_t controls = m->control & inString;
+		if (controls) {
+			firstBad = blockStart + (size_t)__builtin_ctzll(controls);
+			badMessage = "control character in string";
+		}
+		for (uint64_t escapes = escaped & inString; escapes; escapes &= escapes - 1) {
+			size_t pos = blockStart + (size_t)__builtin_ctzll(escapes);
+			if (pos >= firstBad) {
+				break;
+			}
+			size_t bad = checkEscape(bytes, pos, length);
+			if (bad != SIZE_MAX) {
+				firstBad = bad;
+				badError = bad == length ? GRJsonErrorUnexpectedEOF : GRJsonErrorInvalidString;
+				badMessage = "invalid escape";
+				break;
+			}
+		}
+		if (utf8Pos < blockEnd) {
+			size_t invalidAt = 0;
+			utf8Pos = validateUTF8(bytes, utf8Pos, blockEnd, length, &invalidAt);
+			if (utf8Pos == SIZE_MAX && invalidAt < firstBad) {
+				firstBad = invalidAt;
+				badError = (m->quote | inString) >> (invalidAt - blockStart) & 1 ? GRJsonErrorInvalidString : GRJsonErrorUnexpectedCharacter;
+				badMessage = "invalid UTF-8";
+			}
+		}
+		if (firstBad != SIZE_MAX && firstBad < blockEnd) {
+			// tokens from there on are not looked at, so the earliest error is the one reported
+			tokens &= (1ULL << (firstBad - blockStart)) - 1;
+		}
+
+		while (tokens) {
+			size_t pos = blockStart + (size_t)__builtin_ctzll(tokens);
+			tokens &= tokens - 1;
+			uint8_t c = bytes[pos];
+			sawToken = true;
+			switch (state) {
+				case EXPECT_KEY_OR_END:
+					if (c == '}') {
+						depth--;
+						goto afterValue;
+					}
+					// fall through
+				case EXPECT_KEY:
+					if (c != '"') {
+						return fail(bytes, result, GRJsonErrorUnexpectedCharacter, pos, "expected a key");
+					}
+					state = EXPECT_COLON;
+					continue;
+				case EXPECT_COLON:
+					if (c != ':') {
+						return fail(bytes, result, GRJsonErrorUnexpectedCharacter, pos, "expected ':'");
+					}
+					state = EXPECT_VALUE;
+					continue;
+				case EXPECT_COMMA_OR_END:
+				{
+					bool inObject = (objects[(depth - 1) >> 6] >> ((depth - 1) & 63)) & 1;
+					if (c == ',') {
+						state = inObject ? EXPECT_KEY : EXPECT_VALUE;
+						continue;
+					}
+					if (c == (inObject ? '}' : ']')) {
+						depth--;
+						goto afterValue;
+					}
+					return fail(bytes, result, GRJsonErrorUnexpectedCharacter, pos, inObject ? "expected ',' or '}'" : "expected ',' or ']'");
+				}
+				case EXPECT_NOTHING:
+					return fail(bytes, result, GRJsonErrorTrailingCharacters, pos, "unexpected characters after the document");
+				case EXPECT_VALUE_OR_END:
+					if (c == ']') {
+						depth--;
+						goto afterValue;
+					}
+					// fall through
+				case EXPECT_VALUE:
+					break;
+			}
+			switch (c) {
+				case '{':
+				case '[':
+				{
+					if (depth == GRJSON_DEFAULT_MAX_DEPTH) {
+						return fail(bytes, result, GRJsonErrorTooDeep, pos, "nested too deeply");
+					}
+					uint64_t bit = 1ULL << (depth & 63);
+					objects[depth >> 6] = c == '{' ? (objects[depth >> 6] | bit) : (objects[depth >> 6] & ~bit);
+					depth++;
+					state = c == '{' ? EXPECT_KEY_OR_END : EXPECT_VALUE_OR_END;
+					continue;
+				}
+				case '"':
+					// the body was checked with the block masks
+					goto afterValue;
+				case '-': case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+				{
+					size_t end = scanNumber(bytes, pos, length, &failedAt);
+					if (end == SIZE_MAX) {
+						return fail(bytes, result, failedAt == length ? GRJsonErrorUnexpectedEOF : GRJsonErrorInvalidNumber, failedAt, "invalid number");
+					}
+					if (end < length && !isDelimiter(bytes[end])) {
+						return fail(bytes, result, GRJsonErrorInvalidNumber, end, "invalid number");
+					}
+					goto afterValue;
+				}
+				case 't':
+				case 'f':
+				case 'n':
+				{
+					// compared as one 32-bit word (plus the 'e' of false)
+					size_t literalLength = c == 'f' ? 5 : 4;
+					uint32_t word = 0, expected;
+					memcpy(&expected, c == 't' ? "true" : c == 'f' ? "fals" : "null", 4);
+					if (length - pos >= literalLength) {
+						memcpy(&word, bytes + pos, 4);
+					}
+					if (word != expected || (c == 'f' && bytes[pos + 4] != 'e') ||
+						(pos + literalLength < length && !isDelimiter(bytes[pos + literalLength]))) {
+						return fail(bytes, result, GRJsonErrorInvalidLiteral, pos, "invalid literal");
+					}
+					goto afterValue;
+				}
+				default:
+					return fail(bytes, result, GRJsonErrorUnexpectedCharacter, pos, "expected a value");
+			}
+		afterValue:
+			state = depth == 0 ? EXPECT_NOTHING : EXPECT_COMMA_OR_END;
+		}
+
+		if (firstBad != SIZE_MAX) {
+			return fail(bytes, result, badError, firstBad, badMessage);
+		}
+	}
+
+	if (!sawToken) {
+		return fail(bytes, result, GRJsonErrorEmptyDocument, length, "empty document");
+	}
+	if (inStringCarry) {
+		return fail(bytes, result, GRJsonErrorUnexpectedEOF, length, "unterminated string");
+	}
+	if (state != EXPECT_NOTHING) {
+		return fail(bytes, result, GRJsonErrorUnexpectedEOF, length, "unexpected end of the input");
+	}
+	return true;
+}
@@ -0,0 +1,47 @@
+//
+//  GRJsonValidator.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonValidator_h
+#define GRJsonValidator_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GRJsonTokenizer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Where and why a document failed validation.  Only filled in when it did. */
+typedef struct GRJsonValidation {
+	GRJsonError error;
+	size_t offset;       ///< of the first byte that is wrong (the length of the input if it ended too soon)
+	size_t line;         ///< 1-based
+	size_t column;       ///< 1-based, counted in characters rather than bytes
+	const char *message; ///< a static description
+} GRJsonValidation;
+
+/**
+ * Checks that bytes are exactly one JSON value, following the RFC 8259 grammar, and that the whole input is
+ * valid UTF-8.  Nothing is decoded, nothing is allocated and no callbacks are made: containers are tracked in
+ * a bit stack on the C stack (one bit per level, up to the tokenizer's GRJSON_DEFAULT_MAX_DEPTH), string bodies
+ * are skipped with the structural classifier 64 bytes at a time, and only the runs in them that contain
+ * non-ASCII bytes are decoded as UTF-8.  Line and column are only worked out once an error has been found.
+ *
+ * @param result filled in if the input is invalid; may be NULL
+ * @return true if the input is valid JSON
+ */
+bool GRJsonValidate(const uint8_t *bytes, size_t length, GRJsonValidation *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonValidator_h */
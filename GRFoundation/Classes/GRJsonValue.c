@@ -0,0 +1,329 @@
+//
+//  GRJsonValue.c
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#include "GRJsonValue.h"
+#include "GRJsonNumber.h"
+#include "GRJsonString.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FIRST_CHUNK_SIZE 4096
+#define ALIGNMENT 8
+
+_Static_assert(sizeof(GRJsonValue) == 16, "GRJsonValue should be 16 bytes");
+_Static_assert(sizeof(GRJsonMember) == 2 * sizeof(GRJsonValue), "a member should be a key value followed by a value");
+_Static_assert(offsetof(GRJsonValue, inlineLength) > GRJSON_VALUE_INLINE_MAX, "inline text should leave room for its NUL");
+
+struct GRJsonArenaChunk {
+	struct GRJsonArenaChunk *next;
+	size_t size;           ///< bytes after the header
+	uint8_t bytes[];
+};
+
+#pragma mark - arena
+
+void GRJsonArenaInit(GRJsonArena *arena) {
+	memset(arena, 0, sizeof(*arena));
+	arena->nextChunkSize = FIRST_CHUNK_SIZE;
+}
+
+void GRJsonArenaRelease(GRJsonArena *arena) {
+	struct GRJsonArenaChunk *chunk = arena->chunks;
+	while (chunk) {
+		struct GRJsonArenaChunk *next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+	free(arena->pending);
+	free(arena->open);
+	GRJsonArenaInit(arena);
+}
+
+void GRJsonArenaReset(GRJsonArena *arena) {
+	struct GRJsonArenaChunk *newest = arena->chunks;
+	if (newest == NULL) {
+		return;
+	}
+	// the newest chunk is the largest, and usually enough for a document like the last one
+	struct GRJsonArenaChunk *chunk = newest->next;
+	while (chunk) {
+		struct GRJsonArenaChunk *next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+	newest->next = NULL;
+	arena->cursor = newest->bytes;
+	arena->end = newest->bytes + newest->size;
+}
+
+static bool addChunk(GRJsonArena *arena, size_t size) {
+	size_t chunkSize = arena->nextChunkSize;
+	while (chunkSize < size) {
+		chunkSize *= 2;
+	}
+	struct GRJsonArenaChunk *chunk = malloc(sizeof(struct GRJsonArenaChunk) + chunkSize);
+	if (chunk == NULL) {
+		return false;
+	}
+	chunk->next = arena->chunks;
+	chunk->size = chunkSize;
+	arena->chunks = chunk;
+	arena->cursor = chunk->bytes;
+	arena->end = chunk->bytes + chunkSize;
+	arena->nextChunkSize = chunkSize * 2;
+	return true;
+}
+
+/** Allocates without aligning, for string bytes. */
+static inline uint8_t *allocBytes(GRJsonArena *arena, size_t size) {
+	if ((size_t)(arena->end - arena->cursor) < size && !addChunk(arena, size)) {
+		return NULL;
+	}
+	uint8_t *bytes = arena->cursor;
+	arena->cursor += size;
+	return bytes;
+}
+
+void *GRJsonArenaAlloc(GRJsonArena *arena, size_t size) {
+	size_t padding = (size_t)(-(uintptr_t)arena->cursor & (ALIGNMENT - 1));
+	if ((size_t)(arena->end - arena->cursor) < padding + size) {
+		// a new chunk starts aligned
+		return addChunk(arena, size) ? allocBytes(arena, size) : NULL;
+	}
+	arena->cursor += padding;
+	return allocBytes(arena, size);
+}
+
+#pragma mark - parsing
+
+static bool reservePending(GRJsonArena *arena, size_t extra) {
+	if (arena->pendingCount + extra <= arena->pendingCapacity) {
+		return true;
+	}
+	size_t capacity = arena->pendingCapacity ? arena->pendingCapacity : 256;
+	while (capacity < arena->pendingCount + extra) {
+		capacity *= 2;
+	}
+	GRJsonValue *pending = realloc(arena->pending, capacity * sizeof(GRJsonValue));
+	if (pending == NULL) {
+		return false;
+	}
+	arena->pending = pending;
+	arena->pendingCapacity = capacity;
+	return true;
+}
+
+/** @return the next slot in pending, zeroed, or NULL if out of memory */
+static inline GRJsonValue *pushValue(GRJsonArena *arena, GRJsonValueType type) {
+	if (arena->pendingCount == arena->pendingCapacity && !reservePending(arena, 1)) {
+		return NULL;
+	}
+	GRJsonValue *value = &arena->pending[arena->pendingCount++];
+	memset(value, 0, sizeof(*value));
+	value->tag = (uint8_t)type;
+	return value;
+}
+
+static bool pushOpen(GRJsonArena *arena, size_t depth) {
+	if (depth == arena->openCapacity) {
+		size_t capacity = arena->openCapacity ? arena->openCapacity * 2 : 32;
+		size_t *open = realloc(arena->open, capacity * sizeof(size_t));
+		if (open == NULL) {
+			return false;
+		}
+		arena->open = open;
+		arena->openCapacity = capacity;
+	}
+	arena->open[depth] = arena->pendingCount;
+	return true;
+}
+
+/** Moves the children of the container that just closed out of pending and into the arena. */
+static bool closeContainer(GRJsonArena *arena, size_t depth, GRJsonValueType type) {
+	size_t first = arena->open[depth];
+	size_t count = arena->pendingCount - first;
+	const void *children = NULL;
+	if (count) {
+		if (count > UINT32_MAX) {
+			return false;
+		}
+		void *copy = GRJsonArenaAlloc(arena, count * sizeof(GRJsonValue));
+		if (copy == NULL) {
+			return false;
+		}
+		memcpy(copy, &arena->pending[first], count * sizeof(GRJsonValue));
+		children = copy;
+	}
+	// the container itself takes the place of its first child
+	arena->pendingCount = first;
+	GRJsonValue *value = pushValue(arena, type);
+	if (value == NULL) {
+		return false;
+	}
+	if (type == GRJsonValueTypeObject) {
+		value->as.members = children;
+		value->length = (uint32_t)(count / 2);
+	}
+	else {
+		value->as.elements = children;
+		value->length = (uint32_t)count;
+	}
+	return true;
+}
+
+static bool pushString(GRJsonArena *arena, const GRJsonToken *token) {
+	GRJsonValue *value = pushValue(arena, GRJsonValueTypeString);
+	if (value == NULL || token->length > UINT32_MAX) {
+		return false;
+	}
+	// decoding never makes a string longer, so a short token always fits in the value
+	if (token->length <= GRJSON_VALUE_INLINE_MAX) {
+		// the value was zeroed, so the text is already NUL-terminated
+		uint8_t *text = (uint8_t *)value;
+		size_t length = token->length;
+		if (token->hasEscapes) {
+			length = GRJsonUnescape(token->bytes, token->length, text);
+		}
+		else {
+			memcpy(text, token->bytes, length);
+		}
+		value->inlineLength = (uint8_t)length;
+		value->tag |= GRJSON_VALUE_INLINE;
+		return true;
+	}
+	uint8_t *bytes = allocBytes(arena, token->length + 1);
+	if (bytes == NULL) {
+		return false;
+	}
+	size_t length = token->length;
+	if (token->hasEscapes) {
+		length = GRJsonUnescape(token->bytes, token->length, bytes);
+		// hand back what the escapes saved; this is still the newest allocation
+		arena->cursor -= token->length - length;
+	}
+	else {
+		memcpy(bytes, token->bytes, length);
+	}
+	bytes[length] = 0;
+	value->as.string = (const char *)bytes;
+	value->length = (uint32_t)length;
+	return true;
+}
+
+static GRJsonError fail(GRJsonTokenizer *t, const GRJsonToken *token, GRJsonError error) {
+	t->error = error;
+	t->errorOffset = token->offset;
+	if (error == GRJsonErrorOutOfMemory) {
+		snprintf(t->errorMessage, sizeof(t->errorMessage), "out of memory");
+	}
+	else {
+		snprintf(t->errorMessage, sizeof(t->errorMessage), "invalid UTF-8 in string at pos %llu", (unsigned long long)token->offset);
+	}
+	return error;
+}
+
+GRJsonError GRJsonValueParse(GRJsonArena *arena, GRJsonTokenizer *t, const uint8_t *buf, size_t len, const GRJsonValue **root) {
+	arena->pendingCount = 0;
+	GRJsonTokenizerReset(t);
+	GRJsonTokenizerSetInput(t, buf, len, true);
+	size_t depth = 0;
+	GRJsonToken token;
+	GRJsonStatus status;
+	while ((status = GRJsonTokenizerNext(t, &token)) == GRJsonStatusToken) {
+		bool ok = true;
+		switch (token.type) {
+			case GRJsonTokenObjectBegin:
+			case GRJsonTokenArrayBegin:
+				ok = pushOpen(arena, depth++);
+				break;
+			case GRJsonTokenObjectEnd:
+				ok = closeContainer(arena, --depth, GRJsonValueTypeObject);
+				break;
+			case GRJsonTokenArrayEnd:
+				ok = closeContainer(arena, --depth, GRJsonValueTypeArray);
+				break;
+			case GRJsonTokenKey:
+			case GRJsonTokenString:
+				if (GRJsonValidateUTF8(token.bytes, token.length) == GRJsonUTF8Invalid) {
+					return fail(t, &token, GRJsonErrorInvalidString);
+				}
+				ok = pushString(arena, &token);
+				break;
+			case GRJsonTokenNumber:
+			{
+				int64_t integer;
+				double real;
+				// the tokenizer has checked the grammar, so an invalid number means strtod had no memory
+				GRJsonNumberKind kind = GRJsonParseNumber(token.bytes, token.length, &integer, &real);
+				if (kind == GRJsonNumberInvalid) {
+					ok = false;
+				}
+				else if (kind == GRJsonNumberInteger) {
+					GRJsonValue *value = pushValue(arena, GRJsonValueTypeInteger);
+					ok = value != NULL;
+					if (ok) {
+						value->as.integer = integer;
+					}
+				}
+				else {
+					GRJsonValue *value = pushValue(arena, GRJsonValueTypeDouble);
+					ok = value != NULL;
+					if (ok) {
+						value->as.real = real;
+					}
+				}
+				break;
+			}
+			case GRJsonTokenTrue:
+				ok = pushValue(arena, GRJsonValueTypeTrue) != NULL;
+				break;
+			case GRJsonTokenFalse:
+				ok = pushValue(arena, GRJsonValueTypeFalse) != NULL;
+				break;
+			case GRJsonTokenNull:
+				ok = pushValue(arena, GRJsonValueTypeNull) != NULL;
+				break;
+			case GRJsonTokenNone:
+				break;
+		}
+		if (!ok) {
+			return fail(t, &token, GRJsonErrorOutOfMemory);
+		}
+	}
+	if (status == GRJsonStatusError) {
+		return t->error;
+	}
+	// the root is all that is left pending, and has to move into the arena with everything else
+	GRJsonValue *value = GRJsonArenaAlloc(arena, sizeof(GRJsonValue));
+	if (value == NULL) {
+		token.offset = len;
+		return fail(t, &token, GRJsonErrorOutOfMemory);
+	}
+	*value = arena->pending[0];
+	arena->pendingCount = 0;
+	*root = value;
+	return GRJsonErrorNone;
+}
+
+#pragma mark - lookup
+
+const GRJsonValue *GRJsonValueMember(const GRJsonValue *value, const char *key, size_t keyLength) {
+	if (value->tag != GRJsonValueTypeObject) {
+		return NULL;
+	}
+	for (size_t i = value->length; i > 0; i--) {
+		const GRJsonMember *member = &value->as.members[i - 1];
+		size_t length = 0;
+		const char *name = GRJsonValueString(&member->key, &length);
+		if (length == keyLength && memcmp(name, key, keyLength) == 0) {
+			return &member->value;
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,208 @@
+//
+//  GRJsonValue.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRJsonValue_h
+#define GRJsonValue_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "GRJsonTokenizer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A bump-pointer allocator.  Memory comes from a list of chunks that double in size as they fill up, each
+ * allocation just moves a cursor forward, and nothing is ever freed on its own: GRJsonArenaReset rewinds
+ * the whole arena at once and GRJsonArenaRelease gives everything back.  Treat the fields as private.
+ */
+typedef struct GRJsonArena {
+	struct GRJsonArenaChunk *chunks; ///< newest first
+	uint8_t *cursor;
+	uint8_t *end;
+	size_t nextChunkSize;
+
+	// scratch space used while parsing
+	struct GRJsonValue *pending; ///< the finished children of every open container, in document order
+	size_t pendingCount;
+	size_t pendingCapacity;
+	size_t *open;                ///< index in pending of the first child of each open container
+	size_t openCapacity;
+} GRJsonArena;
+
+void GRJsonArenaInit(GRJsonArena *arena);
+
+/** Frees every chunk, and with them every value parsed into the arena. */
+void GRJsonArenaRelease(GRJsonArena *arena);
+
+/** Invalidates everything allocated so far but keeps the largest chunk for whatever is allocated next. */
+void GRJsonArenaReset(GRJsonArena *arena);
+
+/** @return size bytes aligned to 8, valid until the arena is reset or released, or NULL if out of memory */
+void *GRJsonArenaAlloc(GRJsonArena *arena, size_t size);
+
+typedef enum GRJsonValueType {
+	GRJsonValueTypeNull = 0,
+	GRJsonValueTypeFalse,
+	GRJsonValueTypeTrue,
+	GRJsonValueTypeInteger,
+	GRJsonValueTypeDouble,
+	GRJsonValueTypeString,
+	GRJsonValueTypeArray,
+	GRJsonValueTypeObject,
+} GRJsonValueType;
+
+/** Set in a value's tag when a string is stored in the value itself. */
+#define GRJSON_VALUE_INLINE 0x80
+/** The longest string, in bytes, that is stored in the value itself (the text is followed by a NUL). */
+#define GRJSON_VALUE_INLINE_MAX 13
+
+struct GRJsonMember;
+
+/**
+ * One node of a parsed document, 16 bytes.  Strings are decoded (escapes resolved, UTF-8 checked) and
+ * NUL-terminated; up to GRJSON_VALUE_INLINE_MAX bytes they overlay as, length and spare instead of being
+ * stored elsewhere in the arena.  An array points at its elements and an object at its members, each laid
+ * out contiguously, so walking a container never chases more than one pointer.
+ *
+ * Use the accessors below rather than the fields.
+ */
+typedef struct GRJsonValue {
+	union {
+		int64_t integer;
+		double real;
+		const char *string;
+		const struct GRJsonValue *elements;
+		const struct GRJsonMember *members;
+	} as;
+	uint32_t length;      ///< bytes in an out-of-line string, or children in an array or object
+	uint8_t spare[2];
+	uint8_t inlineLength; ///< bytes in an inline string
+	uint8_t tag;          ///< a GRJsonValueType, plus GRJSON_VALUE_INLINE for an inline string
+} GRJsonValue;
+
+/** An object member.  The key is always a string. */
+typedef struct GRJsonMember {
+	GRJsonValue key;
+	GRJsonValue value;
+} GRJsonMember;
+
+/**
+ * Parses buf into values allocated from the arena, which must outlive them; nothing points back into buf.
+ * The tokenizer is reset and used for the grammar, and on failure its errorMessage and errorOffset describe
+ * the problem (GRJsonErrorInvalidString for a string that is not valid UTF-8).  No recursion is involved, so
+ * the C stack does not grow with the nesting depth, which the tokenizer's maximum depth bounds.
+ *
+ * @param root set to the root value on success
+ * @return GRJsonErrorNone on success
+ */
+GRJsonError GRJsonValueParse(GRJsonArena *arena, GRJsonTokenizer *tokenizer, const uint8_t *buf, size_t len, const GRJsonValue **root);
+
+static inline GRJsonValueType GRJsonValueTypeOf(const GRJsonValue *value) {
+	return (GRJsonValueType)(value->tag & ~GRJSON_VALUE_INLINE);
+}
+
+static inline bool GRJsonValueIsNull(const GRJsonValue *value) {
+	return value->tag == GRJsonValueTypeNull;
+}
+
+/** @return true for true, false for anything else */
+static inline bool GRJsonValueBool(const GRJsonValue *value) {
+	return value->tag == GRJsonValueTypeTrue;
+}
+
+/** @return an integer, a double truncated toward zero, or 0 for anything else */
+static inline int64_t GRJsonValueInteger(const GRJsonValue *value) {
+	switch (value->tag) {
+		case GRJsonValueTypeInteger:
+			return value->as.integer;
+		case GRJsonValueTypeDouble:
+			// out-of-range doubles saturate rather than overflowing
+			if (value->as.real >= 9223372036854775807.0) {
+				return INT64_MAX;
+			}
+			if (value->as.real <= -9223372036854775808.0) {
+				return INT64_MIN;
+			}
+			return value->as.real == value->as.real ? (int64_t)value->as.real : 0;
+		default:
+			return 0;
+	}
+}
+
+/** @return a double, an integer converted to a double, or 0 for anything else */
+static inline double GRJsonValueDouble(const GRJsonValue *value) {
+	switch (value->tag) {
+		case GRJsonValueTypeDouble:
+			return value->as.real;
+		case GRJsonValueTypeInteger:
+			return (double)value->as.integer;
+		default:
+			return 0;
+	}
+}
+
+/**
+ * @param length if not NULL, set to the length in bytes, which may be less than strlen if the string
+ * contains \u0000
+ * @return the NUL-terminated UTF-8 of a string, or NULL for anything else
+ */
+static inline const char *GRJsonValueString(const GRJsonValue *value, size_t *length) {
+	if (value->tag == (GRJsonValueTypeString | GRJSON_VALUE_INLINE)) {
+		if (length) {
+			*length = value->inlineLength;
+		}
+		return (const char *)value;
+	}
+	if (value->tag == GRJsonValueTypeString) {
+		if (length) {
+			*length = value->length;
+		}
+		return value->as.string;
+	}
+	return NULL;
+}
+
+/** @return the number of elements of an array or members of an object, or 0 for anything else */
+static inline size_t GRJsonValueCount(const GRJsonValue *value) {
+	return value->tag == GRJsonValueTypeArray || value->tag == GRJsonValueTypeObject ? value->length : 0;
+}
+
+/** @return element index of an array, or NULL if value is not an array or index is out of range */
+static inline const GRJsonValue *GRJsonValueAt(const GRJsonValue *value, size_t index) {
+	if (value->tag != GRJsonValueTypeArray || index >= value->length) {
+		return NULL;
+	}
+	return &value->as.elements[index];
+}
+
+/** @return member index of an object, in document order, or NULL if value is not an object or index is out of range */
+static inline const GRJsonMember *GRJsonValueMemberAt(const GRJsonValue *value, size_t index) {
+	if (value->tag != GRJsonValueTypeObject || index >= value->length) {
+		return NULL;
+	}
+	return &value->as.members[index];
+}
+
+/**
+ * Looks a key up by comparing it with each member in turn, which for the small objects typical of JSON is
+ * faster than any hash table would be to build.  If the key appears more than once, the last one wins.
+ *
+ * @return the value for key, or NULL if value is not an object or has no such member
+ */
+const GRJsonValue *GRJsonValueMember(const GRJsonValue *value, const char *key, size_t keyLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRJsonValue_h */
@@ -0,0 +1,95 @@
+//
+//  GRJsonWriter.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ Writes JSON one value at a time, straight into a growable buffer or an NSOutputStream, without building
+ an NSDictionary or NSArray first (see GRJsonEmitter.h for the details of the output).
+
+ The write methods never fail on their own: a misplaced key or value, a NaN, or a stream error is
+ remembered, everything after it is ignored, and it is reported by -finish:.
+
+	GRJsonWriter *writer = [[GRJsonWriter alloc] init];
+	[writer beginObject];
+	[writer writeKey:@"id"];
+	[writer writeInteger:42];
+	[writer endObject];
+	if ([writer finish:&error]) {
+		NSData *json = writer.data;
+	}
+ */
+@interface GRJsonWriter : NSObject
+
+/**
+ Serializes a tree of NSDictionary (with NSString keys), NSArray, NSString, NSNumber and NSNull.
+
+ @param object the value to write
+ @param error an out pointer that holds the error if object contains anything else
+ @return the UTF-8 JSON, or nil on error
+ */
++ (NSData *) dataWithJSONObject:(id)object error:(NSError *__autoreleasing *)error;
+
+/** A writer that keeps everything in memory, available from data. */
+- (instancetype) init;
+
+/**
+ A writer that sends its output to stream in chunks of about 64KB.  The stream must already be open,
+ and is not closed by the writer.
+
+ @param stream where the JSON goes
+ @return the writer
+ */
+- (instancetype) initWithOutputStream:(NSOutputStream *)stream;
+
+/** Everything written so far, for a writer without a stream. */
+@property (nonatomic, readonly) NSData *data;
+
+/** The first error, if any. */
+@property (nonatomic, readonly) NSError *error;
+
+- (void) beginObject;
+- (void) endObject;
+- (void) beginArray;
+- (void) endArray;
+
+/** The name of the next member of the current object. */
+- (void) writeKey:(NSString *)key;
+
+- (void) writeString:(NSString *)string;
+- (void) writeInteger:(int64_t)value;
+- (void) writeDouble:(double)value;
+- (void) writeBool:(BOOL)value;
+- (void) writeNull;
+
+/**
+ Writes an NSNumber the way it was created: booleans as true/false, integers exactly (including values
+ above INT64_MAX) and floating point values as the shortest decimal that reads back the same.
+ */
+- (void) writeNumber:(NSNumber *)number;
+
+/**
+ Writes a tree of Foundation objects, like +dataWithJSONObject:error:.
+
+ @param object the value to write
+ @return NO if object contains something that has no JSON form
+ */
+- (BOOL) writeObject:(id)object;
+
+/**
+ Checks that exactly one complete value was written, and flushes the rest of the output to the stream.
+
+ @param error an out pointer that holds the first error
+ @return YES if the JSON is complete and was written out
+ */
+- (BOOL) finish:(NSError *__autoreleasing *)error;
+
+/** Starts over with an empty buffer (keeping its memory) and no error, to write another document. */
+- (void) reset;
+
+@end
@@ -0,0 +1,246 @@
+//
+//  GRJsonWriter.m
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import "GRJsonWriter.h"
+#import "GRJsonEmitter.h"
+#import "JsonSupport.h"
+#import "Logging.h"
+
+@interface GRJsonWriter ()
+{
+	GRJsonEmitter emitter;
+	NSOutputStream *stream;
+	GRJsonScratch scratch;   ///< UTF-8 of the string being written, when it can't be read in place
+	NSError *error;
+}
+
+@end
+
+@implementation GRJsonWriter
+
+@synthesize error;
+
++ (NSData *) dataWithJSONObject:(id)object error:(NSError *__autoreleasing *)error {
+	GRJsonWriter *writer = [[self alloc] init];
+	[writer writeObject:object];
+	return [writer finish:error] ? writer.data : nil;
+}
+
+- (instancetype) init {
+	self = [super init];
+	if (self) {
+		GRJsonEmitterInit(&emitter);
+		GRJsonScratchInit(&scratch);
+	}
+	return self;
+}
+
+- (instancetype) initWithOutputStream:(NSOutputStream *)streamIn {
+	self = [self init];
+	if (self) {
+		stream = streamIn;
+		GRJsonEmitterSetSink(&emitter, GRJsonWriteToStream, (__bridge void *)stream);
+	}
+	return self;
+}
+
+- (void) dealloc {
+	GRJsonEmitterDestroy(&emitter);
+	GRJsonScratchDestroy(&scratch);
+}
+
+- (NSData *) data {
+	return [NSData dataWithBytes:emitter.buf length:emitter.length];
+}
+
+- (void) reset {
+	GRJsonEmitterReset(&emitter);
+	error = nil;
+}
+
+#pragma mark - errors
+
+- (void) failWithReason:(NSString *)reason {
+	if (error) {
+		return;
+	}
+	DDLogError(@"error while writing JSON: %@", reason);
+	error = GRJsonErrorWithReason(@"GRJsonWriter", reason);
+}
+
+/** Turns a failed emitter call into the writer's error. */
+- (void) check:(bool)succeeded {
+	if (succeeded || error) {
+		return;
+	}
+	switch (emitter.error) {
+		case GRJsonEmitterErrorOutOfMemory:
+			[self failWithReason:@"out of memory"];
+			break;
+		case GRJsonEmitterErrorMisplaced:
+			[self failWithReason:@"a key or value was written where it does not belong"];
+			break;
+		case GRJsonEmitterErrorNonFinite:
+			[self failWithReason:@"NaN and infinity cannot be written as JSON"];
+			break;
+		case GRJsonEmitterErrorSink:
+			[self failWithReason:[NSString stringWithFormat:@"could not write to the stream: %@", stream.streamError.localizedDescription ?: @"unknown error"]];
+			break;
+		case GRJsonEmitterErrorNone:
+			break;
+	}
+}
+
+- (BOOL) finish:(NSError *__autoreleasing *)errorOut {
+	if (!error) {
+		if (!GRJsonEmitterIsComplete(&emitter) && emitter.error == GRJsonEmitterErrorNone) {
+			[self failWithReason:@"the JSON is incomplete"];
+		}
+		else {
+			[self check:GRJsonEmitterFlush(&emitter)];
+		}
+	}
+	if (error && errorOut) {
+		*errorOut = error;
+	}
+	return error == nil;
+}
+
+#pragma mark - strings
+
+- (void) writeKey:(NSString *)key {
+	if (error) {
+		return;
+	}
+	size_t length = 0;
+	const uint8_t *bytes = GRJsonUTF8BytesOfString(key, &scratch, &length);
+	if (bytes == NULL) {
+		[self failWithReason:@"out of memory"];
+		return;
+	}
+	[self check:GRJsonEmitterKey(&emitter, bytes, length)];
+}
+
+- (void) writeString:(NSString *)string {
+	if (error) {
+		return;
+	}
+	size_t length = 0;
+	const uint8_t *bytes = GRJsonUTF8BytesOfString(string, &scratch, &length);
+	if (bytes == NULL) {
+		[self failWithReason:@"out of memory"];
+		return;
+	}
+	[self check:GRJsonEmitterString(&emitter, bytes, length)];
+}
+
+#pragma mark - structure and scalars
+
+- (void) beginObject {
+	[self check:GRJsonEmitterBeginObject(&emitter)];
+}
+
+- (void) endObject {
+	[self check:GRJsonEmitterEndObject(&emitter)];
+}
+
+- (void) beginArray {
+	[self check:GRJsonEmitterBeginArray(&emitter)];
+}
+
+- (void) endArray {
+	[self check:GRJsonEmitterEndArray(&emitter)];
+}
+
+- (void) writeInteger:(int64_t)value {
+	[self check:GRJsonEmitterInteger(&emitter, value)];
+}
+
+- (void) writeDouble:(double)value {
+	[self check:GRJsonEmitterDouble(&emitter, value)];
+}
+
+- (void) writeBool:(BOOL)value {
+	[self check:GRJsonEmitterBool(&emitter, value)];
+}
+
+- (void) writeNull {
+	[self check:GRJsonEmitterNull(&emitter)];
+}
+
+- (void) writeNumber:(NSNumber *)number {
+	// @YES and @NO are shared instances, which is the only reliable way to tell a boolean from a char
+	if (number == (id)@YES || number == (id)@NO) {
+		[self writeBool:number.boolValue];
+		return;
+	}
+	switch (number.objCType[0]) {
+		case 'f':
+		case 'd':
+			[self writeDouble:number.doubleValue];
+			break;
+		case 'Q':
+		case 'L':
+		{
+			unsigned long long value = number.unsignedLongLongValue;
+			[self check:GRJsonEmitterUnsignedInteger(&emitter, value)];
+			break;
+		}
+		default:
+			[self writeInteger:number.longLongValue];
+			break;
+	}
+}
+
+#pragma mark - object trees
+
+- (BOOL) writeObject:(id)object {
+	if (error) {
+		return NO;
+	}
+	if ([object isKindOfClass:[NSString class]]) {
+		[self writeString:object];
+	}
+	else if ([object isKindOfClass:[NSNumber class]]) {
+		[self writeNumber:object];
+	}
+	else if ([object isKindOfClass:[NSDictionary class]]) {
+		[self beginObject];
+		__block BOOL valid = YES;
+		[(NSDictionary *)object enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+			if (![key isKindOfClass:[NSString class]]) {
+				[self failWithReason:[NSString stringWithFormat:@"object keys must be strings, not %@", NSStringFromClass([key class])]];
+				valid = NO;
+			}
+			else {
+				[self writeKey:key];
+				valid = [self writeObject:value];
+			}
+			*stop = !valid;
+		}];
+		[self endObject];
+	}
+	else if ([object isKindOfClass:[NSArray class]]) {
+		[self beginArray];
+		for (id element in (NSArray *)object) {
+			if (![self writeObject:element]) {
+				break;
+			}
+		}
+		[self endArray];
+	}
+	else if (object == nil || object == (id)[NSNull null]) {
+		[self writeNull];
+	}
+	else {
+		[self failWithReason:[NSString stringWithFormat:@"%@ has no JSON representation", NSStringFromClass([object class])]];
+	}
+	return error == nil;
+}
+
+@end
@@ -8,6 +8,8 @@
 
 #import <Foundation/Foundation.h>
 
+@class GRJsonWriter;
+
 extern NSString *GROMapperErrorDomain;
 
 typedef NS_ENUM(NSInteger, GROMapperErrorCode) {
@@ -123,6 +125,20 @@ typedef NS_ENUM(NSInteger, GROMapperErrorCode) {
  */
 + (id) map:(id)object to:(Class)clazz error:(NSError *__autoreleasing *)error;
 
+/**
+ Parses JSON and maps it to an instance of clazz in the same pass, following the same rules as
+ map:to:error:.  Objects are mapped onto their instances member by member as they are parsed, instead of
+ being built as dictionaries and mapped afterwards; members with no property are skipped without creating
+ anything.  Values that a custom mapping, a converter or concreteClassForObject: needs to see are still
+ built as dictionaries or arrays first.
+
+ @param data the UTF-8 JSON to map
+ @param clazz the class object to use for the converted object
+ @param error an out pointer that holds a parse error or any error encountered during conversion
+ @return an instance of the clazz object passed in (or an array of them), or nil if an error occurs
+ */
++ (id) mapData:(NSData *)data to:(Class)clazz error:(NSError *__autoreleasing *)error;
+
 
 /**
  Create a dictionary representation of a KVC-compliant object.  The mapping is as follows:
@@ -141,6 +157,17 @@ typedef NS_ENUM(NSInteger, GROMapperErrorCode) {
  */
 + (id) jsonObjectFrom:(id)object error:(NSError *__autoreleasing *)error;
 
+/**
+ Serializes a KVC-compliant object straight to JSON, following the same rules as jsonObjectFrom:error:, but
+ in a single pass that writes each property as it is read instead of building dictionaries first.  Member
+ order follows the class's property order.
+
+ @param object the object to convert
+ @param error an out pointer that holds an error encountered during conversion
+ @return the UTF-8 JSON, or nil if an error occurs
+ */
++ (NSData *) jsonDataFrom:(id)object error:(NSError *__autoreleasing *)error;
+
 
 /**
  Maps a source object (should be either a dictionary or an array) to an instance of clazz.
@@ -152,8 +179,21 @@ typedef NS_ENUM(NSInteger, GROMapperErrorCode) {
  */
 - (id) mapSource:(id)object to:(Class)clazz error:(NSError *__autoreleasing *)error;
 
+/** Same as +mapData:to:error:, using this mapper (and its ignoreNulls setting). */
+- (id) mapData:(NSData *)data to:(Class)clazz error:(NSError *__autoreleasing *)error;
+
 - (void) map:(NSDictionary <NSString*,id> *)source toObject:(id)target;
 
 - (id) jsonObjectFor:(id)object error:(NSError *__autoreleasing *)error;
 
+/**
+ Writes the JSON for object to writer, as part of whatever the writer is in the middle of.
+
+ @param object the object to convert
+ @param writer where the JSON goes; it is not finished, so more can be written after object
+ @param error an out pointer that holds an error encountered during conversion
+ @return YES if the object was written
+ */
+- (BOOL) writeJSONFor:(id)object toWriter:(GRJsonWriter *)writer error:(NSError *__autoreleasing *)error;
+
 @end
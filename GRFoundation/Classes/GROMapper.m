@@ -7,6 +7,8 @@
 //
 
 #import "GROMapper.h"
+#import "GRJsonWriter.h"
+#import "GRJson.h"
 #import <objc/runtime.h>
 
 #import "Logging.h"
@@ -165,6 +167,15 @@ static NSError * errorWithCodeAndDescription(NSInteger code, NSString *format, .
 	return [NSError errorWithDomain:GROMapperErrorDomain code:code userInfo:@{NSLocalizedDescriptionKey: str}];
 }
 
+static NSError * errorFromException(NSException *exception) {
+	NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:exception.userInfo];
+	userInfo[NSLocalizedDescriptionKey] = exception.reason;
+	if ([exception.name isEqualToString:NSUndefinedKeyException]) {
+		return [NSError errorWithDomain:GROMapperErrorDomain code:GROMapperErrorCodeNotKeyValueCodingCompliant userInfo:userInfo];
+	}
+	return [NSError errorWithDomain:GROMapperErrorDomain code:GROMapperErrorCodeGeneralError userInfo:userInfo];
+}
+
 static Class classForProperty(objc_property_t property) {
 	if (property != NULL) {
 		const char *attr = property_getAttributes(property);
@@ -201,6 +212,448 @@ static Class classForKeyWithTarget(NSString *key, id target) {
 	return nil;
 }
 
+@interface GROMapper ()
+
+- (void) mapValue:(id)origValue forKey:(NSString *)key toObject:(id)target;
+
+@end
+
+#pragma mark - mapping straight from JSON
+
+typedef NS_ENUM(NSInteger, GROMappingFrameKind) {
+	GROMappingFrameRoot,
+	GROMappingFrameModel,          ///< an object being mapped onto an instance, member by member
+	GROMappingFrameModelArray,     ///< an array of objects, each one mapped onto a new instance
+	GROMappingFramePendingArray,   ///< an array whose first element has not been seen yet
+	GROMappingFrameDictionary,     ///< an object kept as a plain NSDictionary
+	GROMappingFrameArray,          ///< an array kept as a plain NSArray
+};
+
+/** How the members of a JSON object with a given key are mapped onto instances of a given class */
+@interface GROMappingKeyPlan : NSObject {
+@public
+	NSString *propertyName;   ///< nil if there is no property for the key
+	Class propertyClass;      ///< nil for primitives, blocks and id
+	Class arrayClass;         ///< from GROArrayClass, for an array of objects
+	BOOL deferred;            ///< the key has a custom mapping or converter, so its value is handed to mapValue:forKey:toObject:
+}
+@end
+
+@implementation GROMappingKeyPlan
+@end
+
+@interface GROMappingFrame : NSObject {
+@public
+	GROMappingFrameKind kind;
+	id container;             ///< the instance, or the mutable array or dictionary, being filled in
+	Class elementClass;       ///< the class a root or array of objects is mapped to
+	BOOL mapsTrees;           ///< elements are built as dictionaries first, for concreteClassForObject:
+	BOOL mapsValue;           ///< the value in progress goes through mapValue:forKey:toObject: once it is built
+	NSString *key;
+	GROMappingKeyPlan *plan;
+}
+@end
+
+@implementation GROMappingFrame
+@end
+
+/** runs the body of one parse event, turning whatever it throws into the mapping error and ignoring every event after that */
+#define MAPPING_EVENT(body) \
+	if (mappingError != nil) return; \
+	@try { body; } \
+	@catch (NSError *thrown) { mappingError = thrown; } \
+	@catch (NSException *exception) { mappingError = errorFromException(exception); }
+
+/**
+ Maps parse events onto objects as they arrive, following the same rules as map:toObject:, so that no
+ NSDictionary or NSArray is built for the parts of the document that end up as properties.  Values that
+ the rules need to see whole (custom mappings, converters and concreteClassForObject:) are still built as
+ trees and handed to the mapper, and values with no property are skipped without creating anything.
+ */
+@interface GROMappingDelegate : NSObject <GRJsonDelegate> {
+	GROMapper *mapper;
+	NSMutableArray<GROMappingFrame *> *frames;
+	NSUInteger depth;
+	NSUInteger skipDepth;
+	NSMapTable<Class, NSMutableDictionary<NSString *, GROMappingKeyPlan *> *> *plans;
+	GRJsonScratch scratch;
+}
+
+@property (nonatomic, readonly) id result;
+@property (nonatomic, readonly) NSError *mappingError;
+
+- (instancetype) initWithMapper:(GROMapper *)mapper rootClass:(Class)clazz;
+
+@end
+
+@implementation GROMappingDelegate
+
+@synthesize result, mappingError;
+
+- (instancetype) initWithMapper:(GROMapper *)mapperIn rootClass:(Class)clazz {
+	self = [super init];
+	if (self) {
+		mapper = mapperIn;
+		frames = [NSMutableArray arrayWithCapacity:8];
+		plans = [NSMapTable strongToStrongObjectsMapTable];
+		GRJsonScratchInit(&scratch);
+		GROMappingFrame *root = [self pushFrame:GROMappingFrameRoot container:nil];
+		root->elementClass = clazz;
+	}
+	return self;
+}
+
+- (void) dealloc {
+	GRJsonScratchDestroy(&scratch);
+}
+
+- (GROMappingFrame *) pushFrame:(GROMappingFrameKind)kind container:(id)container {
+	GROMappingFrame *frame = nil;
+	if (depth < frames.count) {
+		frame = frames[depth];
+	}
+	else {
+		frame = [[GROMappingFrame alloc] init];
+		[frames addObject:frame];
+	}
+	depth++;
+	frame->kind = kind;
+	frame->container = container;
+	frame->elementClass = nil;
+	frame->mapsTrees = NO;
+	frame->mapsValue = NO;
+	frame->key = nil;
+	frame->plan = nil;
+	return frame;
+}
+
+- (GROMappingKeyPlan *) planForKey:(NSString *)key target:(id)target {
+	Class targetClass = [target class];
+	NSMutableDictionary<NSString *, GROMappingKeyPlan *> *classPlans = [plans objectForKey:targetClass];
+	if (classPlans == nil) {
+		classPlans = [NSMutableDictionary dictionary];
+		[plans setObject:classPlans forKey:targetClass];
+	}
+	GROMappingKeyPlan *plan = classPlans[key];
+	if (plan) {
+		return plan;
+	}
+	plan = [[GROMappingKeyPlan alloc] init];
+	// the same lookups as mapValue:forKey:toObject:, made once per class and key
+	NSString *propertyName = key;
+	objc_property_t property = class_getProperty(targetClass, key.UTF8String);
+	if (!property) {
+		SEL selector = NSSelectorFromString([PROPERTY_MAP_PREFIX stringByAppendingString:key]);
+		if (class_respondsToSelector(targetClass, selector)) {
+			IMP imp = class_getMethodImplementation(targetClass, selector);
+			NSString* (*func)(id, SEL) = (void *)imp;
+			propertyName = func(target, selector);
+			property = class_getProperty(targetClass, propertyName.UTF8String);
+		}
+	}
+	if (property) {
+		plan->propertyName = propertyName;
+		plan->propertyClass = classForProperty(property);
+	}
+	plan->arrayClass = classForKeyWithTarget(key, target);
+	plan->deferred = class_respondsToSelector(targetClass, NSSelectorFromString([CUSTOM_MAPPING_PREFIX stringByAppendingString:key])) ||
+		class_respondsToSelector(targetClass, NSSelectorFromString([CONVERTER_BLOCK_PREFIX stringByAppendingString:key]));
+	classPlans[key] = plan;
+	return plan;
+}
+
+static id newInstance(Class clazz) {
+	id instance = [[clazz alloc] init];
+	if (!instance) @throw errorWithCodeAndDescription(GROMapperErrorCodeCouldNotCreateInstanceOfMappedClass, @"could not create object from class: %@", clazz);
+	return instance;
+}
+
+/** maps an object that was built as a dictionary onto an instance of whatever class concreteClassForObject: picks */
+- (id) mapTree:(NSDictionary *)tree toClass:(Class)clazz {
+	id instance = newInstance([clazz concreteClassForObject:tree]);
+	[mapper map:tree toObject:instance];
+	return instance;
+}
+
+- (void) beginContainer:(BOOL)isObject {
+	if (skipDepth > 0) {
+		skipDepth++;
+		return;
+	}
+	GROMappingFrame *parent = frames[depth - 1];
+	switch (parent->kind) {
+		case GROMappingFrameRoot:
+			if (!isObject) {
+				[self pushFrame:GROMappingFramePendingArray container:nil]->elementClass = parent->elementClass;
+			}
+			else if ([parent->elementClass respondsToSelector:@selector(concreteClassForObject:)]) {
+				parent->mapsTrees = YES;
+				[self pushFrame:GROMappingFrameDictionary container:[NSMutableDictionary dictionary]];
+			}
+			else {
+				[self pushFrame:GROMappingFrameModel container:newInstance(parent->elementClass)];
+			}
+			break;
+		case GROMappingFrameModel:
+		{
+			GROMappingKeyPlan *plan = parent->plan;
+			if (plan->deferred) {
+				parent->mapsValue = YES;
+				[self pushFrame:(isObject ? GROMappingFrameDictionary : GROMappingFrameArray) container:(isObject ? [NSMutableDictionary dictionary] : [NSMutableArray array])];
+			}
+			else if (plan->propertyName == nil) {
+				// no property, nothing to map it to
+				skipDepth = 1;
+			}
+			else if (!isObject) {
+				parent->mapsValue = NO;
+				[self pushFrame:GROMappingFramePendingArray container:nil]->elementClass = plan->arrayClass;
+			}
+			else if (!plan->propertyClass) {
+				DDLogWarn(@"cannot map value of type '%@' to a block or primitive type for property %@", NSStringFromClass([NSDictionary class]), plan->propertyName);
+				skipDepth = 1;
+			}
+			else if ([NSDictionary isSubclassOfClass:plan->propertyClass]) {
+				// the dictionary itself is what gets set
+				parent->mapsValue = NO;
+				[self pushFrame:GROMappingFrameDictionary container:[NSMutableDictionary dictionary]];
+			}
+			else if ([plan->propertyClass respondsToSelector:@selector(concreteClassForObject:)]) {
+				parent->mapsValue = YES;
+				[self pushFrame:GROMappingFrameDictionary container:[NSMutableDictionary dictionary]];
+			}
+			else {
+				parent->mapsValue = NO;
+				[self pushFrame:GROMappingFrameModel container:newInstance(plan->propertyClass)];
+			}
+			break;
+		}
+		case GROMappingFramePendingArray:
+			if (!isObject) {
+				parent->kind = GROMappingFrameArray;
+				parent->container = [NSMutableArray array];
+				[self pushFrame:GROMappingFrameArray container:[NSMutableArray array]];
+				break;
+			}
+			parent->kind = GROMappingFrameModelArray;
+			parent->container = [NSMutableArray array];
+			parent->mapsTrees = [parent->elementClass respondsToSelector:@selector(concreteClassForObject:)];
+			// fall through to the first element
+		case GROMappingFrameModelArray:
+			if (!isObject) @throw errorWithCodeAndDescription(GROMapperErrorCodeGeneralError, @"expected an object in an array of %@, found an array", parent->elementClass);
+			if (parent->mapsTrees) {
+				[self pushFrame:GROMappingFrameDictionary container:[NSMutableDictionary dictionary]];
+			}
+			else {
+				[self pushFrame:GROMappingFrameModel container:newInstance(parent->elementClass)];
+			}
+			break;
+		case GROMappingFrameDictionary:
+		case GROMappingFrameArray:
+			[self pushFrame:(isObject ? GROMappingFrameDictionary : GROMappingFrameArray) container:(isObject ? [NSMutableDictionary dictionary] : [NSMutableArray array])];
+			break;
+	}
+}
+
+- (void) endContainer {
+	if (skipDepth > 0) {
+		skipDepth--;
+		return;
+	}
+	if (depth <= 1) {
+		return;
+	}
+	GROMappingFrame *frame = frames[--depth];
+	id value = nil;
+	switch (frame->kind) {
+		case GROMappingFrameModel:
+		case GROMappingFrameModelArray:
+			value = frame->container;
+			break;
+		case GROMappingFramePendingArray:
+			value = [NSArray array];
+			break;
+		case GROMappingFrameDictionary:
+		case GROMappingFrameArray:
+			value = [frame->container copy];
+			break;
+		case GROMappingFrameRoot:
+			break;
+	}
+	frame->container = nil;
+	frame->key = nil;
+	frame->plan = nil;
+	[self deliverValue:value];
+}
+
+/** hands a finished object or array to the frame it belongs to */
+- (void) deliverValue:(id)value {
+	GROMappingFrame *parent = frames[depth - 1];
+	switch (parent->kind) {
+		case GROMappingFrameRoot:
+			result = parent->mapsTrees ? [self mapTree:value toClass:parent->elementClass] : value;
+			break;
+		case GROMappingFrameModel:
+			if (parent->mapsValue) {
+				[mapper mapValue:value forKey:parent->key toObject:parent->container];
+			}
+			else if (value) {
+				[parent->container setValue:value forKey:parent->plan->propertyName];
+			}
+			break;
+		case GROMappingFrameModelArray:
+			[parent->container addObject:(parent->mapsTrees ? [self mapTree:value toClass:parent->elementClass] : value)];
+			break;
+		case GROMappingFrameDictionary:
+			((NSMutableDictionary *)parent->container)[parent->key] = value;
+			break;
+		case GROMappingFrameArray:
+			[parent->container addObject:value];
+			break;
+		case GROMappingFramePendingArray:
+			break;
+	}
+}
+
+/** a string, number, boolean or null (as NSNull) */
+- (void) scalarValue:(id)value {
+	if (skipDepth > 0) {
+		return;
+	}
+	GROMappingFrame *parent = frames[depth - 1];
+	switch (parent->kind) {
+		case GROMappingFrameRoot:
+			// a null document maps to nil
+			if (value != [NSNull null]) @throw errorWithCodeAndDescription(GROMapperErrorCodeInvalidRootJSONObject, @"Cannot map a JSON basic type (string, number, etc).  Root of the JSON must be an array or object.");
+			break;
+		case GROMappingFrameModel:
+		{
+			GROMappingKeyPlan *plan = parent->plan;
+			if (mapper.ignoreNulls && value == [NSNull null]) {
+				break;
+			}
+			if (plan->deferred) {
+				[mapper mapValue:value forKey:parent->key toObject:parent->container];
+			}
+			else if (plan->propertyName) {
+				[parent->container setValue:value forKey:plan->propertyName];
+			}
+			break;
+		}
+		case GROMappingFramePendingArray:
+			parent->kind = GROMappingFrameArray;
+			parent->container = [NSMutableArray array];
+			[parent->container addObject:value];
+			break;
+		case GROMappingFrameModelArray:
+			@throw errorWithCodeAndDescription(GROMapperErrorCodeGeneralError, @"expected an object in an array of %@, found '%@'", parent->elementClass, value);
+			break;
+		case GROMappingFrameDictionary:
+			((NSMutableDictionary *)parent->container)[parent->key] = value;
+			break;
+		case GROMappingFrameArray:
+			[parent->container addObject:value];
+			break;
+	}
+}
+
+- (void) objectKey:(NSString *)key {
+	GROMappingFrame *frame = frames[depth - 1];
+	frame->key = key;
+	if (frame->kind == GROMappingFrameModel) {
+		frame->plan = [self planForKey:key target:frame->container];
+	}
+}
+
+- (void) json_null {
+	MAPPING_EVENT([self scalarValue:[NSNull null]])
+}
+
+- (void) json_bool:(BOOL)boolVal {
+	MAPPING_EVENT([self scalarValue:@(boolVal)])
+}
+
+- (void) json_number:(const unsigned char *)numberVal length:(unsigned long)len {
+	int64_t integer;
+	double real;
+	switch (GRJsonParseNumber(numberVal, len, &integer, &real)) {
+		case GRJsonNumberInteger:
+			[self json_integer:integer];
+			break;
+		case GRJsonNumberDouble:
+			[self json_double:real];
+			break;
+		case GRJsonNumberInvalid:
+			MAPPING_EVENT(@throw errorWithCodeAndDescription(GROMapperErrorCodeGeneralError, @"could not read the number '%@'", [[NSString alloc] initWithBytes:numberVal length:len encoding:NSASCIIStringEncoding]))
+			break;
+	}
+}
+
+- (void) json_integer:(int64_t)value {
+	MAPPING_EVENT([self scalarValue:@(value)])
+}
+
+- (void) json_double:(double)value {
+	MAPPING_EVENT([self scalarValue:@(value)])
+}
+
+- (void) json_string:(NSString *)strVal {
+	MAPPING_EVENT([self scalarValue:strVal])
+}
+
+/** whether scalarValue: would drop a value arriving now: it is being skipped, or it has no property and no custom mapping */
+- (BOOL) dropsScalar {
+	if (skipDepth > 0) {
+		return YES;
+	}
+	GROMappingFrame *parent = frames[depth - 1];
+	if (parent->kind != GROMappingFrameModel) {
+		return NO;
+	}
+	GROMappingKeyPlan *plan = parent->plan;
+	return plan != nil && !plan->deferred && plan->propertyName == nil;
+}
+
+- (void) json_string_bytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii {
+	if (mappingError != nil || [self dropsScalar]) {
+		// values that are not mapped never become strings
+		return;
+	}
+	MAPPING_EVENT([self scalarValue:[GRJson stringWithBytes:bytes length:len needsUnescape:needsUnescape ascii:ascii scratch:&scratch] ?: (id)[NSNull null]])
+}
+
+- (void) json_object_key:(NSString *)key {
+	if (skipDepth > 0) {
+		return;
+	}
+	MAPPING_EVENT([self objectKey:key])
+}
+
+- (void) json_object_key_bytes:(const unsigned char *)bytes length:(unsigned long)len needsUnescape:(BOOL)needsUnescape ascii:(BOOL)ascii {
+	if (skipDepth > 0) {
+		return;
+	}
+	MAPPING_EVENT([self objectKey:[GRJson stringWithBytes:bytes length:len needsUnescape:needsUnescape ascii:ascii scratch:&scratch] ?: @""])
+}
+
+- (void) json_object_begin {
+	MAPPING_EVENT([self beginContainer:YES])
+}
+
+- (void) json_object_end {
+	MAPPING_EVENT([self endContainer])
+}
+
+- (void) json_array_begin {
+	MAPPING_EVENT([self beginContainer:NO])
+}
+
+- (void) json_array_end {
+	MAPPING_EVENT([self endContainer])
+}
+
+@end
+
 @implementation GROMapper
 
 @synthesize ignoreNulls;
@@ -221,10 +674,22 @@ static Class classForKeyWithTarget(NSString *key, id target) {
 	return [[self mapper] mapSource:source to:clazz error:error];
 }
 
++ (id) mapData:(NSData *)data to:(Class)clazz error:(NSError *__autoreleasing *)error {
+	return [[self mapper] mapData:data to:clazz error:error];
+}
+
 + (id) jsonObjectFrom:(id)object error:(NSError *__autoreleasing *)error {
 	return [[self mapper] jsonObjectFor:object error:error];
 }
 
++ (NSData *) jsonDataFrom:(id)object error:(NSError *__autoreleasing *)error {
+	GRJsonWriter *writer = [[GRJsonWriter alloc] init];
+	if (![[self mapper] writeJSONFor:object toWriter:writer error:error] || ![writer finish:error]) {
+		return nil;
+	}
+	return writer.data;
+}
+
 - (id) mapSource:(id)source to:(Class)clazz error:(NSError *__autoreleasing *)error {
 	id rootObj = nil;
 	@try {
@@ -277,19 +742,8 @@ static Class classForKeyWithTarget(NSString *key, id target) {
 		}
 		rootObj = nil;
 	} @catch (NSException *exception) {
-		NSError *toRaise = nil;
-		if ([exception.name isEqualToString:NSUndefinedKeyException]) {
-			NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:exception.userInfo];
-			userInfo[NSLocalizedDescriptionKey] = exception.reason;
-			toRaise = [NSError errorWithDomain:GROMapperErrorDomain code:GROMapperErrorCodeNotKeyValueCodingCompliant userInfo:userInfo];
-		}
-		else {
-			NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:exception.userInfo];
-			userInfo[NSLocalizedDescriptionKey] = exception.reason;
-			toRaise = [NSError errorWithDomain:GROMapperErrorDomain code:GROMapperErrorCodeGeneralError userInfo:userInfo];
-		}
 		if (error) {
-			*error = toRaise;
+			*error = errorFromException(exception);
 		}
 		rootObj = nil;
 	}@finally {
@@ -298,112 +752,146 @@ static Class classForKeyWithTarget(NSString *key, id target) {
 	return rootObj;
 }
 
+- (id) mapData:(NSData *)data to:(Class)clazz error:(NSError *__autoreleasing *)error {
+	id rootObj = nil;
+	@try {
+		if (data == nil) @throw errorWithCodeAndDescription(GROMapperErrorCodeSourceJSONIsNil, @"source JSON data is nil");
+		if (clazz == nil) @throw errorWithCodeAndDescription(GROMapperErrorCodeMappingClassIsNil, @"Class to map to cannot be nil");
+		
+		GROMappingDelegate *delegate = [[GROMappingDelegate alloc] initWithMapper:self rootClass:clazz];
+		GRJson *json = [[GRJson alloc] initWithData:data delegate:delegate];
+		NSError *parseError = nil;
+		if (![json parse:&parseError]) {
+			@throw parseError ?: errorWithCodeAndDescription(GROMapperErrorCodeGeneralError, @"could not parse the source JSON");
+		}
+		if (delegate.mappingError) {
+			@throw delegate.mappingError;
+		}
+		rootObj = delegate.result;
+	} @catch (NSError *thrown) {
+		if (error) {
+			*error = thrown;
+		}
+		rootObj = nil;
+	} @catch (NSException *exception) {
+		if (error) {
+			*error = errorFromException(exception);
+		}
+		rootObj = nil;
+	}
+	return rootObj;
+}
+
 - (void) map:(NSDictionary <NSString*,id> *)source toObject:(id)target {
-	Class targetClass = [target class];
-	id nullInstance = [NSNull null];
 	for (NSString *key in source.allKeys) {
 		@autoreleasepool {
-			id origValue = source[key];
-			if (ignoreNulls && origValue == nullInstance) {
-				// we will ignore it at the end, short-circuit the whole process and move on
-				continue;
-			}
-			SEL customMappingSelector = NSSelectorFromString([CUSTOM_MAPPING_PREFIX stringByAppendingString:key]);
-			if (class_respondsToSelector(targetClass, customMappingSelector)) {
-				IMP imp = class_getMethodImplementation(targetClass, customMappingSelector);
-				id (*func)(id, SEL) = (void *)imp;
-				void (^customMappingBlock)(id original) = func(target, customMappingSelector);
-				if (customMappingBlock) {
-					customMappingBlock(origValue);
-					continue;
-				}
+			[self mapValue:source[key] forKey:key toObject:target];
+		}
+	}
+}
 
+/** maps one member of a JSON object onto target, following the rules described in GROMapper.h */
+- (void) mapValue:(id)origValue forKey:(NSString *)key toObject:(id)target {
+	Class targetClass = [target class];
+	id nullInstance = [NSNull null];
+	if (ignoreNulls && origValue == nullInstance) {
+		// we will ignore it at the end, short-circuit the whole process and move on
+		return;
+	}
+	SEL customMappingSelector = NSSelectorFromString([CUSTOM_MAPPING_PREFIX stringByAppendingString:key]);
+	if (class_respondsToSelector(targetClass, customMappingSelector)) {
+		IMP imp = class_getMethodImplementation(targetClass, customMappingSelector);
+		id (*func)(id, SEL) = (void *)imp;
+		void (^customMappingBlock)(id original) = func(target, customMappingSelector);
+		if (customMappingBlock) {
+			customMappingBlock(origValue);
+			return;
+		}
+
+	}
+	// first, grab the property using only the key
+	NSString *propertyName = key;
+	objc_property_t property = class_getProperty(targetClass, key.UTF8String);
+	if (!property) {
+		// if that is not found, try a mapping
+		SEL selector = NSSelectorFromString([PROPERTY_MAP_PREFIX stringByAppendingString:key]);
+		if (class_respondsToSelector(targetClass, selector)) {
+			IMP imp = class_getMethodImplementation(targetClass, selector);
+			NSString* (*func)(id, SEL) = (void *)imp;
+			propertyName = func(target, selector);
+			property = class_getProperty(targetClass, propertyName.UTF8String);
+		}
+	}
+	if (property == NULL) {
+		// if there is no property, ignore it and move on.
+		return;
+	}
+	id actualValue = origValue;
+	SEL conversionSelector = NSSelectorFromString([CONVERTER_BLOCK_PREFIX stringByAppendingString:key]);
+	if (class_respondsToSelector(targetClass, conversionSelector)) {
+		IMP imp = class_getMethodImplementation(targetClass, conversionSelector);
+		id (*func)(id, SEL) = (void *)imp;
+		id (^converterBlock)(id original) = func(target, conversionSelector);
+		if (converterBlock) {
+			actualValue = converterBlock(origValue);
+		}
+	}
+	id valueToSet = nil;
+	switch (targetType(actualValue)) {
+		case GROTargetTypeUnknown:
+			// can't hit this case currently
+			break;
+		case GROTargetTypeCustomObject:
+		{
+			Class propertyClass = classForProperty(property);
+			if (!propertyClass) {
+				// we have a custom object (aka a dict) and the property we are setting has no class
+				// which means it is either a block or a primitive type, no mapping is therefore possible
+				DDLogWarn(@"cannot map value of type '%@' to a block or primitive type for property %@", NSStringFromClass([actualValue class]), propertyName);
+				return;
 			}
-			// first, grab the property using only the key
-			NSString *propertyName = key;
-			objc_property_t property = class_getProperty(targetClass, key.UTF8String);
-			if (!property) {
-				// if that is not found, try a mapping
-				SEL selector = NSSelectorFromString([PROPERTY_MAP_PREFIX stringByAppendingString:key]);
-				if (class_respondsToSelector(targetClass, selector)) {
-					IMP imp = class_getMethodImplementation(targetClass, selector);
-					NSString* (*func)(id, SEL) = (void *)imp;
-					propertyName = func(target, selector);
-					property = class_getProperty(targetClass, propertyName.UTF8String);
-				}
-			}
-			if (property == NULL) {
-				// if there is no property, ignore it and move on.
-				continue;
-			}
-			id actualValue = origValue;
-			SEL conversionSelector = NSSelectorFromString([CONVERTER_BLOCK_PREFIX stringByAppendingString:key]);
-			if (class_respondsToSelector(targetClass, conversionSelector)) {
-				IMP imp = class_getMethodImplementation(targetClass, conversionSelector);
-				id (*func)(id, SEL) = (void *)imp;
-				id (^converterBlock)(id original) = func(target, conversionSelector);
-				if (converterBlock) {
-					actualValue = converterBlock(origValue);
-				}
+			else if ([actualValue isKindOfClass:propertyClass]) {
+				// the value we are setting matches the property's class, just do a direct set
+				valueToSet = actualValue;
 			}
-			id valueToSet = nil;
-			switch (targetType(actualValue)) {
-				case GROTargetTypeUnknown:
-					// can't hit this case currently
-					break;
-				case GROTargetTypeCustomObject:
-				{
-					Class propertyClass = classForProperty(property);
-					if (!propertyClass) {
-						// we have a custom object (aka a dict) and the property we are setting has no class
-						// which means it is either a block or a primitive type, no mapping is therefore possible
-						DDLogWarn(@"cannot map value of type '%@' to a block or primitive type for property %@", NSStringFromClass([actualValue class]), propertyName);
-						continue;
-					}
-					else if ([actualValue isKindOfClass:propertyClass]) {
-						// the value we are setting matches the property's class, just do a direct set
-						valueToSet = actualValue;
-					}
-					else {
-						if ([propertyClass respondsToSelector:@selector(concreteClassForObject:)]) {
-							Class actualClass = [propertyClass concreteClassForObject:actualValue];
-							valueToSet = [[actualClass alloc] init];
-						}
-						else {
-							valueToSet = [[propertyClass alloc] init];
-						}
-						[self map:actualValue toObject:valueToSet];
-					}
-					break;
-				}
-				case GROTargetTypeArray:
-				{
-					NSArray *array = actualValue;
-					if (array.count == 0) {
-						valueToSet = [NSArray array];
-					}
-					else if (jsonType(array.firstObject) == GROJsonTypeObject) {
-						valueToSet = [NSMutableArray arrayWithCapacity:array.count];
-						Class arrayClass = classForKeyWithTarget(key, target);
-						[self map:actualValue toArray:valueToSet withClass:arrayClass];
-					}
-					else {
-						// do nothing - it is an array of basic (or wrapped) types (or should be)
-						valueToSet = actualValue;
-					}
-					break;
+			else {
+				if ([propertyClass respondsToSelector:@selector(concreteClassForObject:)]) {
+					Class actualClass = [propertyClass concreteClassForObject:actualValue];
+					valueToSet = [[actualClass alloc] init];
 				}
-				case GROTargetTypeBasicOrWrappedValue:
-				{
-					valueToSet = actualValue;
-					break;
+				else {
+					valueToSet = [[propertyClass alloc] init];
 				}
+				[self map:actualValue toObject:valueToSet];
 			}
-			if (valueToSet || !ignoreNulls) {
-				[target setValue:valueToSet forKey:propertyName];
+			break;
+		}
+		case GROTargetTypeArray:
+		{
+			NSArray *array = actualValue;
+			if (array.count == 0) {
+				valueToSet = [NSArray array];
+			}
+			else if (jsonType(array.firstObject) == GROJsonTypeObject) {
+				valueToSet = [NSMutableArray arrayWithCapacity:array.count];
+				Class arrayClass = classForKeyWithTarget(key, target);
+				[self map:actualValue toArray:valueToSet withClass:arrayClass];
 			}
+			else {
+				// do nothing - it is an array of basic (or wrapped) types (or should be)
+				valueToSet = actualValue;
+			}
+			break;
+		}
+		case GROTargetTypeBasicOrWrappedValue:
+		{
+			valueToSet = actualValue;
+			break;
 		}
 	}
+	if (valueToSet || !ignoreNulls) {
+		[target setValue:valueToSet forKey:propertyName];
+	}
 }
 
 - (void) map:(NSArray *)source toArray:(NSMutableArray *)array withClass:(Class)clazz {
@@ -438,19 +926,8 @@ static Class classForKeyWithTarget(NSString *key, id target) {
 		}
 		rootObj = nil;
 	} @catch (NSException *exception) {
-		NSError *toRaise = nil;
-		if ([exception.name isEqualToString:NSUndefinedKeyException]) {
-			NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:exception.userInfo];
-			userInfo[NSLocalizedDescriptionKey] = exception.reason;
-			toRaise = [NSError errorWithDomain:GROMapperErrorDomain code:GROMapperErrorCodeNotKeyValueCodingCompliant userInfo:userInfo];
-		}
-		else {
-			NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:exception.userInfo];
-			userInfo[NSLocalizedDescriptionKey] = exception.reason;
-			toRaise = [NSError errorWithDomain:GROMapperErrorDomain code:GROMapperErrorCodeGeneralError userInfo:userInfo];
-		}
 		if (error) {
-			*error = toRaise;
+			*error = errorFromException(exception);
 		}
 		rootObj = nil;
 	} @finally {
@@ -581,4 +1058,150 @@ static Class classForKeyWithTarget(NSString *key, id target) {
 	return convertedObj;
 }
 
+#pragma mark - writing JSON directly
+
+- (BOOL) writeJSONFor:(id)source toWriter:(GRJsonWriter *)writer error:(NSError *__autoreleasing *)error {
+	@try {
+		if (source == nil) @throw errorWithCodeAndDescription(GROMapperErrorCodeSourceObjectIsNil, @"object to convert to JSON is nil");
+		
+		[self writeJSON:source toWriter:writer];
+		
+	} @catch (NSError *thrown) {
+		if (error) {
+			*error = thrown;
+		}
+		return NO;
+	} @catch (NSException *exception) {
+		if (error) {
+			*error = errorFromException(exception);
+		}
+		return NO;
+	}
+	if (writer.error) {
+		if (error) {
+			*error = writer.error;
+		}
+		return NO;
+	}
+	return YES;
+}
+
+/** The single-pass counterpart of convertToJSON: */
+- (void) writeJSON:(id)source toWriter:(GRJsonWriter *)writer {
+	switch (sourceObjectType(source)) {
+		case GROSourceTypeDictionary:
+		{
+			[writer beginObject];
+			[(NSDictionary *)source enumerateKeysAndObjectsUsingBlock:^(id  _Nonnull key, id  _Nonnull obj, BOOL * _Nonnull stop) {
+				[writer writeKey:key];
+				[self writeJSON:obj toWriter:writer];
+			}];
+			[writer endObject];
+			break;
+		}
+		case GROSourceTypeArray:
+		{
+			[writer beginArray];
+			for (id object in (NSArray *)source) {
+				[self writeJSON:object toWriter:writer];
+			}
+			[writer endArray];
+			break;
+		}
+		case GROSourceTypeCustomObject:
+			[self writeCustomObject:source toWriter:writer];
+			break;
+		case GROSourceTypeString:
+			[writer writeString:source];
+			break;
+		case GROSourceTypeNumber:
+			[writer writeNumber:source];
+			break;
+		case GROSourceTypeNull:
+			[writer writeNull];
+			break;
+		default:
+			break;
+	}
+}
+
+/** The single-pass counterpart of convertCustomObject: */
+- (void) writeCustomObject:(id)customObj toWriter:(GRJsonWriter *)writer {
+	Class customClass = [customObj class];
+	NSSet<NSString*> *toInclude = nil;
+	NSSet<NSString*> *toExclude = nil;
+	unsigned int count = 0;
+	
+	if ([customClass respondsToSelector:@selector(excludePropertiesFromJSON)]) {
+		toExclude = [customClass excludePropertiesFromJSON];
+	}
+	else if ([customClass respondsToSelector:@selector(includePropertiesInJSON)]) {
+		toInclude = [customClass includePropertiesInJSON];
+	}
+	
+	objc_property_t *propList = class_copyPropertyList(customClass, &count);
+	[writer beginObject];
+	for (int i = 0; i < count; i++) {
+		objc_property_t property = propList[i];
+		NSString *propName = [NSString stringWithUTF8String:property_getName(property)];
+		if (toInclude != nil && [toInclude containsObject:propName] == NO) {
+			continue;
+		}
+		if (toExclude != nil && [toExclude containsObject:propName] == YES) {
+			continue;
+		}
+		const char *attr = property_getAttributes(property);
+		GROSourceType propType = sourceTypeFromAttributes(attr);
+		if (propType == GROSourceTypeInconvertibleValue) {
+			DDLogInfo(@"property '%@' (@encode-type '%s') from class '%@' cannot be converted to JSON", propName, attr, NSStringFromClass(customClass));
+			continue;
+		}
+		NSString *key = propName;
+		SEL selector = NSSelectorFromString([KEY_MAP_PREFIX stringByAppendingString:propName]);
+		if ([customObj respondsToSelector:selector]) {
+			IMP imp = class_getMethodImplementation(customClass, selector);
+			NSString* (*func)(id, SEL) = (void *)imp;
+			key = func(customObj, selector);
+		}
+		selector = NSSelectorFromString([JSON_CONVERSION_PREFIX stringByAppendingString:propName]);
+		if ([customObj respondsToSelector:selector]) {
+			IMP imp = class_getMethodImplementation(customClass, selector);
+			id (*func)(id, SEL) = (void *)imp;
+			id (^converterBlock)(void) = func(customObj, selector);
+			if (converterBlock) {
+				id value = converterBlock();
+				if (value && jsonType(value) != GROJsonTypeUnknown) {
+					[writer writeKey:key];
+					[writer writeObject:value];
+				}
+				else if (value) {
+					DDLogWarn(@"converter block for '%@' returned an invalid JSON value ('%@') of type %@", propName, value, NSStringFromClass([value class]));
+				}
+			}
+			else {
+				DDLogWarn(@"converter block for '%@' didn't return a valid block, value will not be converted", propName);
+			}
+			continue;
+		}
+		else if (propType == GROSourceTypePrimitive) {
+			id value = [customObj valueForKey:propName];
+			if (value) {
+				[writer writeKey:key];
+				[writer writeObject:value];
+			}
+		}
+		else if (propType == GROSourceTypeCustomObject) {
+			[writer writeKey:key];
+			[self writeJSON:[customObj valueForKey:propName] toWriter:writer];
+		}
+		else if (propType == GROSourceTypeNeedsConversionBlock) {
+			DDLogInfo(@"property '%@' with @encode-type '%s' will not be converted to JSON because no conversion block was specified", propName, attr);
+		}
+	}
+	[writer endObject];
+	if (propList) {
+		free(propList);
+	}
+}
+
 @end
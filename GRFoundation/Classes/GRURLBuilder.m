@@ -6,6 +6,7 @@
 //
 
 #import "GRURLBuilder.h"
+#import "GRJsonWriter.h"
 #import "Logging.h"
 
 static NSMutableDictionary * parseArgs(NSString *queryString) {
@@ -154,7 +155,7 @@ static NSMutableDictionary * parseArgs(NSString *queryString) {
 
 - (NSString *) jsonString {
     NSError *error = nil;
-	NSData *data = [NSJSONSerialization dataWithJSONObject:params options:0 error:&error];
+	NSData *data = [GRJsonWriter dataWithJSONObject:params error:&error];
     if (error) {
         NSLog(@"could not create JSON from dict '%@': %@", params, error);
     }
@@ -0,0 +1,40 @@
+//
+//  JsonSupport.h
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#ifndef GRFoundation_JsonSupport_h
+#define GRFoundation_JsonSupport_h
+
+#import <Foundation/Foundation.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "GRJsonString.h"
+
+/**
+ A GRJsonEmitterSink that writes to the NSOutputStream passed (bridged, not retained) as its context, for
+ the emitter and the transcoder alike.  It loops because a stream may take only part of what it is given.
+ */
+bool GRJsonWriteToStream(void *context, const uint8_t *bytes, size_t length);
+
+/**
+ The error every JSON class reports: code -1, with reason as the localized description.
+
+ @param domain @"GRJsonParser" for reading JSON, @"GRJsonWriter" for producing it
+ */
+NSError *GRJsonErrorWithReason(NSString *domain, NSString *reason);
+
+/**
+ The UTF-8 bytes of string.  ASCII strings are usually stored that way already and are read in place;
+ anything else is converted into scratch, which is reused from one string to the next.
+
+ @return the bytes, valid until scratch is next used, or NULL if scratch could not grow
+ */
+const uint8_t *GRJsonUTF8BytesOfString(NSString *string, GRJsonScratch *scratch, size_t *length);
+
+#endif /* GRFoundation_JsonSupport_h */
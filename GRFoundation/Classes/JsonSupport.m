@@ -0,0 +1,47 @@
+//
+//  JsonSupport.m
+//  Pods
+//
+//  Created by Grant Robinson on 10/17/26.
+//
+//
+
+#import "JsonSupport.h"
+
+bool GRJsonWriteToStream(void *context, const uint8_t *bytes, size_t length) {
+	NSOutputStream *stream = (__bridge NSOutputStream *)context;
+	while (length > 0) {
+		NSInteger written = [stream write:bytes maxLength:length];
+		if (written <= 0) {
+			return false;
+		}
+		bytes += written;
+		length -= (size_t)written;
+	}
+	return true;
+}
+
+NSError *GRJsonErrorWithReason(NSString *domain, NSString *reason) {
+	return [NSError errorWithDomain:domain code:-1 userInfo:@{NSLocalizedDescriptionKey: reason}];
+}
+
+const uint8_t *GRJsonUTF8BytesOfString(NSString *string, GRJsonScratch *scratch, size_t *length) {
+	CFStringRef cfString = (__bridge CFStringRef)string;
+	CFIndex characters = CFStringGetLength(cfString);
+	const char *direct = CFStringGetCStringPtr(cfString, kCFStringEncodingUTF8);
+	// a byte count that matches the character count means ASCII with no embedded NUL
+	if (direct && strlen(direct) == (size_t)characters) {
+		*length = (size_t)characters;
+		return (const uint8_t *)direct;
+	}
+	// one more than needed, so even an empty string gets a buffer and NULL only means out of memory
+	size_t maximum = (size_t)CFStringGetMaximumSizeForEncoding(characters, kCFStringEncodingUTF8) + 1;
+	uint8_t *bytes = GRJsonScratchReserve(scratch, maximum);
+	if (bytes == NULL) {
+		return NULL;
+	}
+	CFIndex used = 0;
+	CFStringGetBytes(cfString, CFRangeMake(0, characters), kCFStringEncodingUTF8, 0, false, bytes, (CFIndex)scratch->capacity, &used);
+	*length = (size_t)used;
+	return bytes;
+}